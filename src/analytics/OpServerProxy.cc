@@ -11,6 +11,7 @@
 #include <boost/assert.hpp>
 #include "base/util.h"
 #include "base/logging.h"
+#include "base/task.h"
 #include "base/parse_object.h"
 #include <cstdlib>
 #include <utility>
@@ -29,6 +30,8 @@
 #include <base/connection_info.h>
 #include "redis_connection.h"
 #include "redis_processor_vizd.h"
+#include "uve_coalescer.h"
+#include "uve_value_cache.h"
 #include "viz_sandesh.h"
 #include "viz_collector.h"
 
@@ -91,6 +94,22 @@ class KafkaEventCb : public RdKafka::EventCb {
   }
 };
 
+// The UVE coalesce timer flushes the batches filled by UVEUpdate, which runs
+// in the sandesh state machine of the generators, and publishes to kafka
+// like the kafka timer. It runs exclusive of both.
+static void SetUVECoalesceTaskPolicy() {
+    static bool policy_set = false;
+    if (policy_set)
+        return;
+    policy_set = true;
+
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    TaskPolicy policy = list_of
+        (TaskExclusion(scheduler->GetTaskId("sandesh::SandeshStateMachine")))
+        (TaskExclusion(scheduler->GetTaskId("Kafka Timer")));
+    scheduler->SetPolicy(scheduler->GetTaskId("UVE Coalesce Timer"), policy);
+}
+
 static inline unsigned int djb_hash (const char *str, size_t len) {
     unsigned int hash = 5381;
     for (size_t i = 0 ; i < len ; i++)
@@ -112,6 +131,8 @@ class OpServerProxy::OpServerImpl {
         };
 
         static const int kActivityCheckPeriod_ms_ = 30000;
+        // Window over which UVE updates of a generator are coalesced
+        static const int kUVECoalescePeriod_ms_ = 100;
 
         const unsigned int partitions_;
 
@@ -169,14 +190,14 @@ class OpServerProxy::OpServerImpl {
                 rinfo_.set_conn_call_failed(0);
             }
 
-            void RedisUveUpdate() {
-                rinfo_.set_update_succeeded(rinfo_.get_update_succeeded()+1);
+            void RedisUveUpdate(uint64_t count = 1) {
+                rinfo_.set_update_succeeded(rinfo_.get_update_succeeded()+count);
             }
-            void RedisUveUpdateFail() {
-                rinfo_.set_update_failed(rinfo_.get_update_failed()+1);
+            void RedisUveUpdateFail(uint64_t count = 1) {
+                rinfo_.set_update_failed(rinfo_.get_update_failed()+count);
             }
-            void RedisUveUpdateNoConn() {
-                rinfo_.set_update_no_conn(rinfo_.get_update_no_conn()+1);
+            void RedisUveUpdateNoConn(uint64_t count = 1) {
+                rinfo_.set_update_no_conn(rinfo_.get_update_no_conn()+count);
             }
             void RedisUveDelete() {
                 rinfo_.set_delete_succeeded(rinfo_.get_delete_succeeded()+1);
@@ -214,8 +235,141 @@ class OpServerProxy::OpServerImpl {
                 redis_uve_info.set_conn_cb_failed(to_ops_conn_->CallbackFailed());
                 redis_uve_info.set_conn_cb_succeeded(to_ops_conn_->CallbackSucceeded());
             }
+            UVECoalescer::Stats cstats;
+            uve_coalescer_.GetStats(&cstats);
+            redis_uve_info.set_coalesce_updates_received(cstats.updates_received);
+            redis_uve_info.set_coalesce_updates_sent(cstats.updates_sent);
+            redis_uve_info.set_coalesce_updates_pending(
+                uve_coalescer_.PendingUpdates());
+            redis_uve_info.set_coalesce_notifs_received(cstats.notifs_received);
+            redis_uve_info.set_coalesce_notifs_sent(cstats.notifs_sent);
+            redis_uve_info.set_coalesce_flushes(cstats.flushes);
+            redis_uve_info.set_coalesce_flush_failures(
+                cstats.flush_failures);
+            redis_uve_info.set_coalesce_ratio(cstats.updates_sent ?
+                static_cast<double>(cstats.updates_received) /
+                    cstats.updates_sent : 0);
+            UVEValueCache::Stats vstats;
+            uve_value_cache_.GetStats(&vstats);
+            redis_uve_info.set_value_cache_lookups(vstats.lookups);
+            redis_uve_info.set_value_cache_suppressed(vstats.suppressed);
+            redis_uve_info.set_value_cache_evictions(vstats.evictions);
+            redis_uve_info.set_value_cache_entries(uve_value_cache_.Size());
+        }
+
+        // Sends the coalesced UVE updates of a generator to redis as one
+        // pipeline, followed by the coalesced notifications to kafka.
+        // Returns false if not all the updates were sent
+        bool UVEFlush(const UVECoalescer::GeneratorKey &gen,
+                      const UVECoalescer::UVEUpdateList &updates,
+                      const UVECoalescer::UVENotifList &notifs) {
+            bool success = true;
+            if (!updates.empty()) {
+                shared_ptr<RedisAsyncConnection> prac = to_ops_conn();
+                size_t sent = 0;
+                if (!prac) {
+                    redis_uve_.RedisUveUpdateNoConn(updates.size());
+                } else {
+                    sent = RedisProcessorExec::UVEUpdates(prac.get(),
+                        NULL, gen.get<0>(), gen.get<1>(), gen.get<2>(),
+                        gen.get<3>(), updates);
+                    redis_uve_.RedisUveUpdate(sent);
+                    redis_uve_.RedisUveUpdateFail(updates.size() - sent);
+                }
+                // Values that did not make it to redis must not be
+                // suppressed when they are published again
+                if (sent != updates.size()) {
+                    uve_value_cache_.DeleteGenerator(gen);
+                    LOG(ERROR, "UVE Flush: " << gen.get<0>() << ":" <<
+                        gen.get<1>() << ":" << gen.get<2>() << ":" <<
+                        gen.get<3>() << " Sent " << sent << " of " <<
+                        updates.size() << " updates");
+                    success = false;
+                }
+            }
+            for (UVECoalescer::UVENotifList::const_iterator it =
+                    notifs.begin(); it != notifs.end(); it++) {
+                UVENotifPublish(gen, *it);
+            }
+            return success;
+        }
+
+        void UVENotifPublish(const UVECoalescer::GeneratorKey &gen,
+                             const UVECoalescer::UVENotifInfo &notif) {
+            std::string key = notif.table + ":" + notif.barekey;
+
+            unsigned int pt;
+            PartType::type ptype = PartType::PART_TYPE_OTHER;
+            std::map<std::string, PartType::type>::const_iterator mit = 
+                    g_viz_constants.PART_TYPES.find(notif.table);
+            if (mit != g_viz_constants.PART_TYPES.end()) {
+                ptype = mit->second;
+            }
+            std::pair<unsigned int,unsigned int> partdesc =
+                VizCollector::PartitionRange(ptype, partitions_);
+            pt = partdesc.first + (djb_hash(key.c_str(), key.size()) % partdesc.second);
+
+            std::stringstream ss;
+            ss << gen.get<0>() << ":" << gen.get<1>() << ":" << gen.get<2>() <<
+                ":" << gen.get<3>();
+            string genstr = ss.str();
+
+            std::stringstream collss;
+            collss << Collector::GetSelfIp() << ":" <<
+                       redis_uve_.GetPort();
+            string collstr = collss.str();
+
+            std::stringstream ks;
+            ks << key << "|" << notif.type << "|" << genstr << "|" << collstr;
+            string kstr = ks.str();
+
+            if (notif.deleted) {
+                KafkaPub(pt, kstr.c_str(), genstr, string());
+            } else {
+                rapidjson::Document dd;
+                dd.SetObject();
+                for (map<string,string>::const_iterator it = notif.value.begin();
+                            it != notif.value.end(); it++) {
+                    rapidjson::Value sval(rapidjson::kStringType);
+                    sval.SetString((it->second).c_str());
+                    dd.AddMember(it->first.c_str(), sval, dd.GetAllocator());
+                }
+                rapidjson::StringBuffer sb;
+                rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+                dd.Accept(writer);
+                string jsonline(sb.GetString());
+
+                KafkaPub(pt, kstr.c_str(), genstr, jsonline);
+            }
+        }
+
+        // UVE updates of the generator were lost. If redis is down, they are
+        // written again when it is back up and the generators resync. Else
+        // the session of the generator is reset so that it resyncs.
+        void UVEFlushFailed(const UVECoalescer::GeneratorKey &gen) {
+            shared_ptr<RedisAsyncConnection> prac = to_ops_conn();
+            if (!(prac && prac->IsConnUp())) {
+                return;
+            }
+            if (collector_ && collector_->GetCollector()) {
+                collector_->GetCollector()->ResetGeneratorSession(
+                    gen.get<0>(), gen.get<1>(), gen.get<2>(), gen.get<3>());
+            }
         }
 
+        bool UVECoalesceTimer() {
+            std::vector<UVECoalescer::GeneratorKey> failed_gens;
+            uve_coalescer_.FlushAll(&failed_gens);
+            for (std::vector<UVECoalescer::GeneratorKey>::const_iterator it =
+                    failed_gens.begin(); it != failed_gens.end(); it++) {
+                UVEFlushFailed(*it);
+            }
+            return true;
+        }
+
+        UVECoalescer *uve_coalescer() { return &uve_coalescer_; }
+        UVEValueCache *uve_value_cache() { return &uve_value_cache_; }
+
         void ToOpsConnUpPostProcess() {
             processor_cb_proc_fn = boost::bind(&OpServerImpl::processorCallbackProcess, this, _1, _2, _3);
             to_ops_conn_.get()->SetClientAsyncCmdCb(processor_cb_proc_fn);
@@ -343,6 +497,8 @@ class OpServerProxy::OpServerImpl {
             }
             collector_->RedisUpdate(false);
             redis_up_ = false;
+            // Redis may have lost the UVEs, they have to be written again
+            uve_value_cache_.Clear();
 
             // Update connection info
             ConnectionState::GetInstance()->Update(ConnectionType::REDIS_UVE,
@@ -552,7 +708,14 @@ class OpServerProxy::OpServerImpl {
             kafka_timer_(TimerManager::CreateTimer(*evm->io_service(),
                          "Kafka Timer", 
                          TaskScheduler::GetInstance()->GetTaskId(
-                         "Kafka Timer"))) {
+                         "Kafka Timer"))),
+            uve_coalescer_(boost::bind(&OpServerImpl::UVEFlush, this,
+                           _1, _2, _3)),
+            uve_coalesce_timer_(TimerManager::CreateTimer(*evm->io_service(),
+                         "UVE Coalesce Timer",
+                         TaskScheduler::GetInstance()->GetTaskId(
+                         "UVE Coalesce Timer"))) {
+            SetUVECoalesceTaskPolicy();
             to_ops_conn_.reset(new RedisAsyncConnection(evm_, 
                 redis_uve_ip, redis_uve_port, 
                 boost::bind(&OpServerProxy::OpServerImpl::ToOpsConnUp, this),
@@ -574,6 +737,8 @@ class OpServerProxy::OpServerImpl {
 
             kafka_timer_->Start(1000,
                 boost::bind(&OpServerImpl::KafkaTimer, this), NULL);
+            uve_coalesce_timer_->Start(kUVECoalescePeriod_ms_,
+                boost::bind(&OpServerImpl::UVECoalesceTimer, this), NULL);
             if (brokers.empty()) return;
 	    ConnectionState::GetInstance()->Update(ConnectionType::KAFKA_PUB,
 		brokers_, ConnectionStatus::INIT, process::Endpoint(), std::string());
@@ -620,6 +785,9 @@ class OpServerProxy::OpServerImpl {
         }
 
         void Shutdown() {
+            TimerManager::DeleteTimer(uve_coalesce_timer_);
+            uve_coalesce_timer_ = NULL;
+            uve_coalescer_.FlushAll();
             TimerManager::DeleteTimer(kafka_timer_);
             kafka_timer_ = NULL;
             StopKafka();
@@ -627,6 +795,7 @@ class OpServerProxy::OpServerImpl {
 
         ~OpServerImpl() {
             assert(kafka_timer_ == NULL);
+            assert(uve_coalesce_timer_ == NULL);
         }
 
         RedisInfo redis_uve_;
@@ -653,6 +822,9 @@ class OpServerProxy::OpServerImpl {
         const uint64_t kafka_start_ms_;
         uint64_t kafka_tick_ms_;
         Timer *kafka_timer_;
+        UVECoalescer uve_coalescer_;
+        Timer *uve_coalesce_timer_;
+        UVEValueCache uve_value_cache_;
 };
 
 OpServerProxy::OpServerProxy(EventManager *evm, VizCollector *collector,
@@ -687,55 +859,17 @@ OpServerProxy::UVENotif(const std::string &type,
                        const std::string &table, const std::string &barekey,
                        const std::map<std::string,std::string>& value,
                        bool deleted) {
-     
-    std::string key = table + ":" + barekey;
-
-    unsigned int pt;
-    PartType::type ptype = PartType::PART_TYPE_OTHER;
-    std::map<std::string, PartType::type>::const_iterator mit = 
-            g_viz_constants.PART_TYPES.find(table);
-    if (mit != g_viz_constants.PART_TYPES.end()) {
-        ptype = mit->second;
-    }
-    std::pair<unsigned int,unsigned int> partdesc =
-        VizCollector::PartitionRange(ptype, impl_->partitions_);
-    pt = partdesc.first + (djb_hash(key.c_str(), key.size()) % partdesc.second);
-
-    std::stringstream ss;
-    ss << source << ":" << node_type << ":" << module << ":" << instance_id;
-    string genstr = ss.str();
-
-    std::stringstream collss;
-    collss << Collector::GetSelfIp() << ":" <<
-               impl_->redis_uve_.GetPort();
-    string collstr = collss.str();
-
-    std::stringstream ks;
-    ks << key << "|" << type << "|" << genstr << "|" << collstr;
-    string kstr = ks.str();
-
-    if (deleted) {
-        impl_->KafkaPub(pt, kstr.c_str(), genstr, string());
-    } else {
-        rapidjson::Document dd;
-        dd.SetObject();
-        for (map<string,string>::const_iterator it = value.begin();
-                    it != value.end(); it++) {
-            rapidjson::Value sval(rapidjson::kStringType);
-            sval.SetString((it->second).c_str());
-            dd.AddMember(it->first.c_str(), sval, dd.GetAllocator());
-        }
-        rapidjson::StringBuffer sb;
-        rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-        dd.Accept(writer);
-        string jsonline(sb.GetString());
-
-        impl_->KafkaPub(pt, kstr.c_str(), genstr, jsonline);
-    }
-
-    rapidjson::Document dd;
-    dd.SetObject();
 
+    // Notifications are published after the coalesced updates of the
+    // generator have been sent to redis
+    UVECoalescer::UVENotifInfo notif;
+    notif.type = type;
+    notif.table = table;
+    notif.barekey = barekey;
+    notif.value = value;
+    notif.deleted = deleted;
+    impl_->uve_coalescer()->Notif(UVECoalescer::GeneratorKey(source,
+        node_type, module, instance_id), notif);
     return true;
 }
 
@@ -768,15 +902,27 @@ OpServerProxy::UVEUpdate(const std::string &type, const std::string &attr,
         pt = partdesc.first + (djb_hash(key.c_str(), key.size()) % partdesc.second);
     }
 
-    bool ret = RedisProcessorExec::UVEUpdate(prac.get(), NULL, type, attr,
-            source, node_type, module, instance_id, key, message,
-            seq, agg, ts, pt, is_alarm);
-    if (ret) {
-        impl_->redis_uve_.RedisUveUpdate();
-    } else {
-        impl_->redis_uve_.RedisUveUpdateFail();
+    UVECoalescer::UVEUpdateInfo update;
+    update.type = type;
+    update.attr = attr;
+    update.key = key;
+    update.message = message;
+    update.seq = seq;
+    update.agg = agg;
+    update.ts = ts;
+    update.part = pt;
+    update.is_alarm = is_alarm;
+    UVECoalescer::GeneratorKey gen(source, node_type, module, instance_id);
+    // Redis already has the value
+    if (impl_->uve_value_cache()->Unchanged(gen, update)) {
+        return true;
     }
-    return ret;
+    UVECoalescer *coalescer(impl_->uve_coalescer());
+    if (coalescer->Update(gen, update) && !coalescer->Flush(gen)) {
+        impl_->UVEFlushFailed(gen);
+        return false;
+    }
+    return true;
 }
 
 bool
@@ -791,6 +937,10 @@ OpServerProxy::UVEDelete(const std::string &type,
         impl_->redis_uve_.RedisUveDeleteNoConn();
         return false;
     }
+    // Send the pending updates of the generator ahead of the delete
+    UVECoalescer::GeneratorKey gen(source, node_type, module, instance_id);
+    impl_->uve_coalescer()->Flush(gen);
+    impl_->uve_value_cache()->DeleteUVE(gen, key, type);
 
     bool ret = RedisProcessorExec::UVEDelete(prac.get(), NULL, type, source, 
             node_type, module, instance_id, key, seq, is_alarm);
@@ -808,6 +958,8 @@ OpServerProxy::GetSeq(const string &source, const string &node_type,
 
     if (!impl_->to_ops_conn()) return false;
 
+    impl_->uve_coalescer()->Flush(UVECoalescer::GeneratorKey(source,
+        node_type, module, instance_id));
     return RedisProcessorExec::SyncGetSeq(impl_->redis_uve_.GetIp(),
             impl_->redis_uve_.GetPort(), impl_->get_redis_password(),
             source, node_type, module, instance_id, seqReply);
@@ -817,8 +969,16 @@ bool
 OpServerProxy::DeleteUVEs(const string &source, const string &module,
                           const string &node_type, const string &instance_id) {
 
+    // The generator is gone, its values are written again if it comes back
+    UVECoalescer::GeneratorKey gen(source, node_type, module, instance_id);
+    impl_->uve_value_cache()->DeleteGenerator(gen);
+
     shared_ptr<RedisAsyncConnection> prac = impl_->to_ops_conn();
     if  (!(prac && prac->IsConnUp())) return false;
+
+    // The UVEs of the generator are being deleted, pending updates
+    // and notifications are no longer of interest
+    impl_->uve_coalescer()->Discard(gen);
    
     std::vector<std::pair<std::string,std::string> > delReply;
     bool ret =  RedisProcessorExec::SyncDeleteUVEs(impl_->redis_uve_.GetIp(),
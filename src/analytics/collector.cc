@@ -106,6 +106,31 @@ void Collector::RedisUpdate(bool rsc) {
     return;
 }
 
+// Closes the session of a generator whose UVEs could not be written to
+// redis. The generator connects again and sends its UVEs once more.
+void Collector::ResetGeneratorSession(const std::string &source,
+    const std::string &node_type, const std::string &module,
+    const std::string &instance_id) {
+    SandeshGenerator::GeneratorId id(boost::make_tuple(source, module,
+            instance_id, node_type));
+    tbb::mutex::scoped_lock lock(gen_map_mutex_);
+    GeneratorMap::iterator gen_it = gen_map_.find(id);
+    if (gen_it == gen_map_.end()) {
+        return;
+    }
+    SandeshGenerator *gen = gen_it->second;
+    VizSession *gsession = gen->session();
+    if (gsession == NULL) {
+        return;
+    }
+    increment_redis_error();
+    LOG(ERROR, "UVE Update FAILED: " << gen->ToString() << " Session: " <<
+        gsession->ToString());
+    lock.release();
+    // Enqueue a close on the state machine on the generator session
+    gsession->EnqueueClose();
+}
+
 bool Collector::ReceiveResourceUpdate(SandeshSession *session,
             bool rsc) {
     VizSession *vsession = dynamic_cast<VizSession *>(session);
@@ -707,6 +732,15 @@ static void SendDbInfoResponse(Collector *collector, std::string context) {
             db_handler->GetDiskUsagePercentageDropLevel());
     db_info.set_pending_compaction_tasks_level(
             db_handler->GetPendingCompactionTasksDropLevel());
+    FieldNamesCacheStats fc_stats;
+    uint64_t hits, writes, entries;
+    DbHandler::GetFieldNamesCacheStats(&hits, &writes, &entries);
+    fc_stats.set_hits(hits);
+    fc_stats.set_writes(writes);
+    fc_stats.set_entries(entries);
+    fc_stats.set_hit_percentage(hits + writes ?
+        (hits * 100) / (hits + writes) : 0);
+    db_info.set_field_names_cache(fc_stats);
 
     fcsr->set_db_info(db_info);
     fcsr->set_context(context);
@@ -107,6 +107,9 @@ public:
     EventManager * event_manager() const { return evm_; }
     VizCallback ProcessSandeshMsgCb() const { return cb_; }
     void RedisUpdate(bool rsc);
+    void ResetGeneratorSession(const std::string &source,
+        const std::string &node_type, const std::string &module,
+        const std::string &instance_id);
 
     static const std::string &GetProgramName() { return prog_name_; };
     static void SetProgramName(const char *name) { prog_name_ = name; };
@@ -5,9 +5,11 @@
 #include <exception>
 #include <boost/bind.hpp>
 #include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/asio/ip/host_name.hpp>
 #include <boost/uuid/name_generator.hpp>
+#include <boost/uuid/string_generator.hpp>
 
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
@@ -53,12 +55,22 @@ using process::ConnectionState;
 using process::ConnectionType;
 using process::ConnectionStatus;
 
-uint32_t DbHandler::field_cache_t2_ = 0;
-std::set<std::string> DbHandler::field_cache_set_[2];
-uint32_t DbHandler::field_cache_old_t2_ = 0;
-uint8_t DbHandler::old_t2_index_ = 0;
-uint8_t DbHandler::new_t2_index_ = 1;
-tbb::mutex DbHandler::fmutex_;
+const size_t DbHandler::kFieldCacheShards;
+const size_t DbHandler::kStatTableShards;
+DbHandler::FieldCache DbHandler::field_cache_[DbHandler::kFieldCacheShards];
+
+DbHandler::FieldCache::FieldCache() :
+    t2(0),
+    old_t2(0),
+    old_t2_index(0),
+    new_t2_index(1),
+    hits(0),
+    writes(0) {
+}
+
+size_t DbHandler::ShardIndex(const std::string &table_name, size_t shards) {
+    return boost::hash<std::string>()(table_name) % shards;
+}
 
 DbHandler::DbHandler(EventManager *evm,
         GenDb::GenDbIf::DbErrorHandler err_handler,
@@ -607,22 +619,45 @@ bool DbHandler::GetStats(uint64_t *queue_count, uint64_t *enqueues) const {
 
 bool DbHandler::GetStats(std::vector<GenDb::DbTableInfo> *vdbti,
     GenDb::DbErrors *dbe, std::vector<GenDb::DbTableInfo> *vstats_dbti) {
-    {
-        tbb::mutex::scoped_lock lock(smutex_);
-        stable_stats_.GetDiffs(vstats_dbti);
+    // Tables are in only one shard, so the shards are appended
+    for (size_t i = 0; i < kStatTableShards; i++) {
+        tbb::mutex::scoped_lock lock(stable_stats_[i].mutex);
+        stable_stats_[i].stats.GetDiffs(vstats_dbti);
     }
     return dbif_->Db_GetStats(vdbti, dbe);
 }
 
 bool DbHandler::GetCumulativeStats(std::vector<GenDb::DbTableInfo> *vdbti,
     GenDb::DbErrors *dbe, std::vector<GenDb::DbTableInfo> *vstats_dbti) const {
-    {
-        tbb::mutex::scoped_lock lock(smutex_);
-        stable_stats_.GetCumulative(vstats_dbti);
+    for (size_t i = 0; i < kStatTableShards; i++) {
+        tbb::mutex::scoped_lock lock(stable_stats_[i].mutex);
+        stable_stats_[i].stats.GetCumulative(vstats_dbti);
     }
     return dbif_->Db_GetCumulativeStats(vdbti, dbe);
 }
 
+void DbHandler::UpdateStatTableStats(const std::string &table_name,
+    bool fail, uint64_t num) {
+    StatTableShard &shard(
+        stable_stats_[ShardIndex(table_name, kStatTableShards)]);
+    tbb::mutex::scoped_lock lock(shard.mutex);
+    shard.stats.Update(table_name, true, fail, false, num);
+}
+
+void DbHandler::GetFieldNamesCacheStats(uint64_t *hits, uint64_t *writes,
+    uint64_t *entries) {
+    *hits = 0;
+    *writes = 0;
+    *entries = 0;
+    for (size_t i = 0; i < kFieldCacheShards; i++) {
+        FieldCache &cache(field_cache_[i]);
+        tbb::mutex::scoped_lock lock(cache.mutex);
+        *hits += cache.hits;
+        *writes += cache.writes;
+        *entries += cache.set[0].size() + cache.set[1].size();
+    }
+}
+
 bool DbHandler::GetCqlMetrics(cass::cql::Metrics *metrics) const {
     cass::cql::CqlIf *cql_if(dynamic_cast<cass::cql::CqlIf *>(dbif_.get()));
     if (cql_if == NULL) {
@@ -650,6 +685,22 @@ bool DbHandler::InsertIntoDb(std::auto_ptr<GenDb::ColList> col_list,
     return dbif_->Db_AddColumn(col_list, dconsistency, db_cb);
 }
 
+bool DbHandler::InsertIntoDb(const GenDb::ColListBuilder &builder,
+    GenDb::DbConsistency::type dconsistency,
+    GenDb::GenDbIf::DbAddColumnCb db_cb) {
+    if (IsAllWritesDisabled()) {
+        return true;
+    }
+    return dbif_->Db_AddColumn(builder, dconsistency, db_cb);
+}
+
+GenDb::ColListBuilder &DbHandler::LocalColListBuilder(
+    const std::string &cfname) {
+    GenDb::ColListBuilder &builder(col_list_builders_.local());
+    builder.Reset(cfname);
+    return builder;
+}
+
 bool DbHandler::AllowMessageTableInsert(const SandeshHeader &header) {
     return !IsMessagesWritesDisabled() && !IsAllWritesDisabled() &&
         (header.get_Type() != SandeshType::FLOW);
@@ -661,36 +712,37 @@ bool DbHandler::MessageIndexTableInsert(const std::string& cfname,
         const boost::uuids::uuid& unm,
         const std::string keyword,
         GenDb::GenDbIf::DbAddColumnCb db_cb) {
-    std::auto_ptr<GenDb::ColList> col_list(new GenDb::ColList);
-    col_list->cfname_ = cfname;
+    GenDb::ColListBuilder &builder(LocalColListBuilder(cfname));
     // Rowkey
-    GenDb::DbDataValueVec& rowkey = col_list->rowkey_;
-    rowkey.reserve(2);
     uint32_t T2(header.get_Timestamp() >> g_viz_constants.RowTimeInBits);
-    rowkey.push_back(T2);
+    builder.AddRowKey(T2);
     //Push partition into row key
-    rowkey.push_back(gen_partition_no_());
+    uint8_t partition(gen_partition_no_());
+    builder.AddRowKey(partition);
     // Columns
-    GenDb::DbDataValueVec *col_name(new GenDb::DbDataValueVec());
-    col_name->reserve(3);
     int ttl;
     if (message_type == "VncApiConfigLog") {
         ttl = GetTtl(TtlType::CONFIGAUDIT_TTL);
     } else {
         ttl = GetTtl(TtlType::GLOBAL_TTL);
     }
+    builder.BeginColumn(ttl);
+    // Column names reference the header, which outlives the insert
+    const std::string &source(header.get_Source());
+    const std::string &module(header.get_Module());
+    const std::string &category(header.get_Category());
     if (cfname == g_viz_constants.MESSAGE_TABLE_SOURCE) {
-        col_name->push_back(header.get_Source());
+        builder.AddColumnName(GenDb::DbStringRef(source));
     } else if (cfname == g_viz_constants.MESSAGE_TABLE_MODULE_ID) {
-        col_name->push_back(header.get_Module());
+        builder.AddColumnName(GenDb::DbStringRef(module));
     } else if (cfname == g_viz_constants.MESSAGE_TABLE_CATEGORY) {
-        col_name->push_back(header.get_Category());
+        builder.AddColumnName(GenDb::DbStringRef(category));
     } else if (cfname == g_viz_constants.MESSAGE_TABLE_MESSAGE_TYPE) {
-        col_name->push_back(message_type);
+        builder.AddColumnName(GenDb::DbStringRef(message_type));
     } else if (cfname == g_viz_constants.MESSAGE_TABLE_TIMESTAMP) {
     } else if (cfname == g_viz_constants.MESSAGE_TABLE_KEYWORD) {
         if (keyword.length()) {
-            col_name->push_back(keyword);
+            builder.AddColumnName(GenDb::DbStringRef(keyword));
         } else {
             return false;
         }
@@ -700,15 +752,10 @@ bool DbHandler::MessageIndexTableInsert(const std::string& cfname,
         return false;
     }
     uint32_t T1(header.get_Timestamp() & g_viz_constants.RowTimeInMask);
-    col_name->push_back(T1);
-    col_name->push_back(unm);
+    builder.AddColumnName(T1);
+    builder.AddColumnName(unm);
     //No value to be stored against the columns
-    GenDb::DbDataValueVec *col_value(new GenDb::DbDataValueVec(0));
-    GenDb::NewCol *col(new GenDb::NewCol(col_name, col_value, ttl));
-    GenDb::NewColVec& columns = col_list->columns_;
-    columns.reserve(1);
-    columns.push_back(col);
-    if (!InsertIntoDb(col_list, GenDb::DbConsistency::LOCAL_ONE, db_cb)) {
+    if (!InsertIntoDb(builder, GenDb::DbConsistency::LOCAL_ONE, db_cb)) {
         DB_LOG(ERROR, "Addition of message: " << message_type <<
                 ", message UUID: " << unm << " to table: " << cfname <<
                 " FAILED");
@@ -721,9 +768,6 @@ void DbHandler::MessageTableOnlyInsert(const VizMsg *vmsgp,
     GenDb::GenDbIf::DbAddColumnCb db_cb) {
     const SandeshHeader &header(vmsgp->msg->GetHeader());
     const std::string &message_type(vmsgp->msg->GetMessageType());
-    uint64_t temp_u64;
-    uint32_t temp_u32;
-    std::string temp_str;
 
     int ttl;
     if (message_type == "VncApiConfigLog") {
@@ -731,70 +775,70 @@ void DbHandler::MessageTableOnlyInsert(const VizMsg *vmsgp,
     } else {
         ttl = GetTtl(TtlType::GLOBAL_TTL);
     }
-    std::auto_ptr<GenDb::ColList> col_list(new GenDb::ColList);
-    col_list->cfname_ = g_viz_constants.COLLECTOR_GLOBAL_TABLE;
+    GenDb::ColListBuilder &builder(LocalColListBuilder(
+        g_viz_constants.COLLECTOR_GLOBAL_TABLE));
     // Rowkey
-    GenDb::DbDataValueVec& rowkey = col_list->rowkey_;
-    rowkey.reserve(1);
-    rowkey.push_back(vmsgp->unm);
-    // Columns
-    GenDb::NewColVec& columns = col_list->columns_;
-    columns.reserve(16);
-    columns.push_back(new GenDb::NewCol(g_viz_constants.SOURCE,
-        header.get_Source(), ttl));
-    columns.push_back(new GenDb::NewCol(g_viz_constants.NAMESPACE,
-        header.get_Namespace(), ttl));
-    columns.push_back(new GenDb::NewCol(g_viz_constants.MODULE,
-        header.get_Module(), ttl));
-    if (!header.get_Context().empty()) {
-        columns.push_back(new GenDb::NewCol(g_viz_constants.CONTEXT,
-            header.get_Context(), ttl));
-    }
-    if (!header.get_InstanceId().empty()) {
-        columns.push_back(new GenDb::NewCol(g_viz_constants.INSTANCE_ID, 
-                                            header.get_InstanceId(), ttl));
-    }
-    if (!header.get_NodeType().empty()) {
-        columns.push_back(new GenDb::NewCol(g_viz_constants.NODE_TYPE,
-                                            header.get_NodeType(), ttl));
+    builder.AddRowKey(vmsgp->unm);
+    // Columns reference the header and message, which outlive the insert
+    const std::string &source(header.get_Source());
+    const std::string &name_space(header.get_Namespace());
+    const std::string &module(header.get_Module());
+    const std::string &context(header.get_Context());
+    const std::string &instance_id(header.get_InstanceId());
+    const std::string &node_type(header.get_NodeType());
+    const std::string &ip_address(header.get_IPAddress());
+    const std::string &category(header.get_Category());
+    const std::string &data(vmsgp->msg->ExtractMessage());
+    builder.AddColumn(g_viz_constants.SOURCE, GenDb::DbStringRef(source),
+        ttl);
+    builder.AddColumn(g_viz_constants.NAMESPACE,
+        GenDb::DbStringRef(name_space), ttl);
+    builder.AddColumn(g_viz_constants.MODULE, GenDb::DbStringRef(module),
+        ttl);
+    if (!context.empty()) {
+        builder.AddColumn(g_viz_constants.CONTEXT,
+            GenDb::DbStringRef(context), ttl);
+    }
+    if (!instance_id.empty()) {
+        builder.AddColumn(g_viz_constants.INSTANCE_ID,
+            GenDb::DbStringRef(instance_id), ttl);
+    }
+    if (!node_type.empty()) {
+        builder.AddColumn(g_viz_constants.NODE_TYPE,
+            GenDb::DbStringRef(node_type), ttl);
     }
     if (header.__isset.IPAddress) {
-        columns.push_back(new GenDb::NewCol(g_viz_constants.IPADDRESS,
-                                            header.get_IPAddress(), ttl));
+        builder.AddColumn(g_viz_constants.IPADDRESS,
+            GenDb::DbStringRef(ip_address), ttl);
     }
-    // Convert to network byte order
-    temp_u64 = header.get_Timestamp();
-    columns.push_back(new GenDb::NewCol(g_viz_constants.TIMESTAMP, temp_u64, ttl));
+    uint64_t temp_u64(header.get_Timestamp());
+    builder.AddColumn(g_viz_constants.TIMESTAMP, temp_u64, ttl);
 
-    columns.push_back(new GenDb::NewCol(g_viz_constants.CATEGORY,
-        header.get_Category(), ttl));
+    builder.AddColumn(g_viz_constants.CATEGORY, GenDb::DbStringRef(category),
+        ttl);
 
-    temp_u32 = header.get_Level();
-    columns.push_back(new GenDb::NewCol(g_viz_constants.LEVEL, temp_u32, ttl));
+    uint32_t level(header.get_Level());
+    builder.AddColumn(g_viz_constants.LEVEL, level, ttl);
 
-    columns.push_back(new GenDb::NewCol(g_viz_constants.MESSAGE_TYPE,
-        message_type, ttl));
+    builder.AddColumn(g_viz_constants.MESSAGE_TYPE,
+        GenDb::DbStringRef(message_type), ttl);
 
-    temp_u32 = header.get_SequenceNum();
-    columns.push_back(new GenDb::NewCol(g_viz_constants.SEQUENCE_NUM,
-        temp_u32, ttl));
+    uint32_t seqnum(header.get_SequenceNum());
+    builder.AddColumn(g_viz_constants.SEQUENCE_NUM, seqnum, ttl);
 
-    temp_u32 = header.get_VersionSig();
-    columns.push_back(new GenDb::NewCol(g_viz_constants.VERSION, temp_u32, ttl));
+    uint32_t version(header.get_VersionSig());
+    builder.AddColumn(g_viz_constants.VERSION, version, ttl);
 
     uint8_t temp_u8 = header.get_Type();
-    columns.push_back(new GenDb::NewCol(g_viz_constants.SANDESH_TYPE,
-        temp_u8, ttl));
+    builder.AddColumn(g_viz_constants.SANDESH_TYPE, temp_u8, ttl);
     if (header.__isset.Pid) {
-        temp_u32 = header.get_Pid();
-        columns.push_back(new GenDb::NewCol(g_viz_constants.PID,
-                                        temp_u32, ttl));
+        uint32_t pid(header.get_Pid());
+        builder.AddColumn(g_viz_constants.PID, pid, ttl);
     }
 
-    columns.push_back(new GenDb::NewCol(g_viz_constants.DATA,
-        vmsgp->msg->ExtractMessage(), ttl));
+    builder.AddColumn(g_viz_constants.DATA, GenDb::DbStringRef(data), ttl);
 
-    if (!InsertIntoDb(col_list, GenDb::DbConsistency::LOCAL_ONE, db_cb)) {
+    if (!InsertIntoDb(builder, GenDb::DbConsistency::LOCAL_ONE, db_cb)) {
         DB_LOG(ERROR, "Addition of message: " << message_type <<
                 ", message UUID: " << vmsgp->unm << " COLUMN FAILED");
         return;
@@ -905,17 +949,13 @@ void DbHandler::FieldNamesTableInsert(uint64_t timestamp,
     /* Check if fieldname and value were already seen in this T2;
        2 caches are mainted one for  last T2 and T2-1.
        We only need to record them if they have NOT been seen yet */
-    bool record = false;
     std::string fc_entry(table_name);
     fc_entry.append(":");
     fc_entry.append(field_val);
-    {
-        tbb::mutex::scoped_lock lock(fmutex_);
-        record = CanRecordDataForT2(temp_u32, fc_entry);
+    if (!CanRecordDataForT2(table_name, temp_u32, fc_entry)) {
+        return;
     }
 
-    if (!record) return;
-
     DbHandler::TagMap tmap;
     DbHandler::AttribMap amap;
     DbHandler::Var pv;
@@ -941,38 +981,41 @@ void DbHandler::FieldNamesTableInsert(uint64_t timestamp,
 /*
  * This function checks if the data can be recorded or not
  * for the given t2. If t2 corresponding to the data is
- * older than field_cache_old_t2_ and field_cache_t2_
- * it is ignored
+ * older than the old and new t2 of the cache shard of the
+ * table it is ignored
  */
-bool DbHandler::CanRecordDataForT2(uint32_t temp_u32, std::string fc_entry) {
-    bool record = false;
-    if (temp_u32 > field_cache_t2_) {
-            // swap old and new index; clear the old cache
-            old_t2_index_ = new_t2_index_;
-            new_t2_index_ = (new_t2_index_ == 1)?0:1;
-            field_cache_old_t2_ = field_cache_t2_;
-            field_cache_set_[new_t2_index_].clear();
-            field_cache_t2_ = temp_u32;
-        } else if (temp_u32 > field_cache_old_t2_ && temp_u32 != field_cache_t2_){
-            field_cache_set_[old_t2_index_].clear();
-            field_cache_old_t2_ = temp_u32;
-        }
-        // Record only if not found in last or last but one T2 cache.
-        if (temp_u32 == field_cache_t2_) {
-            if (field_cache_set_[new_t2_index_].find(fc_entry) ==
-                field_cache_set_[new_t2_index_].end()) {
-                field_cache_set_[new_t2_index_].insert(fc_entry);
-                record = true;
-            }
-        } else if (temp_u32 == field_cache_old_t2_) {
-            if (field_cache_set_[old_t2_index_].find(fc_entry) ==
-                    field_cache_set_[old_t2_index_].end()) {
-                field_cache_set_[old_t2_index_].insert(fc_entry);
-                record = true;
-            }
-        }
-        return record;
+bool DbHandler::CanRecordDataForT2(const std::string &table_name,
+    uint32_t temp_u32, const std::string &fc_entry) {
+    FieldCache &cache(field_cache_[ShardIndex(table_name, kFieldCacheShards)]);
+    tbb::mutex::scoped_lock lock(cache.mutex);
+    if (temp_u32 > cache.t2) {
+        // swap old and new index; clear the old cache
+        cache.old_t2_index = cache.new_t2_index;
+        cache.new_t2_index = (cache.new_t2_index == 1)?0:1;
+        cache.old_t2 = cache.t2;
+        cache.set[cache.new_t2_index].clear();
+        cache.t2 = temp_u32;
+    } else if (temp_u32 > cache.old_t2 && temp_u32 != cache.t2) {
+        cache.set[cache.old_t2_index].clear();
+        cache.old_t2 = temp_u32;
+    }
+    // Record only if not found in last or last but one T2 cache.
+    std::set<std::string> *fc_set;
+    if (temp_u32 == cache.t2) {
+        fc_set = &cache.set[cache.new_t2_index];
+    } else if (temp_u32 == cache.old_t2) {
+        fc_set = &cache.set[cache.old_t2_index];
+    } else {
+        return false;
+    }
+    if (!fc_set->insert(fc_entry).second) {
+        cache.hits++;
+        return false;
+    }
+    cache.writes++;
+    return true;
 }
+
 void DbHandler::GetRuleMap(RuleMap& rulemap) {
 }
 
@@ -1079,15 +1122,15 @@ bool DbHandler::StatTableWrite(uint32_t t2,
     string cfname;
     const DbHandler::Var& pv = ptag.second;
     const DbHandler::Var& sv = stag.second;
-    GenDb::DbDataValue pg,sg;
+    GenDb::DbDataValueRef pg,sg;
 
     bool bad_suffix = false;
     switch (pv.type) {
         case DbHandler::STRING : {
-                pg = pv.str;
+                pg = GenDb::DbStringRef(pv.str);
                 if (sv.type==DbHandler::STRING) {
                     cfname = g_viz_constants.STATS_TABLE_BY_STR_STR_TAG;
-                    sg = sv.str;
+                    sg = GenDb::DbStringRef(sv.str);
                 } else if (sv.type==DbHandler::UINT64) {
                     cfname = g_viz_constants.STATS_TABLE_BY_STR_U64_TAG;
                     sg = sv.num;
@@ -1102,7 +1145,7 @@ bool DbHandler::StatTableWrite(uint32_t t2,
                 pg = pv.num;
                 if (sv.type==DbHandler::STRING) {
                     cfname = g_viz_constants.STATS_TABLE_BY_U64_STR_TAG;
-                    sg = sv.str;
+                    sg = GenDb::DbStringRef(sv.str);
                 } else if (sv.type==DbHandler::UINT64) {
                     cfname = g_viz_constants.STATS_TABLE_BY_U64_U64_TAG;
                     sg = sv.num;
@@ -1123,74 +1166,48 @@ bool DbHandler::StatTableWrite(uint32_t t2,
             }
             break;
         default:
-            tbb::mutex::scoped_lock lock(smutex_);
-            stable_stats_.Update(statName + ":" + statAttr, true, true,
-                false, 1);
+            UpdateStatTableStats(statName + ":" + statAttr, true, 1);
             DB_LOG(ERROR, "Bad Prefix Tag " << statName <<
                     ", " << statAttr <<  " tag " << ptag.first <<
                     ":" << stag.first << " jsonline " << jsonline);
             return false;
     }
     if (bad_suffix) {
-        tbb::mutex::scoped_lock lock(smutex_);
-        stable_stats_.Update(statName + ":" + statAttr, true, true, false, 1);
+        UpdateStatTableStats(statName + ":" + statAttr, true, 1);
         DB_LOG(ERROR, "Bad Suffix Tag " << statName <<
                 ", " << statAttr <<  " tag " << ptag.first <<
                 ":" << stag.first << " jsonline " << jsonline);
         return false;
     }
-    std::auto_ptr<GenDb::ColList> col_list(new GenDb::ColList);
-    col_list->cfname_ = cfname;
-    
-    GenDb::DbDataValueVec& rowkey = col_list->rowkey_;
-    if (sv.type==DbHandler::INVALID) {
-        rowkey.reserve(5);
-        rowkey.push_back(t2);
-        rowkey.push_back(part);
-        rowkey.push_back(statName);
-        rowkey.push_back(statAttr);
-        rowkey.push_back(ptag.first);
-    } else {
-        rowkey.reserve(6);
-        rowkey.push_back(t2);
-        rowkey.push_back(part);
-        rowkey.push_back(statName);
-        rowkey.push_back(statAttr);
-        rowkey.push_back(ptag.first);
-        rowkey.push_back(stag.first);
-    }
-
-    GenDb::NewColVec& columns = col_list->columns_;
-
-    GenDb::DbDataValueVec *col_name(new GenDb::DbDataValueVec);
-    if (sv.type==DbHandler::INVALID) {
-        col_name->reserve(3);
-        col_name->push_back(pg);
-        col_name->push_back(t1);
-        col_name->push_back(unm);
-    } else {
-        col_name->reserve(4);
-        col_name->push_back(pg);
-        col_name->push_back(sg);
-        col_name->push_back(t1);
-        col_name->push_back(unm);
+    GenDb::ColListBuilder &builder(LocalColListBuilder(cfname));
+
+    builder.AddRowKey(t2);
+    builder.AddRowKey(part);
+    builder.AddRowKey(GenDb::DbStringRef(statName));
+    builder.AddRowKey(GenDb::DbStringRef(statAttr));
+    builder.AddRowKey(GenDb::DbStringRef(ptag.first));
+    if (sv.type!=DbHandler::INVALID) {
+        builder.AddRowKey(GenDb::DbStringRef(stag.first));
     }
 
-    GenDb::DbDataValueVec *col_value(new GenDb::DbDataValueVec(1, jsonline));
-    GenDb::NewCol *col(new GenDb::NewCol(col_name, col_value, ttl));
-    columns.push_back(col);
+    builder.BeginColumn(ttl);
+    builder.AddColumnName(pg);
+    if (sv.type!=DbHandler::INVALID) {
+        builder.AddColumnName(sg);
+    }
+    builder.AddColumnName(t1);
+    builder.AddColumnName(unm);
+    builder.AddColumnValue(GenDb::DbStringRef(jsonline));
 
-    if (!InsertIntoDb(col_list, GenDb::DbConsistency::LOCAL_ONE, db_cb)) {
+    if (!InsertIntoDb(builder, GenDb::DbConsistency::LOCAL_ONE, db_cb)) {
         DB_LOG(ERROR, "Addition of " << statName <<
                 ", " << statAttr <<  " tag " << ptag.first <<
                 ":" << stag.first << " into table " <<
                 cfname <<" FAILED");
-        tbb::mutex::scoped_lock lock(smutex_);
-        stable_stats_.Update(statName + ":" + statAttr, true, true, false, 1);
+        UpdateStatTableStats(statName + ":" + statAttr, true, 1);
         return false;
     } else {
-        tbb::mutex::scoped_lock lock(smutex_);
-        stable_stats_.Update(statName + ":" + statAttr, true, false, false, 1);
+        UpdateStatTableStats(statName + ":" + statAttr, false, 1);
         return true;
     }
 }
@@ -1631,63 +1648,67 @@ static bool PopulateFlowIndexTables(const FlowValueArray &fvalues,
     return true;
 }
 
-template <typename T>
-bool FlowLogDataObjectWalker<T>::for_each(pugi::xml_node& node) {
-    std::string col_name(node.name());
-    FlowTypeMap::const_iterator it = flow_msg2type_map.find(col_name);
-    if (it != flow_msg2type_map.end()) {
+/*
+ * Decode a single field of the flow sample into the value array. Fields
+ * that are not part of the flow record schema are ignored.
+ */
+static void FlowSampleFieldDecode(const pugi::xml_node &node,
+    FlowValueArray &values) {
+    const char *col_name(node.name());
+    const FlowTypeInfo *ftinfop(flow_msg2type_lookup(col_name));
+    if (ftinfop != NULL) {
         // Extract the values and populate the value array
-        const FlowTypeInfo &ftinfo(it->second);
+        const FlowTypeInfo &ftinfo(*ftinfop);
         switch (ftinfo.get<1>()) {
         case GenDb::DbDataType::Unsigned8Type:
             {
                 int8_t val;
                 stringToInteger(node.child_value(), val);
-                values_[ftinfo.get<0>()] = static_cast<uint8_t>(val);
+                values[ftinfo.get<0>()] = static_cast<uint8_t>(val);
                 break;
             }
         case GenDb::DbDataType::Unsigned16Type:
             {
                 int16_t val;
                 stringToInteger(node.child_value(), val);
-                values_[ftinfo.get<0>()] = static_cast<uint16_t>(val);
+                values[ftinfo.get<0>()] = static_cast<uint16_t>(val);
                 break;
             }
         case GenDb::DbDataType::Unsigned32Type:
             {
                 int32_t val;
                 stringToInteger(node.child_value(), val);
-                values_[ftinfo.get<0>()] = static_cast<uint32_t>(val);
+                values[ftinfo.get<0>()] = static_cast<uint32_t>(val);
                 break;
             }
         case GenDb::DbDataType::Unsigned64Type:
             {
                 int64_t val;
                 stringToInteger(node.child_value(), val);
-                values_[ftinfo.get<0>()] = static_cast<uint64_t>(val);
+                values[ftinfo.get<0>()] = static_cast<uint64_t>(val);
                 break;
             }
         case GenDb::DbDataType::DoubleType:
             {
                 double val;
                 stringToInteger(node.child_value(), val);
-                values_[ftinfo.get<0>()] = val;
+                values[ftinfo.get<0>()] = val;
                 break;
             }
         case GenDb::DbDataType::LexicalUUIDType:
         case GenDb::DbDataType::TimeUUIDType:
             {
-                std::stringstream ss;
-                ss << node.child_value();
-                boost::uuids::uuid u;
-                if (!ss.str().empty()) {
-                    ss >> u;
-                    if (ss.fail()) {
+                const char *uuid_str(node.child_value());
+                boost::uuids::uuid u(boost::uuids::nil_uuid());
+                if (*uuid_str != '\0') {
+                    try {
+                        u = boost::uuids::string_generator()(uuid_str);
+                    } catch (const std::runtime_error &e) {
                         LOG(ERROR, "FlowRecordTable: " << col_name << ": (" <<
-                            node.child_value() << ") INVALID");
+                            uuid_str << ") INVALID");
                     }
-                }     
-                values_[ftinfo.get<0>()] = u;
+                }
+                values[ftinfo.get<0>()] = u;
                 break;
             }
         case GenDb::DbDataType::AsciiType:
@@ -1695,7 +1716,7 @@ bool FlowLogDataObjectWalker<T>::for_each(pugi::xml_node& node) {
             {
                 std::string val = node.child_value();
                 TXMLProtocol::unescapeXMLControlChars(val);
-                values_[ftinfo.get<0>()] = val;
+                values[ftinfo.get<0>()] = val;
                 break;
             }
         case GenDb::DbDataType::InetType:
@@ -1705,7 +1726,7 @@ bool FlowLogDataObjectWalker<T>::for_each(pugi::xml_node& node) {
                     uint32_t v4;
                     stringToInteger(node.child_value(), v4);
                     Ip4Address ip4addr(v4);
-                    values_[ftinfo.get<0>()] = ip4addr;
+                    values[ftinfo.get<0>()] = ip4addr;
                 } else {
                     boost::system::error_code ec;
                     IpAddress ipaddr(IpAddress::from_string(
@@ -1714,7 +1735,7 @@ bool FlowLogDataObjectWalker<T>::for_each(pugi::xml_node& node) {
                         LOG(ERROR, "FlowRecordTable: " << col_name << ": (" <<
                             node.child_value() << ") INVALID");
                     }
-                    values_[ftinfo.get<0>()] = ipaddr;
+                    values[ftinfo.get<0>()] = ipaddr;
                 }
                 break;
             }
@@ -1723,7 +1744,6 @@ bool FlowLogDataObjectWalker<T>::for_each(pugi::xml_node& node) {
             break;
         }
     }
-    return true;
 }
 
 /*
@@ -1732,12 +1752,13 @@ bool FlowLogDataObjectWalker<T>::for_each(pugi::xml_node& node) {
 bool DbHandler::FlowSampleAdd(const pugi::xml_node& flow_sample,
                               const SandeshHeader& header,
                               GenDb::GenDbIf::DbAddColumnCb db_cb) {
-    // Traverse and populate the flow entry values
+    // Populate the flow entry values from the fields of the flow sample.
+    // The flow sample is a flat struct, so only the immediate children
+    // need to be visited.
     FlowValueArray flow_entry_values;
-    FlowLogDataObjectWalker<FlowValueArray> flow_msg_walker(flow_entry_values);
-    pugi::xml_node &mnode = const_cast<pugi::xml_node &>(flow_sample);
-    if (!mnode.traverse(flow_msg_walker)) {
-        VIZD_ASSERT(0);
+    for (pugi::xml_node node = flow_sample.first_child(); node;
+         node = node.next_sibling()) {
+        FlowSampleFieldDecode(node, flow_entry_values);
     }
     // Populate FLOWREC_VROUTER from SandeshHeader source
     flow_entry_values[FlowRecordFields::FLOWREC_VROUTER] = header.get_Source();
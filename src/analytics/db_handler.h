@@ -22,12 +22,14 @@
 #endif
 
 #include <boost/tuple/tuple.hpp>
+#include <tbb/enumerable_thread_specific.h>
 
 #include "base/parse_object.h"
 #include "io/event_manager.h"
 #include "base/random_generator.h"
 #include <base/watermark.h>
 #include "gendb_if.h"
+#include "gendb_col_builder.h"
 #include "gendb_statistics.h"
 #include "sandesh/sandesh.h"
 #include "viz_message.h"
@@ -187,7 +189,36 @@ public:
                                         SandeshLevel::type level);
     void ProcessPendingCompactionTasks(uint32_t pending_compaction_tasks);
 
+    // FieldNames rows skipped because they were already written in the
+    // same T2 row, FieldNames rows written, and entries in the cache
+    static void GetFieldNamesCacheStats(uint64_t *hits, uint64_t *writes,
+        uint64_t *entries);
+
 private:
+    // FieldNames rows written in the last two T2 rows, to write each field
+    // value once per row. The cache is split into shards by table name so
+    // that writers of different tables do not contend on one lock.
+    struct FieldCache {
+        FieldCache();
+        uint32_t t2;
+        uint32_t old_t2;
+        uint8_t old_t2_index;
+        uint8_t new_t2_index;
+        std::set<std::string> set[2];
+        uint64_t hits;
+        uint64_t writes;
+        tbb::mutex mutex;
+    };
+    // Statistics of the stats tables, split into shards by stat table name
+    struct StatTableShard {
+        GenDb::DbTableStatistics stats;
+        tbb::mutex mutex;
+    };
+    static const size_t kFieldCacheShards = 16;
+    static const size_t kStatTableShards = 16;
+
+    static size_t ShardIndex(const std::string &table_name, size_t shards);
+
     void MessageTableKeywordInsert(const VizMsg *vmsgp,
         GenDb::GenDbIf::DbAddColumnCb db_cb);
     void StatTableInsertTtl(uint64_t ts,
@@ -196,6 +227,8 @@ private:
         const TagMap & attribs_tag,
         const AttribMap & attribs_all, int ttl,
         GenDb::GenDbIf::DbAddColumnCb db_cb);
+    void UpdateStatTableStats(const std::string &table_name, bool fail,
+        uint64_t num);
     void FieldNamesTableInsert(uint64_t timestamp,
         const std::string& table_name, const std::string& field_name,
         const std::string& field_val, int ttl,
@@ -227,29 +260,31 @@ private:
     uint64_t GetTtl(TtlType::type type) {
         return GetTtlFromMap(ttl_map_, type);
     }
-    bool CanRecordDataForT2(uint32_t, std::string);
+    static bool CanRecordDataForT2(const std::string &table_name, uint32_t t2,
+        const std::string &fc_entry);
     bool PollUDCCfg() { if(udc_) udc_->PollCfg(); return true; }
     void PollUDCCfgErrorHandler(std::string err_name, std::string err_message);
     bool InsertIntoDb(std::auto_ptr<GenDb::ColList> col_list,
         GenDb::DbConsistency::type dconsistency,
         GenDb::GenDbIf::DbAddColumnCb db_cb);
+    bool InsertIntoDb(const GenDb::ColListBuilder &builder,
+        GenDb::DbConsistency::type dconsistency,
+        GenDb::GenDbIf::DbAddColumnCb db_cb);
+    GenDb::ColListBuilder &LocalColListBuilder(const std::string &cfname);
 
     boost::scoped_ptr<GenDb::GenDbIf> dbif_;
+    // Column list builders reused across inserts by each DB thread
+    tbb::enumerable_thread_specific<GenDb::ColListBuilder> col_list_builders_;
     // Random generator for UUIDs
     ThreadSafeUuidGenerator umn_gen_;
     std::string name_;
     std::string col_name_;
     SandeshLevel::type drop_level_;
     VizMsgStatistics dropped_msg_stats_;
-    GenDb::DbTableStatistics stable_stats_;
+    mutable StatTableShard stable_stats_[kStatTableShards];
     mutable tbb::mutex smutex_;
     TtlMap ttl_map_;
-    static uint32_t field_cache_t2_;
-    static std::set<std::string> field_cache_set_[2];
-    static uint32_t field_cache_old_t2_;
-    static uint8_t old_t2_index_;
-    static uint8_t new_t2_index_;
-    static tbb::mutex fmutex_;
+    static FieldCache field_cache_[kFieldCacheShards];
     std::string tablespace_;
     std::string compaction_strategy_;
     std::string flow_tables_compaction_strategy_;
@@ -338,32 +373,4 @@ class DbHandlerInitializer {
     Timer *db_init_timer_;
 };
 
-/*
- * pugi walker to process flow message
- */
-template <typename T>
-class FlowLogDataObjectWalker : public pugi::xml_tree_walker {
-public:
-    FlowLogDataObjectWalker(T &values) :
-        values_(values) {
-    }
-    ~FlowLogDataObjectWalker() {}
-
-    // Callback that is called when traversal begins
-    virtual bool begin(pugi::xml_node& node) {
-        return true;
-    }
-
-    // Callback that is called for each node traversed
-    virtual bool for_each(pugi::xml_node& node);
-
-    // Callback that is called when traversal ends
-    virtual bool end(pugi::xml_node& node) {
-        return true;
-    }
-
-private:
-    T &values_;
-};
-
 #endif /* DB_HANDLER_H_ */
@@ -46,7 +46,9 @@ IpfixCollector::IpfixCollector(EventManager* evm,
       port_(port),
       num_packets_(0),
       udp_sources_(NULL),
-      colinfo_(new ipfix_col_info())  {
+      colinfo_(new ipfix_col_info()),
+      flow_data_(),
+      batch_timestamp_(0) {
 }
 
 IpfixCollector::~IpfixCollector() {
@@ -81,6 +83,10 @@ void IpfixCollector::Shutdown() {
     }
 }
 
+void IpfixCollector::OnReceiveBatch(std::size_t count) {
+    batch_timestamp_ = UTCTimestampUsec();
+}
+
 void IpfixCollector::ProcessIpfixPacket(const boost::asio::const_buffer& buffer,
                                         size_t length,
                                         boost::asio::ip::udp::endpoint generator_ip) { 
@@ -93,6 +99,12 @@ void IpfixCollector::ProcessIpfixPacket(const boost::asio::const_buffer& buffer,
     input.u.ipcon.addrlen = generator_ip.size();
     (void) ipfix_parse_msg( &input, &udp_sources_,
         boost::asio::buffer_cast<const unsigned char*>(buffer), length);
+    if (!flow_data_.flow.empty()) {
+        flow_data_.__isset.flow = true;
+        db_handler_->UnderlayFlowSampleInsert(flow_data_, batch_timestamp_,
+            GenDb::GenDbIf::DbAddColumnCb());
+        flow_data_.flow.clear();
+    }
 }
 
 int IpfixCollector::NewSource(ipfixs_node *s, void *arg)
@@ -135,11 +147,7 @@ int IpfixCollector::ExportDrecord(
         " nfields: " << t->ipfixt->nfields <<
         ((t->ipfixt->nscopefields)?"(option record)":""));
 #endif
-    UFlowData flow_data;
-    flow_data.set_name(ipfix_col_input_get_ident(s->input));
-    // TODO: Get the timestamp from the packet
-    uint64_t tm = UTCTimestampUsec();
-    std::vector<UFlowSample> samples;
+    flow_data_.set_name(ipfix_col_input_get_ident(s->input));
     UFlowSample sample;
     sample.set_flowtype(g_uflow_constants.FlowTypeName.find(
                             FlowType::IPFIX)->second);
@@ -170,10 +178,8 @@ int IpfixCollector::ExportDrecord(
             // TODO : Put other fields in  "otherinfo"
         }
     }
-    samples.push_back(sample);
-    flow_data.set_flow(samples);
-    db_handler_->UnderlayFlowSampleInsert(flow_data, tm,
-        GenDb::GenDbIf::DbAddColumnCb());
+    // Inserted once the whole datagram is parsed, see ProcessIpfixPacket
+    flow_data_.flow.push_back(sample);
     return 0;
 }
 
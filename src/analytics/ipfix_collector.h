@@ -10,6 +10,7 @@
 #include "io/udp_server.h"
 #include "db_handler.h"
 #include "ipfix.h"
+#include "uflow_types.h"
 
 struct ipfixs_node;
 struct ipfixt_node;
@@ -18,6 +19,9 @@ struct ipfix_datarecord;
 
 class IpfixCollector : public UdpServer {
 public:
+    // Number of IPFIX datagrams read from the socket in one system call
+    static const int kReceiveBatchSize = 32;
+
     explicit IpfixCollector(EventManager* evm,
         DbHandlerPtr db_handler, std::string ip_address,
         int port);
@@ -35,6 +39,11 @@ public:
             ipfix_datarecord *data,
             void *arg);
     int ExportTrecord(ipfixs_node *s, ipfixt_node *t, void *arg);
+
+protected:
+    virtual int receive_batch_size() const { return kReceiveBatchSize; }
+    virtual void OnReceiveBatch(std::size_t count);
+
 private:
    
     DbHandlerPtr db_handler_;
@@ -44,6 +53,10 @@ private:
     ipfixs_node  *udp_sources_;
     std::map<std::string,std::string> uflowfields_;
     boost::scoped_ptr<ipfix_col_info> colinfo_;
+    // Data records of the datagram being parsed, inserted in the database
+    // together once the datagram is parsed
+    UFlowData flow_data_;
+    uint64_t batch_timestamp_;
 
     void HandleReceive(const boost::asio::const_buffer& buffer,
                        boost::asio::ip::udp::endpoint remote_endpoint,
@@ -1,28 +1,298 @@
 /*
  * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
  */
-#define BOOST_SPIRIT_DEBUG
-#include "boost/spirit/include/classic.hpp"
-#include <boost/config/warning_disable.hpp>
-#include <boost/spirit/include/qi.hpp>
-#include <boost/spirit/include/phoenix_core.hpp>
-#include <boost/spirit/include/phoenix_operator.hpp>
-#include <boost/spirit/include/phoenix_stl.hpp>
-#include <boost/spirit/include/qi_repeat.hpp>
-
-#include <boost/assign/list_of.hpp>
-
+#include <string.h>
 #include <boost/algorithm/string/case_conv.hpp>
 
 #include <iostream>
+#include <sstream>
 #include "parser_util.h"
 
-namespace qi = boost::spirit::qi;
-namespace ascii = boost::spirit::ascii;
-namespace phx = boost::phoenix;
-using namespace BOOST_SPIRIT_CLASSIC_NS;
+namespace {
+
+// Characters skipped between keywords
+bool IsSkip(char c) {
+    switch (c) {
+    case ' ': case '\t': case '\n': case '\v': case '\f': case '\r':
+    case '.': case ',': case ';': case ':':
+    case '[': case ']': case '(': case ')': case '{': case '}':
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Characters that end a word. Unlike the skipped characters, newlines and
+// the like don't.
+bool IsWordEnd(char c) {
+    switch (c) {
+    case ' ': case '\t': case '\r':
+    case '.': case ',': case ';': case ':':
+    case '[': case ']': case '(': case ')': case '{': case '}':
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool IsOctal(char c) {
+    return c >= '0' && c <= '7';
+}
+
+bool IsHex(char c) {
+    return IsDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+const char *SkipWhile(const char *p, const char *end, bool (*pred)(char)) {
+    while (p != end && pred(*p))
+        p++;
+    return p;
+}
+
+// Each of the matchers below returns the end of the token starting at p,
+// or NULL if there is no such token at p.
+//
+// The keywords are the ones the spirit grammar this replaced used to
+// produce. Among other things, stop words are matched as prefixes, and
+// stats, ip and ipv6 keywords keep the separator of a trailing part that
+// is not followed by a number, e.g. "10.1.1.1/" for "10.1.1.1/x". That
+// separator is not consumed.
+
+const char *kStopWords[] = {
+    "via", "or", "of", "string", "sandesh", "client", "the", "that", "and",
+};
+
+// "order" is "or" followed by "der"
+const char *MatchStopWord(const char *p, const char *end) {
+    const char *match = NULL;
+    for (size_t idx = 0; idx < sizeof(kStopWords) / sizeof(kStopWords[0]);
+         ++idx) {
+        size_t len = strlen(kStopWords[idx]);
+        if (static_cast<size_t>(end - p) >= len &&
+            memcmp(p, kStopWords[idx], len) == 0 &&
+            (match == NULL || p + len > match)) {
+            match = p + len;
+        }
+    }
+    return match;
+}
+
+// Digits followed by one or more "/digits", e.g. 0/0/121
+const char *MatchStats(const char *p, const char *end,
+    const char **token_end) {
+    const char *q = SkipWhile(p, end, IsDigit);
+    if (q == p)
+        return NULL;
+    bool found = false;
+    *token_end = q;
+    while (q != end && *q == '/') {
+        const char *r = SkipWhile(q + 1, end, IsDigit);
+        if (r == q + 1) {
+            *token_end = r;
+            break;
+        }
+        q = *token_end = r;
+        found = true;
+    }
+    return found ? q : NULL;
+}
+
+// Text between quotes, without any leading separators
+const char *MatchQuoted(const char *p, const char *end, char quote,
+    const char **token) {
+    if (*p != quote)
+        return NULL;
+    const char *q = SkipWhile(p + 1, end, IsSkip);
+    const char *r = q;
+    while (r != end && *r != quote)
+        r++;
+    if (r == q || r == end)
+        return NULL;
+    *token = q;
+    return r + 1;
+}
+
+const char *MatchUuid(const char *p, const char *end) {
+    static const size_t kUuidLength = 36;
+    if (static_cast<size_t>(end - p) < kUuidLength)
+        return NULL;
+    for (size_t idx = 0; idx < kUuidLength; ++idx) {
+        if (idx == 8 || idx == 13 || idx == 18 || idx == 23) {
+            if (p[idx] != '-')
+                return NULL;
+        } else if (!IsHex(p[idx])) {
+            return NULL;
+        }
+    }
+    return p + kUuidLength;
+}
+
+// Optional "/digits" prefix length
+const char *MatchPrefixLength(const char *p, const char *end,
+    const char **token_end) {
+    *token_end = p;
+    if (p == end || *p != '/')
+        return p;
+    const char *q = SkipWhile(p + 1, end, IsDigit);
+    if (q == p + 1) {
+        *token_end = q;
+        return p;
+    }
+    *token_end = q;
+    return q;
+}
 
+// Three or more dotted numbers with an optional prefix length
+const char *MatchIp(const char *p, const char *end, const char **token_end) {
+    const char *q = SkipWhile(p, end, IsDigit);
+    if (q == p || q == end || *q != '.')
+        return NULL;
+    const char *r = SkipWhile(q + 1, end, IsDigit);
+    if (r == q + 1)
+        return NULL;
+    q = r;
+    bool found = false;
+    while (q != end && *q == '.') {
+        r = SkipWhile(q + 1, end, IsDigit);
+        if (r == q + 1) {
+            if (!found)
+                return NULL;
+            *token_end = r;
+            return q;
+        }
+        q = r;
+        found = true;
+    }
+    return found ? MatchPrefixLength(q, end, token_end) : NULL;
+}
 
+bool IsColon(char c) {
+    return c == ':';
+}
+
+// Hex numbers separated by one or more colons, with an optional prefix
+// length
+const char *MatchIpv6(const char *p, const char *end,
+    const char **token_end) {
+    const char *q = SkipWhile(p, end, IsHex);
+    if (q == p)
+        return NULL;
+    bool found = false;
+    while (true) {
+        const char *r = SkipWhile(q, end, IsColon);
+        if (r == q)
+            break;
+        const char *s = SkipWhile(r, end, IsHex);
+        if (s == r) {
+            if (!found)
+                return NULL;
+            *token_end = r;
+            return q;
+        }
+        q = s;
+        found = true;
+    }
+    return found ? MatchPrefixLength(q, end, token_end) : NULL;
+}
+
+const char *MatchHex(const char *p, const char *end) {
+    if (end - p < 3 || p[0] != '0' || p[1] != 'x')
+        return NULL;
+    const char *q = SkipWhile(p + 2, end, IsHex);
+    return q == p + 2 ? NULL : q;
+}
+
+const char *MatchOctal(const char *p, const char *end) {
+    if (*p != '0')
+        return NULL;
+    const char *q = SkipWhile(p + 1, end, IsOctal);
+    return q == p + 1 ? NULL : q;
+}
+
+// Optional digits followed by a dot and digits
+const char *MatchDecimal(const char *p, const char *end) {
+    const char *q = SkipWhile(p, end, IsDigit);
+    if (q == end || *q != '.')
+        return NULL;
+    const char *r = SkipWhile(q + 1, end, IsDigit);
+    return r == q + 1 ? NULL : r;
+}
+
+// Digits with an optional trailing dot
+const char *MatchNumber(const char *p, const char *end) {
+    const char *q = SkipWhile(p, end, IsDigit);
+    if (q == p)
+        return NULL;
+    return (q != end && *q == '.') ? q + 1 : q;
+}
+
+const char *MatchWord(const char *p, const char *end) {
+    const char *q = p;
+    while (q != end && !IsWordEnd(*q))
+        q++;
+    return q == p ? NULL : q;
+}
+
+bool IsSkipOrAmpersand(char c) {
+    return c == '&' || IsSkip(c);
+}
+
+}  // namespace
+
+LineTokenizer::LineTokenizer(const char *begin, const char *end) :
+    pos_(begin),
+    end_(end) {
+}
+
+//
+// The alternatives are tried in order at each position and the first one
+// that matches is taken. Stop words, hex and octal numbers and decimals
+// are skipped rather than returned.
+//
+bool LineTokenizer::Next(const char **token, size_t *length) {
+    while (true) {
+        const char *p = SkipWhile(pos_, end_, IsSkipOrAmpersand);
+        if (p == end_)
+            return false;
+
+        const char *start = p;
+        const char *token_end = NULL;
+        const char *q;
+        bool keyword = true;
+        if ((q = MatchStopWord(p, end_)) != NULL) {
+            keyword = false;
+        } else if ((q = MatchStats(p, end_, &token_end)) != NULL) {
+        } else if ((q = MatchQuoted(p, end_, '\'', &start)) != NULL ||
+                   (q = MatchQuoted(p, end_, '"', &start)) != NULL) {
+            token_end = q - 1;
+        } else if ((q = MatchUuid(p, end_)) != NULL) {
+        } else if ((q = MatchIp(p, end_, &token_end)) != NULL) {
+        } else if ((q = MatchIpv6(p, end_, &token_end)) != NULL) {
+        } else if ((q = MatchHex(p, end_)) != NULL ||
+                   (q = MatchOctal(p, end_)) != NULL ||
+                   (q = MatchDecimal(p, end_)) != NULL ||
+                   (q = MatchNumber(p, end_)) != NULL) {
+            keyword = false;
+        } else {
+            q = MatchWord(p, end_);
+        }
+
+        pos_ = q;
+        if (keyword) {
+            *token = start;
+            *length = (token_end ? token_end : q) - start;
+            return true;
+        }
+    }
+}
+
+bool LineTokenizer::Complete() const {
+    return SkipWhile(pos_, end_, IsSkip) == end_;
+}
 
 bool
 LineParser::GetAtrributes(const pugi::xml_node &node,
@@ -34,7 +304,7 @@ LineParser::GetAtrributes(const pugi::xml_node &node,
          std::string s =  MakeSane(boost::algorithm::to_lower_copy(std::string(
                      attr.value())));
          if (!s.empty()) {
-             r &= ParseDoc(s.begin(), s.end(), words);
+             r &= ParseDoc(s, words);
          }
      }
      return r;
@@ -54,7 +324,7 @@ LineParser::Traverse(const pugi::xml_node &node,
          std::string s =  MakeSane(boost::algorithm::to_lower_copy(std::string(
                      node.value())));
          if (!s.empty()) {
-             r &= ParseDoc(s.begin(), s.end(), words);
+             r &= ParseDoc(s, words);
          }
     }
     for (pugi::xml_node s = node.first_child(); s; s = s.next_sibling())
@@ -76,102 +346,32 @@ LineParser::ParseXML(const pugi::xml_node &node,
 
 bool
 LineParser::Parse(std::string s, LineParser::WordListType *words) {
-    std::string ls = MakeSane(boost::algorithm::to_lower_copy(s));
-    return ParseDoc(ls.begin(), ls.end(), words);
+    boost::algorithm::to_lower(s);
+    if (NeedsSane(s))
+        s = MakeSane(s);
+    return ParseDoc(s, words);
 }
 
-template<typename Iterator>
-struct msg_skipper : public qi::grammar<Iterator> {
-    msg_skipper() : msg_skipper::base_type(skip, "msgskpr") {
-        skip = ascii::space | qi::char_(".,;:[](){}\t\r");
+bool
+LineParser::ParseDoc(const std::string &text, LineParser::WordListType *pv)
+{
+    LineTokenizer tokenizer(text.data(), text.data() + text.size());
+    const char *token;
+    size_t length;
+    while (tokenizer.Next(&token, &length)) {
+        pv->insert(std::string(token, length));
     }
-    qi::rule<Iterator> skip;
-};
+    return tokenizer.Complete();
+}
 
-template <typename Iterator>
 bool
-LineParser::ParseDoc(Iterator start, Iterator end,
-        LineParser::WordListType *pv)
-{
-    using ascii::space;
-    using qi::char_;
-    using qi::lit;
-    using qi::_1;
-    using qi::lexeme;
-    using qi::debug;
-    using phx::insert;
-    using phx::ref;
-    using boost::spirit::repeat;
-
-    typedef msg_skipper<Iterator> skipper_t;
-    skipper_t skpr;
-
-    qi::rule<Iterator, std::string(), skipper_t> num1 =
-        lexeme[ *char_("0-9") >> '.' >> +char_("0-9") ];
-    qi::rule<Iterator, std::string(), skipper_t> num2=
-        lexeme[ +char_("0-9") >> -lit('.') ];
-    qi::rule<Iterator, std::string(), skipper_t> hex1=
-        lexeme[ lit('0') >> lit('x') >> +char_("0-9A-Fa-f") ];
-    qi::rule<Iterator, std::string(), skipper_t> oct1=
-        lexeme[ lit('0') >> +char_("0-7") ];
-    qi::rule<Iterator, std::string(), skipper_t> word =
-        lexeme[ +(char_ - char_(" .,;:[](){}\t\r")) ];
-    qi::rule<Iterator, std::string(), skipper_t> word2 =
-        '\'' >> lexeme[ +(char_ - '\'') ] >> '\'';
-    qi::rule<Iterator, std::string(), skipper_t> word3 =
-        '"' >> lexeme[ +(char_ - '"') ] >> '"';
-    qi::rule<Iterator, std::string(), skipper_t> uuid =
-        lexeme[ repeat(8)[char_("0-9a-fA-F")] >> char_('-') >>
-         repeat(3)[ repeat(4)[char_("0-9a-fA-F")] >> char_('-') ] >>
-         repeat(12)[char_("0-9a-fA-F")] ];
-    qi::rule<Iterator, std::string(), skipper_t> ip =
-    lexeme[ +char_(L'0', L'9') >> char_('.') >> +char_(L'0', L'9')
-        >> +(char_('.') >> +char_(L'0', L'9'))
-        >> -(char_('/') >> +char_(L'0', L'9'))];
-    qi::rule<Iterator, std::string(), skipper_t> ipv6 =
-    lexeme[ +char_("0-9a-fA-F") >> +(+ char_(':')
-        >> +char_("0-9a-fA-F")) >> -(char_('/')
-        >> +char_(L'0', L'9'))];
-    qi::rule<Iterator, std::string(), skipper_t> stats =
-    lexeme[ +char_(L'0', L'9') >> +(char_('/') >> +char_(L'0', L'9'))];
-
-    qi::symbols<char, bool> stop_words;
-    stop_words.add
-        ("via", true)("or", true)("of", true)
-        ("string", true)("sandesh", true)("client", true)
-        ("the", true)("that", true)("and", true);
-    qi::rule<Iterator, std::string(), skipper_t> aw =
-        +( *( lit(":")
-            | lit(",")
-            | lit(".")
-            | lit(";")
-            | lit("&")
-            ) >>
-         ( stop_words
-         | stats [insert(ref(*pv), _1)]
-         | word2 [insert(ref(*pv), _1)]
-         | word3 [insert(ref(*pv), _1)]
-         | uuid  [insert(ref(*pv), _1)]
-         | ip    [insert(ref(*pv), _1)]
-         | ipv6  [insert(ref(*pv), _1)]
-         | hex1
-         | oct1
-         | num1
-         | num2
-         | word  [insert(ref(*pv), _1)]
-         )
-        );
-
-    bool r = qi::phrase_parse(start, end,
-        // Begin grammer
-        *aw
-        // end grammer
-        , skpr);
-    BOOST_SPIRIT_DEBUG_NODES((word)(num1)(aw)(word2));
-    BOOST_SPIRIT_DEBUG_RULE(word);
-    BOOST_SPIRIT_DEBUG_RULE(word2);
-    BOOST_SPIRIT_DEBUG_RULE(aw);
-    return ((start == end) && r);
+LineParser::NeedsSane(const std::string &text) {
+    for (std::string::const_iterator it = text.begin(); it != text.end();
+            ++it) {
+        if (0x80 & *it)
+            return true;
+    }
+    return false;
 }
 
 std::string
@@ -234,12 +434,3 @@ LineParser::SearchPattern(const boost::regex &exp, std::string text)
 }
 
 
-// generate a method for the template(required for static template function
-void
-TemplateGen() {
-    std::string s("hello");
-    LineParser::WordListType words;
-    LineParser::Parse(s, &words);
-    std::cout << "result length: " << words.size() << std::endl;
-}
-
@@ -9,6 +9,24 @@
 #include <boost/regex.hpp>
 #include <pugixml/pugixml.hpp>
 
+//
+// Splits text into the keywords that LineParser indexes. The text is
+// expected to be in lower case and passed through LineParser::MakeSane.
+// The tokens point into the text, so tokenizing doesn't allocate.
+//
+class LineTokenizer
+{
+public:
+    LineTokenizer(const char *begin, const char *end);
+    // Returns false once there are no keywords left
+    bool Next(const char **token, size_t *length);
+    // Whether all of the text was consumed, valid once Next returned false
+    bool Complete() const;
+private:
+    const char *pos_;
+    const char *end_;
+};
+
 class LineParser
 {
 public:
@@ -25,9 +43,9 @@ public:
     static unsigned int SearchPattern(std::string exp, std::string text) {
         return SearchPattern(boost::regex(exp, boost::regex::icase), text); }
 private:
-    template <typename Iterator>
-    static bool ParseDoc(Iterator start, Iterator end,
+    static bool ParseDoc(const std::string &text,
             LineParser::WordListType *pv);
+    static bool NeedsSane(const std::string &text);
     static bool Traverse(const pugi::xml_node &node, WordListType *words,
             bool check_attr=true);
     static bool GetAtrributes(const pugi::xml_node &node, WordListType *words);
@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "analytics/pattern_matcher.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <deque>
+#include <map>
+
+using std::string;
+using std::vector;
+
+const size_t PatternMatcher::kNoLiteral;
+const size_t PatternMatcher::kStackLiterals;
+
+namespace {
+
+const uint32_t kNoState = static_cast<uint32_t>(-1);
+
+bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Returns the position after the bracket expression at pos, or npos
+size_t SkipClass(const string &pattern, size_t pos) {
+    size_t idx = pos + 1;
+    if (idx < pattern.size() && pattern[idx] == '^')
+        idx++;
+    if (idx < pattern.size() && pattern[idx] == ']')
+        idx++;
+    while (idx < pattern.size()) {
+        char c = pattern[idx];
+        if (c == '\\') {
+            idx += 2;
+        } else if (c == '[' && idx + 1 < pattern.size() &&
+                   strchr(":.=", pattern[idx + 1]) != NULL) {
+            // [:alpha:] and the like
+            char term[] = { pattern[idx + 1], ']', '\0' };
+            size_t end = pattern.find(term, idx + 2);
+            if (end == string::npos)
+                return string::npos;
+            idx = end + 2;
+        } else if (c == ']') {
+            return idx + 1;
+        } else {
+            idx++;
+        }
+    }
+    return string::npos;
+}
+
+// Returns the position after the group at pos, or npos
+size_t SkipGroup(const string &pattern, size_t pos) {
+    int depth = 0;
+    size_t idx = pos;
+    while (idx < pattern.size()) {
+        char c = pattern[idx];
+        if (c == '\\') {
+            idx += 2;
+            continue;
+        }
+        if (c == '[') {
+            idx = SkipClass(pattern, idx);
+            if (idx == string::npos)
+                return string::npos;
+            continue;
+        }
+        if (c == '(') {
+            depth++;
+        } else if (c == ')' && --depth == 0) {
+            return idx + 1;
+        }
+        idx++;
+    }
+    return string::npos;
+}
+
+// Parses the {n}, {n,} or {n,m} interval at pos. Returns the position after
+// it, or npos if it isn't a valid interval.
+size_t ParseInterval(const string &pattern, size_t pos, size_t *min) {
+    size_t idx = pos + 1;
+    size_t start = idx;
+    *min = 0;
+    while (idx < pattern.size() && IsDigit(pattern[idx]))
+        *min = *min * 10 + (pattern[idx++] - '0');
+    if (idx == start)
+        return string::npos;
+    if (idx < pattern.size() && pattern[idx] == ',') {
+        idx++;
+        while (idx < pattern.size() && IsDigit(pattern[idx]))
+            idx++;
+    }
+    if (idx >= pattern.size() || pattern[idx] != '}')
+        return string::npos;
+    return idx + 1;
+}
+
+}  // namespace
+
+PatternMatcher::PatternMatcher() :
+    class_count_(1) {
+    memset(char_class_, 0, sizeof(char_class_));
+}
+
+PatternMatcher::~PatternMatcher() {
+}
+
+//
+// Scans the pattern for runs of literal characters that every match must
+// contain, and returns the longest one. Only a subset of the syntax is
+// understood: groups and bracket expressions are skipped over, and any
+// alternation at the top level, inline modifier, unusual escape or flag
+// results in no literal at all, so that the pattern is always searched for.
+//
+string PatternMatcher::RequiredLiteral(const boost::regex &regexp) {
+    if (regexp.flags() != boost::regex::normal)
+        return string();
+    const string pattern(regexp.str());
+    if (pattern.find("(?") != string::npos ||
+        pattern.find("\\Q") != string::npos) {
+        return string();
+    }
+
+    string best;
+    string run;
+    size_t pos = 0;
+    while (pos < pattern.size()) {
+        char c = pattern[pos];
+        bool literal = false;
+        size_t next = pos + 1;
+        switch (c) {
+        case '|':
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+            return string();
+        case '(':
+            next = SkipGroup(pattern, pos);
+            break;
+        case '[':
+            next = SkipClass(pattern, pos);
+            break;
+        case '.':
+        case '^':
+        case '$':
+            break;
+        case '\\':
+            if (pos + 1 >= pattern.size())
+                return string();
+            c = pattern[pos + 1];
+            next = pos + 2;
+            if (isalnum(static_cast<uint8_t>(c))) {
+                // Character classes, assertions and control characters
+                // are single elements; anything else is not handled.
+                if (strchr("dDwWsShHvVbBAzZGKntrfea", c) == NULL)
+                    return string();
+            } else if (strchr("<>`'", c) == NULL) {
+                literal = true;
+            }
+            break;
+        default:
+            literal = true;
+            break;
+        }
+        if (next == string::npos)
+            return string();
+
+        bool optional = false;
+        bool repeated = false;
+        if (next < pattern.size()) {
+            char quantifier = pattern[next];
+            if (quantifier == '*' || quantifier == '?') {
+                optional = repeated = true;
+                next++;
+            } else if (quantifier == '+') {
+                repeated = true;
+                next++;
+            } else if (quantifier == '{') {
+                size_t min;
+                next = ParseInterval(pattern, next, &min);
+                if (next == string::npos)
+                    return string();
+                optional = (min == 0);
+                repeated = true;
+            }
+            // Lazy and possessive quantifiers
+            if (repeated && next < pattern.size() &&
+                (pattern[next] == '?' || pattern[next] == '+')) {
+                next++;
+            }
+        }
+
+        if (literal && !optional)
+            run.push_back(c);
+        if (!literal || repeated) {
+            if (run.size() > best.size())
+                best.swap(run);
+            run.clear();
+        }
+        pos = next;
+    }
+    if (run.size() > best.size())
+        best.swap(run);
+    return best;
+}
+
+size_t PatternMatcher::AddPattern(const string &name,
+    const boost::regex &regexp) {
+    Pattern pattern;
+    pattern.name = name;
+    pattern.regexp = regexp;
+    pattern.literal = RequiredLiteral(regexp);
+    pattern.literal_id = kNoLiteral;
+    patterns_.push_back(pattern);
+    return patterns_.size() - 1;
+}
+
+void PatternMatcher::AddLiteral(uint32_t literal_id, const string &literal,
+    vector<vector<uint32_t> > *outputs) {
+    uint32_t state = 0;
+    for (string::const_iterator it = literal.begin(); it != literal.end();
+         ++it) {
+        size_t slot = state * class_count_ +
+            char_class_[static_cast<uint8_t>(*it)];
+        if (transitions_[slot] == kNoState) {
+            transitions_[slot] = outputs->size();
+            outputs->push_back(vector<uint32_t>());
+            transitions_.resize(transitions_.size() + class_count_,
+                kNoState);
+        }
+        state = transitions_[slot];
+    }
+    (*outputs)[state].push_back(literal_id);
+}
+
+void PatternMatcher::Compile() {
+    literals_.clear();
+    memset(char_class_, 0, sizeof(char_class_));
+    class_count_ = 1;
+
+    // Patterns with the same literal share it
+    std::map<string, size_t> literal_ids;
+    for (vector<Pattern>::iterator it = patterns_.begin();
+         it != patterns_.end(); ++it) {
+        if (it->literal.empty()) {
+            it->literal_id = kNoLiteral;
+            continue;
+        }
+        std::pair<std::map<string, size_t>::iterator, bool> result =
+            literal_ids.insert(std::make_pair(it->literal, literals_.size()));
+        if (result.second)
+            literals_.push_back(it->literal);
+        it->literal_id = result.first->second;
+    }
+
+    for (vector<string>::const_iterator it = literals_.begin();
+         it != literals_.end(); ++it) {
+        for (string::const_iterator cit = it->begin(); cit != it->end();
+             ++cit) {
+            uint16_t &char_class = char_class_[static_cast<uint8_t>(*cit)];
+            if (char_class == 0)
+                char_class = class_count_++;
+        }
+    }
+
+    // Build the trie of the literals
+    transitions_.assign(class_count_, kNoState);
+    vector<vector<uint32_t> > outputs(1);
+    for (size_t idx = 0; idx < literals_.size(); ++idx) {
+        AddLiteral(idx, literals_[idx], &outputs);
+    }
+
+    // Turn it into an automaton by filling in the missing transitions from
+    // the failure links, in breadth first order so that the failure state
+    // of a state is always done before the state itself.
+    vector<uint32_t> failure(outputs.size(), 0);
+    std::deque<uint32_t> queue;
+    for (size_t cls = 0; cls < class_count_; ++cls) {
+        uint32_t &next = transitions_[cls];
+        if (next == kNoState) {
+            next = 0;
+        } else {
+            queue.push_back(next);
+        }
+    }
+    while (!queue.empty()) {
+        uint32_t state = queue.front();
+        queue.pop_front();
+        const vector<uint32_t> &inherited = outputs[failure[state]];
+        outputs[state].insert(outputs[state].end(), inherited.begin(),
+            inherited.end());
+        for (size_t cls = 0; cls < class_count_; ++cls) {
+            uint32_t &next = transitions_[state * class_count_ + cls];
+            uint32_t fallback =
+                transitions_[failure[state] * class_count_ + cls];
+            if (next == kNoState) {
+                next = fallback;
+            } else {
+                failure[next] = fallback;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    output_begin_.clear();
+    outputs_.clear();
+    for (vector<vector<uint32_t> >::const_iterator it = outputs.begin();
+         it != outputs.end(); ++it) {
+        output_begin_.push_back(outputs_.size());
+        outputs_.insert(outputs_.end(), it->begin(), it->end());
+    }
+    output_begin_.push_back(outputs_.size());
+}
+
+void PatternMatcher::Match(const string &text, vector<size_t> *matches) const {
+    if (patterns_.empty())
+        return;
+
+    // Bitmap of the literals found in the text
+    uint64_t stack_found[kStackLiterals / 64];
+    vector<uint64_t> heap_found;
+    uint64_t *found = stack_found;
+    size_t words = (literals_.size() + 63) / 64;
+    if (words > kStackLiterals / 64) {
+        heap_found.resize(words);
+        found = &heap_found[0];
+    } else {
+        memset(stack_found, 0, words * sizeof(stack_found[0]));
+    }
+
+    size_t remaining = literals_.size();
+    uint32_t state = 0;
+    for (string::const_iterator it = text.begin();
+         it != text.end() && remaining != 0; ++it) {
+        state = transitions_[state * class_count_ +
+            char_class_[static_cast<uint8_t>(*it)]];
+        for (uint32_t idx = output_begin_[state];
+             idx < output_begin_[state + 1]; ++idx) {
+            uint32_t literal_id = outputs_[idx];
+            uint64_t bit = static_cast<uint64_t>(1) << (literal_id % 64);
+            if ((found[literal_id / 64] & bit) == 0) {
+                found[literal_id / 64] |= bit;
+                remaining--;
+            }
+        }
+    }
+
+    for (size_t idx = 0; idx < patterns_.size(); ++idx) {
+        size_t literal_id = patterns_[idx].literal_id;
+        if (literal_id != kNoLiteral) {
+            uint64_t bit = static_cast<uint64_t>(1) << (literal_id % 64);
+            if ((found[literal_id / 64] & bit) == 0)
+                continue;
+        }
+        if (boost::regex_search(text, patterns_[idx].regexp))
+            matches->push_back(idx);
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef ANALYTICS_PATTERN_MATCHER_H_
+#define ANALYTICS_PATTERN_MATCHER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <boost/regex.hpp>
+
+#include <base/util.h>
+
+//
+// Matches text against a set of regular expressions. Most expressions can
+// only match text that contains some literal string, e.g. "error" for
+// "error [0-9]+". The literals of all the expressions are looked for with
+// a single Aho-Corasick automaton, and an expression is only searched for
+// if the text contains its literal. So text that matches none of the
+// expressions is usually scanned just once. Expressions without a literal
+// are always searched for.
+//
+class PatternMatcher {
+public:
+    PatternMatcher();
+    ~PatternMatcher();
+
+    // Returns the index of the pattern. The patterns are not used until
+    // Compile is called.
+    size_t AddPattern(const std::string &name, const boost::regex &regexp);
+    void Compile();
+    // Appends the indexes of the patterns that are found in the text to
+    // matches, in the order the patterns were added
+    void Match(const std::string &text, std::vector<size_t> *matches) const;
+
+    size_t size() const { return patterns_.size(); }
+    const std::string &name(size_t index) const {
+        return patterns_[index].name;
+    }
+    // Literal that any match of the pattern contains, empty if none
+    const std::string &literal(size_t index) const {
+        return patterns_[index].literal;
+    }
+
+    static std::string RequiredLiteral(const boost::regex &regexp);
+
+private:
+    struct Pattern {
+        std::string name;
+        boost::regex regexp;
+        std::string literal;
+        // Index into literals_, or kNoLiteral
+        size_t literal_id;
+    };
+
+    static const size_t kNoLiteral = static_cast<size_t>(-1);
+    // Literals that can be tracked without allocating during Match
+    static const size_t kStackLiterals = 1024;
+
+    void AddLiteral(uint32_t literal_id, const std::string &literal,
+        std::vector<std::vector<uint32_t> > *outputs);
+
+    std::vector<Pattern> patterns_;
+    std::vector<std::string> literals_;
+
+    // The automaton has a row of transitions for each state, with a column
+    // for each class of characters. Characters that are in none of the
+    // literals share class 0. State 0 is the root.
+    uint16_t char_class_[256];
+    size_t class_count_;
+    std::vector<uint32_t> transitions_;
+    // The literals that end at state n are outputs_[output_begin_[n]] up
+    // to outputs_[output_begin_[n + 1]]
+    std::vector<uint32_t> output_begin_;
+    std::vector<uint32_t> outputs_;
+
+    DISALLOW_COPY_AND_ASSIGN(PatternMatcher);
+};
+
+#endif  // ANALYTICS_PATTERN_MATCHER_H_
@@ -2,6 +2,7 @@
 // Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
 //
 
+#include <algorithm>
 #include <utility>
 #include <string>
 #include <vector>
@@ -72,6 +73,7 @@ bool ProtobufReader::ParseSelfDescribingMessage(const uint8_t *data,
     for (int i = 0; i < fds.file_size(); i++) {
         const FileDescriptorProto &fdp(fds.file(i));
         tbb::mutex::scoped_lock lock(mutex_);
+        bool new_file(dpool_.FindFileByName(fdp.name()) == NULL);
         const FileDescriptor *fd(dpool_.BuildFile(fdp));
         if (fd == NULL) {
             if (!parse_failure_cb.empty()) {
@@ -81,6 +83,10 @@ bool ProtobufReader::ParseSelfDescribingMessage(const uint8_t *data,
                 ": DescriptorPool BuildFile(" << i << ") FAILED");
             return false;
         }
+        if (new_file) {
+            // The file can extend message types that already have plans
+            extractors_.clear();
+        }
         lock.release();
     }
     // Extract the Descriptor
@@ -116,6 +122,77 @@ bool ProtobufReader::ParseSelfDescribingMessage(const uint8_t *data,
     return true;
 }
 
+boost::shared_ptr<const ProtobufExtractor> ProtobufReader::GetExtractor(
+    const Descriptor *mdesc) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    ExtractorMap::const_iterator it = extractors_.find(mdesc);
+    if (it != extractors_.end()) {
+        return it->second;
+    }
+    boost::shared_ptr<const ProtobufExtractor> extractor(
+        new ProtobufExtractor(mdesc));
+    extractors_.insert(make_pair(mdesc, extractor));
+    return extractor;
+}
+
+static bool IsTelemetryKey(const FieldDescriptor *field) {
+    const FieldOptions &foptions(field->options());
+    if (!foptions.HasExtension(telemetry_options)) {
+        return false;
+    }
+    const TelemetryFieldOptions &toptions(
+        foptions.GetExtension(telemetry_options));
+    return toptions.has_is_key() && toptions.is_key();
+}
+
+static bool FieldNumberLess(const ProtobufExtractor::Field &lhs,
+    const ProtobufExtractor::Field &rhs) {
+    return lhs.field->number() < rhs.field->number();
+}
+
+ProtobufExtractor::ProtobufExtractor(const Descriptor *mdesc) :
+    descriptor_(mdesc) {
+    PlanIndexMap indexes;
+    Compile(mdesc, &indexes);
+}
+
+int ProtobufExtractor::Compile(const Descriptor *mdesc,
+    PlanIndexMap *indexes) {
+    PlanIndexMap::const_iterator it = indexes->find(mdesc);
+    if (it != indexes->end()) {
+        return it->second;
+    }
+    // Reserve the index before compiling the message fields, since the
+    // message type can be reached again from them
+    int index(plans_.size());
+    indexes->insert(make_pair(mdesc, index));
+    plans_.push_back(MessagePlan());
+    std::vector<const FieldDescriptor*> fields;
+    for (int i = 0; i < mdesc->field_count(); i++) {
+        fields.push_back(mdesc->field(i));
+    }
+    mdesc->file()->pool()->FindAllExtensions(mdesc, &fields);
+    MessagePlan plan;
+    for (size_t i = 0; i < fields.size(); i++) {
+        Field field;
+        field.field = fields[i];
+        field.type = fields[i]->cpp_type();
+        field.is_tag = IsTelemetryKey(fields[i]);
+        field.plan = -1;
+        if (field.type == FieldDescriptor::CPPTYPE_MESSAGE) {
+            field.plan = Compile(fields[i]->message_type(), indexes);
+            plan.messages.push_back(field);
+        } else if (!fields[i]->is_repeated()) {
+            // Repeated elemental fields cannot be read as a single value
+            plan.elements.push_back(field);
+        }
+    }
+    std::sort(plan.elements.begin(), plan.elements.end(), FieldNumberLess);
+    std::sort(plan.messages.begin(), plan.messages.end(), FieldNumberLess);
+    plans_[index] = plan;
+    return index;
+}
+
 void PopulateProtobufTopLevelTags(const Message& message,
     const boost::asio::ip::udp::endpoint &remote_endpoint,
     StatWalker::TagMap *top_tags) {
@@ -380,6 +457,121 @@ void ProcessProtobufMessage(const Message& message,
     PopulateProtobufStats(message, std::string(), &stat_walker);
 }
 
+static bool GetFieldValue(const Message& message,
+    const Reflection *reflection, const ProtobufExtractor::Field &field,
+    DbHandler::Var *value) {
+    switch (field.type) {
+      case FieldDescriptor::CPPTYPE_INT32:
+        *value = static_cast<uint64_t>(
+            reflection->GetInt32(message, field.field));
+        return true;
+      case FieldDescriptor::CPPTYPE_INT64:
+        *value = static_cast<uint64_t>(
+            reflection->GetInt64(message, field.field));
+        return true;
+      case FieldDescriptor::CPPTYPE_UINT32:
+        *value = static_cast<uint64_t>(
+            reflection->GetUInt32(message, field.field));
+        return true;
+      case FieldDescriptor::CPPTYPE_UINT64:
+        *value = reflection->GetUInt64(message, field.field);
+        return true;
+      case FieldDescriptor::CPPTYPE_DOUBLE:
+        *value = reflection->GetDouble(message, field.field);
+        return true;
+      case FieldDescriptor::CPPTYPE_FLOAT:
+        *value = static_cast<double>(
+            reflection->GetFloat(message, field.field));
+        return true;
+      case FieldDescriptor::CPPTYPE_BOOL:
+        *value = static_cast<uint64_t>(
+            reflection->GetBool(message, field.field));
+        return true;
+      case FieldDescriptor::CPPTYPE_ENUM:
+        *value = reflection->GetEnum(message, field.field)->name();
+        return true;
+      case FieldDescriptor::CPPTYPE_STRING:
+        *value = reflection->GetString(message, field.field);
+        return true;
+      default:
+        LOG(ERROR, "Unknown protobuf field type: " << field.type);
+        return false;
+    }
+}
+
+static void ExtractProtobufStats(const Message& message,
+    const ProtobufExtractor &extractor, int plan_index,
+    const std::string &stat_attr_name, StatWalker *stat_walker) {
+    const ProtobufExtractor::MessagePlan &plan(extractor.plan(plan_index));
+    const Reflection *reflection(message.GetReflection());
+    // At the top level the stat walker already has the tags
+    bool top_level(stat_attr_name.empty());
+    if (!top_level) {
+        DbHandler::AttribMap attribs;
+        StatWalker::TagMap tags;
+        for (size_t i = 0; i < plan.elements.size(); i++) {
+            const ProtobufExtractor::Field &field(plan.elements[i]);
+            DbHandler::Var value;
+            if (!reflection->HasField(message, field.field) ||
+                !GetFieldValue(message, reflection, field, &value)) {
+                continue;
+            }
+            PopulateAttribsAndTags(&attribs, &tags, field.is_tag,
+                field.field->name(), value);
+        }
+        stat_walker->Push(stat_attr_name, tags, attribs);
+    }
+    for (size_t i = 0; i < plan.messages.size(); i++) {
+        const ProtobufExtractor::Field &field(plan.messages[i]);
+        const std::string &fname(field.field->name());
+        if (field.field->is_repeated()) {
+            int size = reflection->FieldSize(message, field.field);
+            for (int j = 0; j < size; j++) {
+                ExtractProtobufStats(
+                    reflection->GetRepeatedMessage(message, field.field, j),
+                    extractor, field.plan, fname, stat_walker);
+            }
+        } else if (reflection->HasField(message, field.field)) {
+            ExtractProtobufStats(reflection->GetMessage(message, field.field),
+                extractor, field.plan, fname, stat_walker);
+        }
+    }
+    if (!top_level) {
+        stat_walker->Pop();
+    }
+}
+
+void ProcessProtobufMessage(const Message& message,
+    const ProtobufExtractor &extractor, const uint64_t &timestamp,
+    const boost::asio::ip::udp::endpoint &remote_endpoint,
+    StatWalker::StatTableInsertFn stat_db_callback) {
+    assert(message.GetDescriptor() == extractor.descriptor());
+    StatWalker::TagMap top_tags;
+    boost::system::error_code ec;
+    StatWalker::TagVal source;
+    source.val = remote_endpoint.address().to_string(ec);
+    if (ec) {
+        LOG(ERROR, "Remote endpoint: " << remote_endpoint <<
+            " address to string FAILED: " << ec);
+    }
+    top_tags.insert(make_pair("Source", source));
+    // At the top level only the tags are gathered
+    const ProtobufExtractor::MessagePlan &plan(extractor.plan(0));
+    const Reflection *reflection(message.GetReflection());
+    for (size_t i = 0; i < plan.elements.size(); i++) {
+        const ProtobufExtractor::Field &field(plan.elements[i]);
+        StatWalker::TagVal tvalue;
+        if (!field.is_tag || !reflection->HasField(message, field.field) ||
+            !GetFieldValue(message, reflection, field, &tvalue.val)) {
+            continue;
+        }
+        top_tags.insert(make_pair(field.field->name(), tvalue));
+    }
+    StatWalker stat_walker(stat_db_callback, timestamp,
+        message.GetTypeName(), top_tags);
+    ExtractProtobufStats(message, extractor, 0, std::string(), &stat_walker);
+}
+
 }  // namespace impl
 
 class ProtobufServer::ProtobufServerImpl {
@@ -462,8 +654,10 @@ private:
                 DeallocateBuffer(recv_buffer);
                 return;
             }
-            protobuf::impl::ProcessProtobufMessage(*message, timestamp,
-                remote_endpoint, stat_db_callback_);
+            boost::shared_ptr<const protobuf::impl::ProtobufExtractor>
+                extractor(reader_.GetExtractor(message->GetDescriptor()));
+            protobuf::impl::ProcessProtobufMessage(*message, *extractor,
+                timestamp, remote_endpoint, stat_db_callback_);
             const std::string &message_name(message->GetTypeName());
             msg_stats_.UpdateRx(remote_endpoint, message_name,
                 recv_buffer_size);
@@ -5,6 +5,9 @@
 #ifndef ANALYTICS_PROTOBUF_SERVER_IMPL_H_
 #define ANALYTICS_PROTOBUF_SERVER_IMPL_H_
 
+#include <map>
+#include <vector>
+#include <boost/shared_ptr.hpp>
 #include <tbb/mutex.h>
 
 #include <google/protobuf/descriptor.h>
@@ -16,6 +19,49 @@
 namespace protobuf {
 namespace impl {
 
+//
+// ProtobufExtractor
+//
+// Extraction plan for a message type, compiled from its descriptor. For the
+// message type and every message type reachable from it, including through
+// extensions, the plan lists the elemental fields that become stat
+// attributes, whether they are tags, and the message fields that are walked
+// into, so that the fields of each received message are not listed and their
+// telemetry options looked up by reflection.
+//
+class ProtobufExtractor {
+ public:
+    struct Field {
+        const ::google::protobuf::FieldDescriptor *field;
+        ::google::protobuf::FieldDescriptor::CppType type;
+        bool is_tag;
+        // Index of the plan of the field message type, for message fields
+        int plan;
+    };
+    struct MessagePlan {
+        // Sorted by field number, like Reflection::ListFields
+        std::vector<Field> elements;
+        std::vector<Field> messages;
+    };
+
+    explicit ProtobufExtractor(const ::google::protobuf::Descriptor *mdesc);
+    const ::google::protobuf::Descriptor *descriptor() const {
+        return descriptor_;
+    }
+    // Plan of the top level message type is at index 0
+    const MessagePlan &plan(int index) const { return plans_[index]; }
+    size_t plan_count() const { return plans_.size(); }
+
+ private:
+    typedef std::map<const ::google::protobuf::Descriptor *, int> PlanIndexMap;
+
+    int Compile(const ::google::protobuf::Descriptor *mdesc,
+        PlanIndexMap *indexes);
+
+    const ::google::protobuf::Descriptor *descriptor_;
+    std::vector<MessagePlan> plans_;
+};
+
 class ProtobufReader {
  public:
     typedef boost::function<void(
@@ -25,6 +71,12 @@ class ProtobufReader {
     virtual bool ParseSelfDescribingMessage(const uint8_t *data, size_t size,
         uint64_t *timestamp, ::google::protobuf::Message **msg,
         ParseFailureCallback cb);
+    // Returns the extraction plan of the message type, which is compiled
+    // for the first message of the type and then reused. Plans are compiled
+    // again once new files are added to the descriptor pool, since these
+    // can extend the message types.
+    boost::shared_ptr<const ProtobufExtractor> GetExtractor(
+        const ::google::protobuf::Descriptor *mdesc);
 
  protected:
     virtual const ::google::protobuf::Message* GetPrototype(
@@ -32,10 +84,13 @@ class ProtobufReader {
 
  private:
     friend class ProtobufReaderTest;
+    typedef std::map<const ::google::protobuf::Descriptor *,
+        boost::shared_ptr<const ProtobufExtractor> > ExtractorMap;
 
     tbb::mutex mutex_;
     ::google::protobuf::DescriptorPool dpool_;
     ::google::protobuf::DynamicMessageFactory dmf_;
+    ExtractorMap extractors_;
 };
 
 void ProcessProtobufMessage(const ::google::protobuf::Message& message,
@@ -43,6 +98,13 @@ void ProcessProtobufMessage(const ::google::protobuf::Message& message,
     const boost::asio::ip::udp::endpoint &remote_endpoint,
     StatWalker::StatTableInsertFn stat_db_callback);
 
+// Same as above, using the extraction plan of the message type instead of
+// reflecting over the fields of the message
+void ProcessProtobufMessage(const ::google::protobuf::Message& message,
+    const ProtobufExtractor &extractor, const uint64_t &timestamp,
+    const boost::asio::ip::udp::endpoint &remote_endpoint,
+    StatWalker::StatTableInsertFn stat_db_callback);
+
 void ProtobufLibraryLog(::google::protobuf::LogLevel level,
     const char* filename, int line, const std::string& message);
 
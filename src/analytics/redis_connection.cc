@@ -318,6 +318,45 @@ bool RedisAsyncConnection::RedisAsyncArgCmd(void *rpi,
     return status;
 }
 
+size_t RedisAsyncConnection::RedisAsyncArgCmds(void *rpi,
+        const vector<vector<string> > &cmds) {
+
+    tbb::mutex::scoped_lock lock(mutex_);
+
+    if (state_ != REDIS_ASYNC_CONNECTION_CONNECTED) {
+        callDisconnected_ += cmds.size();
+        return 0;
+    }
+
+    size_t queued = 0;
+    vector<const char *> argv;
+    vector<size_t> argvlen;
+    for (vector<vector<string> >::const_iterator it = cmds.begin();
+         it != cmds.end(); it++) {
+        const vector<string> &args(*it);
+        argv.clear();
+        argvlen.clear();
+        for (uint i=0; i < args.size(); i++) {
+            argv.push_back(args[i].c_str());
+            argvlen.push_back(args[i].size());
+        }
+        int ret = redisAsyncCommandArgv(context_,
+                RedisAsyncConnection::RAC_AsyncCmdCallback,
+                rpi,
+                args.size(),
+                &argv[0],
+                &argvlen[0]);
+        if (REDIS_ERR == ret) {
+            LOG(INFO, "Could NOT apply " << args[0] << " to Redis : ");
+            callFailed_++;
+        } else {
+            queued++;
+            callSucceeded_++;
+        }
+    }
+    return queued;
+}
+
 
 bool RedisAsyncConnection::RedisAsyncCommand(void *rpi, const char *format, ...) {
     tbb::mutex::scoped_lock lock(mutex_);
@@ -56,6 +56,10 @@ public:
     bool SetClientAsyncCmdCb(ClientAsyncCmdCbFn cb_fn);
     bool RedisAsyncCommand(void *rpi, const char *format, ...);
     bool RedisAsyncArgCmd(void *rpi, const std::vector<std::string> &args);
+    // Pipelines the commands to redis under a single lock, and returns
+    // the number of commands that were queued
+    size_t RedisAsyncArgCmds(void *rpi,
+        const std::vector<std::vector<std::string> > &cmds);
     void RAC_StatUpdate(const redisReply *reply);
 
     static RAC_CbFnsMap& rac_cb_fns_map() {
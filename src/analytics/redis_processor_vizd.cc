@@ -26,24 +26,20 @@ using std::map;
 using std::make_pair;
 using boost::assign::list_of;
 
-bool
-RedisProcessorExec::UVEUpdate(RedisAsyncConnection * rac, RedisProcessorIf *rpi,
+void
+RedisProcessorExec::UVEUpdateArgs(const std::string &lua_scr,
                        const std::string &type, const std::string &attr,
                        const std::string &source, const std::string &node_type,
                        const std::string &module, 
                        const std::string &instance_id,
                        const std::string &key, const std::string &msg,
-                       int32_t seq, const std::string &agg,
-                       int64_t ts, unsigned int part,
-                       bool is_alarm) {
+                       int32_t seq, int64_t ts, unsigned int part,
+                       bool is_alarm, std::vector<std::string> *args) {
     
-    bool ret = false;
     size_t sep = key.find(":");
     string table = key.substr(0, sep);
     std::ostringstream seqstr;
     seqstr << seq;
-    std::ostringstream tsstr;
-    tsstr << "{\"ts\":" << ts << "}";
     const std::string table_index(is_alarm ? "ALARM_TABLE:" : "TABLE:");
     const std::string origin_index(is_alarm ? "ALARM_ORIGINS:" : "ORIGINS:");
     string ngen_inst = instance_id;
@@ -52,23 +48,55 @@ RedisProcessorExec::UVEUpdate(RedisAsyncConnection * rac, RedisProcessorIf *rpi,
         ngenstr << getpid();
         ngen_inst = ngenstr.str();
     }
-    {
-        string lua_scr(reinterpret_cast<char *>(uveupdate_lua), uveupdate_lua_len);
-        ret = rac->RedisAsyncArgCmd(rpi,
-            list_of(string("EVAL"))(lua_scr)("5")(
-                string("TYPES:") + source + ":" + node_type + ":" + module + ":" + instance_id)(
-                origin_index + key)(
-                table_index + table)(
-                string("UVES:") + source + ":" + node_type + ":" + module +
-                ":" + instance_id + ":" + type)(
-                string("VALUES:") + key + ":" + source + ":" + node_type + 
-                ":" + module + ":" + instance_id + ":" + type)(
-                source)(node_type)(module)(instance_id)(type)(attr)(key)
-                (seqstr.str())(msg)(integerToString(REDIS_DB_UVE))
-                (integerToString(part))(integerToString(is_alarm))(
-                ngen_inst));
+    *args = list_of(string("EVAL"))(lua_scr)("5")(
+        string("TYPES:") + source + ":" + node_type + ":" + module + ":" + instance_id)(
+        origin_index + key)(
+        table_index + table)(
+        string("UVES:") + source + ":" + node_type + ":" + module +
+        ":" + instance_id + ":" + type)(
+        string("VALUES:") + key + ":" + source + ":" + node_type + 
+        ":" + module + ":" + instance_id + ":" + type)(
+        source)(node_type)(module)(instance_id)(type)(attr)(key)
+        (seqstr.str())(msg)(integerToString(REDIS_DB_UVE))
+        (integerToString(part))(integerToString(is_alarm))(
+        ngen_inst).convert_to_container<std::vector<std::string> >();
+}
+
+bool
+RedisProcessorExec::UVEUpdate(RedisAsyncConnection * rac, RedisProcessorIf *rpi,
+                       const std::string &type, const std::string &attr,
+                       const std::string &source, const std::string &node_type,
+                       const std::string &module, 
+                       const std::string &instance_id,
+                       const std::string &key, const std::string &msg,
+                       int32_t seq, const std::string &agg,
+                       int64_t ts, unsigned int part,
+                       bool is_alarm) {
+    
+    string lua_scr(reinterpret_cast<char *>(uveupdate_lua), uveupdate_lua_len);
+    vector<string> args;
+    UVEUpdateArgs(lua_scr, type, attr, source, node_type, module, instance_id,
+        key, msg, seq, ts, part, is_alarm, &args);
+    return rac->RedisAsyncArgCmd(rpi, args);
+}
+
+size_t
+RedisProcessorExec::UVEUpdates(RedisAsyncConnection * rac, RedisProcessorIf *rpi,
+                       const std::string &source, const std::string &node_type,
+                       const std::string &module,
+                       const std::string &instance_id,
+                       const UVECoalescer::UVEUpdateList &updates) {
+
+    string lua_scr(reinterpret_cast<char *>(uveupdate_lua), uveupdate_lua_len);
+    vector<vector<string> > cmds(updates.size());
+    size_t idx = 0;
+    for (UVECoalescer::UVEUpdateList::const_iterator it = updates.begin();
+         it != updates.end(); it++, idx++) {
+        UVEUpdateArgs(lua_scr, it->type, it->attr, source, node_type, module,
+            instance_id, it->key, it->message, it->seq, it->ts, it->part,
+            it->is_alarm, &cmds[idx]);
     }
-    return ret;
+    return rac->RedisAsyncArgCmds(rpi, cmds);
 }
 
 bool
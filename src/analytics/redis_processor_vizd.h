@@ -11,6 +11,7 @@
 #include <map>
 #include <boost/function.hpp>
 #include "hiredis/hiredis.h"
+#include "uve_coalescer.h"
 
 class RedisAsyncConnection; 
 class RedisProcessorIf;
@@ -27,6 +28,14 @@ public:
                        int64_t ts, unsigned int part,
                        bool is_alarm);
 
+    // Pipelines the coalesced updates of a generator, and returns the
+    // number of updates that were queued
+    static size_t
+    UVEUpdates(RedisAsyncConnection * rac, RedisProcessorIf *rpi,
+            const std::string &source, const std::string &node_type,
+            const std::string &module, const std::string &instance_id,
+            const UVECoalescer::UVEUpdateList &updates);
+
     static bool
     UVEDelete(RedisAsyncConnection * rac, RedisProcessorIf *rpi,
             const std::string &type,
@@ -51,6 +60,16 @@ public:
     static bool
     FlushUVEs(const std::string & redis_ip, unsigned short redis_port,
             const std::string & redis_password);
+
+private:
+    static void
+    UVEUpdateArgs(const std::string &lua_scr,
+            const std::string &type, const std::string &attr,
+            const std::string &source, const std::string &node_type,
+            const std::string &module, const std::string &instance_id,
+            const std::string &key, const std::string &message,
+            int32_t seq, int64_t ts, unsigned int part, bool is_alarm,
+            std::vector<std::string> *args);
 };
 
 class RedisProcessorIf {
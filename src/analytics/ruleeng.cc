@@ -389,8 +389,8 @@ class DomStatVisitor : public boost::static_visitor<> {
 
     void GetResult(DbHandler::AttribMap& lattribs,
             map<string, pair<string, ptr_vector<ElemT> > >& lelem_map) {
-        lattribs = attribs;
-        lelem_map = elem_map;
+        lattribs.swap(attribs);
+        lelem_map.swap(elem_map);
     }
 };
 
@@ -416,7 +416,7 @@ class DomSelfVisitor : public boost::static_visitor<> {
 */
 static bool DomStatWalker(StatWalker& sw,
         const std::string& tstr,
-        ptr_vector<tuple<string,ElemT> > elem_chain) {
+        ptr_vector<tuple<string,ElemT> >& elem_chain) {
 
     pugi::xml_node object;
  
@@ -455,15 +455,15 @@ static bool DomStatWalker(StatWalker& sw,
             ptr_vector<ElemT> & elem_list = ei->second.second;
             string & tstr_sub(ei->second.first);
             for (size_t idx=0; idx<elem_list.size(); idx++) {
-                ptr_vector<tuple<string,ElemT> > elem_parent = elem_chain;
-                elem_parent.push_back(new tuple<string,ElemT>(ei->first, elem_list[idx]));
+                elem_chain.push_back(new tuple<string,ElemT>(ei->first, elem_list[idx]));
                 // recursive invokation to process stats of child
                 // structs and lists that have the tags annotation
-                if (!DomStatWalker(sw, tstr_sub, elem_parent)) {
+                if (!DomStatWalker(sw, tstr_sub, elem_chain)) {
                     LOG(ERROR, __func__ << 
                       " Name: " << object.name() <<  " Node: " << node_name  <<
                       " Bad element " << ei->first);
                 }
+                elem_chain.pop_back();
             }
         }
         sw.Pop();
@@ -528,13 +528,12 @@ static bool DomTopStatWalker(const pugi::xml_node& object,
 
         // Process all elements the next level down for stats
         for (size_t idx=0; idx<elem_list.size(); idx++) {
-            ptr_vector<tuple<string, ElemT> > elem_chain = parent_chain; 
-            elem_chain.push_back(new tuple<string, ElemT>(node.name(), elem_list[idx]));
-            if (!DomStatWalker(sw, tstr, elem_chain)) {
+            parent_chain.push_back(new tuple<string, ElemT>(node.name(), elem_list[idx]));
+            if (!DomStatWalker(sw, tstr, parent_chain)) {
                 LOG(ERROR, __func__ << " Source: " << source <<
                   " Name: " << object.name() <<  " Node: " << node.name());
-                continue;
             }
+            parent_chain.pop_back();
         }
     } else {
         LOG(ERROR, __func__ << " Source: " << source <<
@@ -674,6 +673,10 @@ bool Ruleeng::handle_uve_publish(const pugi::xml_node& parent,
 
     object = object.child("data");
     object = object.first_child();
+    // The UVE attributes are published in their XML form, strip the
+    // identifiers from them. Other message types do not serialize the
+    // message DOM, so the walk is only done here.
+    remove_identifier(object);
 
     std::string barekey;
     const char *tempstr;
@@ -831,7 +834,6 @@ bool Ruleeng::rule_execute(const VizMsg *vmsgp, bool uveproc, DbHandler *db,
     const SandeshXMLMessage *sxmsg = 
         static_cast<const SandeshXMLMessage *>(vmsgp->msg);
     const pugi::xml_node &parent(sxmsg->GetMessageNode());
-    remove_identifier(parent);
 
     handle_object_log(parent, vmsgp, db, header, db_cb);
 
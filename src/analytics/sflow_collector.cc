@@ -12,7 +12,11 @@ SFlowCollector::SFlowCollector(EventManager* evm,
     : UdpServer(evm),
       db_handler_(db_handler),
       ip_address_(ip_address),
-      port_(port) {
+      port_(port),
+      num_packets_(0),
+      time_first_pkt_seen_(0),
+      time_last_pkt_seen_(0),
+      batch_timestamp_(0) {
 }
 
 SFlowCollector::~SFlowCollector() {
@@ -35,6 +39,12 @@ void SFlowCollector::Shutdown() {
     }
 }
 
+// All the datagrams read together are stamped with the same receive time,
+// so that the generator can insert their samples together
+void SFlowCollector::OnReceiveBatch(std::size_t count) {
+    batch_timestamp_ = UTCTimestampUsec();
+}
+
 void SFlowCollector::HandleReceive(const boost::asio::const_buffer& buffer,
             boost::asio::ip::udp::endpoint remote_endpoint,
             size_t bytes_transferred,
@@ -51,7 +61,7 @@ void SFlowCollector::ProcessSFlowPacket(const boost::asio::const_buffer& buffer,
                                         size_t length, 
                                         const std::string& generator_ip) {
    num_packets_++;
-   time_last_pkt_seen_ = UTCTimestampUsec();
+   time_last_pkt_seen_ = batch_timestamp_;
    if (!time_first_pkt_seen_) {
        time_first_pkt_seen_ = time_last_pkt_seen_;
    }
@@ -16,6 +16,9 @@ class SFlowGenerator;
 
 class SFlowCollector : public UdpServer {
 public:
+    // Number of sFlow datagrams read from the socket in one system call
+    static const int kReceiveBatchSize = 32;
+
     explicit SFlowCollector(EventManager* evm,
                             DbHandlerPtr db_handler,
                             const std::string& ip_address, int port);
@@ -23,6 +26,10 @@ public:
     virtual void Start();
     virtual void Shutdown();
 
+protected:
+    virtual int receive_batch_size() const { return kReceiveBatchSize; }
+    virtual void OnReceiveBatch(std::size_t count);
+
 private:
     void HandleReceive(const boost::asio::const_buffer& buffer,
                        boost::asio::ip::udp::endpoint remote_endpoint,
@@ -42,7 +49,9 @@ private:
     uint64_t num_packets_;
     uint64_t time_first_pkt_seen_;
     uint64_t time_last_pkt_seen_;
-    
+    // Receive time of the datagrams read in the current batch
+    uint64_t batch_timestamp_;
+
     DISALLOW_COPY_AND_ASSIGN(SFlowCollector);
 };
 
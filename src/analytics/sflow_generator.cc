@@ -27,7 +27,16 @@ SFlowGenerator::SFlowGenerator(const std::string& ip_address,
       sflow_pkt_queue_(TaskScheduler::GetInstance()->GetTaskId(
             "SFlowGenerator:"+ip_address), 0,
             boost::bind(&SFlowGenerator::ProcessSFlowPacket, this, _1)),
-      trace_buf_(SandeshTraceBufferCreate("SFlowGenerator:"+ip_address, 1000)) {
+      trace_buf_(SandeshTraceBufferCreate("SFlowGenerator:"+ip_address, 1000)),
+      num_packets_(0),
+      num_invalid_packets_(0),
+      time_first_pkt_seen_(0),
+      time_last_pkt_seen_(0),
+      flow_samples_(),
+      flow_samples_timestamp_(0),
+      flow_type_(g_uflow_constants.FlowTypeName.find(FlowType::SFLOW)->second) {
+    sflow_pkt_queue_.SetExitCallback(
+        boost::bind(&SFlowGenerator::ProcessSFlowPacketDone, this, _1));
 }
 
 SFlowGenerator::~SFlowGenerator() {
@@ -47,55 +56,61 @@ bool SFlowGenerator::EnqueueSFlowPacket(const boost::asio::const_buffer& buffer,
 
 bool SFlowGenerator::ProcessSFlowPacket(
         boost::shared_ptr<SFlowQueueEntry> qentry) {
+    if (qentry->timestamp != flow_samples_timestamp_) {
+        InsertFlowSamples();
+        flow_samples_timestamp_ = qentry->timestamp;
+    }
     SFlowParser parser(boost::asio::buffer_cast<const uint8_t* const>(
                        qentry->buffer), qentry->length, trace_buf_);
-    SFlowData sflow_data;
-    if (parser.Parse(&sflow_data) < 0) {
+    SFlowHeader sflow_header;
+    size_t nsamples = flow_samples_.size();
+    if (parser.Parse(&sflow_header, boost::bind(
+            &SFlowGenerator::AddFlowSample, this, _1, _2)) < 0) {
+        // Drop the samples of the invalid datagram
+        flow_samples_.resize(nsamples);
+        num_invalid_packets_++;
         LOG(ERROR, "Error parsing sFlow packet");
         return false;
     }
     std::stringstream sflow_data_str;
-    sflow_data_str << "sFlow Packet: " << sflow_data;
+    sflow_data_str << "sFlow Packet: " << std::endl << sflow_header
+        << "Num of Flow Samples with IP data: "
+        << flow_samples_.size() - nsamples;
     SFLOW_PACKET_TRACE(trace_buf_, sflow_data_str.str());
+    return true;
+}
 
-    UFlowData flow_data;
-    flow_data.set_name(ip_address_);
-    std::string flow_type =
-        g_uflow_constants.FlowTypeName.find(FlowType::SFLOW)->second;
-    boost::ptr_vector<SFlowFlowSample>::const_iterator fs_it =
-        sflow_data.flow_samples.begin();
-    std::vector<UFlowSample> samples;
-    for (; fs_it != sflow_data.flow_samples.end(); ++fs_it) {
-        const SFlowFlowSample& flow_sample = *fs_it;
-        UFlowSample sample;
-        sample.set_pifindex(flow_sample.sourceid_index);
-        boost::ptr_vector<SFlowFlowRecord>::const_iterator fr_it =
-            flow_sample.flow_records.begin();
-        for (; fr_it != flow_sample.flow_records.end(); ++fr_it) {
-            switch(fr_it->type) {
-            case SFLOW_FLOW_HEADER: {
-                SFlowFlowHeader& record = (SFlowFlowHeader&)*fr_it;
-                if (record.is_ip_data_set) {
-                    SFlowFlowIpData& ip_data = record.decoded_ip_data;
-                    sample.sip = ip_data.src_ip.to_string();
-                    sample.dip = ip_data.dst_ip.to_string();
-                    sample.sport = ip_data.src_port;
-                    sample.dport = ip_data.dst_port;
-                    sample.protocol = ip_data.protocol;
-                    sample.flowtype = flow_type;
-                    samples.push_back(sample);
-                }
-                break;
-            }
-            default:
-                break;
-            }
-        }
+void SFlowGenerator::AddFlowSample(const SFlowFlowSample& flow_sample,
+                                   const SFlowFlowHeader& flow_header) {
+    if (!flow_header.is_ip_data_set) {
+        return;
     }
-    if (samples.size()) {
-        flow_data.set_flow(samples);
-        db_handler_->UnderlayFlowSampleInsert(flow_data, qentry->timestamp,
-            GenDb::GenDbIf::DbAddColumnCb());
+    const SFlowFlowIpData& ip_data = flow_header.decoded_ip_data;
+    flow_samples_.push_back(UFlowSample());
+    UFlowSample& sample = flow_samples_.back();
+    sample.set_pifindex(flow_sample.sourceid_index);
+    sample.sip = ip_data.src_ip.to_string();
+    sample.dip = ip_data.dst_ip.to_string();
+    sample.sport = ip_data.src_port;
+    sample.dport = ip_data.dst_port;
+    sample.protocol = ip_data.protocol;
+    sample.flowtype = flow_type_;
+}
+
+void SFlowGenerator::InsertFlowSamples() {
+    if (flow_samples_.empty()) {
+        return;
     }
-    return true;
+    UFlowData flow_data;
+    flow_data.set_name(ip_address_);
+    flow_data.flow.swap(flow_samples_);
+    flow_data.__isset.flow = true;
+    db_handler_->UnderlayFlowSampleInsert(flow_data, flow_samples_timestamp_,
+        GenDb::GenDbIf::DbAddColumnCb());
+}
+
+// Samples left from the last datagrams of this run are inserted before
+// the queue task exits
+void SFlowGenerator::ProcessSFlowPacketDone(bool done) {
+    InsertFlowSamples();
 }
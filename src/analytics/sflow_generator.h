@@ -8,8 +8,11 @@
 #include "base/queue_task.h"
 
 #include "db_handler.h"
+#include "uflow_types.h"
 
 class SFlowCollector;
+struct SFlowFlowSample;
+struct SFlowFlowHeader;
 
 struct SFlowQueueEntry {
     SFlowQueueEntry(boost::asio::const_buffer buf, size_t len,
@@ -32,6 +35,10 @@ public:
                             size_t length, uint64_t timestamp);
 private:
     bool ProcessSFlowPacket(boost::shared_ptr<SFlowQueueEntry>);
+    void AddFlowSample(const SFlowFlowSample& flow_sample,
+                       const SFlowFlowHeader& flow_header);
+    void InsertFlowSamples();
+    void ProcessSFlowPacketDone(bool done);
 
     typedef WorkQueue<boost::shared_ptr<SFlowQueueEntry> > SFlowPktQueue;
     
@@ -44,6 +51,11 @@ private:
     uint64_t num_invalid_packets_;
     uint64_t time_first_pkt_seen_;
     uint64_t time_last_pkt_seen_;
+    // Samples of the datagrams with the same receive time, inserted in the
+    // database together
+    std::vector<UFlowSample> flow_samples_;
+    uint64_t flow_samples_timestamp_;
+    std::string flow_type_;
 
     DISALLOW_COPY_AND_ASSIGN(SFlowGenerator);
 };
@@ -36,28 +36,42 @@ SFlowParser::SFlowParser(const uint8_t* buf, size_t len,
                          SandeshTraceBufferPtr trace_buf)
     : raw_datagram_(buf), length_(len), end_ptr_(buf+len),
       decode_ptr_(reinterpret_cast<const uint32_t*>(buf)),
-      trace_buf_(trace_buf) {
+      trace_buf_(trace_buf),
+      flow_header_cb_() {
 }
 
 SFlowParser::~SFlowParser() {
 }
 
 int SFlowParser::Parse(SFlowData* const sflow_data) {
-    if (ReadSFlowHeader(sflow_data->sflow_header) < 0) {
+    return ParseSamples(sflow_data->sflow_header, &sflow_data->flow_samples);
+}
+
+int SFlowParser::Parse(SFlowHeader* const sflow_header,
+                       FlowHeaderCb flow_header_cb) {
+    flow_header_cb_ = flow_header_cb;
+    return ParseSamples(*sflow_header, NULL);
+}
+
+// Flow samples are added to flow_samples, or passed to flow_header_cb_
+// record by record if flow_samples is NULL
+int SFlowParser::ParseSamples(SFlowHeader& sflow_header,
+        boost::ptr_vector<SFlowFlowSample>* flow_samples) {
+    if (ReadSFlowHeader(sflow_header) < 0) {
         SFLOW_PACKET_TRACE(trace_buf_, "Failed to parse sFlow header");
         return -1;
     }
-    if (sflow_data->sflow_header.version != 5) {
+    if (sflow_header.version != 5) {
         // unsupported version. Don't proceed futher.
         SFLOW_PACKET_TRACE(trace_buf_, "Unsupported sFlow version: " +
-            integerToString(sflow_data->sflow_header.version));
+            integerToString(sflow_header.version));
         return -1;
     }
-    for (uint32_t nsamples = 0; nsamples < sflow_data->sflow_header.nsamples;
+    for (uint32_t nsamples = 0; nsamples < sflow_header.nsamples;
          nsamples++) {
         if (!CanReadBytes(SFlowSample::kMinSampleLen)) {
             SFLOW_PACKET_TRACE(trace_buf_, "Invalid sample count [" +
-                integerToString(sflow_data->sflow_header.nsamples) +
+                integerToString(sflow_header.nsamples) +
                 "] in sFlow header (or) Tuncated sFlow packet");
             return -1;
         }
@@ -76,24 +90,23 @@ int SFlowParser::Parse(SFlowData* const sflow_data) {
         // read exactly the sample_len bytes.
         const uint32_t* const sample_start = decode_ptr_;
         switch(sample_type) {
-        case SFLOW_FLOW_SAMPLE: {
-            SFlowFlowSample* flow_sample(new SFlowFlowSample(
-                                SFLOW_FLOW_SAMPLE, sample_len));
-            if (ReadSFlowFlowSample(*flow_sample) < 0) {
-                delete flow_sample;
-                return -1;
-            }
-            sflow_data->flow_samples.push_back(flow_sample);
-            break;
-        }
+        case SFLOW_FLOW_SAMPLE:
         case SFLOW_FLOW_SAMPLE_EXPANDED: {
+            if (flow_samples == NULL) {
+                SFlowFlowSample flow_sample(
+                    static_cast<SFlowSampleType>(sample_type), sample_len);
+                if (ReadSFlowFlowSample(flow_sample) < 0) {
+                    return -1;
+                }
+                break;
+            }
             SFlowFlowSample* flow_sample(new SFlowFlowSample(
-                                SFLOW_FLOW_SAMPLE_EXPANDED, sample_len));
+                static_cast<SFlowSampleType>(sample_type), sample_len));
             if (ReadSFlowFlowSample(*flow_sample) < 0) {
                 delete flow_sample;
                 return -1;
             }
-            sflow_data->flow_samples.push_back(flow_sample);
+            flow_samples->push_back(flow_sample);
             break;
         }
         default:
@@ -196,6 +209,14 @@ int SFlowParser::ReadSFlowFlowSample(SFlowFlowSample& flow_sample) {
         const uint32_t* const flow_record_start = decode_ptr_;
         switch(flow_record_type) {
         case SFLOW_FLOW_HEADER: {
+            if (!flow_header_cb_.empty()) {
+                SFlowFlowHeader flow_header(flow_record_len);
+                if (ReadSFlowFlowHeader(flow_header) < 0) {
+                    return -1;
+                }
+                flow_header_cb_(flow_sample, flow_header);
+                break;
+            }
             int ret = 0;
             SFlowFlowHeader* flow_header(new SFlowFlowHeader(flow_record_len));
             if ((ret = ReadSFlowFlowHeader(*flow_header)) < 0) {
@@ -5,6 +5,7 @@
 #ifndef __SFLOW_PARSER_H__
 #define __SFLOW_PARSER_H__
 
+#include <boost/function.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
 
 #include <sandesh/sandesh_trace.h>
@@ -40,11 +41,22 @@ std::ostream& operator<<(std::ostream& out, const SFlowData& sflow_data) {
 
 class SFlowParser {
 public:
+    // Called for each flow header record of a flow sample. The flow sample
+    // (without its flow_records) and the flow header are on the stack and
+    // are valid only during the call; the packet header points into the
+    // datagram.
+    typedef boost::function<void (const SFlowFlowSample&,
+                                  const SFlowFlowHeader&)> FlowHeaderCb;
+
     explicit SFlowParser(const uint8_t* buf, size_t len,
                          SandeshTraceBufferPtr trace_buf);
     ~SFlowParser();
     int Parse(SFlowData* const sflow_data);
+    // Decodes the datagram in place, without building SFlowData
+    int Parse(SFlowHeader* const sflow_header, FlowHeaderCb flow_header_cb);
 private:
+    int ParseSamples(SFlowHeader& sflow_header,
+                     boost::ptr_vector<SFlowFlowSample>* flow_samples);
     int ReadSFlowHeader(SFlowHeader& sflow_header);
     int ReadSFlowFlowSample(SFlowFlowSample& flow_sample);
     int ReadSFlowFlowHeader(SFlowFlowHeader& flow_header);
@@ -75,6 +87,7 @@ private:
     const uint8_t* const end_ptr_;
     const uint32_t* decode_ptr_;
     SandeshTraceBufferPtr trace_buf_;
+    FlowHeaderCb flow_header_cb_;
     
     DISALLOW_COPY_AND_ASSIGN(SFlowParser);
 };
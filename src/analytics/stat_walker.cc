@@ -9,28 +9,38 @@ using std::string;
 using std::vector;
 using std::make_pair;
 
+StatWalker::StatWalker(StatTableInsertFn fn, const uint64_t &timestamp,
+        const std::string& statName, const TagMap& tags) :
+        timestamp_(timestamp),
+        stat_name_(statName),
+        fn_(fn) {
+    for (TagMap::const_iterator ti = tags.begin();
+            ti != tags.end(); ti++) {
+        FillTag(&top_attribs_tag_, &(*ti));
+    }
+}
+
 void
 StatWalker::Push(const std::string& name,
         const TagMap& tags,
         const DbHandler::AttribMap& attribs) {
 
-    string prename("");
-    for (vector<StatNode>::const_iterator ni = nodes_.begin();
-            ni != nodes_.end(); ni++) {
-        const StatNode& ancestor = *ni;
-        if (!prename.empty()) {
-            prename.append(".");
-        }
-        prename.append(ancestor.name);
-    }
-
-    StatNode sn;
-    sn.name = name;
-
-    if (!prename.empty()) {
-        prename.append(".");
+    nodes_.push_back(StatNode());
+    StatNode& sn = nodes_.back();
+    const StatNode* parent = (nodes_.size() > 1) ?
+        &nodes_[nodes_.size() - 2] : NULL;
+
+    // The parent's fully-qualified name and aggregated tags are the
+    // starting point for this node
+    if (parent) {
+        sn.name = parent->name;
+        sn.name.append(".");
+        sn.attribs_tag = parent->attribs_tag;
+    } else {
+        sn.attribs_tag = top_attribs_tag_;
     }
-    prename.append(sn.name);
+    sn.name.append(name);
+    const string& prename(sn.name);
 
     // For both tag names and attribute names, we need to convert
     // from local name to fully-qualified name
@@ -42,7 +52,8 @@ StatWalker::Push(const std::string& name,
         tname = prename + "." + ti->first;
 
         // For prefixes, the tag prefix name is already fully-qualified
-        sn.tags.insert(make_pair(tname, ti->second));
+        std::pair<const std::string, TagVal> tag(tname, ti->second);
+        FillTag(&sn.attribs_tag, &tag);
     }
     for (DbHandler::AttribMap::const_iterator ai = attribs.begin();
             ai != attribs.end(); ai++) {
@@ -52,7 +63,6 @@ StatWalker::Push(const std::string& name,
         aname = prename + "." + ai->first;
         sn.attribs.insert(make_pair(aname, ai->second));
     }
-    nodes_.push_back(sn);
 }
 
 void
@@ -96,29 +106,10 @@ StatWalker::FillTag(DbHandler::TagMap *attribs_tag,
 void
 StatWalker::Pop(void) {
     VIZD_ASSERT(!nodes_.empty());
-    DbHandler::AttribMap attribs = nodes_.back().attribs;
-    DbHandler::TagMap attribs_tag;
-
-    for (TagMap::const_iterator ti = top_tags_.begin();
-            ti != top_tags_.end(); ti++) {
-        FillTag(&attribs_tag, &(*ti));
-    }
-    
-    string prename("");
-    for (vector<StatNode>::const_iterator ni = nodes_.begin();
-            ni != nodes_.end(); ni++) {
-
-        const StatNode& ancestor = *ni;
-        if (!prename.empty()) {
-            prename.append(".");
-        }
-        prename.append(ancestor.name);
-
-        for (TagMap::const_iterator ti = ancestor.tags.begin();
-                ti != ancestor.tags.end(); ti++) {
-            FillTag(&attribs_tag, &(*ti));
-        }
-    }
+    StatNode& sn = nodes_.back();
+    DbHandler::AttribMap attribs;
+    attribs.swap(sn.attribs);
+    const DbHandler::TagMap& attribs_tag(sn.attribs_tag);
 
     // Take the final tags and also insert them as attribs
     // We may get duplicates ; the last value read will get used
@@ -127,7 +118,7 @@ StatWalker::Pop(void) {
         attribs.insert(make_pair(fi->first, fi->second.first));
         attribs.insert(fi->second.second.begin(), fi->second.second.end());
     }
-    fn_(timestamp_, stat_name_, prename, attribs_tag, attribs);
+    fn_(timestamp_, stat_name_, sn.name, attribs_tag, attribs);
     nodes_.pop_back();
 }
 
@@ -46,17 +46,16 @@ public:
     void Pop(void);
 
     StatWalker(StatTableInsertFn fn, const uint64_t &timestamp,
-               const std::string& statName, const TagMap& tags) :
-            timestamp_(timestamp),
-            stat_name_(statName),
-            fn_(fn),
-            top_tags_(tags)  {}
+               const std::string& statName, const TagMap& tags);
     ~StatWalker();
 private:
     struct StatNode {
+        // Fully-qualified name of this node
         std::string name;
-        TagMap tags;
         DbHandler::AttribMap attribs;
+        // Tags of this node and all its ancestors, aggregated when
+        // the node is pushed so that they are not rebuilt per sample
+        DbHandler::TagMap attribs_tag;
     };
 
     // Utility function for aggregating StatWalker::TagMap into DbHandler::TagMap
@@ -66,7 +65,7 @@ private:
     const uint64_t timestamp_;
     const std::string stat_name_;
     const StatTableInsertFn fn_;
-    const TagMap top_tags_;
+    DbHandler::TagMap top_attribs_tag_;
     std::vector<StatNode> nodes_;
 };
 
@@ -7,6 +7,7 @@
 
 #include <database/cassandra/cql/cql_if.h>
 #include <database/gendb_if.h>
+#include <database/gendb_col_builder.h>
 
 class CqlIfMock : public cass::cql::CqlIf {
  public:
@@ -22,6 +23,12 @@ class CqlIfMock : public cass::cql::CqlIf {
         return Db_AddColumnProxy(cl.get());
     }
 
+    bool Db_AddColumn(const GenDb::ColListBuilder &builder,
+        GenDb::DbConsistency::type dconsistency,
+        GenDb::GenDbIf::DbAddColumnCb db_cb) {
+        return Db_AddColumnProxy(builder.Build().get());
+    }
+
     bool Db_AddColumnSync(std::auto_ptr<GenDb::ColList> cl,
         GenDb::DbConsistency::type dconsistency) {
         return Db_AddColumnSyncProxy(cl.get());
@@ -41,6 +48,9 @@ class CqlIfMock : public cass::cql::CqlIf {
     MOCK_METHOD5(Db_GetRowAsync, bool(const std::string& cfname,
         const GenDb::DbDataValueVec& rowkey, const GenDb::ColumnNameRange &crange,
         GenDb::DbConsistency::type dconsistency, DbGetRowCb cb));
+    MOCK_METHOD3(Db_GetMultiRow, bool(GenDb::ColListVec *ret,
+        const std::string& cfname,
+        const std::vector<GenDb::DbDataValueVec>& key));
 };
 
 #endif // ANALYTICS_TEST_CQL_IF_MOCK_H_
@@ -2,12 +2,15 @@
  * Copyright (c) 2013 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <new>
+#include <cstdlib>
 #include <pthread.h>
 
 #include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/assign/ptr_list_of.hpp>
 #include <boost/uuid/uuid.hpp>
+#include <tbb/atomic.h>
 
 #include <testing/gunit.h>
 #include <base/logging.h>
@@ -38,6 +41,51 @@ using namespace GenDb;
 
 TtlMap ttl_map = g_viz_constants.TtlValuesDefault;
 
+// Count heap allocations made by the code under test
+static tbb::atomic<uint64_t> num_allocs;
+
+void *operator new(std::size_t size) throw(std::bad_alloc) {
+    num_allocs++;
+    void *ptr(malloc(size ? size : 1));
+    if (ptr == NULL) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) throw() {
+    free(ptr);
+}
+
+// Database interface which consumes the column lists in place, without
+// converting them, so that benchmarks measure only the DbHandler side
+class CqlIfNullMock : public CqlIfMock {
+ public:
+    CqlIfNullMock() :
+        inserts_(0),
+        bytes_(0) {
+    }
+
+    bool Db_AddColumn(std::auto_ptr<GenDb::ColList> cl,
+        GenDb::DbConsistency::type dconsistency,
+        GenDb::GenDbIf::DbAddColumnCb db_cb) {
+        inserts_++;
+        bytes_ += cl->GetSize();
+        return true;
+    }
+
+    bool Db_AddColumn(const GenDb::ColListBuilder &builder,
+        GenDb::DbConsistency::type dconsistency,
+        GenDb::GenDbIf::DbAddColumnCb db_cb) {
+        inserts_++;
+        bytes_ += builder.GetSize();
+        return true;
+    }
+
+    uint64_t inserts_;
+    uint64_t bytes_;
+};
+
 struct DbHandlerCacheParam {
         uint32_t field_cache_t2_;
         std::set<std::string> field_cache_set_[2];
@@ -54,6 +102,12 @@ public:
         db_handler_(new DbHandler(dbif_mock_, ttl_map)) {
     }
 
+    explicit DbHandlerTest(CqlIfMock *dbif_mock) :
+        builder_(SandeshXMLMessageTestBuilder::GetInstance()),
+        dbif_mock_(dbif_mock),
+        db_handler_(new DbHandler(dbif_mock_, ttl_map)) {
+    }
+
     ~DbHandlerTest() {
     }
 
@@ -72,19 +126,23 @@ public:
     }
 
     struct DbHandlerCacheParam GetDbHandlerCacheParam() {
-        db_handler_cache_param_.field_cache_t2_ = DbHandler::field_cache_t2_;
-        db_handler_cache_param_.field_cache_set_[0] = DbHandler::field_cache_set_[0];
-        db_handler_cache_param_.field_cache_set_[1] = DbHandler::field_cache_set_[1];
-        db_handler_cache_param_.field_cache_old_t2_ = DbHandler::field_cache_old_t2_;
-        db_handler_cache_param_.old_t2_index_ = DbHandler::old_t2_index_;
-        db_handler_cache_param_.new_t2_index_ = DbHandler::new_t2_index_;
+        const DbHandler::FieldCache &cache(DbHandler::field_cache_[
+            DbHandler::ShardIndex(kCacheTable, DbHandler::kFieldCacheShards)]);
+        db_handler_cache_param_.field_cache_t2_ = cache.t2;
+        db_handler_cache_param_.field_cache_set_[0] = cache.set[0];
+        db_handler_cache_param_.field_cache_set_[1] = cache.set[1];
+        db_handler_cache_param_.field_cache_old_t2_ = cache.old_t2;
+        db_handler_cache_param_.old_t2_index_ = cache.old_t2_index;
+        db_handler_cache_param_.new_t2_index_ = cache.new_t2_index;
         return db_handler_cache_param_;
     }
 
     bool WriteToCache(uint32_t temp_t2, std::string fc_entry) {
-        return db_handler()->CanRecordDataForT2(temp_t2, fc_entry);
+        return DbHandler::CanRecordDataForT2(kCacheTable, temp_t2, fc_entry);
     }
 
+    static const std::string kCacheTable;
+
 protected:
     class SandeshXMLMessageTest : public SandeshXMLMessage {
     public:
@@ -145,6 +203,13 @@ protected:
             boost::bind(&DbHandlerTest::DbAddColumnCbFn, this, _1));
     }
 
+    void StatTableInsert(uint64_t ts, const std::string& statName,
+        const std::string& statAttr, const DbHandler::TagMap &attribs_tag,
+        const DbHandler::AttribMap &attribs) {
+        db_handler()->StatTableInsert(ts, statName, statAttr, attribs_tag,
+            attribs, boost::bind(&DbHandlerTest::DbAddColumnCbFn, this, _1));
+    }
+
     void MessageIndexTableInsert(const std::string& cfname,
         const SandeshHeader& header, const std::string& message_type,
         const boost::uuids::uuid& unm, const std::string keyword) {
@@ -1040,6 +1105,120 @@ TEST_F(DbHandlerTest, FlowTableInsertTest) {
     }
 }
 
+// Measures flow sample ingest rate, from the parsed sandesh message to the
+// column lists handed to the database interface
+TEST_F(DbHandlerTest, DISABLED_FlowTableInsertPerf) {
+    init_vizd_tables();
+
+    SandeshHeader hdr;
+    hdr.set_Timestamp(UTCTimestampUsec());
+    hdr.set_Module("VizdTest");
+    hdr.set_Source("127.0.0.1");
+    const int kNumSamples(64);
+    const int kNumIterations(1000);
+    std::ostringstream xml_ss;
+    xml_ss << "<FlowLogDataObject type=\"sandesh\"><flowdata type=\"list\" identifier=\"1\"><list type=\"struct\" size=\"" << kNumSamples << "\">";
+    for (int i = 0; i < kNumSamples; i++) {
+        xml_ss << "<FlowLogData><flowuuid type=\"string\" identifier=\"1\">" << to_string(rgen_()) << "</flowuuid><direction_ing type=\"byte\" identifier=\"2\">1</direction_ing><sourcevn type=\"string\" identifier=\"3\">default-domain:contrail:vn0</sourcevn><sourceip type=\"ipaddr\" identifier=\"4\">10.10.10.1</sourceip><destvn type=\"string\" identifier=\"5\">default-domain:contrail:vn1</destvn><destip type=\"ipaddr\" identifier=\"6\">10.10.11.1</destip><protocol type=\"byte\" identifier=\"7\">17</protocol><sport type=\"i16\" identifier=\"8\">" << 1024 + i << "</sport><dport type=\"i16\" identifier=\"9\">8087</dport><vm type=\"string\" identifier=\"12\">04430130-6641-1b89-9287-39d71f351206</vm><reverse_uuid type=\"string\" identifier=\"16\">58745ee6-d616-4e59-b8f7-96e896587c9f</reverse_uuid><bytes type=\"i64\" identifier=\"23\">1024</bytes><packets type=\"i64\" identifier=\"24\">4</packets><diff_bytes type=\"i64\" identifier=\"26\">256</diff_bytes><diff_packets type=\"i64\" identifier=\"27\">1</diff_packets></FlowLogData>";
+    }
+    xml_ss << "</list></flowdata></FlowLogDataObject>";
+    std::string xmlmessage(xml_ss.str());
+    std::auto_ptr<SandeshXMLMessageTest> msg(
+        dynamic_cast<SandeshXMLMessageTest *>(
+            builder_->Create(reinterpret_cast<const uint8_t *>(
+                xmlmessage.c_str()), xmlmessage.size())));
+    msg->SetHeader(hdr);
+
+    EXPECT_CALL(*dbif_mock(), Db_AddColumnProxy(_))
+        .WillRepeatedly(Return(true));
+    uint64_t start_time(UTCTimestampUsec());
+    for (int i = 0; i < kNumIterations; i++) {
+        FlowTableInsert(msg->GetMessageNode(), msg->GetHeader());
+    }
+    uint64_t elapsed_time(UTCTimestampUsec() - start_time);
+    LOG(ERROR, "FlowTableInsert: " << kNumSamples * kNumIterations <<
+        " samples in " << elapsed_time << " usec, " <<
+        (kNumSamples * kNumIterations * 1000000.0) / elapsed_time <<
+        " samples/sec");
+}
+
+class DbHandlerIngestTest : public DbHandlerTest {
+public:
+    DbHandlerIngestTest() :
+        DbHandlerTest(new CqlIfNullMock) {
+    }
+
+    CqlIfNullMock *dbif_null_mock() {
+        return static_cast<CqlIfNullMock *>(dbif_mock());
+    }
+};
+
+// Measures message and statistics ingest, from the parsed sandesh message to
+// the column lists handed to the database interface, and the heap
+// allocations made per message
+TEST_F(DbHandlerIngestTest, DISABLED_MessageStatInsertPerf) {
+    SandeshHeader hdr;
+    hdr.set_Source("127.0.0.1");
+    hdr.set_Module("VizdTest");
+    hdr.set_InstanceId("Test");
+    hdr.set_NodeType("Test");
+    hdr.set_Timestamp(UTCTimestampUsec());
+    hdr.set_Type(SandeshType::SYSTEM);
+    std::string xmlmessage = "<SandeshAsyncTest2 type=\"sandesh\"><file type=\"string\" identifier=\"-32768\">src/analytics/test/viz_collector_test.cc</file><line type=\"i32\" identifier=\"-32767\">80</line><f1 type=\"struct\" identifier=\"1\"><SAT2_struct><f1 type=\"string\" identifier=\"1\">sat2string101</f1><f2 type=\"i32\" identifier=\"2\">101</f2></SAT2_struct></f1><f2 type=\"i32\" identifier=\"2\">101</f2></SandeshAsyncTest2>";
+    std::auto_ptr<SandeshXMLMessageTest> msg(
+        dynamic_cast<SandeshXMLMessageTest *>(
+            builder_->Create(reinterpret_cast<const uint8_t *>(
+                xmlmessage.c_str()), xmlmessage.size())));
+    msg->SetHeader(hdr);
+    VizMsg vmsg(msg.get(), rgen_());
+    const int kNumMessages(100000);
+
+    // Messages
+    MessageTableInsert(&vmsg);
+    uint64_t start_inserts(dbif_null_mock()->inserts_);
+    uint64_t start_allocs(num_allocs);
+    uint64_t start_time(UTCTimestampUsec());
+    for (int i = 0; i < kNumMessages; i++) {
+        MessageTableInsert(&vmsg);
+    }
+    uint64_t msg_time(UTCTimestampUsec() - start_time);
+    uint64_t msg_allocs(num_allocs - start_allocs);
+    uint64_t msg_inserts(dbif_null_mock()->inserts_ - start_inserts);
+
+    // Statistics
+    DbHandler::AttribMap amap;
+    DbHandler::TagMap tags;
+    DbHandler::AttribMap attribs;
+    DbHandler::Var pv(std::string("a6s23"));
+    tags.insert(std::make_pair("name", std::make_pair(pv, amap)));
+    attribs.insert(std::make_pair(std::string("name"), pv));
+    attribs.insert(std::make_pair(std::string("cpu_share"),
+        DbHandler::Var(12.5)));
+    attribs.insert(std::make_pair(std::string("used_sys_mem"),
+        DbHandler::Var(static_cast<uint64_t>(1024))));
+    start_inserts = dbif_null_mock()->inserts_;
+    start_allocs = num_allocs;
+    start_time = UTCTimestampUsec();
+    for (int i = 0; i < kNumMessages; i++) {
+        StatTableInsert(hdr.get_Timestamp(), "ComputeCpuState", "cpu_info",
+            tags, attribs);
+    }
+    uint64_t stat_time(UTCTimestampUsec() - start_time);
+    uint64_t stat_allocs(num_allocs - start_allocs);
+    uint64_t stat_inserts(dbif_null_mock()->inserts_ - start_inserts);
+
+    LOG(ERROR, "MessageTableInsert: " << kNumMessages << " messages, " <<
+        msg_inserts << " inserts in " << msg_time << " usec, " <<
+        (double)msg_allocs / kNumMessages << " allocations/message");
+    LOG(ERROR, "StatTableInsert: " << kNumMessages << " samples, " <<
+        stat_inserts << " inserts in " << stat_time << " usec, " <<
+        (double)stat_allocs / kNumMessages << " allocations/sample");
+    EXPECT_LT(0U, msg_inserts);
+    EXPECT_LT(0U, stat_inserts);
+}
+
+const std::string DbHandlerTest::kCacheTable("tabname");
+
 TEST_F(DbHandlerTest, CanRecordDataForT2Test) {
     uint32_t t1 = GetDbHandlerCacheParam().field_cache_t2_ + 2;
     std::string fc_entry("tabname:vn1");
@@ -1121,6 +1300,23 @@ TEST_F(DbHandlerTest, CanRecordDataForT2Test) {
     EXPECT_EQ(true, ret);
 }
 
+TEST_F(DbHandlerTest, FieldNamesCacheStatsTest) {
+    uint64_t hits, writes, entries;
+    DbHandler::GetFieldNamesCacheStats(&hits, &writes, &entries);
+    uint32_t t2 = GetDbHandlerCacheParam().field_cache_t2_ + 2;
+    EXPECT_TRUE(WriteToCache(t2, "tabname:vn10"));
+    EXPECT_FALSE(WriteToCache(t2, "tabname:vn10"));
+    EXPECT_FALSE(WriteToCache(t2, "tabname:vn10"));
+    EXPECT_TRUE(WriteToCache(t2, "tabname:vn11"));
+    uint64_t nhits, nwrites, nentries;
+    DbHandler::GetFieldNamesCacheStats(&nhits, &nwrites, &nentries);
+    EXPECT_EQ(hits + 2, nhits);
+    EXPECT_EQ(writes + 2, nwrites);
+    // Cache for the new T2 has only the new entries
+    EXPECT_EQ(2U, GetDbHandlerCacheParam().field_cache_set_[
+        GetDbHandlerCacheParam().new_t2_index_].size());
+}
+
 class FlowTableTest: public ::testing::Test {
 };
 
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "testing/gunit.h"
+#include "base/logging.h"
+#include "base/string_util.h"
+#include "base/time_util.h"
+
+#include "parser_util.h"
+#include "pattern_matcher.h"
+
+using std::string;
+using std::vector;
+
+class PatternMatcherTest : public ::testing::Test {
+protected:
+    static string Literal(const string &pattern) {
+        return PatternMatcher::RequiredLiteral(boost::regex(pattern));
+    }
+
+    void AddPattern(const string &pattern) {
+        regexps_.push_back(boost::regex(pattern));
+        matcher_.AddPattern(pattern, regexps_.back());
+    }
+
+    // Checks the matcher against searching for each pattern in turn
+    void ExpectMatch(const string &text) {
+        vector<size_t> expected;
+        for (size_t idx = 0; idx < regexps_.size(); ++idx) {
+            if (LineParser::SearchPattern(regexps_[idx], text))
+                expected.push_back(idx);
+        }
+        vector<size_t> matches;
+        matcher_.Match(text, &matches);
+        EXPECT_EQ(expected, matches) << text;
+    }
+
+    PatternMatcher matcher_;
+    vector<boost::regex> regexps_;
+};
+
+TEST_F(PatternMatcherTest, RequiredLiteral) {
+    EXPECT_EQ("error ", Literal("error [0-9]+"));
+    EXPECT_EQ("name: a7s", Literal("name: a7s[0-9]+"));
+    EXPECT_EQ("bo", Literal("bo.*f"));
+    EXPECT_EQ("b", Literal("a*b"));
+    EXPECT_EQ("colo", Literal("colou?r"));
+    EXPECT_EQ("yz", Literal("x{0,2}yz"));
+    EXPECT_EQ("baz", Literal("(foo|bar)baz"));
+    EXPECT_EQ("def", Literal("[abc]+def"));
+    EXPECT_EQ(".com", Literal("\\.com"));
+    EXPECT_EQ("ms", Literal("\\d+ms"));
+    EXPECT_EQ("word", Literal("\\bword\\b"));
+    EXPECT_EQ("cd", Literal("(ab)*cd"));
+    // No literal, so always searched for
+    EXPECT_EQ("", Literal("foo|bar"));
+    EXPECT_EQ("", Literal("(?i)abc"));
+    EXPECT_EQ("", Literal("\\x41b"));
+    EXPECT_EQ("", Literal("[0-9]+"));
+    EXPECT_EQ("", PatternMatcher::RequiredLiteral(
+        boost::regex("abc", boost::regex::icase)));
+}
+
+TEST_F(PatternMatcherTest, Match) {
+    AddPattern("error [0-9]+");
+    AddPattern("bo.*f");
+    AddPattern("foo|bar");
+    AddPattern("\"type\": \"int\"");
+    AddPattern("name: a7s[0-9]+");
+    AddPattern("[0-9]+ms");
+    AddPattern("error [a-z]+");
+    AddPattern("ab+c");
+    matcher_.Compile();
+
+    ExpectMatch("");
+    ExpectMatch("Its in the box of gems");
+    ExpectMatch("nothing to see here");
+    ExpectMatch("error 42 and error abc");
+    ExpectMatch("error ");
+    ExpectMatch("barn");
+    ExpectMatch("{\"box\": {\"count\": 2, \"type\": \"int\"}}");
+    ExpectMatch("name: a7s30 took 12ms");
+    ExpectMatch("abbbc abc ac");
+    ExpectMatch("name: a7sx");
+}
+
+// Patterns that share a literal, and literals that contain each other
+TEST_F(PatternMatcherTest, OverlappingLiterals) {
+    AddPattern("error [0-9]+");
+    AddPattern("error [a-z]+");
+    AddPattern("rror");
+    AddPattern("terror");
+    AddPattern("or");
+    matcher_.Compile();
+
+    ExpectMatch("terror 1");
+    ExpectMatch("error x");
+    ExpectMatch("errorx");
+    ExpectMatch("o r");
+}
+
+TEST_F(PatternMatcherTest, Recompile) {
+    AddPattern("foo");
+    matcher_.Compile();
+    ExpectMatch("foo bar");
+    AddPattern("bar");
+    matcher_.Compile();
+    ExpectMatch("foo bar");
+    ExpectMatch("bar");
+}
+
+// Syslog lines through the keyword tokenizer and 200 user defined
+// counters, matched by the PatternMatcher and by searching for each
+// pattern in turn.
+TEST_F(PatternMatcherTest, DISABLED_SyslogIngestPerf) {
+    static const int kCounters = 200;
+    static const int kLines = 50000;
+    for (int idx = 0; idx < kCounters; ++idx) {
+        if (idx % 20 == 0) {
+            AddPattern("[0-9]+ drops on port" + integerToString(idx));
+        } else {
+            AddPattern("counter" + integerToString(idx) + " error [0-9]+");
+        }
+    }
+    matcher_.Compile();
+
+    vector<string> lines;
+    for (int idx = 0; idx < kLines; ++idx) {
+        lines.push_back("<84>Feb 25 13:44:21 a3s45 sudo: pam_limits(sudo:"
+            "session): invalid line 'cassandra - nofile 100000' - skipped "
+            "10.84.9.45 d52eea70-e419-4246-98b9-292ae98d4d04 counter" +
+            integerToString(idx % 1000) + " error " + integerToString(idx));
+    }
+
+    uint64_t start = UTCTimestampUsec();
+    size_t words = 0;
+    for (vector<string>::const_iterator it = lines.begin();
+         it != lines.end(); ++it) {
+        LineParser::WordListType keywords;
+        LineParser::Parse(*it, &keywords);
+        words += keywords.size();
+    }
+    uint64_t parse_elapsed = UTCTimestampUsec() - start;
+
+    start = UTCTimestampUsec();
+    size_t sequential_matches = 0;
+    for (vector<string>::const_iterator it = lines.begin();
+         it != lines.end(); ++it) {
+        for (vector<boost::regex>::const_iterator rit = regexps_.begin();
+             rit != regexps_.end(); ++rit) {
+            if (LineParser::SearchPattern(*rit, *it))
+                sequential_matches++;
+        }
+    }
+    uint64_t sequential_elapsed = UTCTimestampUsec() - start;
+
+    start = UTCTimestampUsec();
+    size_t matches = 0;
+    vector<size_t> line_matches;
+    for (vector<string>::const_iterator it = lines.begin();
+         it != lines.end(); ++it) {
+        line_matches.clear();
+        matcher_.Match(*it, &line_matches);
+        matches += line_matches.size();
+    }
+    uint64_t matcher_elapsed = UTCTimestampUsec() - start;
+
+    EXPECT_EQ(sequential_matches, matches);
+    LOG(DEBUG, kLines << " lines: tokenize " << parse_elapsed << " usec (" <<
+        words << " keywords), " << kCounters << " counters sequential " <<
+        sequential_elapsed << " usec, matcher " << matcher_elapsed <<
+        " usec (" << matches << " matches)");
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -5,6 +5,8 @@
 #include <fstream>
 
 #include <boost/assign/list_of.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <testing/gunit.h>
 
@@ -17,6 +19,7 @@
 #include <sandesh/sandesh.h>
 
 #include <base/logging.h>
+#include <base/time_util.h>
 #include <base/test/task_test_util.h>
 #include <io/test/event_manager_test.h>
 #include <io/io_types.h>
@@ -1230,6 +1233,148 @@ TEST_F(ProtobufStatWalkerTest, AllTypes) {
     delete msg;
 }
 
+typedef void (*CreateAndSerializeFn)(uint8_t *output, size_t size,
+    int *serialized_size);
+
+// Creates the test message, wraps it in a SelfDescribingMessage and parses
+// it back with the reader
+static Message *CreateAndParseSelfDescribingMessage(
+    protobuf::impl::ProtobufReader *reader, const std::string &message_name,
+    const std::string &desc_file, CreateAndSerializeFn create_fn,
+    uint64_t *timestamp) {
+    boost::scoped_array<uint8_t> data(new uint8_t[kTestMessageBufferSize]);
+    int serialized_data_size(0);
+    create_fn(data.get(), kTestMessageBufferSize, &serialized_data_size);
+    boost::scoped_array<uint8_t> sdm_data(
+        new uint8_t[kSelfDescribingMessageBufferSize]);
+    int serialized_sdm_data_size(0);
+    CreateAndSerializeSelfDescribingMessage(message_name, sdm_data.get(),
+        kSelfDescribingMessageBufferSize, &serialized_sdm_data_size,
+        desc_file.c_str(), data.get(), (size_t) serialized_data_size);
+    Message *msg = NULL;
+    bool success = reader->ParseSelfDescribingMessage(sdm_data.get(),
+        serialized_sdm_data_size, timestamp, &msg, NULL);
+    EXPECT_TRUE(success);
+    return msg;
+}
+
+TEST_F(ProtobufStatWalkerTest, ExtractorAllTypes) {
+    StatCbTester ct(PopulateTestMessageAllTypesStatsInfo());
+    protobuf::impl::ProtobufReader reader;
+    uint64_t timestamp;
+    boost::scoped_ptr<Message> msg(CreateAndParseSelfDescribingMessage(
+        &reader, "TestMessageAllTypes", tm_desc_file_,
+        CreateAndSerializeTestMessageAllTypes, &timestamp));
+    ASSERT_TRUE(msg.get() != NULL);
+    boost::shared_ptr<const protobuf::impl::ProtobufExtractor> extractor(
+        reader.GetExtractor(msg->GetDescriptor()));
+    // TestMessageAllTypes and TestMessageAllTypesInner
+    EXPECT_EQ(2U, extractor->plan_count());
+
+    boost::system::error_code ec;
+    boost::asio::ip::address raddr(
+        boost::asio::ip::address::from_string("127.0.0.1", ec));
+    boost::asio::ip::udp::endpoint rep(raddr, 0);
+    protobuf::impl::ProcessProtobufMessage(*msg, *extractor, timestamp, rep,
+        boost::bind(&StatCbTester::Cb, &ct, _1, _2, _3, _4, _5));
+}
+
+TEST_F(ProtobufStatWalkerTest, ExtractorExtensionsInnerMessage) {
+    StatCbTester ct(PopulateTestMessageBaseStreamStatsInfo());
+    protobuf::impl::ProtobufReader reader;
+    uint64_t timestamp;
+    boost::scoped_ptr<Message> msg(CreateAndParseSelfDescribingMessage(
+        &reader, "TestMessageBaseStream", tme_desc_file_,
+        CreateAndSerializeTestMessageBaseStream, &timestamp));
+    ASSERT_TRUE(msg.get() != NULL);
+    boost::shared_ptr<const protobuf::impl::ProtobufExtractor> extractor(
+        reader.GetExtractor(msg->GetDescriptor()));
+
+    boost::system::error_code ec;
+    boost::asio::ip::address raddr(
+        boost::asio::ip::address::from_string("127.0.0.1", ec));
+    boost::asio::ip::udp::endpoint rep(raddr, 0);
+    protobuf::impl::ProcessProtobufMessage(*msg, *extractor, timestamp, rep,
+        boost::bind(&StatCbTester::Cb, &ct, _1, _2, _3, _4, _5));
+}
+
+TEST_F(ProtobufStatWalkerTest, ExtractorCache) {
+    protobuf::impl::ProtobufReader reader;
+    uint64_t timestamp;
+    boost::scoped_ptr<Message> msg(CreateAndParseSelfDescribingMessage(
+        &reader, "TestMessage", tm_desc_file_,
+        CreateAndSerializeTestMessage, &timestamp));
+    ASSERT_TRUE(msg.get() != NULL);
+    boost::shared_ptr<const protobuf::impl::ProtobufExtractor> extractor(
+        reader.GetExtractor(msg->GetDescriptor()));
+    EXPECT_EQ(msg->GetDescriptor(), extractor->descriptor());
+    // Compiled once per message type
+    EXPECT_EQ(extractor, reader.GetExtractor(msg->GetDescriptor()));
+    // Same files again
+    boost::scoped_ptr<Message> msg2(CreateAndParseSelfDescribingMessage(
+        &reader, "TestMessage", tm_desc_file_,
+        CreateAndSerializeTestMessage, &timestamp));
+    ASSERT_TRUE(msg2.get() != NULL);
+    EXPECT_EQ(extractor, reader.GetExtractor(msg2->GetDescriptor()));
+    // New file with extensions, compiled again
+    boost::scoped_ptr<Message> msg3(CreateAndParseSelfDescribingMessage(
+        &reader, "TestMessageBase", tme_desc_file_,
+        CreateAndSerializeTestMessageBase, &timestamp));
+    ASSERT_TRUE(msg3.get() != NULL);
+    EXPECT_NE(extractor, reader.GetExtractor(msg->GetDescriptor()));
+    // TestMessageBase and the extension message types
+    boost::shared_ptr<const protobuf::impl::ProtobufExtractor> base_extractor(
+        reader.GetExtractor(msg3->GetDescriptor()));
+    EXPECT_EQ(5U, base_extractor->plan_count());
+}
+
+static void CountStatTableInsert(size_t *count, const uint64_t &timestamp,
+    const std::string &stat_name, const std::string &stat_attr,
+    const DbHandler::TagMap &attribs_tag,
+    const DbHandler::AttribMap &attribs) {
+    (*count)++;
+}
+
+// Compares the reflective walk of the message fields against the compiled
+// extraction plan
+TEST_F(ProtobufStatWalkerTest, DISABLED_ExtractorPerf) {
+    const int kNumMessages = 100000;
+    protobuf::impl::ProtobufReader reader;
+    uint64_t timestamp;
+    boost::scoped_ptr<Message> msg(CreateAndParseSelfDescribingMessage(
+        &reader, "TestMessageAllTypes", tm_desc_file_,
+        CreateAndSerializeTestMessageAllTypes, &timestamp));
+    ASSERT_TRUE(msg.get() != NULL);
+    boost::system::error_code ec;
+    boost::asio::ip::address raddr(
+        boost::asio::ip::address::from_string("127.0.0.1", ec));
+    boost::asio::ip::udp::endpoint rep(raddr, 0);
+
+    size_t reflection_count = 0;
+    uint64_t start = ClockMonotonicUsec();
+    for (int i = 0; i < kNumMessages; i++) {
+        protobuf::impl::ProcessProtobufMessage(*msg, timestamp, rep,
+            boost::bind(&CountStatTableInsert, &reflection_count,
+                _1, _2, _3, _4, _5));
+    }
+    uint64_t reflection_time = ClockMonotonicUsec() - start;
+
+    size_t extractor_count = 0;
+    start = ClockMonotonicUsec();
+    for (int i = 0; i < kNumMessages; i++) {
+        boost::shared_ptr<const protobuf::impl::ProtobufExtractor> extractor(
+            reader.GetExtractor(msg->GetDescriptor()));
+        protobuf::impl::ProcessProtobufMessage(*msg, *extractor, timestamp,
+            rep, boost::bind(&CountStatTableInsert, &extractor_count,
+                _1, _2, _3, _4, _5));
+    }
+    uint64_t extractor_time = ClockMonotonicUsec() - start;
+    EXPECT_EQ(reflection_count, extractor_count);
+    LOG(DEBUG, "ProcessProtobufMessage: " << kNumMessages << " messages, "
+        << "reflection " << reflection_time << " usec, extractor " <<
+        extractor_time << " usec");
+}
+
 class ProtobufMockClient : public UdpServer {
  public:
     explicit ProtobufMockClient(EventManager *evm) :
@@ -9,6 +9,7 @@
 #include <boost/random/mersenne_twister.hpp>
 
 #include <base/logging.h>
+#include <base/time_util.h>
 
 #include <analytics/sflow_parser.h>
 #include <analytics/test/sflow_pktgen.h>
@@ -56,6 +57,78 @@ protected:
         EXPECT_TRUE(exp_sflow_data == act_sflow_data);
     }
 
+    static void AddFlowHeader(std::vector<SFlowFlowIpData>* ip_data,
+                              std::vector<uint32_t>* sourceid_index,
+                              const SFlowFlowSample& flow_sample,
+                              const SFlowFlowHeader& flow_header) {
+        EXPECT_TRUE(flow_sample.flow_records.empty());
+        ip_data->push_back(flow_header.decoded_ip_data);
+        sourceid_index->push_back(flow_sample.sourceid_index);
+    }
+
+    // Parse in place should report the same flow headers as Parse into
+    // SFlowData
+    void VerifySFlowParseInPlace(const SFlowData& exp_sflow_data,
+                                 const SFlowPktGen& sflow_pktgen) const {
+        SFlowParser parser(sflow_pktgen.GetSFlowPkt(),
+                           sflow_pktgen.GetSFlowPktLen(), trace_buf_);
+        SFlowHeader act_sflow_header;
+        std::vector<SFlowFlowIpData> act_ip_data;
+        std::vector<uint32_t> act_sourceid_index;
+        EXPECT_EQ(0, parser.Parse(&act_sflow_header,
+            boost::bind(&SFlowParserTest::AddFlowHeader, &act_ip_data,
+                        &act_sourceid_index, _1, _2)));
+        EXPECT_TRUE(exp_sflow_data.sflow_header == act_sflow_header);
+        size_t i = 0;
+        boost::ptr_vector<SFlowFlowSample>::const_iterator it =
+            exp_sflow_data.flow_samples.begin();
+        for (; it != exp_sflow_data.flow_samples.end(); ++it) {
+            boost::ptr_vector<SFlowFlowRecord>::const_iterator rit =
+                it->flow_records.begin();
+            for (; rit != it->flow_records.end(); ++rit, ++i) {
+                ASSERT_LT(i, act_ip_data.size());
+                const SFlowFlowHeader& flow_header =
+                    static_cast<const SFlowFlowHeader&>(*rit);
+                EXPECT_TRUE(flow_header.decoded_ip_data == act_ip_data[i]);
+                EXPECT_EQ(it->sourceid_index, act_sourceid_index[i]);
+            }
+        }
+        EXPECT_EQ(i, act_ip_data.size());
+    }
+
+    // Creates a datagram with nsamples flow samples, each with a different
+    // source address
+    void CreateSFlowPkt(SFlowPktGen* sflow_pktgen, uint32_t nsamples) {
+        SFlowData sflow_data;
+        for (uint32_t i = 0; i < nsamples; i++) {
+            SFlowFlowSample* flow_sample(new SFlowFlowSample(
+                                            SFLOW_FLOW_SAMPLE, 0));
+            std::stringstream sip;
+            sip << "10.1." << (sflow_seqno_ & 0xFF) << "." << i + 1;
+            CreateSFlowFlowSample1(*flow_sample,
+                                   SFLOW_FLOW_HEADER_ETHERNET_ISO8023, -1,
+                                   sip.str(), "192.168.1.1",
+                                   IPPROTO_TCP, 10000 + i, 80);
+            flow_sample->length = ComputeSFlowFlowSampleLength(*flow_sample);
+            sflow_data.flow_samples.push_back(flow_sample);
+        }
+        CreateSFlowHeader(sflow_data.sflow_header, "10.204.217.1", nsamples);
+        sflow_pktgen->WriteHeader(sflow_data.sflow_header);
+        boost::ptr_vector<SFlowFlowSample>::const_iterator it =
+            sflow_data.flow_samples.begin();
+        for (; it != sflow_data.flow_samples.end(); ++it) {
+            sflow_pktgen->WriteFlowSample(*it);
+        }
+    }
+
+    static void CountFlowHeader(size_t* count,
+                                const SFlowFlowSample& flow_sample,
+                                const SFlowFlowHeader& flow_header) {
+        if (flow_header.is_ip_data_set) {
+            (*count)++;
+        }
+    }
+
     void VerifySFlowParseError(const SFlowPktGen& sflow_pktgen,
                                size_t sflow_pktlen) const {
         LOG(INFO, "sFlow Packet Len: " << sflow_pktlen);
@@ -221,6 +294,7 @@ private:
         flow_header.header = header;
     }
 
+protected:
     static const uint16_t kTraceBufSize_ = 100;
     uint32_t sflow_seqno_;
     uint32_t sflow_flow_sample_seqno_;
@@ -282,6 +356,77 @@ TEST_F(SFlowParserTest, ParseMultipleFlowSamples) {
     VerifySFlowParse(exp_sflow_data, sflow_pktgen);
 }
 
+TEST_F(SFlowParserTest, ParseInPlace) {
+    SFlowData exp_sflow_data;
+    SFlowFlowSample* flow_sample1(new SFlowFlowSample(
+                                    SFLOW_FLOW_SAMPLE_EXPANDED, 0));
+    CreateSFlowFlowSample1(*flow_sample1, SFLOW_FLOW_HEADER_ETHERNET_ISO8023,
+                           104, "127.0.0.1", "192.168.12.1",
+                           IPPROTO_TCP, 12341, 4567);
+    flow_sample1->length = ComputeSFlowFlowSampleLength(*flow_sample1);
+    exp_sflow_data.flow_samples.push_back(flow_sample1);
+    SFlowFlowSample* flow_sample2(new SFlowFlowSample(SFLOW_FLOW_SAMPLE, 0));
+    CreateSFlowFlowSample1(*flow_sample2, SFLOW_FLOW_HEADER_IPV4, -1,
+                           "33.33.33.1", "44.44.44.1",
+                           IPPROTO_UDP, 3456, 53);
+    flow_sample2->length = ComputeSFlowFlowSampleLength(*flow_sample2);
+    exp_sflow_data.flow_samples.push_back(flow_sample2);
+    CreateSFlowHeader(exp_sflow_data.sflow_header, "11.12.13.14", 3);
+    SFlowPktGen sflow_pktgen;
+    sflow_pktgen.WriteHeader(exp_sflow_data.sflow_header);
+    sflow_pktgen.WriteFlowSample(*flow_sample1);
+    SFlowSample counter_sample(SFLOW_COUNTER_SAMPLE, 32);
+    sflow_pktgen.WriteCounterSample(counter_sample);
+    sflow_pktgen.WriteFlowSample(*flow_sample2);
+    VerifySFlowParse(exp_sflow_data, sflow_pktgen);
+    VerifySFlowParseInPlace(exp_sflow_data, sflow_pktgen);
+}
+
+// Replays a capture of generated datagrams through both decoders
+TEST_F(SFlowParserTest, DISABLED_ReplayPerf) {
+    const int kNumPkts = 1000;
+    const int kNumSamples = 6;
+    const int kNumReplays = 100;
+    boost::ptr_vector<SFlowPktGen> capture;
+    for (int i = 0; i < kNumPkts; i++) {
+        SFlowPktGen* sflow_pktgen(new SFlowPktGen());
+        CreateSFlowPkt(sflow_pktgen, kNumSamples);
+        capture.push_back(sflow_pktgen);
+    }
+
+    uint64_t start = ClockMonotonicUsec();
+    size_t nsamples = 0;
+    for (int r = 0; r < kNumReplays; r++) {
+        for (int i = 0; i < kNumPkts; i++) {
+            SFlowParser parser(capture[i].GetSFlowPkt(),
+                               capture[i].GetSFlowPktLen(), trace_buf_);
+            SFlowData sflow_data;
+            EXPECT_EQ(0, parser.Parse(&sflow_data));
+            nsamples += sflow_data.flow_samples.size();
+        }
+    }
+    uint64_t sflow_data_time = ClockMonotonicUsec() - start;
+    EXPECT_EQ((size_t) kNumReplays * kNumPkts * kNumSamples, nsamples);
+
+    start = ClockMonotonicUsec();
+    nsamples = 0;
+    for (int r = 0; r < kNumReplays; r++) {
+        for (int i = 0; i < kNumPkts; i++) {
+            SFlowParser parser(capture[i].GetSFlowPkt(),
+                               capture[i].GetSFlowPktLen(), trace_buf_);
+            SFlowHeader sflow_header;
+            EXPECT_EQ(0, parser.Parse(&sflow_header, boost::bind(
+                &SFlowParserTest::CountFlowHeader, &nsamples, _1, _2)));
+        }
+    }
+    uint64_t in_place_time = ClockMonotonicUsec() - start;
+    EXPECT_EQ((size_t) kNumReplays * kNumPkts * kNumSamples, nsamples);
+
+    LOG(INFO, "Replayed " << kNumReplays * kNumPkts << " datagrams: "
+        << "SFlowData " << sflow_data_time << " usec, in place "
+        << in_place_time << " usec");
+}
+
 TEST_F(SFlowParserTest, ParseCounterSample) {
     SFlowData exp_sflow_data;
     CreateSFlowHeader(exp_sflow_data.sflow_header, "1.2.3.40", 1);
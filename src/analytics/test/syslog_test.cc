@@ -362,6 +362,38 @@ TEST_F(LineParserTest, NoAttrString)
                 "10.84.5.22", "address", "has", "my", "server"));
 }
 
+TEST_F(LineParserTest, StopWordPrefix)
+{
+    EXPECT_THAT(Parse("order thereby android"),
+            testing::ElementsAre("der", "reby", "roid"));
+}
+
+TEST_F(LineParserTest, StatsAndTimes)
+{
+    EXPECT_THAT(Parse("took 0/0/121 at 13:44:21"),
+            testing::ElementsAre("0/0/121", "13:44:21", "at", "took"));
+}
+
+TEST_F(LineParserTest, IpTrailingSeparator)
+{
+    EXPECT_THAT(Parse("from 10.84.5.22/x"),
+            testing::ElementsAre("/x", "10.84.5.22/", "from"));
+}
+
+TEST_F(LineParserTest, QuotedLeadingSeparators)
+{
+    EXPECT_THAT(Parse("said ' (hello) there'"),
+            testing::ElementsAre("hello) there", "said"));
+}
+
+TEST_F(LineParserTest, TrailingAmpersand)
+{
+    LineParser::WordListType w;
+    EXPECT_FALSE(LineParser::Parse("fox &", &w));
+    EXPECT_THAT(w, testing::ElementsAre("fox"));
+    EXPECT_TRUE(LineParser::Parse("fox & box", &w));
+}
+
 TEST_F(LineParserTest, RegexpTextSearch)
 {
     EXPECT_EQ(1, SearchPattern("box", "Its in the box of gems"));
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <set>
+#include <boost/bind.hpp>
+
+#include "testing/gunit.h"
+#include "base/logging.h"
+#include "base/string_util.h"
+
+#include "uve_coalescer.h"
+
+using std::string;
+using std::vector;
+using std::map;
+using std::set;
+
+// Stand-in for redis and kafka which records what gets flushed
+class UVEFlushRecorder {
+public:
+    UVEFlushRecorder() :
+        fail_(false) {
+    }
+
+    struct Flush {
+        UVECoalescer::GeneratorKey gen;
+        UVECoalescer::UVEUpdateList updates;
+        UVECoalescer::UVENotifList notifs;
+    };
+
+    bool Cb(const UVECoalescer::GeneratorKey &gen,
+            const UVECoalescer::UVEUpdateList &updates,
+            const UVECoalescer::UVENotifList &notifs) {
+        Flush flush;
+        flush.gen = gen;
+        flush.updates = updates;
+        flush.notifs = notifs;
+        flushes_.push_back(flush);
+        for (UVECoalescer::UVEUpdateList::const_iterator it = updates.begin();
+             it != updates.end(); ++it) {
+            values_[it->key][it->attr] = it->message;
+        }
+        return !fail_ && fail_gens_.find(gen) == fail_gens_.end();
+    }
+
+    // Makes the flushes fail, as when redis is unreachable
+    bool fail_;
+    // Makes the flushes of these generators fail
+    set<UVECoalescer::GeneratorKey> fail_gens_;
+    vector<Flush> flushes_;
+    // UVE key -> attribute -> value, as it would be in redis
+    map<string, map<string, string> > values_;
+};
+
+class UVECoalescerTest : public ::testing::Test {
+protected:
+    UVECoalescerTest() :
+        coalescer_(boost::bind(&UVEFlushRecorder::Cb, &recorder_,
+            _1, _2, _3)),
+        gen1_("a6s1", "Compute", "contrail-vrouter-agent", "0"),
+        gen2_("a6s2", "Compute", "contrail-vrouter-agent", "0") {
+    }
+
+    static UVECoalescer::UVEUpdateInfo MakeUpdate(const string &key,
+        const string &attr, const string &message, int32_t seq) {
+        UVECoalescer::UVEUpdateInfo update;
+        update.type = "VrouterStatsAgent";
+        update.attr = attr;
+        update.key = key;
+        update.message = message;
+        update.seq = seq;
+        return update;
+    }
+
+    static UVECoalescer::UVENotifInfo MakeNotif(const string &barekey,
+        bool deleted) {
+        UVECoalescer::UVENotifInfo notif;
+        notif.type = "VrouterStatsAgent";
+        notif.table = "ObjectVRouter";
+        notif.barekey = barekey;
+        notif.deleted = deleted;
+        return notif;
+    }
+
+    UVEFlushRecorder recorder_;
+    UVECoalescer coalescer_;
+    UVECoalescer::GeneratorKey gen1_;
+    UVECoalescer::GeneratorKey gen2_;
+};
+
+TEST_F(UVECoalescerTest, LastWriterWins) {
+    const string key("ObjectVRouter:a6s1");
+    for (int i = 0; i < 100; i++) {
+        EXPECT_FALSE(coalescer_.Update(gen1_, MakeUpdate(key, "in_bytes",
+            integerToString(i), 2 * i)));
+        EXPECT_FALSE(coalescer_.Update(gen1_, MakeUpdate(key, "out_bytes",
+            integerToString(i), 2 * i + 1)));
+    }
+    EXPECT_EQ(2, coalescer_.PendingUpdates());
+    EXPECT_TRUE(recorder_.flushes_.empty());
+    coalescer_.FlushAll();
+    EXPECT_EQ(0, coalescer_.PendingUpdates());
+    ASSERT_EQ(1, recorder_.flushes_.size());
+    const UVECoalescer::UVEUpdateList &updates(
+        recorder_.flushes_[0].updates);
+    ASSERT_EQ(2, updates.size());
+    // Updates are flushed in the order of their last write
+    EXPECT_EQ("in_bytes", updates.front().attr);
+    EXPECT_EQ(198, updates.front().seq);
+    EXPECT_EQ("out_bytes", updates.back().attr);
+    EXPECT_EQ(199, updates.back().seq);
+    EXPECT_EQ("99", recorder_.values_[key]["in_bytes"]);
+    EXPECT_EQ("99", recorder_.values_[key]["out_bytes"]);
+    UVECoalescer::Stats stats;
+    coalescer_.GetStats(&stats);
+    EXPECT_EQ(200, stats.updates_received);
+    EXPECT_EQ(2, stats.updates_sent);
+    EXPECT_EQ(1, stats.flushes);
+}
+
+TEST_F(UVECoalescerTest, PerGenerator) {
+    coalescer_.Update(gen1_, MakeUpdate("ObjectVRouter:a6s1", "cpu", "1", 1));
+    coalescer_.Update(gen2_, MakeUpdate("ObjectVRouter:a6s2", "cpu", "2", 1));
+    coalescer_.Notif(gen1_, MakeNotif("a6s1", false));
+    coalescer_.Notif(gen2_, MakeNotif("a6s2", false));
+    coalescer_.Flush(gen1_);
+    ASSERT_EQ(1, recorder_.flushes_.size());
+    EXPECT_TRUE(recorder_.flushes_[0].gen == gen1_);
+    EXPECT_EQ(1, recorder_.flushes_[0].updates.size());
+    EXPECT_EQ(1, recorder_.flushes_[0].notifs.size());
+    EXPECT_EQ(1, coalescer_.PendingUpdates());
+    // Nothing pending for gen1
+    coalescer_.Flush(gen1_);
+    EXPECT_EQ(1, recorder_.flushes_.size());
+    coalescer_.FlushAll();
+    ASSERT_EQ(2, recorder_.flushes_.size());
+    EXPECT_TRUE(recorder_.flushes_[1].gen == gen2_);
+    EXPECT_EQ("2", recorder_.values_["ObjectVRouter:a6s2"]["cpu"]);
+}
+
+TEST_F(UVECoalescerTest, Notif) {
+    coalescer_.Notif(gen1_, MakeNotif("a6s1", false));
+    coalescer_.Notif(gen1_, MakeNotif("a6s3", false));
+    coalescer_.Notif(gen1_, MakeNotif("a6s1", true));
+    coalescer_.FlushAll();
+    ASSERT_EQ(1, recorder_.flushes_.size());
+    const UVECoalescer::UVENotifList &notifs(recorder_.flushes_[0].notifs);
+    ASSERT_EQ(2, notifs.size());
+    EXPECT_EQ("a6s3", notifs.front().barekey);
+    EXPECT_FALSE(notifs.front().deleted);
+    EXPECT_EQ("a6s1", notifs.back().barekey);
+    EXPECT_TRUE(notifs.back().deleted);
+    UVECoalescer::Stats stats;
+    coalescer_.GetStats(&stats);
+    EXPECT_EQ(3, stats.notifs_received);
+    EXPECT_EQ(2, stats.notifs_sent);
+}
+
+TEST_F(UVECoalescerTest, NotifDeleteKept) {
+    coalescer_.Notif(gen1_, MakeNotif("a6s1", false));
+    coalescer_.Notif(gen1_, MakeNotif("a6s1", true));
+    coalescer_.Notif(gen1_, MakeNotif("a6s1", false));
+    coalescer_.Notif(gen1_, MakeNotif("a6s1", false));
+    coalescer_.FlushAll();
+    ASSERT_EQ(1, recorder_.flushes_.size());
+    const UVECoalescer::UVENotifList &notifs(recorder_.flushes_[0].notifs);
+    ASSERT_EQ(2, notifs.size());
+    EXPECT_TRUE(notifs.front().deleted);
+    EXPECT_FALSE(notifs.back().deleted);
+}
+
+TEST_F(UVECoalescerTest, FlushFailure) {
+    EXPECT_TRUE(coalescer_.Flush(gen1_));
+    coalescer_.Update(gen1_, MakeUpdate("ObjectVRouter:a6s1", "cpu", "1", 1));
+    EXPECT_TRUE(coalescer_.Flush(gen1_));
+    recorder_.fail_ = true;
+    coalescer_.Update(gen1_, MakeUpdate("ObjectVRouter:a6s1", "cpu", "2", 2));
+    EXPECT_FALSE(coalescer_.Flush(gen1_));
+    EXPECT_EQ(0, coalescer_.PendingUpdates());
+    UVECoalescer::Stats stats;
+    coalescer_.GetStats(&stats);
+    EXPECT_EQ(2, stats.flushes);
+    EXPECT_EQ(1, stats.flush_failures);
+}
+
+TEST_F(UVECoalescerTest, FlushAllFailure) {
+    coalescer_.Update(gen1_, MakeUpdate("ObjectVRouter:a6s1", "cpu", "1", 1));
+    coalescer_.Update(gen2_, MakeUpdate("ObjectVRouter:a6s2", "cpu", "1", 1));
+    recorder_.fail_gens_.insert(gen2_);
+    vector<UVECoalescer::GeneratorKey> failed_gens;
+    coalescer_.FlushAll(&failed_gens);
+    EXPECT_EQ(2, recorder_.flushes_.size());
+    ASSERT_EQ(1, failed_gens.size());
+    EXPECT_TRUE(failed_gens[0] == gen2_);
+    UVECoalescer::Stats stats;
+    coalescer_.GetStats(&stats);
+    EXPECT_EQ(1, stats.flush_failures);
+
+    // Nothing is pending, so nothing fails
+    failed_gens.clear();
+    coalescer_.FlushAll(&failed_gens);
+    EXPECT_TRUE(failed_gens.empty());
+}
+
+TEST_F(UVECoalescerTest, FlushThreshold) {
+    size_t i;
+    for (i = 1; i < UVECoalescer::kMaxPendingUpdates; i++) {
+        EXPECT_FALSE(coalescer_.Update(gen1_, MakeUpdate(
+            "ObjectVMITable:vmi" + integerToString(i), "stats", "1", i)));
+    }
+    EXPECT_TRUE(coalescer_.Update(gen1_, MakeUpdate(
+        "ObjectVMITable:vmi" + integerToString(i), "stats", "1", i)));
+    coalescer_.Flush(gen1_);
+    ASSERT_EQ(1, recorder_.flushes_.size());
+    EXPECT_EQ(UVECoalescer::kMaxPendingUpdates,
+        recorder_.flushes_[0].updates.size());
+}
+
+TEST_F(UVECoalescerTest, Discard) {
+    coalescer_.Update(gen1_, MakeUpdate("ObjectVRouter:a6s1", "cpu", "1", 1));
+    coalescer_.Notif(gen1_, MakeNotif("a6s1", false));
+    coalescer_.Update(gen2_, MakeUpdate("ObjectVRouter:a6s2", "cpu", "2", 1));
+    coalescer_.Discard(gen1_);
+    EXPECT_EQ(1, coalescer_.PendingUpdates());
+    coalescer_.FlushAll();
+    ASSERT_EQ(1, recorder_.flushes_.size());
+    EXPECT_TRUE(recorder_.flushes_[0].gen == gen2_);
+    EXPECT_TRUE(recorder_.values_.find("ObjectVRouter:a6s1") ==
+        recorder_.values_.end());
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
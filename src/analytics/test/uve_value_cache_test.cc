@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <unistd.h>
+
+#include "testing/gunit.h"
+#include "base/logging.h"
+#include "base/string_util.h"
+
+#include "uve_value_cache.h"
+
+using std::string;
+
+class UVEValueCacheTest : public ::testing::Test {
+protected:
+    UVEValueCacheTest() :
+        gen1_("a6s1", "Compute", "contrail-vrouter-agent", "0"),
+        gen2_("a6s2", "Compute", "contrail-vrouter-agent", "0") {
+    }
+
+    static UVECoalescer::UVEUpdateInfo MakeUpdate(const string &key,
+        const string &type, const string &attr, const string &message) {
+        UVECoalescer::UVEUpdateInfo update;
+        update.type = type;
+        update.attr = attr;
+        update.key = key;
+        update.message = message;
+        return update;
+    }
+
+    static UVEValueCache::Stats GetStats(const UVEValueCache &cache) {
+        UVEValueCache::Stats stats;
+        cache.GetStats(&stats);
+        return stats;
+    }
+
+    UVEValueCache::GeneratorKey gen1_;
+    UVEValueCache::GeneratorKey gen2_;
+};
+
+TEST_F(UVEValueCacheTest, Suppress) {
+    UVEValueCache cache;
+    const string key("ObjectVRouter:a6s1");
+    const string type("VrouterAgent");
+    EXPECT_FALSE(cache.Unchanged(gen1_, MakeUpdate(key, type, "cpu", "1")));
+    EXPECT_TRUE(cache.Unchanged(gen1_, MakeUpdate(key, type, "cpu", "1")));
+    EXPECT_TRUE(cache.Unchanged(gen1_, MakeUpdate(key, type, "cpu", "1")));
+    EXPECT_FALSE(cache.Unchanged(gen1_, MakeUpdate(key, type, "cpu", "2")));
+    EXPECT_FALSE(cache.Unchanged(gen1_, MakeUpdate(key, type, "cpu", "1")));
+    // Same value for another attribute, type, key or generator
+    EXPECT_FALSE(cache.Unchanged(gen1_, MakeUpdate(key, type, "mem", "1")));
+    EXPECT_FALSE(cache.Unchanged(gen1_,
+        MakeUpdate(key, "VrouterStatsAgent", "cpu", "1")));
+    EXPECT_FALSE(cache.Unchanged(gen1_,
+        MakeUpdate("ObjectVRouter:a6s2", type, "cpu", "1")));
+    EXPECT_FALSE(cache.Unchanged(gen2_, MakeUpdate(key, type, "cpu", "1")));
+    EXPECT_EQ(5U, cache.Size());
+    UVEValueCache::Stats stats(GetStats(cache));
+    EXPECT_EQ(9U, stats.lookups);
+    EXPECT_EQ(2U, stats.suppressed);
+    EXPECT_EQ(0U, stats.evictions);
+}
+
+TEST_F(UVEValueCacheTest, MaxAge) {
+    UVEValueCache cache(UVEValueCache::kMaxEntries, 1000);
+    const string key("ObjectVRouter:a6s1");
+    EXPECT_FALSE(cache.Unchanged(gen1_,
+        MakeUpdate(key, "VrouterAgent", "cpu", "1")));
+    usleep(2000);
+    // Unchanged, but written again as it is too old
+    EXPECT_FALSE(cache.Unchanged(gen1_,
+        MakeUpdate(key, "VrouterAgent", "cpu", "1")));
+    EXPECT_EQ(1U, cache.Size());
+
+    UVEValueCache nocache(0);
+    EXPECT_FALSE(nocache.Unchanged(gen1_,
+        MakeUpdate(key, "VrouterAgent", "cpu", "1")));
+    EXPECT_FALSE(nocache.Unchanged(gen1_,
+        MakeUpdate(key, "VrouterAgent", "cpu", "1")));
+    EXPECT_EQ(0U, nocache.Size());
+}
+
+TEST_F(UVEValueCacheTest, Evict) {
+    UVEValueCache cache(2);
+    const string type("VrouterAgent");
+    EXPECT_FALSE(cache.Unchanged(gen1_, MakeUpdate("ObjectVRouter:a", type,
+        "cpu", "1")));
+    EXPECT_FALSE(cache.Unchanged(gen2_, MakeUpdate("ObjectVRouter:b", type,
+        "cpu", "1")));
+    // a is used more recently than b
+    EXPECT_TRUE(cache.Unchanged(gen1_, MakeUpdate("ObjectVRouter:a", type,
+        "cpu", "1")));
+    EXPECT_FALSE(cache.Unchanged(gen1_, MakeUpdate("ObjectVRouter:c", type,
+        "cpu", "1")));
+    EXPECT_EQ(2U, cache.Size());
+    EXPECT_EQ(1U, GetStats(cache).evictions);
+    EXPECT_TRUE(cache.Unchanged(gen1_, MakeUpdate("ObjectVRouter:a", type,
+        "cpu", "1")));
+    EXPECT_FALSE(cache.Unchanged(gen2_, MakeUpdate("ObjectVRouter:b", type,
+        "cpu", "1")));
+    EXPECT_EQ(2U, cache.Size());
+    EXPECT_EQ(2U, GetStats(cache).evictions);
+}
+
+TEST_F(UVEValueCacheTest, Delete) {
+    UVEValueCache cache;
+    const string key("ObjectVRouter:a6s1");
+    for (int i = 0; i < 10; i++) {
+        string attr("attr" + integerToString(i));
+        cache.Unchanged(gen1_, MakeUpdate(key, "VrouterAgent", attr, "1"));
+        cache.Unchanged(gen1_, MakeUpdate(key, "VrouterStatsAgent", attr,
+            "1"));
+        cache.Unchanged(gen2_, MakeUpdate(key, "VrouterAgent", attr, "1"));
+    }
+    EXPECT_EQ(30U, cache.Size());
+    cache.DeleteUVE(gen1_, key, "VrouterAgent");
+    EXPECT_EQ(20U, cache.Size());
+    EXPECT_FALSE(cache.Unchanged(gen1_, MakeUpdate(key, "VrouterAgent",
+        "attr0", "1")));
+    EXPECT_TRUE(cache.Unchanged(gen1_, MakeUpdate(key, "VrouterStatsAgent",
+        "attr0", "1")));
+    EXPECT_TRUE(cache.Unchanged(gen2_, MakeUpdate(key, "VrouterAgent",
+        "attr0", "1")));
+    cache.DeleteGenerator(gen2_);
+    EXPECT_EQ(11U, cache.Size());
+    EXPECT_FALSE(cache.Unchanged(gen2_, MakeUpdate(key, "VrouterAgent",
+        "attr0", "1")));
+    cache.Clear();
+    EXPECT_EQ(0U, cache.Size());
+    EXPECT_FALSE(cache.Unchanged(gen1_, MakeUpdate(key, "VrouterStatsAgent",
+        "attr0", "1")));
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
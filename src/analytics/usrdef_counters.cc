@@ -15,6 +15,8 @@
 UserDefinedCounters::UserDefinedCounters(EventManager *evm,
         VncApiConfig *vnccfg) : evm_(evm)
 {
+    // The config callbacks recompile the matcher, so it has to exist first
+    CompileMatcher();
     InitVnc(evm_, vnccfg);
 }
 
@@ -81,6 +83,7 @@ UserDefinedCounters::UDCHandler(rapidjson::Document &jdoc,
                             << patrn << "\n";
                     }
                     Cfg_t::iterator cit=config_.begin();
+                    bool deleted = false;
                     while (cit != config_.end()) {
                         Cfg_t::iterator dit = cit++;
                         if (!dit->second->IsRefreshed()) {
@@ -89,8 +92,11 @@ UserDefinedCounters::UDCHandler(rapidjson::Document &jdoc,
                             udc.set_deleted(true);
                             UserDefinedLogStatisticUVE::Send(udc);
                             config_.erase(dit);
+                            deleted = true;
                         }
                     }
+                    if (deleted)
+                        CompileMatcher();
                 }
             }
         }
@@ -102,16 +108,35 @@ UserDefinedCounters::UDCHandler(rapidjson::Document &jdoc,
 }
 
 void
-UserDefinedCounters::MatchFilter(std::string text, LineParser::WordListType *w)
+UserDefinedCounters::CompileMatcher()
 {
+    boost::shared_ptr<PatternMatcher> matcher(new PatternMatcher);
     for(Cfg_t::iterator it=config_.begin(); it != config_.end(); ++it) {
-        if (LineParser::SearchPattern(it->second->regexp(), text)) {
-            UserDefinedLogStatistic udc;
-            udc.set_name(it->first);
-            udc.set_rx_event(1);
-            UserDefinedLogStatisticUVE::Send(udc);
-            w->insert(it->first);
-        }
+        matcher->AddPattern(it->first, it->second->regexp());
+    }
+    matcher->Compile();
+    tbb::mutex::scoped_lock lock(matcher_mutex_);
+    matcher_ = matcher;
+}
+
+void
+UserDefinedCounters::MatchFilter(std::string text, LineParser::WordListType *w)
+{
+    boost::shared_ptr<const PatternMatcher> matcher;
+    {
+        tbb::mutex::scoped_lock lock(matcher_mutex_);
+        matcher = matcher_;
+    }
+    std::vector<size_t> matches;
+    matcher->Match(text, &matches);
+    for (std::vector<size_t>::const_iterator it = matches.begin();
+            it != matches.end(); ++it) {
+        const std::string &name(matcher->name(*it));
+        UserDefinedLogStatistic udc;
+        udc.set_name(name);
+        udc.set_rx_event(1);
+        UserDefinedLogStatisticUVE::Send(udc);
+        w->insert(name);
     }
 }
 
@@ -124,6 +149,7 @@ UserDefinedCounters::AddConfig(std::string name, std::string pattern)
             // ignore
         } else {
             it->second->SetPattern(pattern);
+            CompileMatcher();
         }
         it->second->Refresh();
     } else {
@@ -131,6 +157,7 @@ UserDefinedCounters::AddConfig(std::string name, std::string pattern)
                     name, pattern));
         config_.insert(std::make_pair<std::string,
                 boost::shared_ptr<UserDefinedCounterData> >(name, c));
+        CompileMatcher();
     }
 }
 
@@ -12,6 +12,7 @@
 #include "discovery/client/discovery_client.h"
 #include "http/client/vncapi.h"
 #include "parser_util.h"
+#include "pattern_matcher.h"
 
 class Options;
 //class DiscoveryServiceClient;
@@ -65,10 +66,15 @@ class UserDefinedCounters {
                     std::string version, int status, std::string reason,
                     std::map<std::string, std::string> *headers);
         void InitVnc(EventManager *evm, VncApiConfig *vnccfg);
+        void CompileMatcher();
         void RetryNextApi();
         void APIfromDisc(Options *o, std::vector<DSResponse> response);
 
         Cfg_t config_;
+        // Built from config_ whenever it changes, and replaced as a whole
+        // so that MatchFilter can keep using the previous one meanwhile
+        boost::shared_ptr<const PatternMatcher> matcher_;
+        mutable tbb::mutex matcher_mutex_;
         std::string call_str_;
         boost::shared_ptr<VncApi> vnc_;
         EventManager *evm_;
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "analytics/uve_coalescer.h"
+
+const size_t UVECoalescer::kMaxPendingUpdates;
+
+UVECoalescer::UVECoalescer(FlushFn flush_fn) :
+    flush_fn_(flush_fn),
+    pending_updates_(0) {
+}
+
+UVECoalescer::~UVECoalescer() {
+}
+
+UVECoalescer::PendingBatch *UVECoalescer::LocateBatch(
+    const GeneratorKey &gen) {
+    PendingBatchMap::iterator it(pending_.find(gen));
+    if (it == pending_.end()) {
+        GeneratorKey key(gen);
+        it = pending_.insert(key, new PendingBatch).first;
+    }
+    return it->second;
+}
+
+bool UVECoalescer::Update(const GeneratorKey &gen,
+    const UVEUpdateInfo &update) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    stats_.updates_received++;
+    PendingBatch *batch(LocateBatch(gen));
+    UpdateKey ukey(update.key, update.type, update.attr);
+    UpdateIndex::iterator it(batch->update_index_.find(ukey));
+    if (it != batch->update_index_.end()) {
+        // Last writer wins, and moves to the end of the batch
+        batch->updates_.erase(it->second);
+        it->second = batch->updates_.insert(batch->updates_.end(), update);
+    } else {
+        batch->update_index_.insert(std::make_pair(ukey,
+            batch->updates_.insert(batch->updates_.end(), update)));
+        pending_updates_++;
+    }
+    return batch->updates_.size() >= kMaxPendingUpdates;
+}
+
+void UVECoalescer::Notif(const GeneratorKey &gen,
+    const UVENotifInfo &notif) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    stats_.notifs_received++;
+    PendingBatch *batch(LocateBatch(gen));
+    NotifKey nkey(notif.table, notif.barekey, notif.type);
+    NotifIndex::iterator it(batch->notif_index_.find(nkey));
+    if (it != batch->notif_index_.end()) {
+        // A pending delete is kept, so that consumers see the delete even
+        // if the UVE is added again in the same window
+        if (!it->second->deleted) {
+            batch->notifs_.erase(it->second);
+        }
+        it->second = batch->notifs_.insert(batch->notifs_.end(), notif);
+    } else {
+        batch->notif_index_.insert(std::make_pair(nkey,
+            batch->notifs_.insert(batch->notifs_.end(), notif)));
+    }
+}
+
+bool UVECoalescer::FlushBatch(const GeneratorKey &gen,
+    const PendingBatch &batch) {
+    bool success(flush_fn_(gen, batch.updates_, batch.notifs_));
+    tbb::mutex::scoped_lock lock(mutex_);
+    stats_.updates_sent += batch.updates_.size();
+    stats_.notifs_sent += batch.notifs_.size();
+    stats_.flushes++;
+    if (!success) {
+        stats_.flush_failures++;
+    }
+    return success;
+}
+
+bool UVECoalescer::Flush(const GeneratorKey &gen) {
+    tbb::mutex::scoped_lock flush_lock(flush_mutex_);
+    PendingBatchMap::auto_type batch;
+    {
+        tbb::mutex::scoped_lock lock(mutex_);
+        PendingBatchMap::iterator it(pending_.find(gen));
+        if (it == pending_.end()) {
+            return true;
+        }
+        pending_updates_ -= it->second->updates_.size();
+        batch = pending_.release(it);
+    }
+    return FlushBatch(gen, *batch);
+}
+
+void UVECoalescer::FlushAll(std::vector<GeneratorKey> *failed_gens) {
+    tbb::mutex::scoped_lock flush_lock(flush_mutex_);
+    PendingBatchMap pending;
+    {
+        tbb::mutex::scoped_lock lock(mutex_);
+        pending.swap(pending_);
+        pending_updates_ = 0;
+    }
+    for (PendingBatchMap::const_iterator it = pending.begin();
+         it != pending.end(); ++it) {
+        if (!FlushBatch(it->first, *it->second) && failed_gens) {
+            failed_gens->push_back(it->first);
+        }
+    }
+}
+
+void UVECoalescer::Discard(const GeneratorKey &gen) {
+    tbb::mutex::scoped_lock flush_lock(flush_mutex_);
+    tbb::mutex::scoped_lock lock(mutex_);
+    PendingBatchMap::iterator it(pending_.find(gen));
+    if (it == pending_.end()) {
+        return;
+    }
+    pending_updates_ -= it->second->updates_.size();
+    pending_.erase(it);
+}
+
+size_t UVECoalescer::PendingUpdates() const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    return pending_updates_;
+}
+
+void UVECoalescer::GetStats(Stats *stats) const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    *stats = stats_;
+}
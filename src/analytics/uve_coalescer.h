@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef ANALYTICS_UVE_COALESCER_H_
+#define ANALYTICS_UVE_COALESCER_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+#include <boost/ptr_container/ptr_map.hpp>
+#include <tbb/mutex.h>
+
+#include <base/util.h>
+
+//
+// Coalesces the UVE updates and notifications of each generator over a
+// short window before they are sent out. Updates to the same attribute of
+// a UVE replace each other, so only the last value written in the window
+// is sent. Likewise only the last notification for a UVE type is kept,
+// except that a delete notification is never replaced. The remaining
+// updates are flushed in the order of their last write.
+//
+class UVECoalescer {
+public:
+    // Source, node type, module and instance id of the generator
+    typedef boost::tuple<std::string, std::string, std::string,
+        std::string> GeneratorKey;
+
+    struct UVEUpdateInfo {
+        UVEUpdateInfo() :
+            seq(0),
+            ts(0),
+            part(0),
+            is_alarm(false) {
+        }
+        std::string type;
+        std::string attr;
+        std::string key;
+        std::string message;
+        int32_t seq;
+        std::string agg;
+        int64_t ts;
+        unsigned int part;
+        bool is_alarm;
+    };
+    typedef std::list<UVEUpdateInfo> UVEUpdateList;
+
+    struct UVENotifInfo {
+        UVENotifInfo() :
+            deleted(false) {
+        }
+        std::string type;
+        std::string table;
+        std::string barekey;
+        std::map<std::string, std::string> value;
+        bool deleted;
+    };
+    typedef std::list<UVENotifInfo> UVENotifList;
+
+    // Returns false if not all the updates could be sent
+    typedef boost::function<bool (const GeneratorKey &gen,
+        const UVEUpdateList &updates, const UVENotifList &notifs)> FlushFn;
+
+    struct Stats {
+        Stats() :
+            updates_received(0),
+            updates_sent(0),
+            notifs_received(0),
+            notifs_sent(0),
+            flushes(0),
+            flush_failures(0) {
+        }
+        uint64_t updates_received;
+        uint64_t updates_sent;
+        uint64_t notifs_received;
+        uint64_t notifs_sent;
+        uint64_t flushes;
+        uint64_t flush_failures;
+    };
+
+    static const size_t kMaxPendingUpdates = 1024;
+
+    explicit UVECoalescer(FlushFn flush_fn);
+    ~UVECoalescer();
+
+    // Returns true if the generator has kMaxPendingUpdates or more updates
+    // pending, in which case the caller should flush the generator
+    bool Update(const GeneratorKey &gen, const UVEUpdateInfo &update);
+    void Notif(const GeneratorKey &gen, const UVENotifInfo &notif);
+    // Hands the pending updates and notifications to the flush function.
+    // Flushes are serialized, so the flush function sees the batches of a
+    // generator in order. Returns false if the flush function failed
+    bool Flush(const GeneratorKey &gen);
+    // Flushes all the generators. The generators for which the flush
+    // function failed are added to failed_gens, if it is not NULL
+    void FlushAll(std::vector<GeneratorKey> *failed_gens = NULL);
+    // Drops the pending updates and notifications of the generator
+    void Discard(const GeneratorKey &gen);
+    size_t PendingUpdates() const;
+    void GetStats(Stats *stats) const;
+
+private:
+    // UVE key, type and attribute
+    typedef boost::tuple<std::string, std::string, std::string> UpdateKey;
+    typedef std::map<UpdateKey, UVEUpdateList::iterator> UpdateIndex;
+    // UVE table, bare key and type
+    typedef boost::tuple<std::string, std::string, std::string> NotifKey;
+    typedef std::map<NotifKey, UVENotifList::iterator> NotifIndex;
+
+    struct PendingBatch {
+        UVEUpdateList updates_;
+        UpdateIndex update_index_;
+        UVENotifList notifs_;
+        NotifIndex notif_index_;
+    };
+    typedef boost::ptr_map<GeneratorKey, PendingBatch> PendingBatchMap;
+
+    PendingBatch *LocateBatch(const GeneratorKey &gen);
+    bool FlushBatch(const GeneratorKey &gen, const PendingBatch &batch);
+
+    FlushFn flush_fn_;
+    mutable tbb::mutex mutex_;
+    tbb::mutex flush_mutex_;
+    PendingBatchMap pending_;
+    size_t pending_updates_;
+    Stats stats_;
+
+    DISALLOW_COPY_AND_ASSIGN(UVECoalescer);
+};
+
+#endif  // ANALYTICS_UVE_COALESCER_H_
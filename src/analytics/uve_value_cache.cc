@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <boost/functional/hash.hpp>
+
+#include "base/time_util.h"
+#include "analytics/uve_value_cache.h"
+
+const size_t UVEValueCache::kMaxEntries;
+const uint64_t UVEValueCache::kMaxAgeUsec;
+
+UVEValueCache::UVEValueCache(size_t max_entries, uint64_t max_age_usec) :
+    max_entries_(max_entries),
+    max_age_usec_(max_age_usec),
+    entries_(0) {
+}
+
+UVEValueCache::~UVEValueCache() {
+}
+
+UVEValueCache::AttrMap *UVEValueCache::LocateGenerator(
+    const GeneratorKey &gen) {
+    GeneratorMap::iterator it(generators_.find(gen));
+    if (it == generators_.end()) {
+        GeneratorKey key(gen);
+        it = generators_.insert(key, new AttrMap).first;
+    }
+    return it->second;
+}
+
+void UVEValueCache::Erase(AttrMap *attrs, AttrMap::iterator it) {
+    lru_.erase(it->second.lru_);
+    attrs->erase(it);
+    entries_--;
+}
+
+bool UVEValueCache::Unchanged(const GeneratorKey &gen,
+    const UVECoalescer::UVEUpdateInfo &update) {
+    if (max_entries_ == 0) {
+        return false;
+    }
+    size_t hash(boost::hash<std::string>()(update.message));
+    uint64_t now(ClockMonotonicUsec());
+    tbb::mutex::scoped_lock lock(mutex_);
+    stats_.lookups++;
+    AttrMap *attrs(LocateGenerator(gen));
+    AttrKey akey(update.key, update.type, update.attr);
+    AttrMap::iterator it(attrs->find(akey));
+    if (it != attrs->end()) {
+        Value &value(it->second);
+        lru_.splice(lru_.end(), lru_, value.lru_);
+        if (value.hash_ == hash && value.length_ == update.message.size() &&
+            now - value.time_ < max_age_usec_) {
+            stats_.suppressed++;
+            return true;
+        }
+        value.hash_ = hash;
+        value.length_ = update.message.size();
+        value.time_ = now;
+        return false;
+    }
+    if (entries_ >= max_entries_) {
+        const LruEntry &oldest(lru_.front());
+        Erase(oldest.attrs_, oldest.attrs_->find(*oldest.key_));
+        stats_.evictions++;
+    }
+    it = attrs->insert(std::make_pair(akey, Value())).first;
+    Value &value(it->second);
+    value.hash_ = hash;
+    value.length_ = update.message.size();
+    value.time_ = now;
+    value.lru_ = lru_.insert(lru_.end(), LruEntry(attrs, &it->first));
+    entries_++;
+    return false;
+}
+
+void UVEValueCache::DeleteUVE(const GeneratorKey &gen, const std::string &key,
+    const std::string &type) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    GeneratorMap::iterator git(generators_.find(gen));
+    if (git == generators_.end()) {
+        return;
+    }
+    AttrMap *attrs(git->second);
+    AttrMap::iterator it(attrs->lower_bound(AttrKey(key, type,
+        std::string())));
+    while (it != attrs->end() && it->first.get<0>() == key &&
+           it->first.get<1>() == type) {
+        Erase(attrs, it++);
+    }
+}
+
+void UVEValueCache::DeleteGenerator(const GeneratorKey &gen) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    GeneratorMap::iterator git(generators_.find(gen));
+    if (git == generators_.end()) {
+        return;
+    }
+    AttrMap *attrs(git->second);
+    for (AttrMap::iterator it = attrs->begin(); it != attrs->end(); ++it) {
+        lru_.erase(it->second.lru_);
+    }
+    entries_ -= attrs->size();
+    generators_.erase(git);
+}
+
+void UVEValueCache::Clear() {
+    tbb::mutex::scoped_lock lock(mutex_);
+    lru_.clear();
+    generators_.clear();
+    entries_ = 0;
+}
+
+size_t UVEValueCache::Size() const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    return entries_;
+}
+
+void UVEValueCache::GetStats(Stats *stats) const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    *stats = stats_;
+}
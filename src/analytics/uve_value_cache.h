@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef ANALYTICS_UVE_VALUE_CACHE_H_
+#define ANALYTICS_UVE_VALUE_CACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+#include <boost/ptr_container/ptr_map.hpp>
+#include <tbb/mutex.h>
+
+#include <base/util.h>
+#include "analytics/uve_coalescer.h"
+
+//
+// Remembers a hash of the last value of each UVE attribute that a
+// generator has sent towards redis, so that updates which publish the same
+// value again can be dropped instead of rewriting redis. Agents publish
+// many UVEs periodically whether or not anything changed.
+//
+// A value is trusted for at most max age, after which the next update is
+// written even if it is unchanged. This refreshes the sequence number and
+// the generator liveness that the redis update script maintains.
+//
+// The cache holds at most max entries, the least recently updated
+// attribute is evicted when it is full. The attributes of a generator are
+// forgotten when its UVEs are deleted, and those of a UVE type when it is
+// deleted.
+//
+class UVEValueCache {
+public:
+    typedef UVECoalescer::GeneratorKey GeneratorKey;
+
+    struct Stats {
+        Stats() :
+            lookups(0),
+            suppressed(0),
+            evictions(0) {
+        }
+        uint64_t lookups;
+        uint64_t suppressed;
+        uint64_t evictions;
+    };
+
+    static const size_t kMaxEntries = 512 * 1024;
+    static const uint64_t kMaxAgeUsec = 30 * 1000 * 1000;
+
+    explicit UVEValueCache(size_t max_entries = kMaxEntries,
+        uint64_t max_age_usec = kMaxAgeUsec);
+    ~UVEValueCache();
+
+    // Returns true if the update has the same value as the last one
+    // recorded for the attribute. Otherwise records the value of the update
+    // and returns false, and the update must be sent.
+    bool Unchanged(const GeneratorKey &gen,
+        const UVECoalescer::UVEUpdateInfo &update);
+    void DeleteUVE(const GeneratorKey &gen, const std::string &key,
+        const std::string &type);
+    void DeleteGenerator(const GeneratorKey &gen);
+    void Clear();
+    size_t Size() const;
+    void GetStats(Stats *stats) const;
+
+private:
+    // UVE key, type and attribute
+    typedef boost::tuple<std::string, std::string, std::string> AttrKey;
+    struct Value;
+    typedef std::map<AttrKey, Value> AttrMap;
+    struct LruEntry {
+        LruEntry(AttrMap *attrs, const AttrKey *key) :
+            attrs_(attrs),
+            key_(key) {
+        }
+        AttrMap *attrs_;
+        const AttrKey *key_;
+    };
+    typedef std::list<LruEntry> LruList;
+    struct Value {
+        size_t hash_;
+        size_t length_;
+        uint64_t time_;
+        LruList::iterator lru_;
+    };
+    typedef boost::ptr_map<GeneratorKey, AttrMap> GeneratorMap;
+
+    AttrMap *LocateGenerator(const GeneratorKey &gen);
+    void Erase(AttrMap *attrs, AttrMap::iterator it);
+
+    const size_t max_entries_;
+    const uint64_t max_age_usec_;
+    mutable tbb::mutex mutex_;
+    GeneratorMap generators_;
+    // Least recently updated attribute first
+    LruList lru_;
+    size_t entries_;
+    Stats stats_;
+
+    DISALLOW_COPY_AND_ASSIGN(UVEValueCache);
+};
+
+#endif  // ANALYTICS_UVE_VALUE_CACHE_H_
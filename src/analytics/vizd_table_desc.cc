@@ -4,6 +4,8 @@
 
 #include "vizd_table_desc.h"
 
+#include <cstring>
+#include <algorithm>
 #include <boost/assign/list_of.hpp>
 #include <sandesh/sandesh_types.h>
 #include <sandesh/sandesh.h>
@@ -15,6 +17,37 @@ std::vector<GenDb::NewCf> vizd_flow_tables;
 std::vector<GenDb::NewCf> vizd_stat_tables;
 FlowTypeMap flow_msg2type_map;
 
+// Sorted by name, points into flow_msg2type_map
+typedef std::pair<const char *, const FlowTypeInfo *> FlowTypeIndexEntry;
+static std::vector<FlowTypeIndexEntry> flow_msg2type_index;
+
+struct FlowTypeIndexCompare {
+    bool operator()(const FlowTypeIndexEntry &lhs, const char *rhs) const {
+        return strcmp(lhs.first, rhs) < 0;
+    }
+};
+
+const FlowTypeInfo *flow_msg2type_lookup(const char *name) {
+    std::vector<FlowTypeIndexEntry>::const_iterator it(
+        std::lower_bound(flow_msg2type_index.begin(),
+            flow_msg2type_index.end(), name, FlowTypeIndexCompare()));
+    if (it == flow_msg2type_index.end() || strcmp(it->first, name) != 0) {
+        return NULL;
+    }
+    return it->second;
+}
+
+static void init_flow_msg2type_index(void) {
+    flow_msg2type_index.clear();
+    flow_msg2type_index.reserve(flow_msg2type_map.size());
+    // std::map iteration order matches strcmp order for the field names
+    for (FlowTypeMap::const_iterator it = flow_msg2type_map.begin();
+         it != flow_msg2type_map.end(); it++) {
+        flow_msg2type_index.push_back(FlowTypeIndexEntry(it->first.c_str(),
+            &it->second));
+    }
+}
+
 void init_tables(std::vector<GenDb::NewCf>& table,
                 std::vector<table_schema> schema) {
 
@@ -157,4 +190,5 @@ void init_vizd_tables() {
          FlowTypeInfo(FlowRecordFields::FLOWREC_VMI_UUID, GenDb::DbDataType::LexicalUUIDType);
     flow_msg2type_map[g_viz_constants.FlowRecordNames[FlowRecordFields::FLOWREC_DROP_REASON]] =
          FlowTypeInfo(FlowRecordFields::FLOWREC_DROP_REASON, GenDb::DbDataType::UTF8Type);
+    init_flow_msg2type_index();
 }
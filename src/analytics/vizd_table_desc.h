@@ -19,6 +19,10 @@ typedef boost::tuple<FlowRecordFields::type, GenDb::DbDataType::type> FlowTypeIn
 typedef std::map<std::string, FlowTypeInfo> FlowTypeMap;
 extern FlowTypeMap flow_msg2type_map;
 
+// Lookup into flow_msg2type_map by sandesh element name, used when decoding
+// flow samples to avoid constructing a std::string for every element
+const FlowTypeInfo *flow_msg2type_lookup(const char *name);
+
 void init_vizd_tables(void);
 
 #endif // __VIZD_TABLE_DESC_H__
@@ -925,6 +925,10 @@ void BgpAttr::set_label_block(LabelBlockPtr label_block) {
     label_block_ = label_block;
 }
 
+void BgpAttr::set_olist(BgpOListPtr olist) {
+    olist_ = olist;
+}
+
 void BgpAttr::set_olist(const BgpOListSpec *olist_spec) {
     if (olist_spec) {
         olist_ = attr_db_->server()->olist_db()->Locate(*olist_spec);
@@ -933,6 +937,10 @@ void BgpAttr::set_olist(const BgpOListSpec *olist_spec) {
     }
 }
 
+void BgpAttr::set_leaf_olist(BgpOListPtr leaf_olist) {
+    leaf_olist_ = leaf_olist;
+}
+
 void BgpAttr::set_leaf_olist(const BgpOListSpec *leaf_olist_spec) {
     if (leaf_olist_spec) {
         leaf_olist_ = attr_db_->server()->olist_db()->Locate(*leaf_olist_spec);
@@ -1133,6 +1141,18 @@ BgpAttrPtr BgpAttrDB::ReplaceLeafOListAndLocate(const BgpAttr *attr,
     return Locate(clone);
 }
 
+// Return a clone of attribute with updated olist and leaf olist.
+BgpAttrPtr BgpAttrDB::ReplaceOListsAndLocate(const BgpAttr *attr,
+    BgpOListPtr olist, BgpOListPtr leaf_olist) {
+    assert(!olist || olist->olist().subcode == BgpAttribute::OList);
+    assert(!leaf_olist ||
+           leaf_olist->olist().subcode == BgpAttribute::LeafOList);
+    BgpAttr *clone = new BgpAttr(*attr);
+    clone->set_olist(olist);
+    clone->set_leaf_olist(leaf_olist);
+    return Locate(clone);
+}
+
 // Return a clone of attribute with updated pmsi tunnel.
 BgpAttrPtr BgpAttrDB::ReplacePmsiTunnelAndLocate(const BgpAttr *attr,
     const PmsiTunnelSpec *pmsi_spec) {
@@ -815,7 +815,9 @@ public:
     void set_edge_discovery(const EdgeDiscoverySpec *edspec);
     void set_edge_forwarding(const EdgeForwardingSpec *efspec);
     void set_label_block(LabelBlockPtr label_block);
+    void set_olist(BgpOListPtr olist);
     void set_olist(const BgpOListSpec *olist_spec);
+    void set_leaf_olist(BgpOListPtr leaf_olist);
     void set_leaf_olist(const BgpOListSpec *leaf_olist_spec);
     friend std::size_t hash_value(BgpAttr const &attr);
 
@@ -938,6 +940,8 @@ public:
                                      const BgpOListSpec *olist_spec);
     BgpAttrPtr ReplaceLeafOListAndLocate(const BgpAttr *attr,
                                          const BgpOListSpec *leaf_olist_spec);
+    BgpAttrPtr ReplaceOListsAndLocate(const BgpAttr *attr, BgpOListPtr olist,
+                                      BgpOListPtr leaf_olist);
     BgpAttrPtr ReplacePmsiTunnelAndLocate(const BgpAttr *attr,
                                           const PmsiTunnelSpec *pmsi_spec);
     BgpAttrPtr ReplaceNexthopAndLocate(const BgpAttr *attr,
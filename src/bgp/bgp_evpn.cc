@@ -16,6 +16,7 @@
 #include "bgp/bgp_update.h"
 #include "bgp/evpn/evpn_table.h"
 
+using std::lower_bound;
 using std::sort;
 using std::string;
 using std::vector;
@@ -222,8 +223,8 @@ void EvpnLocalMcastNode::TriggerUpdate() {
 // is used the Export method of the EvpnTable. It is expected that the caller
 // fills in the target RibPeerSet in the UpdateInfo.
 //
-// The main functionality here is to build a per-IPeer BgpOList from the list
-// of EvpnRemoteMcastNodes.
+// The main functionality here is to get the per-IPeer BgpOList and leaf
+// BgpOList from the EvpnManagerPartition.
 //
 UpdateInfo *EvpnLocalMcastNode::GetUpdateInfo() {
     CHECK_CONCURRENCY("db::DBTable");
@@ -232,45 +233,17 @@ UpdateInfo *EvpnLocalMcastNode::GetUpdateInfo() {
     if (assisted_replication_leaf_)
         return NULL;
 
-    // Go through list of EvpnRemoteMcastNodes and build the BgpOList.
-    BgpOListSpec olist_spec(BgpAttribute::OList);
-    BOOST_FOREACH(EvpnMcastNode *node, partition_->remote_mcast_node_list()) {
-        if (node->address() == address_)
-            continue;
-        if (node->assisted_replication_leaf())
-            continue;
-        if (!edge_replication_not_supported_ &&
-            !node->edge_replication_not_supported())
-            continue;
-
-        const ExtCommunity *extcomm = node->attr()->ext_community();
-        BgpOListElem elem(node->address(), node->label(),
-            extcomm ? extcomm->GetTunnelEncap() : vector<string>());
-        olist_spec.elements.push_back(elem);
-    }
-
-    // Go through list of leaf EvpnMcastNodes and build the leaf BgpOList.
-    BgpOListSpec leaf_olist_spec(BgpAttribute::LeafOList);
-    if (assisted_replication_supported_) {
-        BOOST_FOREACH(EvpnMcastNode *node, partition_->leaf_node_list()) {
-            if (node->replicator_address() != address_)
-                continue;
-
-            const ExtCommunity *extcomm = node->attr()->ext_community();
-            BgpOListElem elem(node->address(), node->label(),
-                extcomm ? extcomm->GetTunnelEncap() : vector<string>());
-            leaf_olist_spec.elements.push_back(elem);
-        }
-    }
+    BgpOListPtr olist = partition_->GetOList(this);
+    BgpOListPtr leaf_olist = partition_->GetLeafOList(this);
 
     // Bail if both BgpOLists are empty.
-    if (olist_spec.elements.empty() && leaf_olist_spec.elements.empty())
+    if (olist->elements().empty() && leaf_olist->elements().empty())
         return NULL;
 
     // Add BgpOList and leaf BgpOList to RibOutAttr for broadcast MAC route.
     BgpAttrDB *attr_db = partition_->server()->attr_db();
-    BgpAttrPtr attr = attr_db->ReplaceOListAndLocate(attr_.get(), &olist_spec);
-    attr = attr_db->ReplaceLeafOListAndLocate(attr.get(), &leaf_olist_spec);
+    BgpAttrPtr attr =
+        attr_db->ReplaceOListsAndLocate(attr_.get(), olist, leaf_olist);
 
     UpdateInfo *uinfo = new UpdateInfo;
     uinfo->roattr =
@@ -303,7 +276,10 @@ void EvpnRemoteMcastNode::TriggerUpdate() {
 //
 EvpnManagerPartition::EvpnManagerPartition(EvpnManager *evpn_manager,
     size_t part_id)
-    : evpn_manager_(evpn_manager), part_id_(part_id) {
+    : evpn_manager_(evpn_manager),
+      part_id_(part_id),
+      notify_count_(0),
+      olist_node_count_(0) {
 }
 
 //
@@ -325,6 +301,7 @@ DBTablePartition *EvpnManagerPartition::GetTablePartition() {
 void EvpnManagerPartition::NotifyNodeRoute(EvpnMcastNode *node) {
     DBTablePartition *tbl_partition = GetTablePartition();
     tbl_partition->Notify(node->route());
+    notify_count_++;
 }
 
 //
@@ -332,9 +309,22 @@ void EvpnManagerPartition::NotifyNodeRoute(EvpnMcastNode *node) {
 // MAC route.
 //
 void EvpnManagerPartition::NotifyReplicatorNodeRoutes() {
-    DBTablePartition *tbl_partition = GetTablePartition();
     BOOST_FOREACH(EvpnMcastNode *node, replicator_node_list_) {
-        tbl_partition->Notify(node->route());
+        NotifyNodeRoute(node);
+    }
+}
+
+//
+// Notify the Broadcast MAC route of the replicator EvpnMcastNodes with the
+// given address. Only their leaf BgpOLists include the leaf EvpnMcastNodes
+// that use the address as the replicator-address.
+//
+void EvpnManagerPartition::NotifyReplicatorNodeRoutes(
+    Ip4Address replicator_address) {
+    BOOST_FOREACH(EvpnMcastNode *node, replicator_node_list_) {
+        if (node->address() != replicator_address)
+            continue;
+        NotifyNodeRoute(node);
     }
 }
 
@@ -344,19 +334,24 @@ void EvpnManagerPartition::NotifyReplicatorNodeRoutes() {
 //
 void EvpnManagerPartition::NotifyIrClientNodeRoutes(
     bool exclude_edge_replication_supported) {
-    DBTablePartition *tbl_partition = GetTablePartition();
     BOOST_FOREACH(EvpnMcastNode *node, ir_client_node_list_) {
         if (exclude_edge_replication_supported &&
             !node->edge_replication_not_supported()) {
             continue;
         }
-        tbl_partition->Notify(node->route());
+        NotifyNodeRoute(node);
     }
 }
 
 //
 // Add an EvpnMcastNode to the EvpnManagerPartition.
 //
+// Adding a leaf EvpnMcastNode only affects the leaf BgpOList of replicators
+// with the replicator-address of the leaf. Adding a regular EvpnMcastNode
+// affects the BgpOList of all ingress replication clients, while adding an
+// EvpnMcastNode that supports edge replication only affects the BgpOList of
+// ingress replication clients that don't support edge replication.
+//
 void EvpnManagerPartition::AddMcastNode(EvpnMcastNode *node) {
     if (node->type() == EvpnMcastNode::LocalNode) {
         local_mcast_node_list_.insert(node);
@@ -369,11 +364,12 @@ void EvpnManagerPartition::AddMcastNode(EvpnMcastNode *node) {
         remote_mcast_node_list_.insert(node);
         if (node->assisted_replication_leaf()) {
             leaf_node_list_.insert(node);
-            NotifyReplicatorNodeRoutes();
+            NotifyReplicatorNodeRoutes(node->replicator_address());
         } else if (node->edge_replication_not_supported()) {
             regular_node_list_.insert(node);
+            regular_olist_.reset();
             NotifyIrClientNodeRoutes(false);
-        } else if (!node->assisted_replication_leaf()) {
+        } else {
             NotifyIrClientNodeRoutes(true);
         }
     }
@@ -390,12 +386,13 @@ void EvpnManagerPartition::DeleteMcastNode(EvpnMcastNode *node) {
     } else {
         remote_mcast_node_list_.erase(node);
         if (leaf_node_list_.erase(node) > 0) {
-            NotifyReplicatorNodeRoutes();
+            NotifyReplicatorNodeRoutes(node->replicator_address());
+        } else if (regular_node_list_.erase(node) > 0) {
+            regular_olist_.reset();
+            NotifyIrClientNodeRoutes(false);
         } else {
             NotifyIrClientNodeRoutes(true);
         }
-        if (regular_node_list_.erase(node) > 0)
-            NotifyIrClientNodeRoutes(false);
     }
     if (empty())
         evpn_manager_->RetryDelete();
@@ -406,6 +403,9 @@ void EvpnManagerPartition::DeleteMcastNode(EvpnMcastNode *node) {
 // Need to remove/add EvpnMcastNode from the replicator, leaf and ir client
 // lists as appropriate.
 //
+// The previous replicator-address of a leaf EvpnMcastNode is not known, so
+// all replicators are notified if the EvpnMcastNode is or was a leaf.
+//
 void EvpnManagerPartition::UpdateMcastNode(EvpnMcastNode *node) {
     node->TriggerUpdate();
     if (node->type() == EvpnMcastNode::LocalNode) {
@@ -422,14 +422,111 @@ void EvpnManagerPartition::UpdateMcastNode(EvpnMcastNode *node) {
             leaf_node_list_.insert(node);
         if (was_leaf || node->assisted_replication_leaf())
             NotifyReplicatorNodeRoutes();
-        if (!was_leaf || !node->assisted_replication_leaf())
-            NotifyIrClientNodeRoutes(true);
+
         bool was_regular = regular_node_list_.erase(node) > 0;
-        if (node->edge_replication_not_supported())
+        bool is_regular = !node->assisted_replication_leaf() &&
+            node->edge_replication_not_supported();
+        if (is_regular)
             regular_node_list_.insert(node);
-        if (was_regular || node->edge_replication_not_supported())
+        if (was_regular || is_regular) {
+            regular_olist_.reset();
             NotifyIrClientNodeRoutes(false);
+        } else if (!was_leaf || !node->assisted_replication_leaf()) {
+            NotifyIrClientNodeRoutes(true);
+        }
+    }
+}
+
+//
+// Build a BgpOListElem for the given EvpnMcastNode.
+//
+static BgpOListElem BuildOListElem(const EvpnMcastNode *node) {
+    const ExtCommunity *extcomm = node->attr()->ext_community();
+    return BgpOListElem(node->address(), node->label(),
+        extcomm ? extcomm->GetTunnelEncap() : vector<string>());
+}
+
+//
+// Return true if the BgpOList has an element with the given address. The
+// elements in a BgpOList are sorted by address.
+//
+static bool OListHasAddress(const BgpOList *olist, Ip4Address address) {
+    BgpOListElem key(address, 0);
+    BgpOList::Elements::const_iterator it = lower_bound(
+        olist->elements().begin(), olist->elements().end(), &key,
+        BgpOListElemCompare());
+    return it != olist->elements().end() && (*it)->address == address;
+}
+
+//
+// Get the BgpOList with all regular EvpnMcastNodes. It's only built after
+// a change to the regular EvpnMcastNodes when it is first needed, and is
+// shared by the ingress replication clients that support edge replication.
+//
+BgpOListPtr EvpnManagerPartition::GetRegularOList() {
+    if (regular_olist_)
+        return regular_olist_;
+
+    BgpOListSpec olist_spec(BgpAttribute::OList);
+    BOOST_FOREACH(const EvpnMcastNode *node, regular_node_list_) {
+        olist_spec.elements.push_back(BuildOListElem(node));
+    }
+    olist_node_count_ += regular_node_list_.size();
+    regular_olist_ = server()->olist_db()->Locate(olist_spec);
+    return regular_olist_;
+}
+
+//
+// Get the ingress replication BgpOList for the given EvpnLocalMcastNode.
+//
+// An EvpnLocalMcastNode that supports edge replication only needs to send
+// to the regular EvpnMcastNodes, so it uses the shared BgpOList unless it
+// contains the address of the EvpnLocalMcastNode itself. Otherwise, build
+// a BgpOList from all EvpnMcastNodes with a different address, excluding
+// leaf EvpnMcastNodes.
+//
+BgpOListPtr EvpnManagerPartition::GetOList(const EvpnMcastNode *local_node) {
+    CHECK_CONCURRENCY("db::DBTable");
+
+    const EvpnMcastNodeList *node_list = &remote_mcast_node_list_;
+    if (!local_node->edge_replication_not_supported()) {
+        BgpOListPtr olist = GetRegularOList();
+        if (!OListHasAddress(olist.get(), local_node->address()))
+            return olist;
+        node_list = &regular_node_list_;
+    }
+
+    BgpOListSpec olist_spec(BgpAttribute::OList);
+    BOOST_FOREACH(const EvpnMcastNode *node, *node_list) {
+        if (node->address() == local_node->address())
+            continue;
+        if (node->assisted_replication_leaf())
+            continue;
+        olist_spec.elements.push_back(BuildOListElem(node));
+    }
+    olist_node_count_ += node_list->size();
+    return server()->olist_db()->Locate(olist_spec);
+}
+
+//
+// Get the leaf BgpOList for the given EvpnLocalMcastNode. It's empty unless
+// the EvpnLocalMcastNode is a replicator, in which case it has the leaf
+// EvpnMcastNodes with a replicator-address of the EvpnLocalMcastNode.
+//
+BgpOListPtr EvpnManagerPartition::GetLeafOList(
+    const EvpnMcastNode *local_node) {
+    CHECK_CONCURRENCY("db::DBTable");
+
+    BgpOListSpec leaf_olist_spec(BgpAttribute::LeafOList);
+    if (local_node->assisted_replication_supported()) {
+        BOOST_FOREACH(const EvpnMcastNode *node, leaf_node_list_) {
+            if (node->replicator_address() != local_node->address())
+                continue;
+            leaf_olist_spec.elements.push_back(BuildOListElem(node));
+        }
+        olist_node_count_ += leaf_node_list_.size();
     }
+    return server()->olist_db()->Locate(leaf_olist_spec);
 }
 
 //
@@ -142,6 +142,13 @@ private:
 // track of local and remote EvpnMcastNodes that belong to the partition. The
 // partition is determined on the ethernet tag in the EvpnRoute.
 //
+// A change to a remote EvpnMcastNode only results in notification of the
+// Broadcast MAC routes of EvpnLocalMcastNodes whose OLists can be affected
+// by the change.  Note that every ingress replication client that supports
+// edge replication gets the same OList i.e. the one with all the regular
+// nodes.  This OList is built once after a change to the regular nodes and
+// is then shared by all such clients.
+//
 class EvpnManagerPartition {
 public:
     typedef std::set<EvpnMcastNode *> EvpnMcastNodeList;
@@ -152,10 +159,13 @@ public:
     DBTablePartition *GetTablePartition();
     void NotifyNodeRoute(EvpnMcastNode *node);
     void NotifyReplicatorNodeRoutes();
+    void NotifyReplicatorNodeRoutes(Ip4Address replicator_address);
     void NotifyIrClientNodeRoutes(bool exclude_edge_replication_supported);
     void AddMcastNode(EvpnMcastNode *node);
     void DeleteMcastNode(EvpnMcastNode *node);
     void UpdateMcastNode(EvpnMcastNode *node);
+    BgpOListPtr GetOList(const EvpnMcastNode *local_node);
+    BgpOListPtr GetLeafOList(const EvpnMcastNode *local_node);
 
     bool empty() const;
     const EvpnMcastNodeList &remote_mcast_node_list() const {
@@ -167,12 +177,19 @@ public:
     const EvpnMcastNodeList &leaf_node_list() const {
         return leaf_node_list_;
     }
+    const EvpnMcastNodeList &regular_node_list() const {
+        return regular_node_list_;
+    }
+    uint64_t notify_count() const { return notify_count_; }
+    uint64_t olist_node_count() const { return olist_node_count_; }
     BgpServer *server();
     const EvpnTable *table() const;
 
 private:
     friend class BgpEvpnManagerTest;
 
+    BgpOListPtr GetRegularOList();
+
     EvpnManager *evpn_manager_;
     size_t part_id_;
     EvpnMcastNodeList local_mcast_node_list_;
@@ -182,6 +199,14 @@ private:
     EvpnMcastNodeList regular_node_list_;
     EvpnMcastNodeList ir_client_node_list_;
 
+    // OList with all regular nodes, NULL until needed after a change
+    BgpOListPtr regular_olist_;
+
+    // Number of Broadcast MAC route notifications and of EvpnMcastNodes
+    // visited to build OLists, to keep track of the work done per change
+    uint64_t notify_count_;
+    uint64_t olist_node_count_;
+
     DISALLOW_COPY_AND_ASSIGN(EvpnManagerPartition);
 };
 
@@ -235,6 +260,7 @@ public:
 
 private:
     friend class BgpEvpnManagerTest;
+    friend class EvpnManagerScaleTest;
 
     class DeleteActor;
     typedef std::vector<EvpnManagerPartition *> PartitionList;
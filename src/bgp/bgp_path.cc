@@ -22,24 +22,42 @@ BgpPath::BgpPath(const IPeer *peer, uint32_t path_id, PathSource src,
                  const BgpAttrPtr ptr, uint32_t flags, uint32_t label)
     : peer_(peer), path_id_(path_id), source_(src), attr_(ptr),
       original_attr_(ptr), flags_(flags), label_(label) {
+    UpdateSelectionKey();
 }
 
 BgpPath::BgpPath(const IPeer *peer, PathSource src, const BgpAttrPtr ptr,
         uint32_t flags, uint32_t label)
     : peer_(peer), path_id_(0), source_(src), attr_(ptr), original_attr_(ptr),
       flags_(flags), label_(label) {
+    UpdateSelectionKey();
 }
 
 BgpPath::BgpPath(uint32_t path_id, PathSource src, const BgpAttrPtr ptr,
         uint32_t flags, uint32_t label)
     : peer_(NULL), path_id_(path_id), source_(src), attr_(ptr),
       original_attr_(ptr), flags_(flags), label_(label) {
+    UpdateSelectionKey();
 }
 
 BgpPath::BgpPath(PathSource src, const BgpAttrPtr ptr,
         uint32_t flags, uint32_t label)
     : peer_(NULL), path_id_(0), source_(src), attr_(ptr), original_attr_(ptr),
       flags_(flags), label_(label) {
+    UpdateSelectionKey();
+}
+
+void BgpPath::UpdateSelectionKey() {
+    pref_key_ = IsFeasible() ? (1ULL << 32) : 0;
+    seq_key_ = IsLlgrStale() ? 0 : 1;
+    if (!attr_) {
+        return;
+    }
+    pref_key_ |= attr_->local_pref();
+    seq_key_ |= static_cast<uint64_t>(attr_->sequence_number()) << 1;
+    if (attr_->community() &&
+        attr_->community()->ContainsValue(CommunityType::LlgrStale)) {
+        seq_key_ &= ~1ULL;
+    }
 }
 
 // True is better
@@ -55,25 +73,11 @@ BgpPath::BgpPath(PathSource src, const BgpAttrPtr ptr,
 int BgpPath::PathCompare(const BgpPath &rhs, bool allow_ecmp) const {
     const BgpAttr *rattr = rhs.GetAttr();
 
-    // Feasible Path first
-    KEY_COMPARE(rhs.IsFeasible(), IsFeasible());
-
-    // Compare local_pref in reverse order as larger is better.
-    KEY_COMPARE(rattr->local_pref(), attr_->local_pref());
-
-    // Compare sequence_number in reverse order as larger is better.
-    KEY_COMPARE(rattr->sequence_number(), attr_->sequence_number());
-
-    // Route without LLGR_STALE community is always preferred over one with.
-    bool llgr_stale = attr_->community() && attr_->community()->ContainsValue(
-                                                CommunityType::LlgrStale);
-    llgr_stale |= IsLlgrStale();
-
-    bool rllgr_stale = rattr->community() && rattr->community()->ContainsValue(
-                                                 CommunityType::LlgrStale);
-    rllgr_stale |= rhs.IsLlgrStale();
-
-    KEY_COMPARE(llgr_stale, rllgr_stale);
+    // Feasible Path first, then larger local_pref, then larger
+    // sequence_number. Route without LLGR_STALE community is always preferred
+    // over one with. Compare in reverse order as larger key is better.
+    KEY_COMPARE(rhs.pref_key_, pref_key_);
+    KEY_COMPARE(rhs.seq_key_, seq_key_);
 
     // Do not compare as path length for service chain paths at this point.
     // We want to treat service chain paths as ECMP irrespective of as path
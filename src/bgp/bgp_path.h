@@ -76,6 +76,7 @@ public:
     void SetAttr(const BgpAttrPtr attr, const BgpAttrPtr original_attr) {
         attr_ = attr;
         original_attr_ = original_attr;
+        UpdateSelectionKey();
     }
 
     const BgpAttr *GetAttr() const { return attr_.get(); }
@@ -102,10 +103,16 @@ public:
     bool IsLlgrStale() const { return ((flags_ & LlgrStale) != 0); }
 
     // Mark a path as rejected by Routing policy
-    void SetPolicyReject() { flags_ |= RoutingPolicyReject; }
+    void SetPolicyReject() {
+        flags_ |= RoutingPolicyReject;
+        UpdateSelectionKey();
+    }
 
     // Reset a path as active from Routing Policy
-    void ResetPolicyReject() { flags_ &= ~RoutingPolicyReject; }
+    void ResetPolicyReject() {
+        flags_ &= ~RoutingPolicyReject;
+        UpdateSelectionKey();
+    }
 
     bool IsPolicyReject() const {
         return ((flags_ & RoutingPolicyReject) != 0);
@@ -117,8 +124,14 @@ public:
     // Reset a path as active (not stale)
     void ResetStale() { flags_ &= ~Stale; }
 
-    void SetLlgrStale() { flags_ |= LlgrStale; }
-    void ResetLlgrStale() { flags_ &= ~LlgrStale; }
+    void SetLlgrStale() {
+        flags_ |= LlgrStale;
+        UpdateSelectionKey();
+    }
+    void ResetLlgrStale() {
+        flags_ &= ~LlgrStale;
+        UpdateSelectionKey();
+    }
 
     bool NeedsResolution() const { return ((flags_ & ResolveNexthop) != 0); }
 
@@ -129,6 +142,8 @@ public:
     bool PathSameNeighborAs(const BgpPath &rhs) const;
 
 private:
+    void UpdateSelectionKey();
+
     const IPeer *peer_;
     const uint32_t path_id_;
     const PathSource source_;
@@ -139,6 +154,12 @@ private:
     BgpAttrPtr original_attr_;
     uint32_t flags_;
     uint32_t label_;
+    // The first criteria of path selection, packed such that the larger key
+    // is the better path: feasibility and local preference in pref_key_,
+    // sequence number and absence of LLGR stale in seq_key_. Kept up to date
+    // with attr_ and flags_ so that PathCompare need not look them up.
+    uint64_t pref_key_;
+    uint64_t seq_key_;
 };
 
 class BgpSecondaryPath : public BgpPath {
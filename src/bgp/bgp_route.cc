@@ -43,16 +43,13 @@ const BgpPath *BgpRoute::BestPath() const {
 //
 void BgpRoute::InsertPath(BgpPath *path) {
     assert(!IsDeleted());
-    const Path *prev_front = front();
 
     BgpTable *table = static_cast<BgpTable *>(get_table());
     if (table && table->IsRoutingPolicySupported()) {
         RoutingInstance *rtinstance = table->routing_instance();
         rtinstance->ProcessRoutingPolicy(this, path);
     }
-    insert(path);
-
-    Sort(&BgpTable::PathSelection, prev_front);
+    InsertSorted(path, &BgpTable::PathSelection);
 
     // Update counters.
     if (table) table->UpdatePathCount(path, +1);
@@ -63,10 +60,7 @@ void BgpRoute::InsertPath(BgpPath *path) {
 // Delete given path and redo path selection.
 //
 void BgpRoute::DeletePath(BgpPath *path) {
-    const Path *prev_front = front();
-
-    remove(path);
-    Sort(&BgpTable::PathSelection, prev_front);
+    RemoveSorted(path);
 
     // Update counters.
     BgpTable *table = static_cast<BgpTable *>(get_table());
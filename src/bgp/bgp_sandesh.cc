@@ -17,6 +17,7 @@
 #include "bgp/inet/inet_table.h"
 #include "bgp/routing-instance/peer_manager.h"
 #include "bgp/routing-instance/routing_instance.h"
+#include "io/event_manager.h"
 
 using boost::assign::list_of;
 using std::string;
@@ -415,6 +416,11 @@ public:
         bsc->bgp_server->session_manager()->GetTxSocketStats(&peer_socket_stats);
         resp->set_tx_socket_stats(peer_socket_stats);
 
+        vector<EventManagerShardStats> shard_stats;
+        bsc->bgp_server->session_manager()->event_manager()->GetShardStats(
+            &shard_stats);
+        resp->set_shard_stats(shard_stats);
+
         resp->set_context(req->context());
         resp->Response();
         return true;
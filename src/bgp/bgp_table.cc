@@ -387,8 +387,8 @@ UpdateInfo *BgpTable::GetUpdateInfo(RibOut *ribout, BgpRoute *route,
 // Bgp Path selection..
 // Based Attribute weight
 bool BgpTable::PathSelection(const Path &path1, const Path &path2) {
-    const BgpPath &l_path = dynamic_cast<const BgpPath &> (path1);
-    const BgpPath &r_path = dynamic_cast<const BgpPath &> (path2);
+    const BgpPath &l_path = static_cast<const BgpPath &> (path1);
+    const BgpPath &r_path = static_cast<const BgpPath &> (path2);
 
     // Check the weight of Path
     bool res = l_path.PathCompare(r_path, false) < 0;
@@ -35,6 +35,7 @@
 #include "control-node/sandesh/control_node_types.h"
 #include "net/community_type.h"
 #include "schema/xmpp_multicast_types.h"
+#include "schema/xmpp_unicast_types.h"
 #include "schema/xmpp_enet_types.h"
 #include "xml/xml_pugi.h"
 #include "xmpp/xmpp_connection.h"
@@ -52,10 +53,13 @@ using autogen::McastNextHopsType;
 using autogen::McastTunnelEncapsulationListType;
 
 using autogen::ItemType;
-using autogen::NextHopListType;
-using autogen::SecurityGroupListType;
-using autogen::CommunityTagListType;
-using autogen::TunnelEncapsulationListType;
+
+// Route items in the xmpp unicast format are decoded into the channel's
+// BgpXmppUnicastItem rather than into autogen::ItemType.
+typedef BgpXmppUnicastItem::NextHopList NextHopListType;
+typedef BgpXmppUnicastItem::IntList SecurityGroupListType;
+typedef BgpXmppUnicastItem::StringList CommunityTagListType;
+typedef BgpXmppUnicastItem::StringList TunnelEncapsulationListType;
 
 using boost::assign::list_of;
 using boost::regex;
@@ -478,6 +482,7 @@ BgpXmppChannel::BgpXmppChannel(XmppChannel *channel,
       skip_update_send_(false),
       skip_update_send_cached_(false),
       eor_sent_(false),
+      autogen_decode_(getenv("BGP_XMPP_AUTOGEN_DECODE") != NULL),
       eor_receive_timer_(NULL),
       eor_send_timer_(NULL),
       eor_receive_timer_start_time_(0),
@@ -892,12 +897,29 @@ bool BgpXmppChannel::ProcessMcastItem(string vrf_name,
     return true;
 }
 
+//
+// Decode an inet or inet6 route item into the given scratch item. Items are
+// decoded straight from the xml node unless BGP_XMPP_AUTOGEN_DECODE is set
+// in the environment, in which case they go through autogen::ItemType. The
+// latter is used to run the tests against both decoders.
+//
+bool BgpXmppChannel::ParseUnicastItem(const pugi::xml_node &node,
+    BgpXmppUnicastItem *item) {
+    if (!autogen_decode_)
+        return item->XmlParse(node);
+
+    ItemType autogen_item;
+    autogen_item.Clear();
+    if (!autogen_item.XmlParse(node))
+        return false;
+    item->Copy(autogen_item);
+    return true;
+}
+
 bool BgpXmppChannel::ProcessItem(string vrf_name,
     const pugi::xml_node &node, bool add_change) {
-    ItemType item;
-    item.Clear();
-
-    if (!item.XmlParse(node)) {
+    BgpXmppUnicastItem &item = unicast_item_;
+    if (!ParseUnicastItem(node, &item)) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Invalid inet route message received");
         return false;
@@ -919,7 +941,7 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
         return false;
     }
 
-    if (add_change && item.entry.next_hops.next_hop.empty()) {
+    if (add_change && item.entry.next_hops.empty()) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Missing next-hops for inet route " << inet_prefix.ToString());
         return false;
@@ -1161,10 +1183,8 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
 
 bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
     const pugi::xml_node &node, bool add_change) {
-    ItemType item;
-    item.Clear();
-
-    if (!item.XmlParse(node)) {
+    BgpXmppUnicastItem &item = unicast_item_;
+    if (!ParseUnicastItem(node, &item)) {
         error_stats().incr_inet6_rx_bad_xml_token_count();
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Invalid inet6 route message received");
@@ -1197,7 +1217,7 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
         return false;
     }
 
-    if (add_change && item.entry.next_hops.next_hop.empty()) {
+    if (add_change && item.entry.next_hops.empty()) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Missing next-hops for inet6 route " << inet6_prefix.ToString());
         return false;
@@ -17,6 +17,7 @@
 
 #include "base/queue_task.h"
 #include "bgp/bgp_rib_policy.h"
+#include "bgp/bgp_xmpp_item.h"
 #include "bgp/routing-instance/routing_instance.h"
 #include "io/tcp_session.h"
 #include "net/rd.h"
@@ -260,6 +261,8 @@ private:
         BgpTable **table, int *instance_id, uint64_t *subscribed_at,
         bool *subscribe_pending, bool add_change);
 
+    bool ParseUnicastItem(const pugi::xml_node &node,
+                          BgpXmppUnicastItem *item);
     bool ProcessItem(std::string vrf_name, const pugi::xml_node &node,
                      bool add_change);
     bool ProcessInet6Item(std::string vrf_name, const pugi::xml_node &node,
@@ -314,6 +317,7 @@ private:
     bool skip_update_send_;
     bool skip_update_send_cached_;
     bool eor_sent_;
+    bool autogen_decode_;
     Timer *eor_receive_timer_;
     Timer *eor_send_timer_;
     uint64_t eor_receive_timer_start_time_;
@@ -321,6 +325,10 @@ private:
     WorkQueue<std::string> membership_response_worker_;
     SubscribedRoutingInstanceList routing_instances_;
 
+    // Scratch storage for inet and inet6 route items, reused for every
+    // item received on the channel.
+    BgpXmppUnicastItem unicast_item_;
+
     // statistics
     Stats stats_[2];
     ChannelStats channel_stats_;
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "bgp/bgp_xmpp_item.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pugixml/pugixml.hpp>
+
+#include "schema/xmpp_unicast_types.h"
+
+using pugi::xml_node;
+using std::string;
+
+namespace {
+
+// Integers and strings are read the same way as the autogen parser does:
+// integers must be followed by nothing but whitespace and strings are
+// trimmed.
+bool ParseInteger(const xml_node &node, int *valuep) {
+    const char *value = node.child_value();
+    char *endp;
+    *valuep = strtoul(value, &endp, 10);
+    while (isspace(*endp))
+        endp++;
+    return endp[0] == '\0';
+}
+
+void ParseString(const xml_node &node, string *valuep) {
+    const char *begin = node.child_value();
+    while (isspace(*begin))
+        begin++;
+    const char *end = begin + strlen(begin);
+    while (end > begin && isspace(end[-1]))
+        end--;
+    valuep->assign(begin, end - begin);
+}
+
+bool NodeIs(const xml_node &node, const char *name) {
+    return strcmp(node.name(), name) == 0;
+}
+
+bool ParseNlri(const xml_node &node, BgpXmppUnicastItem::Nlri *nlri) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NodeIs(child, "af")) {
+            if (!ParseInteger(child, &nlri->af))
+                return false;
+        } else if (NodeIs(child, "safi")) {
+            if (!ParseInteger(child, &nlri->safi))
+                return false;
+        } else if (NodeIs(child, "address")) {
+            ParseString(child, &nlri->address);
+        }
+    }
+    return true;
+}
+
+void ParseStringList(const xml_node &node, const char *name,
+    BgpXmppUnicastItem::StringList *list) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NodeIs(child, name))
+            ParseString(child, list->Add());
+    }
+}
+
+bool ParseNextHop(const xml_node &node, BgpXmppUnicastItem::NextHop *nh) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NodeIs(child, "af")) {
+            if (!ParseInteger(child, &nh->af))
+                return false;
+        } else if (NodeIs(child, "address")) {
+            ParseString(child, &nh->address);
+        } else if (NodeIs(child, "mac")) {
+            ParseString(child, &nh->mac);
+        } else if (NodeIs(child, "label")) {
+            if (!ParseInteger(child, &nh->label))
+                return false;
+        } else if (NodeIs(child, "vni")) {
+            if (!ParseInteger(child, &nh->vni))
+                return false;
+        } else if (NodeIs(child, "tunnel-encapsulation-list")) {
+            ParseStringList(child, "tunnel-encapsulation",
+                &nh->tunnel_encapsulation_list);
+        }
+    }
+    return true;
+}
+
+bool ParseNextHops(const xml_node &node,
+    BgpXmppUnicastItem::NextHopList *list) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (!NodeIs(child, "next-hop"))
+            continue;
+        BgpXmppUnicastItem::NextHop *nh = list->Add();
+        nh->Clear();
+        if (!ParseNextHop(child, nh))
+            return false;
+    }
+    return true;
+}
+
+bool ParseSecurityGroups(const xml_node &node,
+    BgpXmppUnicastItem::IntList *list) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NodeIs(child, "security-group") &&
+            !ParseInteger(child, list->Add())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Builds the attribute in the same way as the LoadBalance constructor that
+// takes an autogen::LoadBalanceType.
+void ParseLoadBalance(const xml_node &node,
+    LoadBalance::LoadBalanceAttribute *attr) {
+    string decision("field-hash");
+    xml_node fields;
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NodeIs(child, "load-balance-fields")) {
+            fields = child;
+        } else if (NodeIs(child, "load-balance-decision")) {
+            ParseString(child, &decision);
+        }
+    }
+
+    LoadBalance::LoadBalanceAttribute &lba = *attr;
+    lba = LoadBalance::LoadBalanceAttribute();
+    lba.source_bias = (decision == "source-bias");
+
+    // An empty field list means the standard 5-tuple, unless the decision
+    // is source bias.
+    bool load_balance_default =
+        !lba.source_bias && !fields.child("load-balance-field-list");
+    lba.l3_source_address = load_balance_default;
+    lba.l3_destination_address = load_balance_default;
+    lba.l4_protocol = load_balance_default;
+    lba.l4_source_port = load_balance_default;
+    lba.l4_destination_port = load_balance_default;
+
+    string field;
+    for (xml_node child = fields.first_child(); child;
+         child = child.next_sibling()) {
+        if (!NodeIs(child, "load-balance-field-list"))
+            continue;
+        ParseString(child, &field);
+        if (field == "l3-source-address") {
+            lba.l3_source_address = true;
+        } else if (field == "l3-destination-address") {
+            lba.l3_destination_address = true;
+        } else if (field == "l4-protocol") {
+            lba.l4_protocol = true;
+        } else if (field == "l4-source-port") {
+            lba.l4_source_port = true;
+        } else if (field == "l4-destination-port") {
+            lba.l4_destination_port = true;
+        }
+    }
+}
+
+}  // namespace
+
+void BgpXmppUnicastItem::NextHop::Clear() {
+    af = 0;
+    address.clear();
+    mac.clear();
+    label = 0;
+    vni = 0;
+    tunnel_encapsulation_list.Clear();
+}
+
+BgpXmppUnicastItem::BgpXmppUnicastItem() {
+    Clear();
+}
+
+void BgpXmppUnicastItem::Clear() {
+    entry.nlri.af = 0;
+    entry.nlri.safi = 0;
+    entry.nlri.address.clear();
+    entry.next_hops.Clear();
+    entry.version = 0;
+    entry.sequence_number = 0;
+    entry.security_group_list.Clear();
+    entry.community_tag_list.Clear();
+    entry.local_preference = 0;
+    entry.med = 0;
+    entry.load_balance = LoadBalance::LoadBalanceAttribute();
+}
+
+//
+// Decode the item node. The entry element is the only one that is looked
+// at, and elements in it that route processing doesn't use are skipped.
+// The version is decoded only so that a bad one fails the item, as it does
+// with the autogen parser.
+//
+bool BgpXmppUnicastItem::XmlParse(const xml_node &node) {
+    Clear();
+    xml_node entry_node = node.child("entry");
+    if (!entry_node)
+        return true;
+
+    for (xml_node child = entry_node.first_child(); child;
+         child = child.next_sibling()) {
+        bool valid = true;
+        if (NodeIs(child, "nlri")) {
+            valid = ParseNlri(child, &entry.nlri);
+        } else if (NodeIs(child, "next-hops")) {
+            valid = ParseNextHops(child, &entry.next_hops);
+        } else if (NodeIs(child, "version")) {
+            valid = ParseInteger(child, &entry.version);
+        } else if (NodeIs(child, "sequence-number")) {
+            valid = ParseInteger(child, &entry.sequence_number);
+        } else if (NodeIs(child, "security-group-list")) {
+            valid = ParseSecurityGroups(child, &entry.security_group_list);
+        } else if (NodeIs(child, "community-tag-list")) {
+            ParseStringList(child, "community-tag",
+                &entry.community_tag_list);
+        } else if (NodeIs(child, "local-preference")) {
+            valid = ParseInteger(child, &entry.local_preference);
+        } else if (NodeIs(child, "med")) {
+            valid = ParseInteger(child, &entry.med);
+        } else if (NodeIs(child, "load-balance")) {
+            ParseLoadBalance(child, &entry.load_balance);
+        }
+        if (!valid)
+            return false;
+    }
+    return true;
+}
+
+void BgpXmppUnicastItem::Copy(const autogen::ItemType &item) {
+    Clear();
+    entry.nlri.af = item.entry.nlri.af;
+    entry.nlri.safi = item.entry.nlri.safi;
+    entry.nlri.address = item.entry.nlri.address;
+
+    for (std::vector<autogen::NextHopType>::const_iterator nit =
+         item.entry.next_hops.begin();
+         nit != item.entry.next_hops.end(); ++nit) {
+        NextHop *nh = entry.next_hops.Add();
+        nh->Clear();
+        nh->af = nit->af;
+        nh->address = nit->address;
+        nh->mac = nit->mac;
+        nh->label = nit->label;
+        nh->vni = nit->vni;
+        for (std::vector<string>::const_iterator eit =
+             nit->tunnel_encapsulation_list.begin();
+             eit != nit->tunnel_encapsulation_list.end(); ++eit) {
+            *nh->tunnel_encapsulation_list.Add() = *eit;
+        }
+    }
+
+    entry.version = item.entry.version;
+    entry.sequence_number = item.entry.sequence_number;
+    for (std::vector<int>::const_iterator sit =
+         item.entry.security_group_list.begin();
+         sit != item.entry.security_group_list.end(); ++sit) {
+        *entry.security_group_list.Add() = *sit;
+    }
+    for (std::vector<string>::const_iterator cit =
+         item.entry.community_tag_list.begin();
+         cit != item.entry.community_tag_list.end(); ++cit) {
+        *entry.community_tag_list.Add() = *cit;
+    }
+    entry.local_preference = item.entry.local_preference;
+    entry.med = item.entry.med;
+    entry.load_balance = LoadBalance(item.entry.load_balance).ToAttribute();
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BGP_BGP_XMPP_ITEM_H_
+#define SRC_BGP_BGP_XMPP_ITEM_H_
+
+#include <string>
+#include <vector>
+
+#include "bgp/extended-community/load_balance.h"
+
+namespace pugi {
+class xml_node;
+}
+
+//
+// List that keeps its elements when cleared, so that the strings and lists
+// in them keep their capacity when the list is filled again. Add returns
+// the next element, which may hold the contents of an earlier use.
+//
+template <typename T>
+class BgpXmppItemList {
+public:
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    BgpXmppItemList() : size_(0) {
+    }
+
+    const_iterator begin() const { return list_.begin(); }
+    const_iterator end() const { return list_.begin() + size_; }
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+    T *Add() {
+        if (size_ == list_.size())
+            list_.push_back(T());
+        return &list_[size_++];
+    }
+    void Clear() { size_ = 0; }
+
+private:
+    std::vector<T> list_;
+    size_t size_;
+};
+
+//
+// Inet or inet6 route item in the xmpp unicast format, decoded straight
+// from the xml node without going through the autogen ItemType. Only the
+// elements that route processing looks at are decoded, and the layout of
+// the entry follows autogen::EntryType. A BgpXmppChannel reuses one item
+// for all the routes it receives.
+//
+// The item can also be filled in from an autogen::ItemType, which is used
+// to check that both decoders agree.
+//
+struct BgpXmppUnicastItem {
+    typedef BgpXmppItemList<int> IntList;
+    typedef BgpXmppItemList<std::string> StringList;
+
+    struct Nlri {
+        int af;
+        int safi;
+        std::string address;
+    };
+
+    struct NextHop {
+        void Clear();
+
+        int af;
+        std::string address;
+        std::string mac;
+        int label;
+        int vni;
+        StringList tunnel_encapsulation_list;
+    };
+    typedef BgpXmppItemList<NextHop> NextHopList;
+
+    struct Entry {
+        Nlri nlri;
+        NextHopList next_hops;
+        int version;
+        int sequence_number;
+        IntList security_group_list;
+        StringList community_tag_list;
+        int local_preference;
+        int med;
+        LoadBalance::LoadBalanceAttribute load_balance;
+    };
+
+    BgpXmppUnicastItem();
+
+    void Clear();
+    bool XmlParse(const pugi::xml_node &node);
+    void Copy(const autogen::ItemType &item);
+
+    Entry entry;
+};
+
+#endif  // SRC_BGP_BGP_XMPP_ITEM_H_
@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <boost/foreach.hpp>
+
+#include "base/task_annotations.h"
+#include "bgp/bgp_evpn.h"
+#include "bgp/bgp_factory.h"
+#include "bgp/bgp_ribout_updates.h"
+#include "bgp/bgp_update.h"
+#include "bgp/evpn/evpn_table.h"
+#include "bgp/origin-vn/origin_vn.h"
+#include "bgp/test/bgp_server_test_util.h"
+#include "bgp/xmpp_message_builder.h"
+#include "control-node/control_node.h"
+#include "io/test/event_manager_test.h"
+
+using namespace std;
+
+class PeerMock : public IPeer {
+public:
+    PeerMock(const Ip4Address address, bool is_xmpp, uint32_t label)
+        : address_(address), is_xmpp_(is_xmpp), label_(label) {
+        address_str_ = address.to_string();
+    }
+    virtual ~PeerMock() { }
+
+    Ip4Address address() { return address_; }
+    uint32_t label() { return label_; }
+
+    virtual const std::string &ToString() const { return address_str_; }
+    virtual const std::string &ToUVEKey() const { return address_str_; }
+    virtual bool SendUpdate(const uint8_t *msg, size_t msgsize) {
+        return true;
+    }
+    virtual BgpServer *server() { return NULL; }
+    virtual BgpServer *server() const { return NULL; }
+    virtual IPeerClose *peer_close() { return NULL; }
+    virtual IPeerClose *peer_close() const { return NULL; }
+    virtual void UpdateCloseRouteStats(Address::Family family,
+        const BgpPath *old_path, uint32_t path_flags) const {
+    }
+    virtual IPeerDebugStats *peer_stats() { return NULL; }
+    virtual const IPeerDebugStats *peer_stats() const { return NULL; }
+    virtual bool IsReady() const { return true; }
+    virtual bool IsXmppPeer() const { return is_xmpp_; }
+    virtual bool IsRegistrationRequired() const { return false; }
+    virtual void Close(bool graceful) { }
+    BgpProto::BgpPeerType PeerType() const { return BgpProto::IBGP; }
+    virtual uint32_t bgp_identifier() const {
+        return htonl(address_.to_ulong());
+    }
+    virtual const std::string GetStateName() const { return ""; }
+    virtual void UpdateTotalPathCount(int count) const { }
+    virtual int GetTotalPathCount() const { return 0; }
+    virtual void UpdatePrimaryPathCount(int count) const { }
+    virtual int GetPrimaryPathCount() const { return 0; }
+    virtual void MembershipRequestCallback(BgpTable *table) { }
+    virtual bool MembershipPathCallback(DBTablePartBase *tpart,
+        BgpRoute *route, BgpPath *path) { return false; }
+    virtual bool CanUseMembershipManager() const { return true; }
+    virtual bool IsInGRTimerWaitState() const { return false; }
+
+private:
+    Ip4Address address_;
+    bool is_xmpp_;
+    uint32_t label_;
+    std::string address_str_;
+};
+
+static const char *config_template = "\
+<config>\
+    <bgp-router name=\'local\'>\
+        <autonomous-system>64512</autonomous-system>\
+        <identifier>192.168.0.1</identifier>\
+        <address>127.0.0.1</address>\
+    </bgp-router>\
+    <virtual-network name='blue'>\
+        <network-id>1</network-id>\
+    </virtual-network>\
+    <routing-instance name='blue'>\
+        <virtual-network>blue</virtual-network>\
+        <vrf-target>target:64512:1</vrf-target>\
+    </routing-instance>\
+</config>\
+";
+
+static const size_t kVRouterCount = 256;
+static const size_t kPeCount = 4;
+
+//
+// Measure the work done by the EvpnManager for a single membership change
+// in a VN that spans many vRouters.  The work is the number of Broadcast
+// MAC route notifications and the number of EvpnMcastNodes visited while
+// building OLists.  Neither should grow with the square of the number of
+// vRouters.
+//
+class EvpnManagerScaleTest : public ::testing::Test {
+protected:
+    typedef boost::shared_ptr<UpdateInfo> UpdateInfoPtr;
+
+    static const int kVrfId = 1;
+    static const int kVnIndex = 1;
+
+    EvpnManagerScaleTest()
+        : thread_(&evm_),
+          blue_(NULL),
+          master_(NULL),
+          blue_manager_(NULL),
+          blue_ribout_(NULL) {
+    }
+
+    virtual void SetUp() {
+        server_.reset(new BgpServerTest(&evm_, "local"));
+        thread_.Start();
+        server_->Configure(config_template);
+        task_util::WaitForIdle();
+
+        DB *db = server_->database();
+        TASK_UTIL_EXPECT_TRUE(db->FindTable("bgp.evpn.0") != NULL);
+        master_ = static_cast<EvpnTable *>(db->FindTable("bgp.evpn.0"));
+        TASK_UTIL_EXPECT_TRUE(db->FindTable("blue.evpn.0") != NULL);
+        blue_ = static_cast<EvpnTable *>(db->FindTable("blue.evpn.0"));
+        blue_manager_ = blue_->GetEvpnManager();
+        RibExportPolicy policy(BgpProto::XMPP, RibExportPolicy::XMPP, 0, 0);
+        blue_ribout_ = blue_->RibOutLocate(server_->update_sender(), policy);
+
+        for (size_t idx = 0; idx < kVRouterCount; ++idx) {
+            Ip4Address address(0x0a010000 + idx + 1);
+            PeerMock *peer = new PeerMock(address, true, 1000 + idx);
+            xmpp_peers_.push_back(peer);
+            RibOutRegister(blue_ribout_, peer);
+        }
+        for (size_t idx = 0; idx < kPeCount; ++idx) {
+            Ip4Address address(0x14010100 + idx + 1);
+            bgp_peers_.push_back(new PeerMock(address, false, 200 + idx));
+        }
+
+        BOOST_FOREACH(PeerMock *peer, bgp_peers_) {
+            AddBgpPeerInclusiveMulticastRoute(peer);
+        }
+        BOOST_FOREACH(PeerMock *peer, xmpp_peers_) {
+            AddXmppPeerBroadcastMacRoute(peer);
+        }
+        task_util::WaitForIdle();
+        TASK_UTIL_EXPECT_EQ(kVRouterCount, GetPartitionLocalSize());
+        TASK_UTIL_EXPECT_EQ(kVRouterCount + kPeCount,
+            GetPartitionRemoteSize());
+    }
+
+    virtual void TearDown() {
+        BOOST_FOREACH(PeerMock *peer, xmpp_peers_) {
+            DelXmppPeerBroadcastMacRoute(peer);
+        }
+        BOOST_FOREACH(PeerMock *peer, bgp_peers_) {
+            DelBgpPeerInclusiveMulticastRoute(peer);
+        }
+        task_util::WaitForIdle();
+        BOOST_FOREACH(PeerMock *peer, xmpp_peers_) {
+            RibOutUnregister(blue_ribout_, peer);
+        }
+        STLDeleteValues(&xmpp_peers_);
+        STLDeleteValues(&bgp_peers_);
+
+        server_->Shutdown();
+        task_util::WaitForIdle();
+        evm_.Shutdown();
+        thread_.Join();
+        task_util::WaitForIdle();
+    }
+
+    void RibOutRegister(RibOut *ribout, PeerMock *peer) {
+        ConcurrencyScope scope("bgp::PeerMembership");
+        ribout->Register(peer);
+    }
+
+    void RibOutUnregister(RibOut *ribout, PeerMock *peer) {
+        ConcurrencyScope scope("bgp::PeerMembership");
+        ribout->Deactivate(peer);
+        ribout->Unregister(peer);
+    }
+
+    void AddXmppPeerBroadcastMacRoute(PeerMock *peer) {
+        RouteDistinguisher rd(peer->address().to_ulong(), kVrfId);
+        EvpnPrefix prefix(rd, 0, MacAddress::BroadcastMac(), IpAddress());
+
+        BgpAttrSpec attr_spec;
+        ExtCommunitySpec ext_comm;
+        OriginVn origin_vn(server_->autonomous_system(), kVnIndex);
+        ext_comm.communities.push_back(origin_vn.GetExtCommunityValue());
+        attr_spec.push_back(&ext_comm);
+        BgpAttrNextHop nexthop(peer->address().to_ulong());
+        attr_spec.push_back(&nexthop);
+        PmsiTunnelSpec pmsi_spec;
+        pmsi_spec.tunnel_flags = PmsiTunnelSpec::EdgeReplicationSupported;
+        pmsi_spec.tunnel_type = PmsiTunnelSpec::IngressReplication;
+        pmsi_spec.SetLabel(peer->label());
+        pmsi_spec.SetIdentifier(peer->address());
+        attr_spec.push_back(&pmsi_spec);
+        BgpAttrPtr attr = server_->attr_db()->Locate(attr_spec);
+
+        DBRequest addReq;
+        addReq.key.reset(new EvpnTable::RequestKey(prefix, peer));
+        addReq.data.reset(new EvpnTable::RequestData(attr, 0, peer->label()));
+        addReq.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
+        blue_->Enqueue(&addReq);
+    }
+
+    void DelXmppPeerBroadcastMacRoute(PeerMock *peer) {
+        RouteDistinguisher rd(peer->address().to_ulong(), kVrfId);
+        EvpnPrefix prefix(rd, 0, MacAddress::BroadcastMac(), IpAddress());
+
+        DBRequest delReq;
+        delReq.key.reset(new EvpnTable::RequestKey(prefix, peer));
+        delReq.oper = DBRequest::DB_ENTRY_DELETE;
+        blue_->Enqueue(&delReq);
+    }
+
+    void AddBgpPeerInclusiveMulticastRoute(PeerMock *peer) {
+        RouteDistinguisher rd(peer->address().to_ulong(), kVrfId);
+        EvpnPrefix prefix(rd, 0, peer->address());
+
+        BgpAttrSpec attr_spec;
+        ExtCommunitySpec ext_comm;
+        RouteTarget rtarget = RouteTarget::FromString("target:64512:1");
+        ext_comm.communities.push_back(rtarget.GetExtCommunityValue());
+        attr_spec.push_back(&ext_comm);
+        BgpAttrNextHop nexthop(peer->address().to_ulong());
+        attr_spec.push_back(&nexthop);
+        PmsiTunnelSpec pmsi_spec;
+        pmsi_spec.tunnel_flags = 0;
+        pmsi_spec.tunnel_type = PmsiTunnelSpec::IngressReplication;
+        pmsi_spec.SetLabel(peer->label());
+        pmsi_spec.SetIdentifier(peer->address());
+        attr_spec.push_back(&pmsi_spec);
+        BgpAttrPtr attr = server_->attr_db()->Locate(attr_spec);
+
+        DBRequest addReq;
+        addReq.key.reset(new EvpnTable::RequestKey(prefix, peer));
+        addReq.data.reset(new EvpnTable::RequestData(attr, 0, peer->label()));
+        addReq.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
+        master_->Enqueue(&addReq);
+    }
+
+    void DelBgpPeerInclusiveMulticastRoute(PeerMock *peer) {
+        RouteDistinguisher rd(peer->address().to_ulong(), kVrfId);
+        EvpnPrefix prefix(rd, 0, peer->address());
+
+        DBRequest delReq;
+        delReq.key.reset(new EvpnTable::RequestKey(prefix, peer));
+        delReq.oper = DBRequest::DB_ENTRY_DELETE;
+        master_->Enqueue(&delReq);
+    }
+
+    EvpnManagerPartition *GetPartition() {
+        return blue_manager_->partitions_[0];
+    }
+
+    size_t GetPartitionLocalSize() {
+        return GetPartition()->local_mcast_node_list().size();
+    }
+
+    size_t GetPartitionRemoteSize() {
+        return GetPartition()->remote_mcast_node_list().size();
+    }
+
+    // Returns the size of the OList for the vRouter, 0 if there's none
+    size_t GetOListSize(PeerMock *peer) {
+        ConcurrencyScope scope("db::DBTable");
+        RouteDistinguisher rd(peer->address().to_ulong(), kVrfId);
+        EvpnPrefix prefix(rd, 0, MacAddress::BroadcastMac(), IpAddress());
+        EvpnTable::RequestKey key(prefix, peer);
+        EvpnRoute *rt = dynamic_cast<EvpnRoute *>(blue_->Find(&key));
+        if (rt == NULL)
+            return 0;
+        UpdateInfoPtr uinfo(blue_manager_->GetUpdateInfo(rt));
+        if (uinfo == NULL)
+            return 0;
+        return uinfo->roattr.attr()->olist()->elements().size();
+    }
+
+    EventManager evm_;
+    ServerThread thread_;
+    BgpServerTestPtr server_;
+    EvpnTable *blue_;
+    EvpnTable *master_;
+    EvpnManager *blue_manager_;
+    RibOut *blue_ribout_;
+    vector<PeerMock *> bgp_peers_;
+    vector<PeerMock *> xmpp_peers_;
+};
+
+//
+// A vRouter goes away and comes back. The OLists of other vRouters that
+// support edge replication are not affected, so their Broadcast MAC routes
+// should not get notified.
+//
+TEST_F(EvpnManagerScaleTest, VRouterFlap) {
+    EvpnManagerPartition *partition = GetPartition();
+    uint64_t notify_count = partition->notify_count();
+    uint64_t olist_node_count = partition->olist_node_count();
+
+    PeerMock *peer = xmpp_peers_[kVRouterCount / 2];
+    DelXmppPeerBroadcastMacRoute(peer);
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(kVRouterCount - 1, GetPartitionLocalSize());
+    AddXmppPeerBroadcastMacRoute(peer);
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(kVRouterCount, GetPartitionLocalSize());
+
+    uint64_t notify_delta = partition->notify_count() - notify_count;
+    uint64_t olist_node_delta =
+        partition->olist_node_count() - olist_node_count;
+    LOG(DEBUG, kVRouterCount << " vRouters, vRouter flap: " <<
+        notify_delta << " notifications, " << olist_node_delta <<
+        " nodes visited to build olists");
+    EXPECT_LE(notify_delta, 1U);
+    EXPECT_LE(olist_node_delta, kPeCount);
+    EXPECT_EQ(kPeCount, GetOListSize(peer));
+}
+
+//
+// A PE goes away and comes back. The OList of every vRouter changes, so
+// all the Broadcast MAC routes get notified, but the OList with the PEs is
+// built only once for each change and shared by all the vRouters.
+//
+TEST_F(EvpnManagerScaleTest, PeFlap) {
+    EvpnManagerPartition *partition = GetPartition();
+    uint64_t notify_count = partition->notify_count();
+    uint64_t olist_node_count = partition->olist_node_count();
+
+    PeerMock *peer = bgp_peers_[0];
+    DelBgpPeerInclusiveMulticastRoute(peer);
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(kVRouterCount + kPeCount - 1,
+        GetPartitionRemoteSize());
+    BOOST_FOREACH(PeerMock *xmpp_peer, xmpp_peers_) {
+        EXPECT_EQ(kPeCount - 1, GetOListSize(xmpp_peer));
+    }
+    uint64_t olist_node_delta1 =
+        partition->olist_node_count() - olist_node_count;
+
+    AddBgpPeerInclusiveMulticastRoute(peer);
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(kVRouterCount + kPeCount, GetPartitionRemoteSize());
+    BOOST_FOREACH(PeerMock *xmpp_peer, xmpp_peers_) {
+        EXPECT_EQ(kPeCount, GetOListSize(xmpp_peer));
+    }
+
+    uint64_t notify_delta = partition->notify_count() - notify_count;
+    uint64_t olist_node_delta =
+        partition->olist_node_count() - olist_node_count;
+    LOG(DEBUG, kVRouterCount << " vRouters, PE flap: " <<
+        notify_delta << " notifications, " << olist_node_delta <<
+        " nodes visited to build olists");
+    EXPECT_EQ(2 * kVRouterCount, notify_delta);
+    EXPECT_EQ(kPeCount - 1, olist_node_delta1);
+    EXPECT_EQ(2 * kPeCount - 1, olist_node_delta);
+}
+
+class TestEnvironment : public ::testing::Environment {
+    virtual ~TestEnvironment() { }
+    virtual void SetUp() {
+    }
+    virtual void TearDown() {
+    }
+};
+
+static void SetUp() {
+    ControlNode::SetDefaultSchedulingPolicy();
+    BgpServerTest::GlobalSetUp();
+    BgpObjectFactory::Register<BgpXmppMessageBuilder>(
+        boost::factory<BgpXmppMessageBuilder *>());
+}
+
+static void TearDown() {
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    bgp_log_test::init();
+    ::testing::InitGoogleTest(&argc, argv);
+    ::testing::AddGlobalTestEnvironment(new TestEnvironment());
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+
+    return result;
+}
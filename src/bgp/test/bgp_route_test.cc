@@ -3,9 +3,13 @@
  */
 
 
+#include <boost/ptr_container/ptr_vector.hpp>
+
 #include "base/test/task_test_util.h"
+#include "base/time_util.h"
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_server.h"
+#include "bgp/bgp_table.h"
 #include "bgp/inet/inet_route.h"
 #include "bgp/origin-vn/origin_vn.h"
 #include "control-node/control_node.h"
@@ -72,6 +76,41 @@ protected:
         task_util::WaitForIdle();
     }
 
+    // Path list must stay sorted as if it had been sorted from scratch.
+    void VerifyPathOrder(const BgpRoute &route) {
+        const Route::PathList &paths = route.GetPathList();
+        Route::PathList::const_iterator prev = paths.end();
+        for (Route::PathList::const_iterator it = paths.begin();
+             it != paths.end(); prev = it, ++it) {
+            if (prev == paths.end())
+                continue;
+            EXPECT_FALSE(BgpTable::PathSelection(*it, *prev));
+        }
+    }
+
+    BgpAttrPtr LocateAttr(uint32_t local_pref, uint32_t med) {
+        BgpAttrSpec spec;
+        BgpAttrLocalPref local_pref_spec(local_pref);
+        spec.push_back(&local_pref_spec);
+        BgpAttrMultiExitDisc med_spec(med);
+        spec.push_back(&med_spec);
+        return server_.attr_db()->Locate(spec);
+    }
+
+    BgpAttrPtr LocateAttr(as_t neighbor_as, as_t origin_as, uint32_t med) {
+        BgpAttrSpec spec;
+        BgpAttrMultiExitDisc med_spec(med);
+        spec.push_back(&med_spec);
+        AsPathSpec aspath_spec;
+        AsPathSpec::PathSegment *ps = new AsPathSpec::PathSegment;
+        ps->path_segment_type = AsPathSpec::PathSegment::AS_SEQUENCE;
+        ps->path_segment.push_back(neighbor_as);
+        ps->path_segment.push_back(origin_as);
+        aspath_spec.path_segments.push_back(ps);
+        spec.push_back(&aspath_spec);
+        return server_.attr_db()->Locate(spec);
+    }
+
     EventManager evm_;
     BgpServer server_;
 };
@@ -814,6 +853,131 @@ TEST_F(BgpRouteTest, PathCompareLlgrStale6) {
     EXPECT_EQ(0, path2.PathCompare(path1, false));
 }
 
+//
+// Paths inserted and deleted in arbitrary order keep the path list sorted.
+//
+TEST_F(BgpRouteTest, InsertDeletePathOrder) {
+    boost::system::error_code ec;
+    const int kPeerCount = 64;
+    boost::ptr_vector<PeerMock> peers;
+    for (int idx = 0; idx < kPeerCount; ++idx) {
+        peers.push_back(new PeerMock(BgpProto::IBGP,
+            Ip4Address(0x0a010101 + (idx * 37) % kPeerCount)));
+    }
+
+    Ip4Prefix prefix;
+    InetRoute route(prefix);
+    for (int idx = 0; idx < kPeerCount; ++idx) {
+        BgpPath *path = new BgpPath(&peers[idx], BgpPath::BGP_XMPP,
+            LocateAttr(100 + idx % 3, idx % 5), 0, 0);
+        if (idx % 7 == 0)
+            path->SetLlgrStale();
+        route.InsertPath(path);
+        VerifyPathOrder(route);
+    }
+    EXPECT_EQ(kPeerCount, route.count());
+    EXPECT_EQ(102U, route.BestPath()->GetAttr()->local_pref());
+    EXPECT_FALSE(route.BestPath()->IsLlgrStale());
+
+    for (int idx = 0; idx < kPeerCount; idx += 2) {
+        EXPECT_TRUE(route.RemovePath(BgpPath::BGP_XMPP, &peers[idx], 0));
+        VerifyPathOrder(route);
+    }
+    EXPECT_EQ(kPeerCount / 2, route.count());
+    for (int idx = 1; idx < kPeerCount; idx += 2) {
+        EXPECT_TRUE(route.RemovePath(BgpPath::BGP_XMPP, &peers[idx], 0));
+    }
+    EXPECT_TRUE(route.BestPath() == NULL);
+}
+
+//
+// MED is compared only for paths from the same neighbor AS, so the path
+// comparison is not transitive:
+//   path a: neighbor AS 64512, MED 200, router id 10.1.1.1
+//   path b: neighbor AS 64512, MED 100, router id 10.1.1.3
+//   path c: neighbor AS 64513, MED 0,   router id 10.1.1.2
+// b is better than a on MED, a better than c and c better than b on router
+// id. A new path is inserted before the first path it is better than, so
+// the order and the best path depend on the order in which the paths are
+// added, as with non-deterministic MED. Sorting the same paths from
+// scratch may give yet another order.
+//
+TEST_F(BgpRouteTest, InsertPathOrderMed) {
+    boost::system::error_code ec;
+    PeerMock peer_a(BgpProto::EBGP, Ip4Address::from_string("10.1.1.1", ec));
+    PeerMock peer_b(BgpProto::EBGP, Ip4Address::from_string("10.1.1.3", ec));
+    PeerMock peer_c(BgpProto::EBGP, Ip4Address::from_string("10.1.1.2", ec));
+    PeerMock *peers[] = { &peer_a, &peer_b, &peer_c };
+    BgpAttrPtr attrs[] = {
+        LocateAttr(64512, 64520, 200),
+        LocateAttr(64512, 64520, 100),
+        LocateAttr(64513, 64520, 0),
+    };
+
+    // Order in which the paths are inserted, and the resulting path list
+    const int kOrders[][2][3] = {
+        { { 0, 1, 2 }, { 2, 1, 0 } },
+        { { 2, 0, 1 }, { 1, 0, 2 } },
+        { { 2, 1, 0 }, { 0, 2, 1 } },
+    };
+    for (size_t idx = 0; idx < sizeof(kOrders) / sizeof(kOrders[0]); ++idx) {
+        Ip4Prefix prefix;
+        InetRoute route(prefix);
+        for (int pos = 0; pos < 3; ++pos) {
+            int path_idx = kOrders[idx][0][pos];
+            route.InsertPath(new BgpPath(peers[path_idx], BgpPath::BGP_XMPP,
+                attrs[path_idx], 0, 0));
+        }
+        const Route::PathList &paths = route.GetPathList();
+        Route::PathList::const_iterator it = paths.begin();
+        for (int pos = 0; pos < 3; ++pos, ++it) {
+            const BgpPath *path = static_cast<const BgpPath *>(&*it);
+            EXPECT_EQ(static_cast<const IPeer *>(peers[kOrders[idx][1][pos]]),
+                path->GetPeer());
+        }
+        for (int pos = 0; pos < 3; ++pos) {
+            EXPECT_TRUE(route.RemovePath(BgpPath::BGP_XMPP, peers[pos], 0));
+        }
+    }
+}
+
+//
+// Flap paths of a route with many ECMP paths, as for an anycast address
+// advertised by many vrouters.
+//
+TEST_F(BgpRouteTest, DISABLED_InsertDeletePathPerf) {
+    const int kPeerCount = 500;
+    const int kFlapCount = 100000;
+    boost::ptr_vector<PeerMock> peers;
+    for (int idx = 0; idx < kPeerCount; ++idx) {
+        peers.push_back(new PeerMock(BgpProto::XMPP,
+            Ip4Address(0x0a000001 + idx)));
+    }
+
+    Ip4Prefix prefix;
+    InetRoute route(prefix);
+    BgpAttrPtr attr = LocateAttr(100, 0);
+    for (int idx = 0; idx < kPeerCount; ++idx) {
+        route.InsertPath(new BgpPath(&peers[idx], BgpPath::BGP_XMPP,
+            attr, 0, 0));
+    }
+
+    uint64_t start = ClockMonotonicUsec();
+    for (int idx = 0; idx < kFlapCount; ++idx) {
+        PeerMock *peer = &peers[(idx * 7919) % kPeerCount];
+        route.RemovePath(BgpPath::BGP_XMPP, peer, 0);
+        route.InsertPath(new BgpPath(peer, BgpPath::BGP_XMPP, attr, 0, 0));
+    }
+    uint64_t elapsed = ClockMonotonicUsec() - start;
+    LOG(DEBUG, kFlapCount << " path flaps on route with " << kPeerCount <<
+        " paths in " << elapsed << " usec");
+    VerifyPathOrder(route);
+
+    for (int idx = 0; idx < kPeerCount; ++idx) {
+        route.RemovePath(BgpPath::BGP_XMPP, &peers[idx], 0);
+    }
+}
+
 static void SetUp() {
     bgp_log_test::init();
     ControlNode::SetDefaultSchedulingPolicy();
@@ -270,6 +270,12 @@ void BgpServerUnitTest::ValidateShowBgpServerResponse(Sandesh *sandesh) {
     EXPECT_NE(0, tx_stats.calls);
     EXPECT_NE(0, tx_stats.bytes);
     EXPECT_NE(0, tx_stats.average_bytes);
+    const vector<EventManagerShardStats> &shard_stats =
+        resp->get_shard_stats();
+    EXPECT_EQ(1, shard_stats.size());
+    EXPECT_EQ(0, shard_stats[0].shard);
+    EXPECT_NE(0, shard_stats[0].sessions);
+    EXPECT_NE(0, shard_stats[0].sessions_created);
     validate_done_ = true;
 }
 
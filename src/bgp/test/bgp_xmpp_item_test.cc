@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "bgp/bgp_xmpp_item.h"
+
+#include <algorithm>
+#include <fstream>
+#include <pugixml/pugixml.hpp>
+
+#include "base/logging.h"
+#include "net/bgp_af.h"
+#include "schema/xmpp_unicast_types.h"
+#include "testing/gunit.h"
+
+using pugi::xml_document;
+using pugi::xml_node;
+using std::ifstream;
+using std::istreambuf_iterator;
+using std::string;
+
+class BgpXmppItemTest : public ::testing::Test {
+protected:
+    static string FileRead(const string &filename) {
+        ifstream file(filename.c_str());
+        string content((istreambuf_iterator<char>(file)),
+                       istreambuf_iterator<char>());
+        return content;
+    }
+
+    static autogen::NextHopType BuildNextHop(const string &address,
+        int label, const string &encap1, const string &encap2) {
+        autogen::NextHopType nexthop;
+        nexthop.Clear();
+        nexthop.af = BgpAf::IPv4;
+        nexthop.address = address;
+        nexthop.mac = "00:01:02:03:04:05";
+        nexthop.label = label;
+        nexthop.vni = label + 1;
+        nexthop.tunnel_encapsulation_list.tunnel_encapsulation.push_back(
+            encap1);
+        if (!encap2.empty()) {
+            nexthop.tunnel_encapsulation_list.tunnel_encapsulation.push_back(
+                encap2);
+        }
+        return nexthop;
+    }
+
+    static void BuildItem(autogen::ItemType *item) {
+        item->Clear();
+        item->entry.nlri.af = BgpAf::IPv4;
+        item->entry.nlri.safi = BgpAf::Unicast;
+        item->entry.nlri.address = "10.1.1.1/32";
+        item->entry.next_hops.next_hop.push_back(
+            BuildNextHop("192.168.1.1", 10000, "gre", "udp"));
+        item->entry.next_hops.next_hop.push_back(
+            BuildNextHop("192.168.1.2", 10001, "vxlan", ""));
+        item->entry.version = 1;
+        item->entry.virtual_network = "red";
+        item->entry.sequence_number = 7;
+        item->entry.security_group_list.security_group.push_back(8000001);
+        item->entry.security_group_list.security_group.push_back(8000002);
+        item->entry.community_tag_list.community_tag.push_back("no-export");
+        item->entry.community_tag_list.community_tag.push_back("64512:100");
+        item->entry.local_preference = 100;
+        item->entry.med = 200;
+    }
+
+    // Decode the node with both decoders and check that the results match.
+    bool ParseBoth(const xml_node &node, BgpXmppUnicastItem *item) {
+        autogen::ItemType autogen_item;
+        autogen_item.Clear();
+        bool autogen_valid = autogen_item.XmlParse(node);
+        bool valid = item->XmlParse(node);
+        EXPECT_EQ(autogen_valid, valid);
+        if (!autogen_valid || !valid)
+            return false;
+
+        BgpXmppUnicastItem copy;
+        copy.Copy(autogen_item);
+        ExpectEqual(copy, *item);
+        return true;
+    }
+
+    bool EncodeAndParse(autogen::ItemType &autogen_item,
+        BgpXmppUnicastItem *item) {
+        xml_document doc;
+        xml_node node = doc.append_child("item");
+        autogen_item.Encode(&node);
+        return ParseBoth(node, item);
+    }
+
+    static void ExpectEqual(const BgpXmppUnicastItem &expected,
+        const BgpXmppUnicastItem &actual) {
+        const BgpXmppUnicastItem::Entry &lhs = expected.entry;
+        const BgpXmppUnicastItem::Entry &rhs = actual.entry;
+        EXPECT_EQ(lhs.nlri.af, rhs.nlri.af);
+        EXPECT_EQ(lhs.nlri.safi, rhs.nlri.safi);
+        EXPECT_EQ(lhs.nlri.address, rhs.nlri.address);
+        ASSERT_EQ(lhs.next_hops.size(), rhs.next_hops.size());
+        BgpXmppUnicastItem::NextHopList::const_iterator lit, rit;
+        for (lit = lhs.next_hops.begin(), rit = rhs.next_hops.begin();
+             lit != lhs.next_hops.end(); ++lit, ++rit) {
+            EXPECT_EQ(lit->af, rit->af);
+            EXPECT_EQ(lit->address, rit->address);
+            EXPECT_EQ(lit->mac, rit->mac);
+            EXPECT_EQ(lit->label, rit->label);
+            EXPECT_EQ(lit->vni, rit->vni);
+            ExpectEqual(lit->tunnel_encapsulation_list,
+                rit->tunnel_encapsulation_list);
+        }
+        EXPECT_EQ(lhs.version, rhs.version);
+        EXPECT_EQ(lhs.sequence_number, rhs.sequence_number);
+        ExpectEqual(lhs.security_group_list, rhs.security_group_list);
+        ExpectEqual(lhs.community_tag_list, rhs.community_tag_list);
+        EXPECT_EQ(lhs.local_preference, rhs.local_preference);
+        EXPECT_EQ(lhs.med, rhs.med);
+        EXPECT_TRUE(lhs.load_balance == rhs.load_balance);
+    }
+
+    template <typename T>
+    static void ExpectEqual(const BgpXmppItemList<T> &expected,
+        const BgpXmppItemList<T> &actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(),
+            actual.begin()));
+    }
+};
+
+TEST_F(BgpXmppItemTest, Basic) {
+    autogen::ItemType autogen_item;
+    BuildItem(&autogen_item);
+    BgpXmppUnicastItem item;
+    EXPECT_TRUE(EncodeAndParse(autogen_item, &item));
+
+    EXPECT_EQ("10.1.1.1/32", item.entry.nlri.address);
+    EXPECT_EQ(2, item.entry.next_hops.size());
+    EXPECT_EQ("192.168.1.2", item.entry.next_hops.begin()[1].address);
+    EXPECT_EQ(2,
+        item.entry.next_hops.begin()->tunnel_encapsulation_list.size());
+    EXPECT_EQ(2, item.entry.security_group_list.size());
+    EXPECT_EQ("64512:100", item.entry.community_tag_list.begin()[1]);
+    EXPECT_EQ(200, item.entry.med);
+    EXPECT_TRUE(item.entry.load_balance.IsDefault());
+}
+
+// Decode a smaller item into the same scratch item and make sure nothing
+// is left over from the first one.
+TEST_F(BgpXmppItemTest, Reuse) {
+    autogen::ItemType autogen_item1;
+    BuildItem(&autogen_item1);
+    BgpXmppUnicastItem item;
+    EXPECT_TRUE(EncodeAndParse(autogen_item1, &item));
+
+    autogen::ItemType autogen_item2;
+    autogen_item2.Clear();
+    autogen_item2.entry.nlri.af = BgpAf::IPv6;
+    autogen_item2.entry.nlri.safi = BgpAf::Unicast;
+    autogen_item2.entry.nlri.address = "abcd::1/128";
+    autogen::NextHopType nexthop;
+    nexthop.Clear();
+    nexthop.af = BgpAf::IPv4;
+    nexthop.address = "192.168.1.3";
+    nexthop.label = 20000;
+    autogen_item2.entry.next_hops.next_hop.push_back(nexthop);
+    EXPECT_TRUE(EncodeAndParse(autogen_item2, &item));
+
+    EXPECT_EQ("abcd::1/128", item.entry.nlri.address);
+    ASSERT_EQ(1, item.entry.next_hops.size());
+    const BgpXmppUnicastItem::NextHop &nh = *item.entry.next_hops.begin();
+    EXPECT_EQ("192.168.1.3", nh.address);
+    EXPECT_TRUE(nh.mac.empty());
+    EXPECT_EQ(0, nh.vni);
+    EXPECT_TRUE(nh.tunnel_encapsulation_list.empty());
+    EXPECT_TRUE(item.entry.security_group_list.empty());
+    EXPECT_TRUE(item.entry.community_tag_list.empty());
+    EXPECT_EQ(0, item.entry.sequence_number);
+    EXPECT_EQ(0, item.entry.med);
+}
+
+TEST_F(BgpXmppItemTest, LoadBalanceFields) {
+    autogen::ItemType autogen_item;
+    BuildItem(&autogen_item);
+    autogen_item.entry.load_balance.load_balance_fields.
+        load_balance_field_list.push_back("l3-source-address");
+    autogen_item.entry.load_balance.load_balance_fields.
+        load_balance_field_list.push_back("l4-protocol");
+    autogen_item.entry.load_balance.load_balance_decision = "field-hash";
+    BgpXmppUnicastItem item;
+    EXPECT_TRUE(EncodeAndParse(autogen_item, &item));
+
+    const LoadBalance::LoadBalanceAttribute &lba = item.entry.load_balance;
+    EXPECT_FALSE(lba.IsDefault());
+    EXPECT_TRUE(lba.l3_source_address);
+    EXPECT_FALSE(lba.l3_destination_address);
+    EXPECT_TRUE(lba.l4_protocol);
+    EXPECT_FALSE(lba.l4_source_port);
+    EXPECT_FALSE(lba.l4_destination_port);
+    EXPECT_FALSE(lba.source_bias);
+}
+
+TEST_F(BgpXmppItemTest, LoadBalanceSourceBias) {
+    autogen::ItemType autogen_item;
+    BuildItem(&autogen_item);
+    autogen_item.entry.load_balance.load_balance_decision = "source-bias";
+    BgpXmppUnicastItem item;
+    EXPECT_TRUE(EncodeAndParse(autogen_item, &item));
+
+    const LoadBalance::LoadBalanceAttribute &lba = item.entry.load_balance;
+    EXPECT_TRUE(lba.source_bias);
+    EXPECT_FALSE(lba.l3_source_address);
+    EXPECT_FALSE(lba.l4_destination_port);
+}
+
+// Both decoders must accept and reject the same test data.
+TEST_F(BgpXmppItemTest, TestData) {
+    const char *files[] = {
+        "bad_inet_item_1.xml", "bad_inet_item_2.xml", "bad_inet_item_3.xml",
+        "bad_inet_item_4.xml", "bad_inet_item_5.xml", "bad_inet_item_6.xml",
+        "bad_inet6_item_1.xml", "bad_inet6_item_2.xml",
+        "bad_inet6_item_3.xml", "bad_inet6_item_4.xml",
+        "bad_inet6_item_5.xml", "bad_inet6_item_6.xml",
+    };
+    BgpXmppUnicastItem item;
+    for (size_t idx = 0; idx < sizeof(files) / sizeof(files[0]); ++idx) {
+        SCOPED_TRACE(files[idx]);
+        string data =
+            FileRead(string("controller/src/bgp/testdata/") + files[idx]);
+        xml_document doc;
+        ASSERT_TRUE(doc.load(data.c_str()));
+        ParseBoth(doc.child("item"), &item);
+    }
+}
+
+TEST_F(BgpXmppItemTest, BadInteger) {
+    autogen::ItemType autogen_item;
+    BuildItem(&autogen_item);
+    xml_document doc;
+    xml_node node = doc.append_child("item");
+    autogen_item.Encode(&node);
+    node.child("entry").child("next-hops").child("next-hop").child("label").
+        first_child().set_value("10000x");
+
+    BgpXmppUnicastItem item;
+    EXPECT_FALSE(item.XmlParse(node));
+    autogen::ItemType autogen_item2;
+    autogen_item2.Clear();
+    EXPECT_FALSE(autogen_item2.XmlParse(node));
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
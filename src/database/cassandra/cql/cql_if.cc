@@ -16,8 +16,10 @@
 #include <base/task.h>
 #include <base/timer.h>
 #include <base/string_util.h>
+#include <base/time_util.h>
 #include <io/event_manager.h>
 #include <database/gendb_if.h>
+#include <database/gendb_col_builder.h>
 #include <database/cassandra/cql/cql_if.h>
 #include <database/cassandra/cql/cql_if_impl.h>
 #include <database/cassandra/cql/cql_lib_if.h>
@@ -239,6 +241,11 @@ class CassStatementIndexBinder : public boost::static_visitor<> {
             tstring.c_str(), tstring.length()));
         assert(rc == CASS_OK);
     }
+    void operator()(const GenDb::DbStringRef &tstring, size_t index) const {
+        CassError rc(cci_->CassStatementBindStringN(statement_, index,
+            tstring.data(), tstring.size()));
+        assert(rc == CASS_OK);
+    }
     void operator()(const boost::uuids::uuid &tuuid, size_t index) const {
         CassUuid cuuid;
         decode_uuid((char *)&tuuid, &cuuid);
@@ -307,6 +314,12 @@ class CassStatementNameBinder : public boost::static_visitor<> {
             strlen(name), tstring.c_str(), tstring.length()));
         assert(rc == CASS_OK);
     }
+    void operator()(const GenDb::DbStringRef &tstring,
+        const char *name) const {
+        CassError rc(cci_->CassStatementBindStringByNameN(statement_, name,
+            strlen(name), tstring.data(), tstring.size()));
+        assert(rc == CASS_OK);
+    }
     void operator()(const boost::uuids::uuid &tuuid, const char *name) const {
         CassUuid cuuid;
         decode_uuid((char *)&tuuid, &cuuid);
@@ -720,6 +733,75 @@ bool DynamicCf2CassPrepareBind(interface::CassLibrary *cci,
     return true;
 }
 
+bool StaticCf2CassPrepareBind(interface::CassLibrary *cci,
+    CassStatement *statement,
+    const GenDb::ColListBuilder &builder) {
+    CassStatementNameBinder values_binder(cci, statement);
+    // Row keys
+    const GenDb::DbDataValueRefVec &rkeys(builder.rowkey());
+    int rk_size(rkeys.size());
+    size_t idx(0);
+    for (; (int) idx < rk_size; idx++) {
+        std::string rk_name;
+        if (idx) {
+            int key_num(idx + 1);
+            rk_name = "key" + integerToString(key_num);
+        } else {
+            rk_name = "key";
+        }
+        boost::apply_visitor(boost::bind(values_binder, _1, rk_name.c_str()),
+            rkeys[idx]);
+    }
+    // Columns
+    int cttl(-1);
+    BOOST_FOREACH(const GenDb::ColListBuilder::Column &column,
+        builder.columns()) {
+        assert(column.cftype_ == GenDb::NewCf::COLUMN_FAMILY_SQL);
+        assert(column.value_end_ - column.value_begin_ == 1);
+        boost::apply_visitor(boost::bind(values_binder, _1,
+            column.sql_name_->c_str()), builder.value(column.value_begin_));
+        // Column TTL
+        cttl = column.ttl_;
+        idx++;
+    }
+    CassError rc(cci->CassStatementBindInt32(statement, idx++,
+        (cass_int32_t)cttl));
+    assert(rc == CASS_OK);
+    return true;
+}
+
+bool DynamicCf2CassPrepareBind(interface::CassLibrary *cci,
+    CassStatement *statement,
+    const GenDb::ColListBuilder &builder) {
+    CassStatementIndexBinder values_binder(cci, statement);
+    // Row keys
+    const GenDb::DbDataValueRefVec &rkeys(builder.rowkey());
+    int rk_size(rkeys.size());
+    size_t idx(0);
+    for (; (int) idx < rk_size; idx++) {
+        boost::apply_visitor(boost::bind(values_binder, _1, idx), rkeys[idx]);
+    }
+    // Columns
+    const GenDb::ColListBuilder::ColumnVec &columns(builder.columns());
+    assert(columns.size() == 1);
+    const GenDb::ColListBuilder::Column &column(columns[0]);
+    assert(column.cftype_ == GenDb::NewCf::COLUMN_FAMILY_NOSQL);
+    // Column Names
+    for (size_t i = column.name_begin_; i < column.name_end_; i++, idx++) {
+        boost::apply_visitor(boost::bind(values_binder, _1, idx),
+            builder.name(i));
+    }
+    // Column Values
+    if (column.value_end_ > column.value_begin_) {
+        boost::apply_visitor(boost::bind(values_binder, _1, idx++),
+            builder.value(column.value_begin_));
+    }
+    CassError rc(cci->CassStatementBindInt32(statement, idx++,
+        (cass_int32_t)column.ttl_));
+    assert(rc == CASS_OK);
+    return true;
+}
+
 static std::string CassSelectFromTableInternal(const std::string &table,
     const GenDb::DbDataValueVec &rkeys,
     const GenDb::ColumnNameRange &ck_range) {
@@ -1427,6 +1509,98 @@ static void CassLibraryLog(const CassLogMessage* message, void *data) {
     }
 }
 
+//
+// Unlogged batch inserts
+//
+bool CassInsertBatchKey::operator<(const CassInsertBatchKey &rhs) const {
+    if (cf_name_ != rhs.cf_name_) {
+        return cf_name_ < rhs.cf_name_;
+    }
+    if (consistency_ != rhs.consistency_) {
+        return consistency_ < rhs.consistency_;
+    }
+    return row_key_ < rhs.row_key_;
+}
+
+CassBatchStats::CassBatchStats() :
+    batches_(0),
+    statements_(0),
+    failed_batches_(0),
+    max_batch_size_(0),
+    min_latency_(0),
+    max_latency_(0),
+    total_latency_(0) {
+}
+
+void CassBatchStats::Update(size_t num_statements, uint64_t latency_usec,
+    bool success) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (batches_ == 0 || latency_usec < min_latency_) {
+        min_latency_ = latency_usec;
+    }
+    if (latency_usec > max_latency_) {
+        max_latency_ = latency_usec;
+    }
+    if (num_statements > max_batch_size_) {
+        max_batch_size_ = num_statements;
+    }
+    batches_++;
+    statements_ += num_statements;
+    total_latency_ += latency_usec;
+    if (!success) {
+        failed_batches_++;
+    }
+}
+
+void CassBatchStats::Get(BatchStats *stats) const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    stats->batches = batches_;
+    stats->statements = statements_;
+    stats->failed_batches = failed_batches_;
+    stats->max_batch_size = max_batch_size_;
+    stats->min_latency = min_latency_;
+    stats->max_latency = max_latency_;
+    if (batches_) {
+        stats->mean_batch_size = (double)statements_ / batches_;
+        stats->mean_latency = total_latency_ / batches_;
+    } else {
+        stats->mean_batch_size = 0;
+        stats->mean_latency = 0;
+    }
+}
+
+static void OnExecuteBatchAsync(CassFuture *future, void *data) {
+    assert(data);
+    std::auto_ptr<CassAsyncBatchContext> ctx(
+        boost::reinterpret_pointer_cast<CassAsyncBatchContext>(data));
+    interface::CassLibrary *cci(ctx->cci_);
+    CassError rc(cci->CassFutureErrorCode(future));
+    GenDb::DbOpResult::type db_rc(CassError2DbOpResult(rc));
+    if (rc != CASS_OK) {
+        CassString err;
+        cci->CassFutureErrorMessage(future, &err.data, &err.length);
+        CQLIF_LOG_ERR("AsyncBatch: " << ctx->batch_id_ << " FAILED: "
+            << err.data);
+    }
+    if (ctx->stats_) {
+        ctx->stats_->Update(ctx->cbs_.size(),
+            UTCTimestampUsec() - ctx->start_time_, rc == CASS_OK);
+    }
+    BOOST_FOREACH(CassAsyncQueryCallback &cb, ctx->cbs_) {
+        cb(db_rc, std::auto_ptr<GenDb::ColList>());
+    }
+}
+
+void ExecuteBatchAsync(interface::CassLibrary *cci, CassSession *session,
+    CassBatch *batch, CassConsistency consistency,
+    CassAsyncBatchContext *ctx) {
+    std::auto_ptr<CassAsyncBatchContext> bctx(ctx);
+    cci->CassBatchSetConsistency(batch, consistency);
+    CassFuturePtr future(cci->CassSessionExecuteBatch(session, batch), cci);
+    cci->CassFutureSetCallback(future.get(), OnExecuteBatchAsync,
+        bctx.release());
+}
+
 
 class WorkerTask : public Task {
  public:
@@ -1468,7 +1642,11 @@ CqlIfImpl::CqlIfImpl(EventManager *evm,
     connect_cb_(NULL),
     disconnect_cb_(NULL),
     keyspace_(),
-    io_thread_count_(2) {
+    io_thread_count_(2),
+    batch_flush_timer_(TimerManager::CreateTimer(*evm->io_service(),
+        "CqlIfImpl Batch Flush Timer",
+        TaskScheduler::GetInstance()->GetTaskId(kTaskName),
+        kTaskInstance)) {
     // Set session state to INIT
     session_state_ = SessionState::INIT;
     // Set contact points and port
@@ -1486,6 +1664,8 @@ CqlIfImpl::CqlIfImpl(EventManager *evm,
     cci_->CassClusterSetPendingRequestsLowWaterMark(cluster_.get(), 5000);
     cci_->CassClusterSetWriteBytesHighWaterMark(cluster_.get(), 128000);
     cci_->CassClusterSetWriteBytesLowWaterMark(cluster_.get(), 96000);
+    // Route statements to the replicas owning the partition key
+    cci_->CassClusterSetTokenAwareRouting(cluster_.get(), cass_true);
 }
 
 CqlIfImpl::~CqlIfImpl() {
@@ -1493,6 +1673,8 @@ CqlIfImpl::~CqlIfImpl() {
         session_state_ == SessionState::DISCONNECTED);
     TimerManager::DeleteTimer(reconnect_timer_);
     reconnect_timer_ = NULL;
+    TimerManager::DeleteTimer(batch_flush_timer_);
+    batch_flush_timer_ = NULL;
 }
 
 bool CqlIfImpl::CreateKeyspaceIfNotExistsSync(const std::string &keyspace,
@@ -1766,6 +1948,8 @@ bool CqlIfImpl::ConnectSync() {
 }
 
 void CqlIfImpl::DisconnectAsync() {
+    // Send out pending batches before closing the session
+    FlushInsertBatches();
     // Close all session and pending queries
     session_state_ = SessionState::DISCONNECT_PENDING;
     impl::CassFuturePtr future(cci_->CassSessionClose(session_.get()), cci_);
@@ -1777,6 +1961,8 @@ void CqlIfImpl::DisconnectAsync() {
 }
 
 bool CqlIfImpl::DisconnectSync() {
+    // Send out pending batches before closing the session
+    FlushInsertBatches();
     // Close all session and pending queries
     impl::CassFuturePtr future(cci_->CassSessionClose(session_.get()), cci_);
     bool success(impl::SyncFutureWait(cci_, future.get()));
@@ -1831,6 +2017,12 @@ void CqlIfImpl::GetMetrics(Metrics *metrics) const {
         cass_metrics.errors.pending_request_timeouts;
     metrics->errors.request_timeouts =
         cass_metrics.errors.request_timeouts;
+    // Batches
+    GetBatchStats(&metrics->batches);
+}
+
+void CqlIfImpl::GetBatchStats(BatchStats *stats) const {
+    batch_stats_.Get(stats);
 }
 
 void CqlIfImpl::ConnectCallback(CassFuture *future, void *data) {
@@ -1921,13 +2113,8 @@ bool CqlIfImpl::PrepareInsertIntoTableSync(const GenDb::NewCf &cf,
         prepared);
 }
 
-bool CqlIfImpl::InsertIntoTablePrepareInternal(
-    std::auto_ptr<GenDb::ColList> v_columns,
-    CassConsistency consistency, bool sync,
-    impl::CassAsyncQueryCallback cb) {
-    if (session_state_ != SessionState::CONNECTED) {
-        return false;
-    }
+bool CqlIfImpl::BindInsertIntoTablePrepare(const GenDb::ColList *v_columns,
+    impl::CassStatementPtr *qstatement) {
     impl::CassPreparedPtr prepared(NULL, cci_);
     bool success(GetPrepareInsertIntoTable(v_columns->cfname_, &prepared));
     if (!success) {
@@ -1935,16 +2122,26 @@ bool CqlIfImpl::InsertIntoTablePrepareInternal(
             v_columns->cfname_);
         return false;
     }
-    impl::CassStatementPtr qstatement(cci_->CassPreparedBind(prepared.get()),
-        cci_);
+    *qstatement = impl::CassStatementPtr(
+        cci_->CassPreparedBind(prepared.get()), cci_);
     if (IsTableStatic(v_columns->cfname_)) {
-        success = impl::StaticCf2CassPrepareBind(cci_, qstatement.get(),
-            v_columns.get());
+        return impl::StaticCf2CassPrepareBind(cci_, qstatement->get(),
+            v_columns);
     } else {
-        success = impl::DynamicCf2CassPrepareBind(cci_, qstatement.get(),
-            v_columns.get());
+        return impl::DynamicCf2CassPrepareBind(cci_, qstatement->get(),
+            v_columns);
     }
-    if (!success) {
+}
+
+bool CqlIfImpl::InsertIntoTablePrepareInternal(
+    std::auto_ptr<GenDb::ColList> v_columns,
+    CassConsistency consistency, bool sync,
+    impl::CassAsyncQueryCallback cb) {
+    if (session_state_ != SessionState::CONNECTED) {
+        return false;
+    }
+    impl::CassStatementPtr qstatement(NULL, cci_);
+    if (!BindInsertIntoTablePrepare(v_columns.get(), &qstatement)) {
         return false;
     }
     if (sync) {
@@ -1958,6 +2155,176 @@ bool CqlIfImpl::InsertIntoTablePrepareInternal(
     }
 }
 
+CqlIfImpl::PendingInsertBatch::PendingInsertBatch(
+    const std::string &cf_name) :
+    cf_name_(cf_name),
+    size_(0) {
+}
+
+bool CqlIfImpl::BindInsertIntoTablePrepare(
+    const GenDb::ColListBuilder &builder,
+    impl::CassStatementPtr *qstatement) {
+    impl::CassPreparedPtr prepared(NULL, cci_);
+    bool success(GetPrepareInsertIntoTable(builder.cfname(), &prepared));
+    if (!success) {
+        CQLIF_LOG_ERR("CassPrepared statement NOT found: " <<
+            builder.cfname());
+        return false;
+    }
+    *qstatement = impl::CassStatementPtr(
+        cci_->CassPreparedBind(prepared.get()), cci_);
+    if (IsTableStatic(builder.cfname())) {
+        return impl::StaticCf2CassPrepareBind(cci_, qstatement->get(),
+            builder);
+    } else {
+        return impl::DynamicCf2CassPrepareBind(cci_, qstatement->get(),
+            builder);
+    }
+}
+
+bool CqlIfImpl::InsertIntoTablePrepareAsync(
+    const GenDb::ColListBuilder &builder, CassConsistency consistency,
+    impl::CassAsyncQueryCallback cb) {
+    if (session_state_ != SessionState::CONNECTED) {
+        return false;
+    }
+    impl::CassStatementPtr qstatement(NULL, cci_);
+    if (!BindInsertIntoTablePrepare(builder, &qstatement)) {
+        return false;
+    }
+    std::string qid("Prepare: " + builder.cfname());
+    impl::ExecuteQueryStatementAsync(cci_, session_.get(), qid.c_str(),
+        qstatement.get(), consistency, cb);
+    return true;
+}
+
+bool CqlIfImpl::InsertIntoTablePrepareBatchAsync(
+    std::auto_ptr<GenDb::ColList> v_columns, CassConsistency consistency,
+    impl::CassAsyncQueryCallback cb) {
+    if (session_state_ != SessionState::CONNECTED) {
+        return false;
+    }
+    impl::CassStatementPtr qstatement(NULL, cci_);
+    if (!BindInsertIntoTablePrepare(v_columns.get(), &qstatement)) {
+        return false;
+    }
+    AddToInsertBatch(impl::CassInsertBatchKey(v_columns->cfname_,
+        v_columns->rowkey_, consistency), qstatement, v_columns->GetSize(),
+        cb);
+    return true;
+}
+
+bool CqlIfImpl::InsertIntoTablePrepareBatchAsync(
+    const GenDb::ColListBuilder &builder, CassConsistency consistency,
+    impl::CassAsyncQueryCallback cb) {
+    if (session_state_ != SessionState::CONNECTED) {
+        return false;
+    }
+    impl::CassStatementPtr qstatement(NULL, cci_);
+    if (!BindInsertIntoTablePrepare(builder, &qstatement)) {
+        return false;
+    }
+    GenDb::DbDataValueVec rowkey;
+    rowkey.reserve(builder.rowkey().size());
+    BOOST_FOREACH(const GenDb::DbDataValueRef &rkey, builder.rowkey()) {
+        rowkey.push_back(GenDb::DbDataValueRefToDbDataValue(rkey));
+    }
+    AddToInsertBatch(impl::CassInsertBatchKey(builder.cfname(), rowkey,
+        consistency), qstatement, builder.GetSize(), cb);
+    return true;
+}
+
+//
+// The first insert into a partition is sent right away, and inserts into
+// the same partition that follow it before the flush timer fires are
+// batched. A batch is sent when it reaches kMaxBatchStatements or
+// kMaxBatchBytes, or when the flush timer fires. The flush timer is started
+// when the first statement is added to a batch, so that further inserts
+// do not hold off the flush.
+//
+void CqlIfImpl::AddToInsertBatch(const impl::CassInsertBatchKey &bkey,
+    const impl::CassStatementPtr &qstatement, size_t size,
+    impl::CassAsyncQueryCallback cb) {
+    tbb::mutex::scoped_lock lock(batch_mutex_);
+    PendingInsertBatchMap::iterator it(pending_batch_map_.find(bkey));
+    if (it == pending_batch_map_.end()) {
+        impl::CassInsertBatchKey key(bkey);
+        pending_batch_map_.insert(key, new PendingInsertBatch(key.cf_name_));
+        std::string qid("Prepare: " + bkey.cf_name_);
+        impl::ExecuteQueryStatementAsync(cci_, session_.get(), qid.c_str(),
+            qstatement.get(), bkey.consistency_, cb);
+        return;
+    }
+    PendingInsertBatch *pbatch(it->second);
+    if (pbatch->size_ + size > kMaxBatchBytes) {
+        ExecuteInsertBatch(it->first, pbatch);
+    }
+    pbatch->statements_.push_back(qstatement);
+    pbatch->cbs_.push_back(cb);
+    pbatch->size_ += size;
+    if (pbatch->statements_.size() == 1) {
+        // No-op if the flush timer is already running for another batch
+        batch_flush_timer_->Start(kBatchFlushInterval,
+            boost::bind(&CqlIfImpl::BatchFlushTimerExpired, this),
+            boost::bind(&CqlIfImpl::BatchFlushTimerErrorHandler, this,
+                _1, _2));
+    }
+    if (pbatch->statements_.size() >= kMaxBatchStatements ||
+        pbatch->size_ >= kMaxBatchBytes) {
+        ExecuteInsertBatch(it->first, pbatch);
+    }
+}
+
+void CqlIfImpl::ExecuteInsertBatch(const impl::CassInsertBatchKey &key,
+    PendingInsertBatch *pbatch) {
+    if (pbatch->statements_.empty()) {
+        return;
+    }
+    if (pbatch->statements_.size() == 1) {
+        std::string qid("Prepare: " + pbatch->cf_name_);
+        impl::ExecuteQueryStatementAsync(cci_, session_.get(), qid.c_str(),
+            pbatch->statements_[0].get(), key.consistency_,
+            pbatch->cbs_[0]);
+    } else {
+        impl::CassBatchPtr batch(
+            cci_->CassBatchNew(CASS_BATCH_TYPE_UNLOGGED), cci_);
+        // The batch keeps its own reference to the bound statements
+        for (size_t i = 0; i < pbatch->statements_.size(); i++) {
+            cci_->CassBatchAddStatement(batch.get(),
+                pbatch->statements_[i].get());
+        }
+        std::auto_ptr<impl::CassAsyncBatchContext> ctx(
+            new impl::CassAsyncBatchContext("Batch: " + pbatch->cf_name_,
+                cci_, &batch_stats_, UTCTimestampUsec()));
+        ctx->cbs_.swap(pbatch->cbs_);
+        impl::ExecuteBatchAsync(cci_, session_.get(), batch.get(),
+            key.consistency_, ctx.release());
+    }
+    pbatch->statements_.clear();
+    pbatch->cbs_.clear();
+    pbatch->size_ = 0;
+}
+
+void CqlIfImpl::FlushInsertBatches() {
+    tbb::mutex::scoped_lock lock(batch_mutex_);
+    for (PendingInsertBatchMap::iterator it = pending_batch_map_.begin();
+         it != pending_batch_map_.end(); ++it) {
+        ExecuteInsertBatch(it->first, it->second);
+    }
+    pending_batch_map_.clear();
+}
+
+bool CqlIfImpl::BatchFlushTimerExpired() {
+    FlushInsertBatches();
+    return false;
+}
+
+void CqlIfImpl::BatchFlushTimerErrorHandler(std::string error_name,
+    std::string error_message) {
+    CQLIF_LOG_ERR("Batch flush timer: " << error_name << " " <<
+        error_message);
+}
+
 const char * CqlIfImpl::kQCreateKeyspaceIfNotExists(
     "CREATE KEYSPACE IF NOT EXISTS \"%s\" WITH "
     "replication = { 'class' : 'SimpleStrategy', 'replication_factor' : %s }");
@@ -1975,7 +2342,8 @@ CqlIf::CqlIf(EventManager *evm,
     cci_(new interface::CassDatastaxLibrary),
     impl_(new CqlIfImpl(evm, cassandra_ips, cassandra_port,
         cassandra_user, cassandra_password, cci_.get())),
-    use_prepared_for_insert_(true) {
+    use_prepared_for_insert_(true),
+    use_batch_for_insert_(true) {
     // Setup library logging
     cci_->CassLogSetLevel(impl::Log4Level2CassLogLevel(
         log4cplus::Logger::getRoot().getLogLevel()));
@@ -2159,7 +2527,12 @@ bool CqlIf::Db_AddColumn(std::auto_ptr<GenDb::ColList> cl,
     }
     CassConsistency consistency(impl::Db2CassConsistency(dconsistency));
     bool success;
-    if (use_prepared_for_insert_ &&
+    if (use_prepared_for_insert_ && use_batch_for_insert_ &&
+        impl_->IsInsertIntoTablePrepareSupported(cfname)) {
+        success = impl_->InsertIntoTablePrepareBatchAsync(cl, consistency,
+            boost::bind(&CqlIf::OnAsyncColumnAddCompletion, this, _1, _2, cfname,
+            cb));
+    } else if (use_prepared_for_insert_ &&
         impl_->IsInsertIntoTablePrepareSupported(cfname)) {
         success = impl_->InsertIntoTablePrepareAsync(cl, consistency,
             boost::bind(&CqlIf::OnAsyncColumnAddCompletion, this, _1, _2, cfname,
@@ -2177,6 +2550,38 @@ bool CqlIf::Db_AddColumn(std::auto_ptr<GenDb::ColList> cl,
     return success;
 }
 
+bool CqlIf::Db_AddColumn(const GenDb::ColListBuilder &builder,
+    GenDb::DbConsistency::type dconsistency,
+    GenDb::GenDbIf::DbAddColumnCb cb) {
+    const std::string &cfname(builder.cfname());
+    if (!use_prepared_for_insert_ ||
+        !impl_->IsInsertIntoTablePrepareSupported(cfname)) {
+        return GenDb::GenDbIf::Db_AddColumn(builder, dconsistency, cb);
+    }
+    if (!initialized_) {
+        IncrementTableWriteFailStats(cfname);
+        IncrementErrors(GenDb::IfErrors::ERR_WRITE_COLUMN);
+        return false;
+    }
+    CassConsistency consistency(impl::Db2CassConsistency(dconsistency));
+    bool success;
+    // Bind directly from the builder without creating a ColList
+    if (use_batch_for_insert_) {
+        success = impl_->InsertIntoTablePrepareBatchAsync(builder,
+            consistency, boost::bind(&CqlIf::OnAsyncColumnAddCompletion,
+            this, _1, _2, cfname, cb));
+    } else {
+        success = impl_->InsertIntoTablePrepareAsync(builder, consistency,
+            boost::bind(&CqlIf::OnAsyncColumnAddCompletion, this, _1, _2,
+            cfname, cb));
+    }
+    if (!success) {
+        IncrementTableWriteFailStats(cfname);
+        IncrementErrors(GenDb::IfErrors::ERR_WRITE_COLUMN);
+    }
+    return success;
+}
+
 bool CqlIf::Db_AddColumnSync(std::auto_ptr<GenDb::ColList> cl,
     GenDb::DbConsistency::type dconsistency) {
     std::string cfname(cl->cfname_);
@@ -2364,6 +2769,7 @@ void CqlIf::Db_GetCqlStats(DbStats *db_stats) const {
     db_stats->requests_one_minute_rate = metrics.requests.one_minute_rate;
     db_stats->stats = metrics.stats;
     db_stats->errors = metrics.errors;
+    db_stats->batches = metrics.batches;
 }
 
 void CqlIf::IncrementTableWriteStats(const std::string &table_name) {
@@ -2494,6 +2900,11 @@ CassError CassDatastaxLibrary::CassClusterSetWriteBytesLowWaterMark(
     return cass_cluster_set_write_bytes_low_water_mark(cluster, num_bytes);
 }
 
+void CassDatastaxLibrary::CassClusterSetTokenAwareRouting(CassCluster* cluster,
+    cass_bool_t enabled) {
+    cass_cluster_set_token_aware_routing(cluster, enabled);
+}
+
 // CassSession
 CassSession* CassDatastaxLibrary::CassSessionNew() {
     return cass_session_new();
@@ -2517,6 +2928,11 @@ CassFuture* CassDatastaxLibrary::CassSessionExecute(CassSession* session,
     return cass_session_execute(session, statement);
 }
 
+CassFuture* CassDatastaxLibrary::CassSessionExecuteBatch(CassSession* session,
+    const CassBatch* batch) {
+    return cass_session_execute_batch(session, batch);
+}
+
 const CassSchemaMeta* CassDatastaxLibrary::CassSessionGetSchemaMeta(
     const CassSession* session) {
     return cass_session_get_schema_meta(session);
@@ -2727,6 +3143,25 @@ CassStatement* CassDatastaxLibrary::CassPreparedBind(
     return cass_prepared_bind(prepared);
 }
 
+// CassBatch
+CassBatch* CassDatastaxLibrary::CassBatchNew(CassBatchType type) {
+    return cass_batch_new(type);
+}
+
+void CassDatastaxLibrary::CassBatchFree(CassBatch* batch) {
+    cass_batch_free(batch);
+}
+
+CassError CassDatastaxLibrary::CassBatchSetConsistency(CassBatch* batch,
+    CassConsistency consistency) {
+    return cass_batch_set_consistency(batch, consistency);
+}
+
+CassError CassDatastaxLibrary::CassBatchAddStatement(CassBatch* batch,
+    CassStatement* statement) {
+    return cass_batch_add_statement(batch, statement);
+}
+
 // CassValue
 CassValueType CassDatastaxLibrary::GetCassValueType(const CassValue* value) {
     return cass_value_type(value);
@@ -50,6 +50,9 @@ class CqlIf : public GenDb::GenDbIf {
         GenDb::GenDbIf::DbAddColumnCb cb);
     virtual bool Db_AddColumnSync(std::auto_ptr<GenDb::ColList> cl,
         GenDb::DbConsistency::type dconsistency);
+    virtual bool Db_AddColumn(const GenDb::ColListBuilder &builder,
+        GenDb::DbConsistency::type dconsistency,
+        GenDb::GenDbIf::DbAddColumnCb cb);
     // Read
     virtual bool Db_GetRow(GenDb::ColList *out, const std::string &cfname,
         const GenDb::DbDataValueVec &rowkey,
@@ -133,6 +136,7 @@ class CqlIf : public GenDb::GenDbIf {
     mutable tbb::mutex stats_mutex_;
     GenDb::GenDbIfStats stats_;
     bool use_prepared_for_insert_;
+    bool use_batch_for_insert_;
 };
 
 } // namespace cql
@@ -6,8 +6,10 @@
 #define DATABASE_CASSANDRA_CQL_CQL_IF_IMPL_H_
 
 #include <string>
+#include <vector>
 
 #include <boost/unordered_map.hpp>
+#include <boost/ptr_container/ptr_map.hpp>
 
 #include <cassandra.h>
 
@@ -15,9 +17,12 @@
 #include <base/timer.h>
 
 #include <database/gendb_if.h>
+#include <database/gendb_col_builder.h>
 #include <database/cassandra/cql/cql_types.h>
 #include <database/cassandra/cql/cql_lib_if.h>
 
+class CqlIfBatchTest;
+
 namespace cass {
 namespace cql {
 namespace impl {
@@ -29,6 +34,10 @@ std::string DynamicCf2CassCreateTableIfNotExists(const GenDb::NewCf &cf,
 std::string StaticCf2CassInsertIntoTable(const GenDb::ColList *v_columns);
 std::string DynamicCf2CassInsertIntoTable(const GenDb::ColList *v_columns);
 std::string StaticCf2CassPrepareInsertIntoTable(const GenDb::NewCf &cf);
+bool StaticCf2CassPrepareBind(interface::CassLibrary *cci,
+    CassStatement *statement, const GenDb::ColListBuilder &builder);
+bool DynamicCf2CassPrepareBind(interface::CassLibrary *cci,
+    CassStatement *statement, const GenDb::ColListBuilder &builder);
 std::string DynamicCf2CassPrepareInsertIntoTable(const GenDb::NewCf &cf);
 std::string CassSelectFromTable(const std::string &table);
 std::string PartitionKey2CassSelectFromTable(const std::string &table,
@@ -137,6 +146,18 @@ struct Deleter<const CassSchemaMeta> {
     interface::CassLibrary *cci_;
 };
 
+template<>
+struct Deleter<CassBatch> {
+    Deleter(interface::CassLibrary *cci) :
+       cci_(cci) {}
+    void operator()(CassBatch* ptr) {
+        if (ptr != NULL) {
+            cci_->CassBatchFree(ptr);
+        }
+    }
+    interface::CassLibrary *cci_;
+};
+
 template <class T>
 class CassSharedPtr : public boost::shared_ptr<T> {
  public:
@@ -152,6 +173,7 @@ typedef CassSharedPtr<const CassResult> CassResultPtr;
 typedef CassSharedPtr<CassIterator> CassIteratorPtr;
 typedef CassSharedPtr<const CassPrepared> CassPreparedPtr;
 typedef CassSharedPtr<const CassSchemaMeta> CassSchemaMetaPtr;
+typedef CassSharedPtr<CassBatch> CassBatchPtr;
 
 typedef boost::function<void(GenDb::DbOpResult::type,
     std::auto_ptr<GenDb::ColList>)> CassAsyncQueryCallback;
@@ -187,6 +209,61 @@ struct CassAsyncQueryContext {
     boost::scoped_ptr<CassQueryResultContext> result_ctx_;
 };
 
+//
+// Inserts into the same column family and partition key with the same
+// consistency are grouped into a single unlogged batch so that the
+// batch is routed to one replica set
+//
+struct CassInsertBatchKey {
+    CassInsertBatchKey(const std::string &cf_name,
+        const GenDb::DbDataValueVec &row_key, CassConsistency consistency) :
+        cf_name_(cf_name),
+        row_key_(row_key),
+        consistency_(consistency) {
+    }
+    bool operator<(const CassInsertBatchKey &rhs) const;
+    std::string cf_name_;
+    GenDb::DbDataValueVec row_key_;
+    CassConsistency consistency_;
+};
+
+class CassBatchStats {
+ public:
+    CassBatchStats();
+    void Update(size_t num_statements, uint64_t latency_usec, bool success);
+    void Get(BatchStats *stats) const;
+
+ private:
+    mutable tbb::mutex mutex_;
+    uint64_t batches_;
+    uint64_t statements_;
+    uint64_t failed_batches_;
+    uint64_t max_batch_size_;
+    uint64_t min_latency_;
+    uint64_t max_latency_;
+    uint64_t total_latency_;
+};
+
+struct CassAsyncBatchContext {
+    CassAsyncBatchContext(const std::string &batch_id,
+        interface::CassLibrary *cci, CassBatchStats *stats,
+        uint64_t start_time) :
+        batch_id_(batch_id),
+        cci_(cci),
+        stats_(stats),
+        start_time_(start_time) {
+    }
+    std::string batch_id_;
+    std::vector<CassAsyncQueryCallback> cbs_;
+    interface::CassLibrary *cci_;
+    CassBatchStats *stats_;
+    uint64_t start_time_;
+};
+
+void ExecuteBatchAsync(interface::CassLibrary *cci, CassSession *session,
+    CassBatch *batch, CassConsistency consistency,
+    CassAsyncBatchContext *ctx);
+
 void DynamicCfGetResult(interface::CassLibrary *cci,
     CassResultPtr *result, size_t rk_count,
     size_t ck_count, GenDb::ColListVec *v_col_list);
@@ -228,6 +305,15 @@ class CqlIfImpl {
     bool InsertIntoTablePrepareAsync(std::auto_ptr<GenDb::ColList> v_columns,
         CassConsistency consistency, impl::CassAsyncQueryCallback cb);
     bool IsInsertIntoTablePrepareSupported(const std::string &table);
+    bool InsertIntoTablePrepareBatchAsync(
+        std::auto_ptr<GenDb::ColList> v_columns, CassConsistency consistency,
+        impl::CassAsyncQueryCallback cb);
+    bool InsertIntoTablePrepareAsync(const GenDb::ColListBuilder &builder,
+        CassConsistency consistency, impl::CassAsyncQueryCallback cb);
+    bool InsertIntoTablePrepareBatchAsync(
+        const GenDb::ColListBuilder &builder, CassConsistency consistency,
+        impl::CassAsyncQueryCallback cb);
+    void FlushInsertBatches();
 
     bool SelectFromTableSync(const std::string &cfname,
         const GenDb::DbDataValueVec &rkey, CassConsistency consistency,
@@ -252,8 +338,24 @@ class CqlIfImpl {
     bool DisconnectSync();
 
     void GetMetrics(Metrics *metrics) const;
+    void GetBatchStats(BatchStats *stats) const;
 
  private:
+    friend class ::CqlIfBatchTest;
+
+    // Statements are added to a CassBatch only when the batch is sent, so
+    // that a single statement can be sent without a batch
+    struct PendingInsertBatch {
+        explicit PendingInsertBatch(const std::string &cf_name);
+        std::string cf_name_;
+        std::vector<impl::CassStatementPtr> statements_;
+        std::vector<impl::CassAsyncQueryCallback> cbs_;
+        // Approximate size of the data in the statements
+        size_t size_;
+    };
+    typedef boost::ptr_map<impl::CassInsertBatchKey, PendingInsertBatch>
+        PendingInsertBatchMap;
+
     typedef boost::function<void(CassFuture *)> ConnectCbFn;
     typedef boost::function<void(CassFuture *)> DisconnectCbFn;
 
@@ -275,12 +377,29 @@ class CqlIfImpl {
     bool InsertIntoTablePrepareInternal(std::auto_ptr<GenDb::ColList> v_columns,
         CassConsistency consistency, bool sync,
         impl::CassAsyncQueryCallback cb);
+    bool BindInsertIntoTablePrepare(const GenDb::ColList *v_columns,
+        impl::CassStatementPtr *qstatement);
+    bool BindInsertIntoTablePrepare(const GenDb::ColListBuilder &builder,
+        impl::CassStatementPtr *qstatement);
+    void AddToInsertBatch(const impl::CassInsertBatchKey &bkey,
+        const impl::CassStatementPtr &qstatement, size_t size,
+        impl::CassAsyncQueryCallback cb);
+    void ExecuteInsertBatch(const impl::CassInsertBatchKey &key,
+        PendingInsertBatch *pbatch);
+    bool BatchFlushTimerExpired();
+    void BatchFlushTimerErrorHandler(std::string error_name,
+        std::string error_message);
 
     static const char * kQCreateKeyspaceIfNotExists;
     static const char * kQUseKeyspace;
     static const char * kTaskName;
     static const int kTaskInstance = -1;
     static const int kReconnectInterval = 5 * 1000;
+    static const size_t kMaxBatchStatements = 64;
+    // Well below the default batch_size_fail_threshold_in_kb of 50KB, as
+    // the size of the statements is estimated from the data alone
+    static const size_t kMaxBatchBytes = 16 * 1024;
+    static const int kBatchFlushInterval = 10;
 
     struct SessionState {
         enum type {
@@ -306,6 +425,10 @@ class CqlIfImpl {
         CassPreparedMapType;
     CassPreparedMapType insert_prepared_map_;
     mutable tbb::mutex map_mutex_;
+    Timer *batch_flush_timer_;
+    PendingInsertBatchMap pending_batch_map_;
+    mutable tbb::mutex batch_mutex_;
+    impl::CassBatchStats batch_stats_;
 };
 
 }  // namespace cql
@@ -34,6 +34,8 @@ class CassLibrary {
         CassCluster* cluster, unsigned num_bytes) = 0;
     virtual CassError CassClusterSetWriteBytesLowWaterMark(
         CassCluster* cluster, unsigned num_bytes) = 0;
+    virtual void CassClusterSetTokenAwareRouting(CassCluster* cluster,
+        cass_bool_t enabled) = 0;
 
     // CassSession
     virtual CassSession* CassSessionNew() = 0;
@@ -43,6 +45,8 @@ class CassLibrary {
     virtual CassFuture* CassSessionClose(CassSession* session) = 0;
     virtual CassFuture* CassSessionExecute(CassSession* session,
         const CassStatement* statement) = 0;
+    virtual CassFuture* CassSessionExecuteBatch(CassSession* session,
+        const CassBatch* batch) = 0;
     virtual const CassSchemaMeta* CassSessionGetSchemaMeta(
         const CassSession* session) = 0;
     virtual CassFuture* CassSessionPrepare(CassSession* session,
@@ -127,6 +131,14 @@ class CassLibrary {
     virtual void CassPreparedFree(const CassPrepared* prepared) = 0;
     virtual CassStatement* CassPreparedBind(const CassPrepared* prepared) = 0;
 
+    // CassBatch
+    virtual CassBatch* CassBatchNew(CassBatchType type) = 0;
+    virtual void CassBatchFree(CassBatch* batch) = 0;
+    virtual CassError CassBatchSetConsistency(CassBatch* batch,
+        CassConsistency consistency) = 0;
+    virtual CassError CassBatchAddStatement(CassBatch* batch,
+        CassStatement* statement) = 0;
+
     // CassValue
     virtual CassValueType GetCassValueType(const CassValue* value) = 0;
     virtual CassError CassValueGetString(const CassValue* value,
@@ -185,6 +197,8 @@ class CassDatastaxLibrary : public CassLibrary {
         CassCluster* cluster, unsigned num_bytes);
     virtual CassError CassClusterSetWriteBytesLowWaterMark(
         CassCluster* cluster, unsigned num_bytes);
+    virtual void CassClusterSetTokenAwareRouting(CassCluster* cluster,
+        cass_bool_t enabled);
 
     // CassSession
     virtual CassSession* CassSessionNew();
@@ -194,6 +208,8 @@ class CassDatastaxLibrary : public CassLibrary {
     virtual CassFuture* CassSessionClose(CassSession* session);
     virtual CassFuture* CassSessionExecute(CassSession* session,
         const CassStatement* statement);
+    virtual CassFuture* CassSessionExecuteBatch(CassSession* session,
+        const CassBatch* batch);
     virtual const CassSchemaMeta* CassSessionGetSchemaMeta(
         const CassSession* session);
     virtual CassFuture* CassSessionPrepare(CassSession* session,
@@ -278,6 +294,14 @@ class CassDatastaxLibrary : public CassLibrary {
     virtual void CassPreparedFree(const CassPrepared* prepared);
     virtual CassStatement* CassPreparedBind(const CassPrepared* prepared);
 
+    // CassBatch
+    virtual CassBatch* CassBatchNew(CassBatchType type);
+    virtual void CassBatchFree(CassBatch* batch);
+    virtual CassError CassBatchSetConsistency(CassBatch* batch,
+        CassConsistency consistency);
+    virtual CassError CassBatchAddStatement(CassBatch* batch,
+        CassStatement* statement);
+
     // CassValue
     virtual CassValueType GetCassValueType(const CassValue* value);
     virtual CassError CassValueGetString(const CassValue* value,
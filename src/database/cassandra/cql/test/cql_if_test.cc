@@ -9,8 +9,11 @@
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/random_generator.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include <base/logging.h>
+#include <base/time_util.h>
+#include <io/event_manager.h>
 #include <database/gendb_constants.h>
 #include <database/gendb_if.h>
 #include <database/cassandra/cql/cql_if_impl.h>
@@ -547,6 +550,7 @@ using ::testing::Return;
 using ::testing::DoAll;
 using ::testing::SetArgPointee;
 using ::testing::ContainerEq;
+using ::testing::Invoke;
 
 TEST_F(CqlIfTest, DynamicCfGetResultAllRows) {
     cass::cql::test::MockCassLibrary mock_cci;
@@ -736,6 +740,212 @@ TEST_F(CqlIfTest, StaticCfGetResultAllRows) {
     EXPECT_THAT(actual_v_col_list, ContainerEq(expected_v_col_list));
 }
 
+TEST_F(CqlIfTest, InsertBatchKey) {
+    GenDb::DbDataValueVec rkey1(1, std::string("key1"));
+    GenDb::DbDataValueVec rkey2(1, std::string("key2"));
+    cass::cql::impl::CassInsertBatchKey key1("Table1", rkey1,
+        CASS_CONSISTENCY_ONE);
+    cass::cql::impl::CassInsertBatchKey key1_dup("Table1", rkey1,
+        CASS_CONSISTENCY_ONE);
+    cass::cql::impl::CassInsertBatchKey key2("Table1", rkey2,
+        CASS_CONSISTENCY_ONE);
+    cass::cql::impl::CassInsertBatchKey key3("Table2", rkey1,
+        CASS_CONSISTENCY_ONE);
+    cass::cql::impl::CassInsertBatchKey key4("Table1", rkey1,
+        CASS_CONSISTENCY_QUORUM);
+    // Same table, partition key and consistency share a batch
+    EXPECT_FALSE(key1 < key1_dup);
+    EXPECT_FALSE(key1_dup < key1);
+    // Everything else is batched separately
+    EXPECT_TRUE(key1 < key2 || key2 < key1);
+    EXPECT_TRUE(key1 < key3 || key3 < key1);
+    EXPECT_TRUE(key1 < key4 || key4 < key1);
+}
+
+TEST_F(CqlIfTest, BatchStats) {
+    cass::cql::impl::CassBatchStats bstats;
+    cass::cql::BatchStats stats;
+    bstats.Get(&stats);
+    EXPECT_EQ(0, stats.batches);
+    EXPECT_EQ(0, stats.mean_batch_size);
+    bstats.Update(10, 200, true);
+    bstats.Update(30, 100, true);
+    bstats.Update(20, 300, false);
+    bstats.Get(&stats);
+    EXPECT_EQ(3, stats.batches);
+    EXPECT_EQ(60, stats.statements);
+    EXPECT_EQ(1, stats.failed_batches);
+    EXPECT_EQ(30, stats.max_batch_size);
+    EXPECT_EQ(20, stats.mean_batch_size);
+    EXPECT_EQ(100, stats.min_latency);
+    EXPECT_EQ(300, stats.max_latency);
+    EXPECT_EQ(200, stats.mean_latency);
+}
+
+static void BatchInsertCallback(GenDb::DbOpResult::type drc,
+    std::auto_ptr<GenDb::ColList> row, int *count,
+    GenDb::DbOpResult::type *result) {
+    (*count)++;
+    *result = drc;
+}
+
+static void InvokeFutureCallback(CassFuture *future,
+    CassFutureCallback callback, void *data) {
+    callback(future, data);
+}
+
+TEST_F(CqlIfTest, ExecuteBatchAsync) {
+    cass::cql::test::MockCassLibrary mock_cci;
+    cass::cql::impl::CassBatchStats bstats;
+    int count(0);
+    GenDb::DbOpResult::type result(GenDb::DbOpResult::ERROR);
+    std::auto_ptr<cass::cql::impl::CassAsyncBatchContext> ctx(
+        new cass::cql::impl::CassAsyncBatchContext("Batch: Table1",
+            &mock_cci, &bstats, UTCTimestampUsec()));
+    for (int i = 0; i < 3; i++) {
+        ctx->cbs_.push_back(boost::bind(&BatchInsertCallback, _1, _2,
+            &count, &result));
+    }
+    EXPECT_CALL(mock_cci, CassBatchSetConsistency(_, CASS_CONSISTENCY_ONE))
+        .Times(1)
+        .WillOnce(Return(CASS_OK));
+    EXPECT_CALL(mock_cci, CassSessionExecuteBatch(_, _))
+        .Times(1)
+        .WillOnce(Return((CassFuture *)NULL));
+    EXPECT_CALL(mock_cci, CassFutureErrorCode(_))
+        .Times(1)
+        .WillOnce(Return(CASS_OK));
+    EXPECT_CALL(mock_cci, CassFutureSetCallback(_, _, _))
+        .Times(1)
+        .WillOnce(DoAll(Invoke(InvokeFutureCallback), Return(CASS_OK)));
+    cass::cql::impl::ExecuteBatchAsync(&mock_cci, NULL, NULL,
+        CASS_CONSISTENCY_ONE, ctx.release());
+    // All statements in the batch complete together
+    EXPECT_EQ(3, count);
+    EXPECT_EQ(GenDb::DbOpResult::OK, result);
+    cass::cql::BatchStats stats;
+    bstats.Get(&stats);
+    EXPECT_EQ(1, stats.batches);
+    EXPECT_EQ(3, stats.statements);
+    EXPECT_EQ(0, stats.failed_batches);
+}
+
+class CqlIfBatchTest : public ::testing::Test {
+ protected:
+    CqlIfBatchTest() :
+        rkey_(1, std::string("key1")),
+        bkey_("Table1", rkey_, CASS_CONSISTENCY_ONE),
+        count_(0),
+        result_(GenDb::DbOpResult::ERROR) {
+    }
+    virtual void SetUp() {
+        impl_.reset(new cass::cql::CqlIfImpl(&evm_,
+            std::vector<std::string>(1, "127.0.0.1"), 9042, "", "",
+            &mock_cci_));
+        ON_CALL(mock_cci_, CassFutureSetCallback(_, _, _))
+            .WillByDefault(DoAll(Invoke(InvokeFutureCallback),
+                Return(CASS_OK)));
+    }
+    virtual void TearDown() {
+        impl_.reset();
+    }
+    void AddToInsertBatch(size_t size) {
+        cass::cql::impl::CassStatementPtr qstatement(NULL, &mock_cci_);
+        impl_->AddToInsertBatch(bkey_, qstatement, size,
+            boost::bind(&BatchInsertCallback, _1, _2, &count_, &result_));
+    }
+    bool BatchFlushTimerExpired() {
+        return impl_->BatchFlushTimerExpired();
+    }
+    bool IsBatchFlushTimerRunning() const {
+        return impl_->batch_flush_timer_->running();
+    }
+    static size_t MaxBatchStatements() {
+        return cass::cql::CqlIfImpl::kMaxBatchStatements;
+    }
+    static size_t MaxBatchBytes() {
+        return cass::cql::CqlIfImpl::kMaxBatchBytes;
+    }
+
+    EventManager evm_;
+    ::testing::NiceMock<cass::cql::test::MockCassLibrary> mock_cci_;
+    boost::scoped_ptr<cass::cql::CqlIfImpl> impl_;
+    GenDb::DbDataValueVec rkey_;
+    cass::cql::impl::CassInsertBatchKey bkey_;
+    int count_;
+    GenDb::DbOpResult::type result_;
+};
+
+TEST_F(CqlIfBatchTest, FirstInsertSent) {
+    EXPECT_CALL(mock_cci_, CassSessionExecute(_, _))
+        .Times(1);
+    EXPECT_CALL(mock_cci_, CassSessionExecuteBatch(_, _))
+        .Times(0);
+    AddToInsertBatch(64);
+    EXPECT_EQ(1, count_);
+    EXPECT_EQ(GenDb::DbOpResult::OK, result_);
+    // Nothing is waiting to be batched yet
+    EXPECT_FALSE(IsBatchFlushTimerRunning());
+}
+
+TEST_F(CqlIfBatchTest, FlushOnMaxStatements) {
+    EXPECT_CALL(mock_cci_, CassSessionExecute(_, _))
+        .Times(1);
+    EXPECT_CALL(mock_cci_, CassBatchAddStatement(_, _))
+        .Times(MaxBatchStatements());
+    EXPECT_CALL(mock_cci_, CassSessionExecuteBatch(_, _))
+        .Times(1);
+    AddToInsertBatch(64);
+    for (size_t i = 0; i < MaxBatchStatements() - 1; i++) {
+        AddToInsertBatch(64);
+    }
+    EXPECT_EQ(1, count_);
+    // The last statement fills up the batch and sends it
+    AddToInsertBatch(64);
+    EXPECT_EQ(MaxBatchStatements() + 1, (size_t)count_);
+    EXPECT_EQ(GenDb::DbOpResult::OK, result_);
+    cass::cql::BatchStats stats;
+    impl_->GetBatchStats(&stats);
+    EXPECT_EQ(1, stats.batches);
+    EXPECT_EQ(MaxBatchStatements(), stats.max_batch_size);
+}
+
+TEST_F(CqlIfBatchTest, FlushOnMaxBytes) {
+    EXPECT_CALL(mock_cci_, CassSessionExecute(_, _))
+        .Times(1);
+    EXPECT_CALL(mock_cci_, CassBatchAddStatement(_, _))
+        .Times(2);
+    EXPECT_CALL(mock_cci_, CassSessionExecuteBatch(_, _))
+        .Times(1);
+    AddToInsertBatch(64);
+    AddToInsertBatch(MaxBatchBytes() / 2);
+    EXPECT_EQ(1, count_);
+    AddToInsertBatch(MaxBatchBytes() / 2);
+    EXPECT_EQ(3, count_);
+}
+
+TEST_F(CqlIfBatchTest, FlushOnTimer) {
+    EXPECT_CALL(mock_cci_, CassSessionExecute(_, _))
+        .Times(2);
+    EXPECT_CALL(mock_cci_, CassBatchAddStatement(_, _))
+        .Times(3);
+    EXPECT_CALL(mock_cci_, CassSessionExecuteBatch(_, _))
+        .Times(1);
+    AddToInsertBatch(64);
+    EXPECT_FALSE(IsBatchFlushTimerRunning());
+    // The timer is started by the first statement added to the batch
+    AddToInsertBatch(64);
+    EXPECT_TRUE(IsBatchFlushTimerRunning());
+    AddToInsertBatch(64);
+    AddToInsertBatch(64);
+    EXPECT_EQ(1, count_);
+    EXPECT_FALSE(BatchFlushTimerExpired());
+    EXPECT_EQ(4, count_);
+    // After the flush, the next insert is sent right away again
+    AddToInsertBatch(64);
+    EXPECT_EQ(5, count_);
+}
+
 int main(int argc, char **argv) {
     LoggingInit();
     ::testing::InitGoogleTest(&argc, argv);
@@ -34,6 +34,8 @@ class MockCassLibrary : public interface::CassLibrary {
         CassCluster* cluster, unsigned num_bytes));
     MOCK_METHOD2(CassClusterSetWriteBytesLowWaterMark, CassError (
         CassCluster* cluster, unsigned num_bytes));
+    MOCK_METHOD2(CassClusterSetTokenAwareRouting, void (CassCluster* cluster,
+        cass_bool_t enabled));
 
     // CassSession
     MOCK_METHOD0(CassSessionNew, CassSession* ());
@@ -43,6 +45,8 @@ class MockCassLibrary : public interface::CassLibrary {
     MOCK_METHOD1(CassSessionClose, CassFuture* (CassSession* session));
     MOCK_METHOD2(CassSessionExecute, CassFuture* (CassSession* session,
         const CassStatement* statement));
+    MOCK_METHOD2(CassSessionExecuteBatch, CassFuture* (CassSession* session,
+        const CassBatch* batch));
     MOCK_METHOD1(CassSessionGetSchemaMeta, const CassSchemaMeta* (
         const CassSession* session));
     MOCK_METHOD2(CassSessionPrepare, CassFuture* (CassSession* session,
@@ -129,6 +133,14 @@ class MockCassLibrary : public interface::CassLibrary {
     MOCK_METHOD1(CassPreparedBind, CassStatement* (
         const CassPrepared* prepared));
 
+    // CassBatch
+    MOCK_METHOD1(CassBatchNew, CassBatch* (CassBatchType type));
+    MOCK_METHOD1(CassBatchFree, void (CassBatch* batch));
+    MOCK_METHOD2(CassBatchSetConsistency, CassError (CassBatch* batch,
+        CassConsistency consistency));
+    MOCK_METHOD2(CassBatchAddStatement, CassError (CassBatch* batch,
+        CassStatement* statement));
+
     // CassValue
     MOCK_METHOD1(GetCassValueType, CassValueType (const CassValue* value));
     MOCK_METHOD3(CassValueGetString, CassError (const CassValue* value,
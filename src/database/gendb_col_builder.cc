@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+//
+
+#include <cassert>
+
+#include <database/gendb_col_builder.h>
+
+using namespace GenDb;
+
+class DbDataValueRefConverter : public boost::static_visitor<DbDataValue> {
+ public:
+    template<typename T>
+    DbDataValue operator()(const T &t) const {
+        return DbDataValue(t);
+    }
+    DbDataValue operator()(const DbStringRef &tstring) const {
+        return DbDataValue(tstring.ToString());
+    }
+};
+
+DbDataValue GenDb::DbDataValueRefToDbDataValue(const DbDataValueRef &value) {
+    return boost::apply_visitor(DbDataValueRefConverter(), value);
+}
+
+class DbDataValueRefSizeVisitor : public boost::static_visitor<size_t> {
+ public:
+    template<typename T>
+    size_t operator()(const T &t) const {
+        return sizeof(t);
+    }
+    size_t operator()(const DbStringRef &tstring) const {
+        return tstring.size();
+    }
+    size_t operator()(const boost::blank &blank) const {
+        return 0;
+    }
+    size_t operator()(const boost::uuids::uuid &uuid) const {
+        return uuid.size();
+    }
+};
+
+//
+// ColListBuilder
+//
+ColListBuilder::ColListBuilder() {
+}
+
+ColListBuilder::~ColListBuilder() {
+}
+
+void ColListBuilder::Reset(const std::string &cfname) {
+    cfname_ = cfname;
+    rowkey_.clear();
+    columns_.clear();
+    names_.clear();
+    values_.clear();
+}
+
+void ColListBuilder::AddColumn(const std::string &name,
+    const DbDataValueRef &value, int ttl) {
+    columns_.push_back(Column(NewCf::COLUMN_FAMILY_SQL, &name, names_.size(),
+        values_.size(), ttl));
+    values_.push_back(value);
+    columns_.back().value_end_ = values_.size();
+}
+
+void ColListBuilder::BeginColumn(int ttl) {
+    columns_.push_back(Column(NewCf::COLUMN_FAMILY_NOSQL, NULL, names_.size(),
+        values_.size(), ttl));
+}
+
+void ColListBuilder::AddColumnName(const DbDataValueRef &name) {
+    assert(!columns_.empty());
+    names_.push_back(name);
+    columns_.back().name_end_ = names_.size();
+}
+
+void ColListBuilder::AddColumnValue(const DbDataValueRef &value) {
+    assert(!columns_.empty());
+    values_.push_back(value);
+    columns_.back().value_end_ = values_.size();
+}
+
+size_t ColListBuilder::GetSize() const {
+    DbDataValueRefSizeVisitor size_visitor;
+    size_t size(0);
+    for (size_t i = 0; i < rowkey_.size(); i++) {
+        size += boost::apply_visitor(size_visitor, rowkey_[i]);
+    }
+    for (size_t i = 0; i < columns_.size(); i++) {
+        if (columns_[i].cftype_ == NewCf::COLUMN_FAMILY_SQL) {
+            size += columns_[i].sql_name_->size();
+        }
+    }
+    for (size_t i = 0; i < names_.size(); i++) {
+        size += boost::apply_visitor(size_visitor, names_[i]);
+    }
+    for (size_t i = 0; i < values_.size(); i++) {
+        size += boost::apply_visitor(size_visitor, values_[i]);
+    }
+    return size;
+}
+
+std::auto_ptr<ColList> ColListBuilder::Build() const {
+    std::auto_ptr<ColList> col_list(new ColList);
+    col_list->cfname_ = cfname_;
+    col_list->rowkey_.reserve(rowkey_.size());
+    for (size_t i = 0; i < rowkey_.size(); i++) {
+        col_list->rowkey_.push_back(DbDataValueRefToDbDataValue(rowkey_[i]));
+    }
+    col_list->columns_.reserve(columns_.size());
+    for (size_t i = 0; i < columns_.size(); i++) {
+        const Column &column(columns_[i]);
+        if (column.cftype_ == NewCf::COLUMN_FAMILY_SQL) {
+            col_list->columns_.push_back(new NewCol(*column.sql_name_,
+                DbDataValueRefToDbDataValue(values_[column.value_begin_]),
+                column.ttl_));
+            continue;
+        }
+        DbDataValueVec *cnames(new DbDataValueVec);
+        cnames->reserve(column.name_end_ - column.name_begin_);
+        for (size_t j = column.name_begin_; j < column.name_end_; j++) {
+            cnames->push_back(DbDataValueRefToDbDataValue(names_[j]));
+        }
+        DbDataValueVec *cvalues(new DbDataValueVec);
+        cvalues->reserve(column.value_end_ - column.value_begin_);
+        for (size_t j = column.value_begin_; j < column.value_end_; j++) {
+            cvalues->push_back(DbDataValueRefToDbDataValue(values_[j]));
+        }
+        col_list->columns_.push_back(new NewCol(cnames, cvalues, column.ttl_));
+    }
+    return col_list;
+}
@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+//
+
+#ifndef DATABASE_GENDB_COL_BUILDER_H_
+#define DATABASE_GENDB_COL_BUILDER_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/variant.hpp>
+#include <boost/uuid/uuid.hpp>
+
+#include <base/util.h>
+#include <database/gendb_if.h>
+
+namespace GenDb {
+
+//
+// Non-owning reference to string data, typically inside the message that
+// is being written. The referenced data must stay valid until the column
+// list has been handed to GenDbIf::Db_AddColumn.
+//
+struct DbStringRef {
+    DbStringRef() :
+        data_(NULL),
+        size_(0) {
+    }
+    DbStringRef(const std::string &str) :
+        data_(str.data()),
+        size_(str.size()) {
+    }
+    DbStringRef(const char *data, size_t size) :
+        data_(data),
+        size_(size) {
+    }
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string ToString() const { return std::string(data_, size_); }
+
+    const char *data_;
+    size_t size_;
+};
+
+inline bool operator==(const DbStringRef &lhs, const DbStringRef &rhs) {
+    return lhs.size_ == rhs.size_ &&
+        std::char_traits<char>::compare(lhs.data_, rhs.data_,
+            lhs.size_) == 0;
+}
+
+// Same alternatives and ordering as DbDataValue, without the Blob type
+typedef boost::variant<boost::blank, DbStringRef, uint64_t, uint32_t,
+    boost::uuids::uuid, uint8_t, uint16_t, double, IpAddress>
+    DbDataValueRef;
+
+typedef std::vector<DbDataValueRef> DbDataValueRefVec;
+
+DbDataValue DbDataValueRefToDbDataValue(const DbDataValueRef &value);
+
+//
+// Reusable builder for a single column list. Names and values reference
+// the originating message, and all storage is retained across Reset() so
+// that a builder owned by a long lived caller does not allocate in steady
+// state. GenDbIf implementations may serialize the builder directly, or
+// fall back to Build() which creates an equivalent ColList.
+//
+class ColListBuilder {
+ public:
+    struct Column {
+        Column(NewCf::ColumnFamilyType cftype, const std::string *sql_name,
+            size_t name_begin, size_t value_begin, int ttl) :
+            cftype_(cftype),
+            sql_name_(sql_name),
+            name_begin_(name_begin),
+            name_end_(name_begin),
+            value_begin_(value_begin),
+            value_end_(value_begin),
+            ttl_(ttl) {
+        }
+        NewCf::ColumnFamilyType cftype_;
+        const std::string *sql_name_;
+        size_t name_begin_;
+        size_t name_end_;
+        size_t value_begin_;
+        size_t value_end_;
+        int ttl_;
+    };
+    typedef std::vector<Column> ColumnVec;
+
+    ColListBuilder();
+    ~ColListBuilder();
+
+    void Reset(const std::string &cfname);
+
+    void AddRowKey(const DbDataValueRef &rkey) {
+        rowkey_.push_back(rkey);
+    }
+    // Static (SQL) column family column
+    void AddColumn(const std::string &name, const DbDataValueRef &value,
+        int ttl);
+    // Dynamic (NoSQL) column family column, followed by the names and
+    // values of the column
+    void BeginColumn(int ttl);
+    void AddColumnName(const DbDataValueRef &name);
+    void AddColumnValue(const DbDataValueRef &value);
+
+    const std::string &cfname() const { return cfname_; }
+    const DbDataValueRefVec &rowkey() const { return rowkey_; }
+    const ColumnVec &columns() const { return columns_; }
+    const DbDataValueRef &name(size_t idx) const { return names_[idx]; }
+    const DbDataValueRef &value(size_t idx) const { return values_[idx]; }
+    // Same as GetSize() of the ColList created by Build()
+    size_t GetSize() const;
+
+    // Allocating conversion to ColList for GenDbIf implementations that
+    // do not handle the builder natively
+    std::auto_ptr<ColList> Build() const;
+
+ private:
+    std::string cfname_;
+    DbDataValueRefVec rowkey_;
+    ColumnVec columns_;
+    DbDataValueRefVec names_;
+    DbDataValueRefVec values_;
+
+    DISALLOW_COPY_AND_ASSIGN(ColListBuilder);
+};
+
+}  // namespace GenDb
+
+#endif  // DATABASE_GENDB_COL_BUILDER_H_
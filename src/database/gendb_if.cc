@@ -6,6 +6,7 @@
 
 #include <base/string_util.h>
 #include <database/gendb_if.h>
+#include <database/gendb_col_builder.h>
 
 using namespace GenDb;
 
@@ -57,6 +58,11 @@ size_t ColList::GetSize() const {
     return size;
 }
 
+bool GenDbIf::Db_AddColumn(const ColListBuilder &builder,
+    DbConsistency::type dconsistency, DbAddColumnCb cb) {
+    return Db_AddColumn(builder.Build(), dconsistency, cb);
+}
+
 std::string ColumnNameRange::ToString() const {
     std::ostringstream ss;
     ss << "ColumnNameRange: ";
@@ -196,6 +196,8 @@ struct ColumnNameRange {
 
 typedef boost::asio::ip::tcp::endpoint Endpoint;
 
+class ColListBuilder;
+
 struct DbOpResult {
     enum type {
         OK,
@@ -234,6 +236,11 @@ public:
         DbConsistency::type dconsistency, DbAddColumnCb cb) = 0;
     virtual bool Db_AddColumnSync(std::auto_ptr<ColList> cl,
         DbConsistency::type dconsistency) = 0;
+    // Column list referencing caller owned data, which only needs to stay
+    // valid for the duration of the call. By default it is converted to a
+    // ColList and added via Db_AddColumn above
+    virtual bool Db_AddColumn(const ColListBuilder &builder,
+        DbConsistency::type dconsistency, DbAddColumnCb cb);
     // Read/Get
     virtual bool Db_GetRow(ColList *ret, const std::string& cfname,
         const DbDataValueVec& rowkey, DbConsistency::type dconsistency) = 0;
@@ -0,0 +1,157 @@
+//
+// Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+//
+
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/random_generator.hpp>
+
+#include <base/logging.h>
+#include <base/time_util.h>
+
+#include "testing/gunit.h"
+#include <database/gendb_if.h>
+#include <database/gendb_col_builder.h>
+
+class GenDbColBuilderTest : public ::testing::Test {
+ protected:
+    GenDbColBuilderTest() {
+    }
+    ~GenDbColBuilderTest() {
+    }
+    virtual void SetUp() {
+    }
+    virtual void TearDown() {
+    }
+};
+
+// Fields of a message as they would be present in the received sandesh
+struct TestMessage {
+    TestMessage() :
+        source("a6s23"),
+        module("contrail-vrouter-agent"),
+        category("Default"),
+        message_type("VrouterAgentFlowLogMessage"),
+        data("<VrouterAgentFlowLogMessage type=\"sandesh\"><flow type=\"struct\""
+            "><FlowDataIpv4 /></flow></VrouterAgentFlowLogMessage>"),
+        timestamp(UTCTimestampUsec()),
+        level(6),
+        unm(boost::uuids::random_generator()()) {
+    }
+    std::string source;
+    std::string module;
+    std::string category;
+    std::string message_type;
+    std::string data;
+    uint64_t timestamp;
+    uint32_t level;
+    boost::uuids::uuid unm;
+};
+
+static const std::string kMessageTable("MessageTable");
+static const std::string kSource("Source");
+static const std::string kModule("ModuleId");
+static const std::string kCategory("Category");
+static const std::string kMessageType("Messagetype");
+static const std::string kTimestamp("MessageTS");
+static const std::string kLevel("Level");
+static const std::string kData("Data");
+
+static void BuildMessageColList(const TestMessage &msg,
+    GenDb::ColList *col_list) {
+    col_list->cfname_ = kMessageTable;
+    col_list->rowkey_.push_back(msg.unm);
+    GenDb::NewColVec &columns(col_list->columns_);
+    columns.reserve(7);
+    columns.push_back(new GenDb::NewCol(kSource, msg.source, 0));
+    columns.push_back(new GenDb::NewCol(kModule, msg.module, 0));
+    columns.push_back(new GenDb::NewCol(kCategory, msg.category, 0));
+    columns.push_back(new GenDb::NewCol(kMessageType, msg.message_type, 0));
+    columns.push_back(new GenDb::NewCol(kTimestamp, msg.timestamp, 0));
+    columns.push_back(new GenDb::NewCol(kLevel, msg.level, 0));
+    columns.push_back(new GenDb::NewCol(kData, msg.data, 0));
+}
+
+static void BuildMessageColListBuilder(const TestMessage &msg,
+    GenDb::ColListBuilder *builder) {
+    builder->Reset(kMessageTable);
+    builder->AddRowKey(msg.unm);
+    builder->AddColumn(kSource, GenDb::DbStringRef(msg.source), 0);
+    builder->AddColumn(kModule, GenDb::DbStringRef(msg.module), 0);
+    builder->AddColumn(kCategory, GenDb::DbStringRef(msg.category), 0);
+    builder->AddColumn(kMessageType, GenDb::DbStringRef(msg.message_type), 0);
+    builder->AddColumn(kTimestamp, msg.timestamp, 0);
+    builder->AddColumn(kLevel, msg.level, 0);
+    builder->AddColumn(kData, GenDb::DbStringRef(msg.data), 0);
+}
+
+TEST_F(GenDbColBuilderTest, StaticCfBuild) {
+    TestMessage msg;
+    GenDb::ColList expected;
+    BuildMessageColList(msg, &expected);
+    GenDb::ColListBuilder builder;
+    BuildMessageColListBuilder(msg, &builder);
+    std::auto_ptr<GenDb::ColList> actual(builder.Build());
+    EXPECT_EQ(expected, *actual);
+    EXPECT_EQ(expected.GetSize(), builder.GetSize());
+    // Reuse the builder
+    msg.source = "a6s24";
+    GenDb::ColList expected1;
+    BuildMessageColList(msg, &expected1);
+    BuildMessageColListBuilder(msg, &builder);
+    std::auto_ptr<GenDb::ColList> actual1(builder.Build());
+    EXPECT_EQ(expected1, *actual1);
+}
+
+TEST_F(GenDbColBuilderTest, DynamicCfBuild) {
+    boost::uuids::random_generator rgen;
+    boost::uuids::uuid unm(rgen());
+    std::string stat_name("FieldNames"), stat_attr("fields");
+    std::string tag("name"), value("value"), json("{\"a\":1}");
+    uint32_t t2(12345), t1(678);
+    uint8_t part(0);
+    // Expected
+    GenDb::ColList expected;
+    expected.cfname_ = "StatsTableByStrTagV3";
+    expected.rowkey_.push_back(t2);
+    expected.rowkey_.push_back(part);
+    expected.rowkey_.push_back(stat_name);
+    expected.rowkey_.push_back(stat_attr);
+    expected.rowkey_.push_back(tag);
+    GenDb::DbDataValueVec *cnames(new GenDb::DbDataValueVec);
+    cnames->push_back(value);
+    cnames->push_back(t1);
+    cnames->push_back(unm);
+    GenDb::DbDataValueVec *cvalues(new GenDb::DbDataValueVec(1, json));
+    expected.columns_.push_back(new GenDb::NewCol(cnames, cvalues, 10));
+    // Actual
+    GenDb::ColListBuilder builder;
+    builder.Reset("StatsTableByStrTagV3");
+    builder.AddRowKey(t2);
+    builder.AddRowKey(part);
+    builder.AddRowKey(GenDb::DbStringRef(stat_name));
+    builder.AddRowKey(GenDb::DbStringRef(stat_attr));
+    builder.AddRowKey(GenDb::DbStringRef(tag));
+    builder.BeginColumn(10);
+    builder.AddColumnName(GenDb::DbStringRef(value));
+    builder.AddColumnName(t1);
+    builder.AddColumnName(unm);
+    builder.AddColumnValue(GenDb::DbStringRef(json));
+    std::auto_ptr<GenDb::ColList> actual(builder.Build());
+    EXPECT_EQ(expected, *actual);
+    EXPECT_EQ(expected.GetSize(), builder.GetSize());
+    // Column without values
+    builder.Reset("MessageTablev2");
+    builder.AddRowKey(t2);
+    builder.BeginColumn(10);
+    builder.AddColumnName(t1);
+    std::auto_ptr<GenDb::ColList> actual1(builder.Build());
+    ASSERT_EQ(1, actual1->columns_.size());
+    EXPECT_EQ(1, actual1->columns_[0].name->size());
+    EXPECT_EQ(0, actual1->columns_[0].value->size());
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
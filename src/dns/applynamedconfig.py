@@ -9,7 +9,8 @@ o For backward compatibility we read the named configurable
 o Alternatively user can create/update contrail-name-base.conf
    for configuring named params
 o contrail-named.conf will be generated by dnsd which will
-   contain views/zones stanzas
+   contain views/zones stanzas, or include statements for the
+   per view files
 o contrail-named-base.conf will be merged with contrail-named.conf
    by the script and config applied to named
 """
@@ -118,13 +119,13 @@ def main():
     file2 = open('/etc/contrail/dns/contrail-named.conf', 'r')
     lines = file2.readlines()
     for i, line in enumerate(lines[:]):
-        if line.startswith('view'):
+        if line.startswith('view') or line.startswith('include'):
             break
         else:
            count = count + 1
     file2.close()
 
-    # delete all lines before the view stanza {}
+    # delete all lines before the view stanza {} or view includes
     del lines[1:count]
 
     # open contrail-named.conf
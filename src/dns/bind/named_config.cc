@@ -20,6 +20,8 @@ using namespace std;
 
 NamedConfig *NamedConfig::singleton_;
 const string NamedConfig::NamedZoneFileSuffix = "zone";
+const string NamedConfig::NamedViewFileSuffix = "view.conf";
+const string NamedConfig::NamedDefaultViewName = "_default_view_";
 const string NamedConfig::NamedZoneNSPrefix = "contrail-ns";
 const string NamedConfig::NamedZoneMXPrefix = "contrail-mx";
 const char NamedConfig::pid_file_name[] = "contrail-named.pid";
@@ -43,6 +45,14 @@ void NamedConfig::Shutdown() {
     delete singleton_;
 }
 
+NamedConfig::~NamedConfig() {
+    if (update_timer_) {
+        update_timer_->Cancel();
+        TimerManager::DeleteTimer(update_timer_);
+    }
+    singleton_ = NULL;
+}
+
 // Reset bind config 
 void NamedConfig::Reset() {
     reset_flag_ = true;
@@ -50,12 +60,23 @@ void NamedConfig::Reset() {
     UpdateNamedConf();
     DIR *dir = opendir(named_config_dir_.c_str());
     if (dir) {
+        std::string view_suffix = "." + NamedViewFileSuffix;
         struct dirent *file;
         while ((file = readdir(dir)) != NULL) {
             std::string str(named_config_dir_);
             str.append(file->d_name);
             if (str.find(".zone") != std::string::npos) {
                 remove(str.c_str());
+                continue;
+            }
+            // remove view include files left behind by an earlier run
+            std::string name(file->d_name);
+            if (name.size() > view_suffix.size() &&
+                name.compare(name.size() - view_suffix.size(),
+                             view_suffix.size(), view_suffix) == 0 &&
+                view_config_.find(name.substr(0, name.size() -
+                    view_suffix.size())) == view_config_.end()) {
+                remove(str.c_str());
             }
         }
         closedir(dir);
@@ -78,13 +99,18 @@ void NamedConfig::ChangeView(const VirtualDnsConfig *vdns) {
 }
 
 void NamedConfig::DelView(const VirtualDnsConfig *vdns) {
+    // the view may be gone from the config by the time the update is
+    // applied, so remove its zone files right away
+    ZoneList zones;
+    MakeZoneList(vdns, zones);
+    RemoveZoneFiles(vdns, zones);
     UpdateNamedConf(vdns);
 }
 
+// all_zone_files_ is cleared once the zone files are created
 void NamedConfig::AddAllViews() {
     all_zone_files_ = true;
     UpdateNamedConf();
-    all_zone_files_ = false;
 }
 
 void NamedConfig::AddZone(const Subnet &subnet, const VirtualDnsConfig *vdns) {
@@ -127,8 +153,34 @@ void NamedConfig::DelZone(const Subnet &subnet, const VirtualDnsConfig *vdns) {
     RemoveZoneFiles(vdns, snet_zones);
 }
 
+// Updates are applied together after kUpdateBatchTimeout, except on reset
 void NamedConfig::UpdateNamedConf(const VirtualDnsConfig *updated_vdns) {
-    CreateNamedConf(updated_vdns);
+    if (updated_vdns)
+        zone_file_views_.insert(updated_vdns->GetViewName());
+
+    if (reset_flag_) {
+        if (update_timer_)
+            update_timer_->Cancel();
+        ApplyNamedConf();
+        return;
+    }
+
+    if (!update_timer_) {
+        update_timer_ = TimerManager::CreateTimer(
+                        *Dns::GetEventManager()->io_service(), "NamedConfigTimer",
+                        TaskScheduler::GetInstance()->GetTaskId("dns::Config"), 0);
+    }
+    if (!update_timer_->running()) {
+        update_timer_->Start(kUpdateBatchTimeout,
+                             boost::bind(&NamedConfig::ApplyNamedConf, this));
+    }
+}
+
+bool NamedConfig::ApplyNamedConf() {
+    if (!CreateNamedConf(NULL)) {
+        // nothing changed, named already has this config
+        return false;
+    }
     sync();
 
     ifstream pyscript("/etc/contrail/dns/applynamedconfig.py");
@@ -150,11 +202,17 @@ void NamedConfig::UpdateNamedConf(const VirtualDnsConfig *updated_vdns) {
             LOG(ERROR, "Applying named configuration failed");
         }
     }
+    return false;
 }
 
-void NamedConfig::CreateNamedConf(const VirtualDnsConfig *updated_vdns) {
+// Each view is written to its own include file, and only the files whose
+// contents changed are written again. Returns true if any of the config or
+// zone files changed.
+bool NamedConfig::CreateNamedConf(const VirtualDnsConfig *updated_vdns) {
+     if (updated_vdns)
+         zone_file_views_.insert(updated_vdns->GetViewName());
      GetDefaultForwarders();
-     file_.open(named_config_file_.c_str());
+     file_.str("");
 
      ifstream pyscript("/etc/contrail/dns/applynamedconfig.py");
      if (!pyscript.good()) {
@@ -163,14 +221,81 @@ void NamedConfig::CreateNamedConf(const VirtualDnsConfig *updated_vdns) {
          WriteLoggingConfig();
      }
 
-     WriteViewConfig(updated_vdns);
+     ViewConfigMap views;
+     bool changed = WriteViewConfig(updated_vdns, &views);
+     zone_file_views_.clear();
+     all_zone_files_ = false;
+
+     for (ViewConfigMap::iterator it = views.begin(); it != views.end(); ++it) {
+         if (WriteViewFile(it->first, it->second))
+             changed = true;
+     }
+
+     std::string config = file_.str();
+     file_.str("");
+     if (config != named_config_ &&
+         WriteConfigFile(named_config_file_, config)) {
+         named_config_ = config;
+         changed = true;
+     }
+
+     // remove the include files of the views which are gone, now that
+     // named.conf does not refer to them
+     for (ViewConfigMap::iterator it = view_config_.begin();
+          it != view_config_.end();) {
+         if (views.find(it->first) == views.end()) {
+             remove(GetViewFilePath(it->first).c_str());
+             view_config_.erase(it++);
+             changed = true;
+         } else {
+             ++it;
+         }
+     }
+     return changed;
+}
+
+// Writes the file through a temporary file, so that named never reads a
+// partially written file
+bool NamedConfig::WriteConfigFile(const std::string &path,
+                                  const std::string &content) {
+    std::string tmp_path = path + ".tmp";
+    ofstream file(tmp_path.c_str());
+    file << content;
+    file.flush();
+    bool good = file.good();
+    file.close();
+    if (!good || rename(tmp_path.c_str(), path.c_str()) != 0) {
+        LOG(ERROR, "Writing named configuration file " << path << " failed");
+        remove(tmp_path.c_str());
+        return false;
+    }
+    write_bytes_ += content.size();
+    write_count_++;
+    return true;
+}
+
+bool NamedConfig::WriteViewFile(const std::string &view_name,
+                                const std::string &content) {
+    ViewConfigMap::iterator it = view_config_.find(view_name);
+    if (it != view_config_.end() && it->second == content)
+        return false;
+    if (!WriteConfigFile(GetViewFilePath(view_name), content))
+        return false;
+    view_config_[view_name] = content;
+    return true;
+}
 
-     file_.flush();
-     file_.close();
+void NamedConfig::RemoveViewFiles() {
+    for (ViewConfigMap::iterator it = view_config_.begin();
+         it != view_config_.end(); ++it) {
+        remove(GetViewFilePath(it->first).c_str());
+    }
+    view_config_.clear();
+    named_config_.clear();
 }
 
 void NamedConfig::CreateRndcConf() {
-     file_.open(rndc_config_file_.c_str());
+     file_.str("");
 
      file_ << "key \"rndc-key\" {" << endl;
      file_ << "    algorithm hmac-md5;" << endl;
@@ -183,8 +308,8 @@ void NamedConfig::CreateRndcConf() {
      file_ << "    default-port " << ContrailPorts::DnsRndc() << ";" << endl;
      file_ << "};" << endl << endl;
 
-     file_.flush();
-     file_.close();
+     WriteConfigFile(rndc_config_file_, file_.str());
+     file_.str("");
 }
 
 void NamedConfig::WriteOptionsConfig() {
@@ -234,11 +359,19 @@ void NamedConfig::WriteLoggingConfig() {
     file_ << "};" << endl << endl;
 }
 
-void NamedConfig::WriteViewConfig(const VirtualDnsConfig *updated_vdns) {
+// Renders each view into views, and adds the include statements for them
+// to named.conf. Returns true if zone files were created.
+bool NamedConfig::WriteViewConfig(const VirtualDnsConfig *updated_vdns,
+                                  ViewConfigMap *views) {
     ZoneViewMap zone_view_map;
+    std::string config = file_.str();
+    bool zone_files = false;
     if (reset_flag_) {
+        file_.str("");
         WriteDefaultView(zone_view_map);
-        return;
+        (*views)[NamedDefaultViewName] = file_.str();
+        file_.str(config + GetViewInclude(NamedDefaultViewName));
+        return zone_files;
     }
 
     VirtualDnsConfig::DataMap vdns = VirtualDnsConfig::GetVirtualDnsMap();
@@ -253,6 +386,7 @@ void NamedConfig::WriteViewConfig(const VirtualDnsConfig *updated_vdns) {
         }
 
         std::string view_name = curr_vdns->GetViewName();
+        file_.str("");
         file_ << "view \"" << view_name << "\" {" << endl;
 
         std::string order = curr_vdns->GetRecordOrder();
@@ -286,18 +420,31 @@ void NamedConfig::WriteViewConfig(const VirtualDnsConfig *updated_vdns) {
         }
 
         file_ << "};" << endl << endl;
+        (*views)[view_name] = file_.str();
+        config += GetViewInclude(view_name);
 
-        if (curr_vdns == updated_vdns || all_zone_files_)
+        if (curr_vdns == updated_vdns || all_zone_files_ ||
+            zone_file_views_.find(view_name) != zone_file_views_.end()) {
             AddZoneFiles(zones, curr_vdns);
+            zone_files = true;
+        }
     }
 
+    file_.str("");
     WriteDefaultView(zone_view_map);
+    (*views)[NamedDefaultViewName] = file_.str();
+    file_.str(config + GetViewInclude(NamedDefaultViewName));
+    return zone_files;
+}
+
+string NamedConfig::GetViewInclude(const string &view_name) {
+    return ("include \"" + GetViewFilePath(view_name) + "\";\n");
 }
 
 void NamedConfig::WriteDefaultView(ZoneViewMap &zone_view_map) {
     // Create a default view first for any requests which do not have 
     // view name TXT record
-    file_ << "view \"_default_view_\" {" << endl;
+    file_ << "view \"" << NamedDefaultViewName << "\" {" << endl;
     file_ << "    match-clients {any;};" << endl;
     file_ << "    match-destinations {any;};" << endl;
     file_ << "    match-recursive-only no;" << endl;
@@ -365,6 +512,10 @@ string NamedConfig::GetZoneFilePath(const string &vdns, const string &name) {
     return (named_config_dir_ + GetZoneFileName(vdns, name));
 }
 
+string NamedConfig::GetViewFilePath(const string &view_name) {
+    return (named_config_dir_ + view_name + "." + NamedViewFileSuffix);
+}
+
 string NamedConfig::GetPidFilePath() {
     return (named_config_dir_ + pid_file_name);
 }
@@ -7,7 +7,9 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
 #include <set>
+#include <sstream>
 #include <string>
 #include <base/timer.h>
 
@@ -46,8 +48,16 @@ public:
     // map of zone name to list of views to which they belong
     typedef std::map<std::string, std::string> ZoneViewMap;
     typedef std::pair<std::string, std::string> ZoneViewPair;
+    // map of view name to the contents of its include file
+    typedef std::map<std::string, std::string> ViewConfigMap;
+
+    // changes to the views are applied to named after this delay, so that
+    // a burst of config updates results in a single reconfig
+    static const uint32_t kUpdateBatchTimeout = 100;
 
     static const std::string NamedZoneFileSuffix;
+    static const std::string NamedViewFileSuffix;
+    static const std::string NamedDefaultViewName;
     static const std::string NamedZoneNSPrefix;
     static const std::string NamedZoneMXPrefix;
     static const char pid_file_name[];
@@ -73,13 +83,14 @@ public:
                 const std::string& named_max_cache_size) :
         file_(), named_log_file_(named_log_file), rndc_secret_(rndc_secret),
         named_max_cache_size_(named_max_cache_size),
-        reset_flag_(false), all_zone_files_(false) {
+        reset_flag_(false), all_zone_files_(false), update_timer_(NULL),
+        write_bytes_(0), write_count_(0) {
             named_config_dir_ = named_config_dir + "/";
             named_config_file_ = named_config_dir_ + named_config_file;
             rndc_config_file_ = named_config_dir_ + rndc_config_file;
     }
 
-    virtual ~NamedConfig() { singleton_ = NULL; }
+    virtual ~NamedConfig();
     static NamedConfig *GetNamedConfigObject() { return singleton_; }
     static void Init(const std::string& named_config_dir,
                      const std::string& named_config_file,
@@ -103,6 +114,7 @@ public:
     virtual std::string GetZoneFilePath(const std::string &vdns, 
                                         const std::string &name);
     virtual std::string GetResolveFile() { return "/etc/resolv.conf"; }
+    std::string GetViewFilePath(const std::string &view_name);
     std::string GetPidFilePath();
     std::string GetSessionKeyFilePath();
     const std::string &named_config_dir() const { return named_config_dir_; }
@@ -110,15 +122,24 @@ public:
     const std::string &named_sessionkey_file() const {
         return named_sessionkey_file_;
     }
+    uint64_t write_bytes() const { return write_bytes_; }
+    uint64_t write_count() const { return write_count_; }
 
 protected:
     void CreateRndcConf();
-    void CreateNamedConf(const VirtualDnsConfig *updated_vdns);
+    bool CreateNamedConf(const VirtualDnsConfig *updated_vdns);
+    virtual bool ApplyNamedConf();
+    bool WriteConfigFile(const std::string &path, const std::string &content);
+    bool WriteViewFile(const std::string &view_name,
+                       const std::string &content);
+    void RemoveViewFiles();
     void WriteOptionsConfig();
     void WriteRndcConfig();
     void WriteLoggingConfig();
-    void WriteViewConfig(const VirtualDnsConfig *updated_vdns);
+    bool WriteViewConfig(const VirtualDnsConfig *updated_vdns,
+                         ViewConfigMap *views);
     void WriteDefaultView(ZoneViewMap &zone_view_map);
+    std::string GetViewInclude(const std::string &view_name);
     void WriteZone(const std::string &vdns, const std::string &name,
                    bool is_master, bool is_rr, const std::string &next_dns);
     void AddZoneFiles(ZoneList &zones, const VirtualDnsConfig *vdns);
@@ -132,7 +153,7 @@ protected:
                              ZoneList &zones);
     void GetDefaultForwarders();
 
-    std::ofstream file_;
+    std::stringstream file_;
     std::string named_config_file_;
     std::string named_config_dir_;
     std::string named_sessionkey_file_;
@@ -143,6 +164,14 @@ protected:
     std::string default_forwarders_;
     bool reset_flag_;
     bool all_zone_files_;
+    // contents last written to named.conf and to the view include files
+    std::string named_config_;
+    ViewConfigMap view_config_;
+    // views whose zone files are to be created on the next update
+    std::set<std::string> zone_file_views_;
+    Timer *update_timer_;
+    uint64_t write_bytes_;
+    uint64_t write_count_;
     static NamedConfig *singleton_;
 };
 
@@ -34,21 +34,38 @@ class NamedConfigTest : public NamedConfig {
 public:
     NamedConfigTest(const std::string &conf_dir, const std::string &conf_file) :
                     NamedConfig(conf_dir, conf_file, "/var/log/named/bind.log",
-                                "rndc.conf", "xvysmOR8lnUQRBcunkC6vg==", "100M") {}
+                                "rndc.conf", "xvysmOR8lnUQRBcunkC6vg==", "100M"),
+                    batch_updates_(false), apply_count_(0) {}
     static void Init() {
         assert(singleton_ == NULL);
         singleton_ = new NamedConfigTest(".", "named.conf");
         singleton_->Reset();
     }
     static void Shutdown() {
+        static_cast<NamedConfigTest *>(singleton_)->RemoveViewFiles();
         delete singleton_;
         singleton_ = NULL;
         remove("./named.conf");
         remove("./rndc.conf");
     }
     virtual void UpdateNamedConf(const VirtualDnsConfig *updated_vdns) {
-        CreateNamedConf(updated_vdns);
+        if (batch_updates_) {
+            NamedConfig::UpdateNamedConf(updated_vdns);
+        } else {
+            CreateNamedConf(updated_vdns);
+        }
     }
+    // Writes the config, without asking named to reload it
+    virtual bool ApplyNamedConf() {
+        apply_count_++;
+        CreateNamedConf(NULL);
+        return false;
+    }
+    void set_batch_updates(bool batch_updates) {
+        batch_updates_ = batch_updates;
+    }
+    int apply_count() const { return apply_count_; }
+    bool IsApplied() const { return apply_count_ > 0; }
     std::string GetZoneFileName(const std::string &vdns, 
                                 const std::string &name) {
         if (name.size() && name.at(name.size() - 1) == '.')
@@ -64,6 +81,10 @@ public:
         return GetZoneFilePath("", name);
     }
     std::string GetResolveFile() { return ""; }
+
+private:
+    bool batch_updates_;
+    int apply_count_;
 };
 
 static bool FileExists(const char *file) {
@@ -130,6 +151,27 @@ static bool FilesEqual(const char *file1, const char *file2) {
     return ret;
 }
 
+// Replaces the include statements in named.conf with the contents of the
+// view files, giving the config as named reads it
+static string NamedConfRead(const string &filename) {
+    ifstream file(filename.c_str());
+    string content, line;
+    const string include = "include \"";
+    while (getline(file, line)) {
+        if (line.compare(0, include.size(), include) == 0) {
+            content += FileRead(line.substr(include.size(),
+                line.rfind('"') - include.size()));
+        } else {
+            content += line + "\n";
+        }
+    }
+    return content;
+}
+
+static bool NamedConfEqual(const string &named_conf, const char *file) {
+    return (NamedConfRead(named_conf) == FileRead(file));
+}
+
 class DnsBindTest : public ::testing::Test {
 protected:
 
@@ -257,7 +299,7 @@ TEST_F(DnsBindTest, Reordered) {
         "67.3.2.2.in-addr.arpa",
     };
 
-    EXPECT_TRUE(FilesEqual(cfg->named_config_file().c_str(),
+    EXPECT_TRUE(NamedConfEqual(cfg->named_config_file(),
                 "controller/src/dns/testdata/named.conf.4"));
     for (int i = 0; i < 17; i++) {
         string s1 = cfg->GetZoneFilePath(dns_domains[i]);
@@ -272,7 +314,7 @@ TEST_F(DnsBindTest, Reordered) {
     boost::replace_all(content, "true", "false");
     EXPECT_TRUE(parser_.Parse(content));
     task_util::WaitForIdle();
-    EXPECT_TRUE(FilesEqual(cfg->named_config_file().c_str(),
+    EXPECT_TRUE(NamedConfEqual(cfg->named_config_file(),
                 "controller/src/dns/testdata/named.conf.rr_ext_disabled"));
     // Now we create all zones irrespective of reverse_resolution
     for (int i = 0; i < 17; i++) {
@@ -284,7 +326,7 @@ TEST_F(DnsBindTest, Reordered) {
     boost::replace_all(content, "false", "true");
     EXPECT_TRUE(parser_.Parse(content));
     task_util::WaitForIdle();
-    EXPECT_TRUE(FilesEqual(cfg->named_config_file().c_str(),
+    EXPECT_TRUE(NamedConfEqual(cfg->named_config_file(),
                 "controller/src/dns/testdata/named.conf.4"));
     for (int i = 0; i < 17; i++) {
         string s1 = cfg->GetZoneFilePath(dns_domains[i]);
@@ -320,7 +362,7 @@ TEST_F(DnsBindTest, Reordered) {
     string zone = "3.2.25.in-addr.arpa";
     string s1 = cfg->GetZoneFilePath(zone);
     EXPECT_TRUE(FileExists(s1.c_str()));
-    EXPECT_TRUE(FilesEqual(cfg->named_config_file().c_str(),
+    EXPECT_TRUE(NamedConfEqual(cfg->named_config_file(),
                 "controller/src/dns/testdata/named.conf.5"));
 
     const char config_change_1[] = "\
@@ -379,7 +421,7 @@ TEST_F(DnsBindTest, Reordered) {
 
     EXPECT_TRUE(parser_.Parse(config_change_1));
     task_util::WaitForIdle();
-    EXPECT_TRUE(FilesEqual(cfg->named_config_file().c_str(),
+    EXPECT_TRUE(NamedConfEqual(cfg->named_config_file(),
                 "controller/src/dns/testdata/named.conf.6"));
     for (int i = 0; i < 12; i++) {
         string s1 = cfg->GetZoneFilePath(dns_domains[i]);
@@ -433,7 +475,7 @@ TEST_F(DnsBindTest, Reordered) {
 
     EXPECT_TRUE(parser_.Parse(config_change_2));
     task_util::WaitForIdle();
-    EXPECT_TRUE(FilesEqual(cfg->named_config_file().c_str(),
+    EXPECT_TRUE(NamedConfEqual(cfg->named_config_file(),
                 "controller/src/dns/testdata/named.conf.7"));
 
     const char config_change_3[] = "\
@@ -477,7 +519,7 @@ TEST_F(DnsBindTest, Reordered) {
 
     EXPECT_TRUE(parser_.Parse(config_change_3));
     task_util::WaitForIdle();
-    EXPECT_TRUE(FilesEqual(cfg->named_config_file().c_str(),
+    EXPECT_TRUE(NamedConfEqual(cfg->named_config_file(),
                 "controller/src/dns/testdata/named.conf.8"));
     for (int i = 0; i < 7; i++) {
         string s1 = cfg->GetZoneFilePath(deleted_domains[i]);
@@ -544,7 +586,7 @@ TEST_F(DnsBindTest, ReorderedExternalReverseResolutionDisabled) {
         "67.3.2.2.in-addr.arpa",
     };
 
-    EXPECT_TRUE(FilesEqual(cfg->named_config_file().c_str(),
+    EXPECT_TRUE(NamedConfEqual(cfg->named_config_file(),
                 "controller/src/dns/testdata/named.conf.rr_ext_disabled"));
     for (int i = 0; i < 4; i++) {
         string s1 = cfg->GetZoneFilePath(dns_domains[i]);
@@ -594,7 +636,7 @@ TEST_F(DnsBindTest, ReorderedExternalReverseResolutionDisabled) {
     string zone = "3.2.25.in-addr.arpa";
     string s1 = cfg->GetZoneFilePath(zone);
     EXPECT_TRUE(FileExists(s1.c_str()));
-    EXPECT_FALSE(FilesEqual(cfg->named_config_file().c_str(),
+    EXPECT_FALSE(NamedConfEqual(cfg->named_config_file(),
                 "controller/src/dns/testdata/named.conf.rr_ext_disabled.2"));
 
     // Case 2: Add and Delete a subnet from an ipam
@@ -654,7 +696,7 @@ TEST_F(DnsBindTest, ReorderedExternalReverseResolutionDisabled) {
 
     EXPECT_TRUE(parser_.Parse(config_change_1));
     task_util::WaitForIdle();
-    EXPECT_FALSE(FilesEqual(cfg->named_config_file().c_str(),
+    EXPECT_FALSE(NamedConfEqual(cfg->named_config_file(),
                 "controller/src/dns/testdata/named.conf.rr_ext_disabled"));
 
     for (int i = 0; i < 12; i++) {
@@ -720,7 +762,7 @@ TEST_F(DnsBindTest, ReorderedExternalReverseResolutionDisabled) {
         string s1 = cfg->GetZoneFilePath(deleted_dns_subnets[i]);
         EXPECT_FALSE(FileExists(s1.c_str()));
     }
-    EXPECT_FALSE(FilesEqual(cfg->named_config_file().c_str(),
+    EXPECT_FALSE(NamedConfEqual(cfg->named_config_file(),
                 "controller/src/dns/testdata/named.conf.rr_ext_disabled"));
 
     const char config_change_3[] = "\
@@ -764,7 +806,7 @@ TEST_F(DnsBindTest, ReorderedExternalReverseResolutionDisabled) {
 
     EXPECT_TRUE(parser_.Parse(config_change_3));
     task_util::WaitForIdle();
-    EXPECT_FALSE(FilesEqual(cfg->named_config_file().c_str(),
+    EXPECT_FALSE(NamedConfEqual(cfg->named_config_file(),
                 "controller/src/dns/testdata/named.conf.rr_ext_disabled"));
     for (int i = 0; i < 7; i++) {
         string s1 = cfg->GetZoneFilePath(deleted_domains[i]);
@@ -801,6 +843,65 @@ TEST_F(DnsBindTest, ReorderedExternalReverseResolutionDisabled) {
     }
 }
 
+// A change to one view rewrites only the include file of that view
+TEST_F(DnsBindTest, IncrementalUpdate) {
+    string content = FileRead("controller/src/dns/testdata/config_test_2.xml");
+    EXPECT_TRUE(parser_.Parse(content));
+    task_util::WaitForIdle();
+    NamedConfigTest *cfg = static_cast<NamedConfigTest *>(NamedConfig::GetNamedConfigObject());
+    string expected = FileRead("controller/src/dns/testdata/named.conf.4");
+    EXPECT_EQ(expected, NamedConfRead(cfg->named_config_file()));
+
+    // same config again, nothing is written
+    uint64_t write_bytes = cfg->write_bytes();
+    uint64_t write_count = cfg->write_count();
+    EXPECT_TRUE(parser_.Parse(content));
+    task_util::WaitForIdle();
+    EXPECT_EQ(write_bytes, cfg->write_bytes());
+    EXPECT_EQ(write_count, cfg->write_count());
+
+    boost::replace_all(content, "<record-order>fixed</record-order>",
+                       "<record-order>random</record-order>");
+    EXPECT_TRUE(parser_.Parse(content));
+    task_util::WaitForIdle();
+    boost::replace_all(expected, "{order fixed;}", "{order random;}");
+    EXPECT_EQ(expected, NamedConfRead(cfg->named_config_file()));
+
+    string view_file = FileRead(cfg->GetViewFilePath("last-DNS1"));
+    EXPECT_EQ(write_count + 1, cfg->write_count());
+    EXPECT_EQ(write_bytes + view_file.size(), cfg->write_bytes());
+    EXPECT_LT(view_file.size() * 4, expected.size());
+}
+
+// Config updates are batched by UpdateNamedConf, and applied once when the
+// batch timer fires
+TEST_F(DnsBindTest, BatchedUpdate) {
+    NamedConfigTest *cfg = static_cast<NamedConfigTest *>(NamedConfig::GetNamedConfigObject());
+    cfg->set_batch_updates(true);
+    string initial = NamedConfRead(cfg->named_config_file());
+
+    // Each view and zone in the config results in an update. The timer runs
+    // on the DNS event manager, which is not polled until later.
+    string content = FileRead("controller/src/dns/testdata/config_test_2.xml");
+    EXPECT_TRUE(parser_.Parse(content));
+    task_util::WaitForIdle();
+    EXPECT_EQ(0, cfg->apply_count());
+    EXPECT_EQ(initial, NamedConfRead(cfg->named_config_file()));
+
+    task_util::WaitForCondition(Dns::GetEventManager(),
+        boost::bind(&NamedConfigTest::IsApplied, cfg), 5);
+    task_util::WaitForIdle();
+    EXPECT_EQ(1, cfg->apply_count());
+    EXPECT_TRUE(NamedConfEqual(cfg->named_config_file(),
+                "controller/src/dns/testdata/named.conf.4"));
+
+    // Nothing is pending after the batch is applied
+    Dns::GetEventManager()->Poll();
+    task_util::WaitForIdle();
+    EXPECT_EQ(1, cfg->apply_count());
+    cfg->set_batch_updates(false);
+}
+
 TEST_F(DnsBindTest, DnsClassTest) {
     std::string cl = BindUtil::DnsClass(4);
     EXPECT_TRUE(cl == "4");
@@ -41,6 +41,7 @@ public:
         singleton_->Reset();
     }
     static void Shutdown() {
+        static_cast<NamedConfigTest *>(singleton_)->RemoveViewFiles();
         delete singleton_;
         singleton_ = NULL;
         remove("./named.conf");
@@ -523,7 +523,7 @@ void IFMapExporter::LinkTableExport(DBTablePartBase *partition,
 
         IFMAP_DEBUG(LinkOper, "LinkRemove", left->ToString(), right->ToString(),
             s_left->interest().ToString(), s_right->interest().ToString());
-        walker_->LinkRemove(interest);
+        walker_->LinkRemove(left, right, interest);
 
         state->RemoveDependency();
         state->ClearValid();
@@ -68,6 +68,7 @@ public:
 
     DBTable *link_table() { return link_table_; }
     IFMapServer *server() { return server_; }
+    IFMapGraphWalker *graph_walker() { return walker_.get(); }
 
     bool FilterNeighbor(IFMapNode *lnode, IFMapLink *link);
 
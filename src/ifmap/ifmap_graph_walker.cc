@@ -4,6 +4,8 @@
 
 #include "ifmap/ifmap_graph_walker.h"
 
+#include <queue>
+
 #include <boost/assign/list_of.hpp>
 #include <boost/bind.hpp>
 
@@ -73,7 +75,10 @@ IFMapGraphWalker::IFMapGraphWalker(DBGraph *graph, IFMapExporter *exporter)
       link_delete_walk_trigger_(new TaskTrigger(
           boost::bind(&IFMapGraphWalker::LinkDeleteWalk, this),
           TaskScheduler::GetInstance()->GetTaskId("db::IFMapTable"), 0)),
-      walk_client_index_(BitSet::npos) {
+      walk_client_index_(BitSet::npos),
+      max_incremental_nodes_(kMaxIncrementalNodes),
+      incremental_walk_count_(0),
+      full_walk_count_(0) {
     traversal_white_list_.reset(new IFMapTypenameWhiteList());
     AddNodesToWhitelist();
 }
@@ -120,8 +125,19 @@ void IFMapGraphWalker::LinkAdd(IFMapLink *link, IFMapNode *lnode, const BitSet &
     }
 }
 
-void IFMapGraphWalker::LinkRemove(const BitSet &bset) {
-    OrLinkDeleteClients(bset);          // link_delete_clients_ | bset
+void IFMapGraphWalker::LinkRemove(IFMapNode *lnode, IFMapNode *rnode,
+                                  const BitSet &bset) {
+    // Clients that already have a full walk pending are taken care of by it.
+    BitSet walk_set;
+    walk_set.BuildComplement(bset, link_delete_clients_);
+    if (walk_set.empty()) {
+        return;
+    }
+    if (LinkDeleteIncremental(lnode, rnode, walk_set)) {
+        incremental_walk_count_++;
+        return;
+    }
+    OrLinkDeleteClients(walk_set);      // link_delete_clients_ | walk_set
     link_delete_walk_trigger_->Set();
 }
 
@@ -167,6 +183,7 @@ bool IFMapGraphWalker::LinkDeleteWalk() {
         IFMapClient *client = server->GetClient(i);
         assert(client);
         AddNewReachableNodesTracker(client->index());
+        full_walk_count_++;
 
         IFMapTable *table = IFMapTable::FindTable(server->database(),
                                                   "virtual-router");
@@ -224,6 +241,11 @@ void IFMapGraphWalker::CleanupInterest(int client_index, IFMapNode *node,
     ninterest.BuildComplement(state->interest(), rm_mask);
     ninterest |= state->nmask();
     state->nmask_clear();
+    UpdateInterest(node, state, ninterest);
+}
+
+void IFMapGraphWalker::UpdateInterest(IFMapNode *node, IFMapNodeState *state,
+                                      const BitSet &ninterest) {
     if (state->interest() == ninterest) {
         return;
     }
@@ -239,6 +261,170 @@ void IFMapGraphWalker::CleanupInterest(int client_index, IFMapNode *node,
     }
 }
 
+// Returns true if the graph walk goes from source to target over edge.
+bool IFMapGraphWalker::TraversalAllowed(IFMapNode *source, DBGraphEdge *edge,
+                                        IFMapNode *target) const {
+    if (source->IsDeleted() || target->IsDeleted() || edge->IsDeleted()) {
+        return false;
+    }
+    return (traversal_white_list_->VertexFilter(source) &&
+            traversal_white_list_->VertexFilter(target) &&
+            traversal_white_list_->EdgeFilter(source, target, edge));
+}
+
+// Recompute the interest of the clients in bset after the link between lnode
+// and rnode has been removed from the graph, without walking the graph from
+// each client's vrouter node.
+// Only the nodes that a client reached through the removed link can lose
+// the client's interest, and all of them are reachable from the link's
+// end points. These are collected first as candidates, per client bit.
+// A candidate is still reachable if it is the client's vrouter node or if it
+// has a neighbor that is interested but is not a candidate itself. Starting
+// from these, the interest is propagated within the candidate set. The
+// candidates that are not reached this way lose the client's interest.
+// Plain reference counts on the interest would not work here since the
+// traversal graph has cycles (e.g. virtual-network and floating-ip-pool).
+// Returns false if the candidate set grows beyond max_incremental_nodes_, in
+// which case the interest must be recomputed with a full walk.
+bool IFMapGraphWalker::LinkDeleteIncremental(IFMapNode *lnode,
+                                             IFMapNode *rnode,
+                                             const BitSet &bset) {
+    InterestMap candidates;
+    std::queue<IFMapNode *> work_q;
+
+    IFMapNode *ends[] = { lnode, rnode };
+    for (size_t i = 0; i < sizeof(ends) / sizeof(ends[0]); ++i) {
+        IFMapNode *node = ends[i];
+        if (!node->IsVertexValid() || node->IsDeleted() ||
+            !traversal_white_list_->VertexFilter(node)) {
+            continue;
+        }
+        IFMapNodeState *state = exporter_->NodeStateLookup(node);
+        if (state == NULL) {
+            continue;
+        }
+        BitSet bits = state->interest() & bset;
+        if (!bits.empty()) {
+            candidates.insert(std::make_pair(node, bits));
+            work_q.push(node);
+        }
+    }
+
+    // Collect the candidates.
+    while (!work_q.empty()) {
+        IFMapNode *node = work_q.front();
+        work_q.pop();
+        BitSet cand = candidates[node];
+        for (DBGraphVertex::edge_iterator iter =
+             node->edge_list_begin(graph_);
+             iter != node->edge_list_end(graph_); ++iter) {
+            IFMapNode *target = static_cast<IFMapNode *>(iter.target());
+            if (!TraversalAllowed(node, &*iter, target)) {
+                continue;
+            }
+            IFMapNodeState *state = exporter_->NodeStateLookup(target);
+            if (state == NULL) {
+                continue;
+            }
+            BitSet bits = cand & state->interest();
+            InterestMap::iterator loc = candidates.find(target);
+            if (loc != candidates.end()) {
+                if (loc->second.Contains(bits)) {
+                    continue;
+                }
+                loc->second |= bits;
+            } else {
+                if (bits.empty()) {
+                    continue;
+                }
+                if (candidates.size() >= max_incremental_nodes_) {
+                    return false;
+                }
+                candidates.insert(std::make_pair(target, bits));
+            }
+            work_q.push(target);
+        }
+    }
+
+    // Find the candidates that are still reachable from outside the set.
+    IFMapServer *server = exporter_->server();
+    InterestMap reach;
+    for (InterestMap::const_iterator it = candidates.begin();
+         it != candidates.end(); ++it) {
+        IFMapNode *node = it->first;
+        BitSet support;
+        if (node->table()->name() == "__ifmap__.virtual_router.0") {
+            IFMapClient *client = server->FindClient(node->name());
+            if ((client != NULL) && it->second.test(client->index())) {
+                support.set(client->index());
+            }
+        }
+        for (DBGraphVertex::edge_iterator iter =
+             node->edge_list_begin(graph_);
+             iter != node->edge_list_end(graph_); ++iter) {
+            IFMapNode *source = static_cast<IFMapNode *>(iter.target());
+            if (!TraversalAllowed(source, &*iter, node)) {
+                continue;
+            }
+            IFMapNodeState *state = exporter_->NodeStateLookup(source);
+            if (state == NULL) {
+                continue;
+            }
+            BitSet bits = state->interest() & it->second;
+            InterestMap::const_iterator loc = candidates.find(source);
+            if (loc != candidates.end()) {
+                bits.Reset(loc->second);
+            }
+            support |= bits;
+        }
+        if (!support.empty()) {
+            reach.insert(std::make_pair(node, support));
+            work_q.push(node);
+        }
+    }
+
+    // Propagate the interest within the candidate set.
+    while (!work_q.empty()) {
+        IFMapNode *node = work_q.front();
+        work_q.pop();
+        BitSet bits = reach[node];
+        for (DBGraphVertex::edge_iterator iter =
+             node->edge_list_begin(graph_);
+             iter != node->edge_list_end(graph_); ++iter) {
+            IFMapNode *target = static_cast<IFMapNode *>(iter.target());
+            InterestMap::const_iterator loc = candidates.find(target);
+            if ((loc == candidates.end()) ||
+                !TraversalAllowed(node, &*iter, target)) {
+                continue;
+            }
+            BitSet add = bits & loc->second;
+            BitSet &target_reach = reach[target];
+            if (target_reach.Contains(add)) {
+                continue;
+            }
+            target_reach |= add;
+            work_q.push(target);
+        }
+    }
+
+    for (InterestMap::const_iterator it = candidates.begin();
+         it != candidates.end(); ++it) {
+        BitSet rm_mask = it->second;
+        InterestMap::const_iterator loc = reach.find(it->first);
+        if (loc != reach.end()) {
+            rm_mask.Reset(loc->second);
+        }
+        if (rm_mask.empty()) {
+            continue;
+        }
+        IFMapNodeState *state = exporter_->NodeStateLookup(it->first);
+        BitSet ninterest;
+        ninterest.BuildComplement(state->interest(), rm_mask);
+        UpdateInterest(it->first, state, ninterest);
+    }
+    return true;
+}
+
 // Cleanup all the graph nodes that were reachable before this link delete.
 // After this link delete, these nodes may still be reachable. But, its
 // also possible that the link delete has made them unreachable.
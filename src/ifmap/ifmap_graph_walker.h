@@ -5,6 +5,8 @@
 #ifndef __ctrlplane__ifmap_graph_walker__
 #define __ctrlplane__ifmap_graph_walker__
 
+#include <map>
+
 #include "base/bitset.h"
 #include "base/queue_task.h"
 
@@ -34,14 +36,27 @@ public:
     // list.
     void LinkAdd(IFMapLink *link, IFMapNode *lnode, const BitSet &lhs,
                  IFMapNode *rnode, const BitSet &rhs);
-    void LinkRemove(const BitSet &bset);
+    // When a link is removed, recompute the interest of the clients in bset
+    // for the part of the graph that was reachable through the link. Falls
+    // back to a full walk from the vrouter node if that part is too large.
+    void LinkRemove(IFMapNode *lnode, IFMapNode *rnode, const BitSet &bset);
 
     bool FilterNeighbor(IFMapNode *lnode, IFMapLink *link);
     const IFMapTypenameWhiteList &get_traversal_white_list() const;
     void ResetLinkDeleteClients(const BitSet &bset);
 
+    uint64_t incremental_walk_count() const { return incremental_walk_count_; }
+    uint64_t full_walk_count() const { return full_walk_count_; }
+    void set_max_incremental_nodes(size_t max_nodes) {
+        max_incremental_nodes_ = max_nodes;
+    }
+
 private:
     static const int kMaxLinkDeleteWalks = 1;
+    static const size_t kMaxIncrementalNodes = 4096;
+
+    // Client interest bits per node, used by the incremental link delete.
+    typedef std::map<IFMapNode *, BitSet> InterestMap;
 
     void ProcessLinkAdd(IFMapNode *lnode, IFMapNode *rnode, const BitSet &bset);
     void JoinVertex(DBGraphVertex *vertex, const BitSet &bset);
@@ -49,6 +64,12 @@ private:
     void RecomputeInterest(DBGraphVertex *vertex, int bit);
     void CleanupInterest(int client_index, IFMapNode *node,
                          IFMapNodeState *state);
+    void UpdateInterest(IFMapNode *node, IFMapNodeState *state,
+                        const BitSet &ninterest);
+    bool TraversalAllowed(IFMapNode *source, DBGraphEdge *edge,
+                          IFMapNode *target) const;
+    bool LinkDeleteIncremental(IFMapNode *lnode, IFMapNode *rnode,
+                               const BitSet &bset);
     void AddNodesToWhitelist();
     void AddLinksToWhitelist();
     bool LinkDeleteWalk();
@@ -67,6 +88,9 @@ private:
     BitSet link_delete_clients_;
     size_t walk_client_index_;
     ReachableNodesTracker new_reachable_nodes_tracker_;
+    size_t max_incremental_nodes_;
+    uint64_t incremental_walk_count_;
+    uint64_t full_walk_count_;
 };
 
 #endif /* defined(__ctrlplane__ifmap_graph_walker__) */
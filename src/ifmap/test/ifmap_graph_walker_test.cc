@@ -6,17 +6,23 @@
 
 #include <fstream>
 
+#include <boost/ptr_container/ptr_vector.hpp>
+
 #include "base/logging.h"
+#include "base/string_util.h"
 #include "base/test/task_test_util.h"
+#include "base/time_util.h"
 #include "control-node/control_node.h"
 #include "db/db.h"
 #include "db/db_graph.h"
 #include "io/event_manager.h"
 #include "ifmap/ifmap_client.h"
+#include "ifmap/ifmap_exporter.h"
 #include "ifmap/ifmap_link_table.h"
 #include "ifmap/ifmap_server.h"
 #include "ifmap/ifmap_server_parser.h"
 #include "ifmap/ifmap_table.h"
+#include "ifmap/ifmap_update.h"
 #include "ifmap/ifmap_util.h"
 #include "ifmap/test/ifmap_client_mock.h"
 #include "ifmap/test/ifmap_test_util.h"
@@ -61,6 +67,58 @@ protected:
         return content;
     }
 
+    IFMapNode *TableLookup(const string &type, const string &name) {
+        IFMapTable *table = IFMapTable::FindTable(&db_, type);
+        if (table == NULL) {
+            return NULL;
+        }
+        return table->FindNode(name);
+    }
+
+    bool NodeInterest(const string &type, const string &name,
+                      const IFMapClient &client) {
+        IFMapNode *node = TableLookup(type, name);
+        if (node == NULL) {
+            return false;
+        }
+        IFMapNodeState *state = server_.exporter()->NodeStateLookup(node);
+        if (state == NULL) {
+            return false;
+        }
+        return state->interest().test(client.index());
+    }
+
+    IFMapGraphWalker *graph_walker() {
+        return server_.exporter()->graph_walker();
+    }
+
+    // Vrouter vr<i> hosts vm<i>-<j>, each with one interface in the shared
+    // virtual-network.
+    void AddVrouterConfig(int vr, int vms) {
+        string vr_name = "vr" + integerToString(vr);
+        for (int j = 0; j < vms; ++j) {
+            string suffix = integerToString(vr) + "-" + integerToString(j);
+            ifmap_test_util::IFMapMsgLink(&db_, "virtual-router", vr_name,
+                "virtual-machine", "vm" + suffix,
+                "virtual-router-virtual-machine");
+            ifmap_test_util::IFMapMsgLink(&db_, "virtual-machine-interface",
+                "vmi" + suffix, "virtual-machine", "vm" + suffix,
+                "virtual-machine-interface-virtual-machine");
+            ifmap_test_util::IFMapMsgLink(&db_, "virtual-machine-interface",
+                "vmi" + suffix, "virtual-network", "vn-shared",
+                "virtual-machine-interface-virtual-network");
+        }
+    }
+
+    void AddSharedNetworkConfig() {
+        ifmap_test_util::IFMapMsgLink(&db_, "virtual-network", "vn-shared",
+            "routing-instance", "ri-shared",
+            "virtual-network-routing-instance");
+        ifmap_test_util::IFMapMsgLink(&db_, "virtual-network", "vn-shared",
+            "access-control-list", "acl-shared",
+            "virtual-network-access-control-list");
+    }
+
     DB db_;
     DBGraph db_graph_;
     EventManager evm_;
@@ -656,6 +714,134 @@ TEST_F(IFMapGraphWalkerTest, VrsubConfignoprop) {
     c1.PrintNodes();
 }
 
+// Removing an interface from the shared network takes the network away from
+// that vrouter only, without a full walk.
+TEST_F(IFMapGraphWalkerTest, LinkDeleteIncremental) {
+    IFMapClientMock c0("vr0");
+    IFMapClientMock c1("vr1");
+    server_.AddClient(&c0);
+    server_.AddClient(&c1);
+    task_util::WaitForIdle();
+
+    AddSharedNetworkConfig();
+    AddVrouterConfig(0, 2);
+    AddVrouterConfig(1, 1);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_TRUE(NodeInterest("routing-instance", "ri-shared", c0));
+    TASK_UTIL_EXPECT_TRUE(NodeInterest("routing-instance", "ri-shared", c1));
+    TASK_UTIL_EXPECT_TRUE(NodeInterest("virtual-network", "vn-shared", c0));
+    TASK_UTIL_EXPECT_TRUE(NodeInterest("virtual-network", "vn-shared", c1));
+
+    // vr0 still reaches the network through its other interface.
+    ifmap_test_util::IFMapMsgUnlink(&db_, "virtual-machine-interface",
+        "vmi0-0", "virtual-network", "vn-shared",
+        "virtual-machine-interface-virtual-network");
+    task_util::WaitForIdle();
+    EXPECT_TRUE(NodeInterest("virtual-network", "vn-shared", c0));
+    EXPECT_TRUE(NodeInterest("routing-instance", "ri-shared", c0));
+    EXPECT_TRUE(NodeInterest("virtual-machine-interface", "vmi0-0", c0));
+
+    ifmap_test_util::IFMapMsgUnlink(&db_, "virtual-machine-interface",
+        "vmi0-1", "virtual-network", "vn-shared",
+        "virtual-machine-interface-virtual-network");
+    task_util::WaitForIdle();
+    EXPECT_FALSE(NodeInterest("virtual-network", "vn-shared", c0));
+    EXPECT_FALSE(NodeInterest("routing-instance", "ri-shared", c0));
+    EXPECT_FALSE(NodeInterest("access-control-list", "acl-shared", c0));
+    EXPECT_TRUE(NodeInterest("virtual-machine-interface", "vmi0-1", c0));
+    EXPECT_TRUE(NodeInterest("virtual-network", "vn-shared", c1));
+    EXPECT_TRUE(NodeInterest("routing-instance", "ri-shared", c1));
+    TASK_UTIL_EXPECT_FALSE(c0.NodeExists("routing-instance", "ri-shared"));
+
+    // Removing the vrouter-vm link takes away everything behind the vm.
+    ifmap_test_util::IFMapMsgUnlink(&db_, "virtual-router", "vr1",
+        "virtual-machine", "vm1-0", "virtual-router-virtual-machine");
+    task_util::WaitForIdle();
+    EXPECT_FALSE(NodeInterest("virtual-machine", "vm1-0", c1));
+    EXPECT_FALSE(NodeInterest("virtual-machine-interface", "vmi1-0", c1));
+    EXPECT_FALSE(NodeInterest("virtual-network", "vn-shared", c1));
+    EXPECT_FALSE(NodeInterest("routing-instance", "ri-shared", c1));
+    EXPECT_TRUE(NodeInterest("virtual-router", "vr1", c1));
+
+    EXPECT_EQ(3, graph_walker()->incremental_walk_count());
+    EXPECT_EQ(0, graph_walker()->full_walk_count());
+}
+
+// The full walk takes over when the affected part of the graph is too large,
+// with the same result.
+TEST_F(IFMapGraphWalkerTest, LinkDeleteFullWalkFallback) {
+    IFMapClientMock c0("vr0");
+    IFMapClientMock c1("vr1");
+    server_.AddClient(&c0);
+    server_.AddClient(&c1);
+    task_util::WaitForIdle();
+    graph_walker()->set_max_incremental_nodes(1);
+
+    AddSharedNetworkConfig();
+    AddVrouterConfig(0, 1);
+    AddVrouterConfig(1, 1);
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_TRUE(NodeInterest("routing-instance", "ri-shared", c0));
+
+    ifmap_test_util::IFMapMsgUnlink(&db_, "virtual-machine-interface",
+        "vmi0-0", "virtual-network", "vn-shared",
+        "virtual-machine-interface-virtual-network");
+    task_util::WaitForIdle();
+    EXPECT_FALSE(NodeInterest("virtual-network", "vn-shared", c0));
+    EXPECT_FALSE(NodeInterest("routing-instance", "ri-shared", c0));
+    EXPECT_TRUE(NodeInterest("virtual-machine-interface", "vmi0-0", c0));
+    EXPECT_TRUE(NodeInterest("virtual-network", "vn-shared", c1));
+    EXPECT_TRUE(NodeInterest("routing-instance", "ri-shared", c1));
+
+    EXPECT_EQ(0, graph_walker()->incremental_walk_count());
+    EXPECT_EQ(1, graph_walker()->full_walk_count());
+}
+
+// Time the link deletes that touch the shared network of all the vrouters,
+// with the incremental walk and with the full walk.
+TEST_F(IFMapGraphWalkerTest, DISABLED_LinkDeleteScalingPerf) {
+    const int kVrouters = 256;
+    const int kVmsPerVrouter = 64;
+    const int kIterations = 16;
+
+    boost::ptr_vector<IFMapClientMock> clients;
+    for (int i = 0; i < kVrouters; ++i) {
+        clients.push_back(new IFMapClientMock("vr" + integerToString(i)));
+        server_.AddClient(&clients.back());
+    }
+    task_util::WaitForIdle();
+    AddSharedNetworkConfig();
+    for (int i = 0; i < kVrouters; ++i) {
+        AddVrouterConfig(i, kVmsPerVrouter);
+    }
+    task_util::WaitForIdle();
+
+    for (int full = 0; full < 2; ++full) {
+        if (full) {
+            graph_walker()->set_max_incremental_nodes(0);
+        }
+        uint64_t start = ClockMonotonicUsec();
+        for (int n = 0; n < kIterations; ++n) {
+            ifmap_test_util::IFMapMsgUnlink(&db_, "virtual-network",
+                "vn-shared", "routing-instance", "ri-shared",
+                "virtual-network-routing-instance");
+            task_util::WaitForIdle();
+            ifmap_test_util::IFMapMsgLink(&db_, "virtual-network",
+                "vn-shared", "routing-instance", "ri-shared",
+                "virtual-network-routing-instance");
+            task_util::WaitForIdle();
+        }
+        uint64_t elapsed = ClockMonotonicUsec() - start;
+        LOG(DEBUG, (full ? "Full" : "Incremental") << " walk: " <<
+            kIterations << " link deletes for " << kVrouters <<
+            " vrouters in " << elapsed << " usec");
+    }
+    LOG(DEBUG, "Incremental walks: " <<
+        graph_walker()->incremental_walk_count() << ", full walks: " <<
+        graph_walker()->full_walk_count());
+}
+
 #if 0
 // Calculate the white list filter information based on the xsd.
 TEST_F(IFMapGraphWalkerTest, PopulateWhiteList) {
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "io/buffer_pool.h"
+
+const size_t BufferPool::kDefaultSlabSize;
+const size_t BufferPool::kDefaultMaxFree;
+
+BufferPool::BufferPool(size_t slab_size, size_t max_free)
+    : slab_size_(slab_size), max_free_(max_free) {
+}
+
+BufferPool::~BufferPool() {
+    for (FreeList::iterator iter = free_list_.begin();
+         iter != free_list_.end(); ++iter) {
+        delete[] *iter;
+    }
+}
+
+uint8_t *BufferPool::Allocate(size_t size) {
+    if (size != slab_size_) {
+        tbb::spin_mutex::scoped_lock lock(mutex_);
+        stats_.oversize++;
+        lock.release();
+        return new uint8_t[size];
+    }
+
+    tbb::spin_mutex::scoped_lock lock(mutex_);
+    if (!free_list_.empty()) {
+        uint8_t *data = free_list_.back();
+        free_list_.pop_back();
+        stats_.hits++;
+        return data;
+    }
+    stats_.misses++;
+    lock.release();
+    return new uint8_t[size];
+}
+
+void BufferPool::Free(uint8_t *data, size_t size) {
+    tbb::spin_mutex::scoped_lock lock(mutex_);
+    if (size == slab_size_ && free_list_.size() < max_free_) {
+        free_list_.push_back(data);
+        stats_.recycled++;
+        return;
+    }
+    stats_.freed++;
+    lock.release();
+    delete[] data;
+}
+
+void BufferPool::set_max_free(size_t max_free) {
+    FreeList trimmed;
+    {
+        tbb::spin_mutex::scoped_lock lock(mutex_);
+        max_free_ = max_free;
+        while (free_list_.size() > max_free_) {
+            trimmed.push_back(free_list_.back());
+            free_list_.pop_back();
+        }
+    }
+    for (FreeList::iterator iter = trimmed.begin();
+         iter != trimmed.end(); ++iter) {
+        delete[] *iter;
+    }
+}
+
+size_t BufferPool::free_count() const {
+    tbb::spin_mutex::scoped_lock lock(mutex_);
+    return free_list_.size();
+}
+
+void BufferPool::GetStats(Stats *stats) const {
+    tbb::spin_mutex::scoped_lock lock(mutex_);
+    *stats = stats_;
+}
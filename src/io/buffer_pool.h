@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_IO_BUFFER_POOL_H_
+#define SRC_IO_BUFFER_POOL_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include <tbb/spin_mutex.h>
+
+#include "base/util.h"
+
+//
+// Pool of fixed size receive buffers, shared by all the sessions of an
+// EventManager.
+//
+// Buffers of exactly the slab size are recycled through a free list that
+// holds at most max_free buffers; anything else is allocated and freed on
+// the heap. Allocate is invoked from the io thread and Free from whichever
+// thread releases the buffer, so the free list is protected by a mutex.
+//
+class BufferPool {
+public:
+    static const size_t kDefaultSlabSize = 16 * 1024;
+    static const size_t kDefaultMaxFree = 256;
+
+    struct Stats {
+        Stats() : hits(0), misses(0), oversize(0), recycled(0), freed(0) {
+        }
+        uint64_t hits;      // slab allocations served from the free list
+        uint64_t misses;    // slab allocations that went to the heap
+        uint64_t oversize;  // allocations of any other size
+        uint64_t recycled;  // slabs returned to the free list
+        uint64_t freed;     // buffers returned to the heap
+    };
+
+    explicit BufferPool(size_t slab_size = kDefaultSlabSize,
+                        size_t max_free = kDefaultMaxFree);
+    ~BufferPool();
+
+    uint8_t *Allocate(size_t size);
+    void Free(uint8_t *data, size_t size);
+
+    size_t slab_size() const { return slab_size_; }
+    size_t max_free() const { return max_free_; }
+    void set_max_free(size_t max_free);
+    size_t free_count() const;
+    void GetStats(Stats *stats) const;
+
+private:
+    typedef std::vector<uint8_t *> FreeList;
+
+    const size_t slab_size_;
+    mutable tbb::spin_mutex mutex_;
+    size_t max_free_;
+    FreeList free_list_;
+    Stats stats_;
+
+    DISALLOW_COPY_AND_ASSIGN(BufferPool);
+};
+
+#endif  // SRC_IO_BUFFER_POOL_H_
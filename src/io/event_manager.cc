@@ -8,31 +8,62 @@
 
 #include "io/event_manager.h"
 #include "base/logging.h"
+#include "base/task.h"
 #include "io/io_log.h"
 
 using boost::asio::io_service;
 
 SandeshTraceBufferPtr IOTraceBuf(SandeshTraceBufferCreate(IO_TRACE_BUF, 1000));
 
-EventManager::EventManager() {
+EventManager::Shard::Shard(EventManager *evm,
+                           boost::asio::io_service *service)
+    : evm(evm), service(service), thread(pthread_self()) {
+    if (!service) {
+        owned_service.reset(new boost::asio::io_service);
+        this->service = owned_service.get();
+    }
+    sessions = 0;
+    sessions_created = 0;
+}
+
+EventManager::EventManager(int shard_count) {
     shutdown_ = false;
+    speculative_read_ = false;
+    assert(shard_count > 0);
+    shards_.push_back(new Shard(this, &io_service_));
+    for (int shard = 1; shard < shard_count; shard++) {
+        shards_.push_back(new Shard(this, NULL));
+    }
+}
+
+EventManager::~EventManager() {
 }
 
 void EventManager::Shutdown() {
     shutdown_ = true;
-    io_service_.stop();
+    for (boost::ptr_vector<Shard>::iterator iter = shards_.begin();
+         iter != shards_.end(); ++iter) {
+        iter->service->stop();
+    }
 }
 
 void EventManager::Run() {
+    assert(mutex_.try_lock());
+    StartShards();
+    RunService(&io_service_);
+    StopShards();
+    mutex_.unlock();
+}
+
+void EventManager::RunService(boost::asio::io_service *service) {
     using apache::thrift::TException;
 
-    assert(mutex_.try_lock());
-    io_service::work work(io_service_);
+    io_service::work work(*service);
     do {
         if (shutdown_) break;
         boost::system::error_code ec;
         try {
-            io_service_.run(ec);
+            service->run(ec);
             if (ec) {
                 EVENT_MANAGER_LOG_ERROR("io_service run failed: " <<
                                         ec.message());
@@ -54,7 +85,72 @@ void EventManager::Run() {
             assert(false);
         }
     } while (true);
-    mutex_.unlock();
+}
+
+// Shard threads enqueue reader tasks, so they join the task scheduler the
+// same way as the thread that runs shard 0.
+void *EventManager::ShardThreadRun(void *arg) {
+    Shard *shard = reinterpret_cast<Shard *>(arg);
+    tbb::task_scheduler_init init(TaskScheduler::GetThreadCount() + 1);
+    shard->evm->RunService(shard->service);
+    return NULL;
+}
+
+void EventManager::StartShards() {
+    for (size_t idx = 1; idx < shards_.size(); idx++) {
+        int res = pthread_create(&shards_[idx].thread, NULL,
+                                 &EventManager::ShardThreadRun, &shards_[idx]);
+        assert(res == 0);
+    }
+}
+
+void EventManager::StopShards() {
+    for (size_t idx = 1; idx < shards_.size(); idx++) {
+        shards_[idx].service->stop();
+        int res = pthread_join(shards_[idx].thread, NULL);
+        assert(res == 0);
+    }
+}
+
+int EventManager::ShardIndex(
+    const boost::asio::io_service *service) const {
+    for (size_t idx = 0; idx < shards_.size(); idx++) {
+        if (shards_[idx].service == service) {
+            return idx;
+        }
+    }
+    // Accounted to shard 0, if the io_service isn't one of ours.
+    return 0;
+}
+
+int EventManager::SelectShard() const {
+    size_t selected = 0;
+    for (size_t idx = 1; idx < shards_.size(); idx++) {
+        if (shards_[idx].sessions < shards_[selected].sessions) {
+            selected = idx;
+        }
+    }
+    return selected;
+}
+
+void EventManager::ShardSessionAdd(int shard) {
+    shards_[shard].sessions++;
+    shards_[shard].sessions_created++;
+}
+
+void EventManager::ShardSessionDelete(int shard) {
+    shards_[shard].sessions--;
+}
+
+void EventManager::GetShardStats(
+    std::vector<EventManagerShardStats> *stats) const {
+    for (size_t idx = 0; idx < shards_.size(); idx++) {
+        EventManagerShardStats shard_stats;
+        shard_stats.shard = idx;
+        shard_stats.sessions = shards_[idx].sessions;
+        shard_stats.sessions_created = shards_[idx].sessions_created;
+        stats->push_back(shard_stats);
+    }
 }
 
 size_t EventManager::RunOnce() {
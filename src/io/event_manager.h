@@ -7,10 +7,18 @@
 
 #pragma once
 
+#include <pthread.h>
+#include <tbb/atomic.h>
 #include <tbb/spin_mutex.h>
+#include <vector>
 #include <boost/asio/io_service.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "base/util.h"
+#include "io/buffer_pool.h"
+
+class EventManagerShardStats;
 
 //
 // Wrapper around boost::io_service.
@@ -21,9 +29,27 @@
 // Poll directly or indirectly after having started a ServerThread (which
 // calls Run).
 //
+// The buffer pool recycles the receive buffers of the TcpSessions that are
+// serviced by the EventManager.
+//
+// By default a TcpSession waits for its socket to become readable before
+// every read. With speculative reads, a session that got data on its last
+// read reads again right away, and only waits for readiness once the read
+// comes up empty. This saves a trip through the reactor per read for busy
+// sessions, at the cost of an extra empty read for idle ones.
+//
+// The EventManager can be split into several shards, each with its own
+// io_service and thread. Shard 0 is the io_service of the EventManager
+// itself, which is run by the caller of Run; Run starts a thread for each
+// of the other shards and stops them on Shutdown. TcpServer places each new
+// session on the shard with the fewest sessions. A session's socket and
+// strand belong to one shard, so its callbacks stay ordered. RunOnce and
+// Poll only service shard 0.
+//
 class EventManager {
 public:
-    EventManager();
+    explicit EventManager(int shard_count = 1);
+    ~EventManager();
 
     // Run until shutdown.
     void Run();
@@ -37,11 +63,48 @@ public:
     void Shutdown();
 
     boost::asio::io_service *io_service() { return &io_service_; }
+    boost::asio::io_service *io_service(int shard) {
+        return shards_[shard].service;
+    }
+
+    int shard_count() const { return shards_.size(); }
+    // Returns the shard that runs the io_service.
+    int ShardIndex(const boost::asio::io_service *service) const;
+    // Returns the shard with the fewest sessions.
+    int SelectShard() const;
+    void ShardSessionAdd(int shard);
+    void ShardSessionDelete(int shard);
+    void GetShardStats(std::vector<EventManagerShardStats> *stats) const;
+    BufferPool *buffer_pool() { return &buffer_pool_; }
+
+    bool speculative_read() const { return speculative_read_; }
+    void set_speculative_read(bool speculative_read) {
+        speculative_read_ = speculative_read;
+    }
 
 private:
+    struct Shard {
+        Shard(EventManager *evm, boost::asio::io_service *service);
+
+        EventManager *evm;
+        boost::scoped_ptr<boost::asio::io_service> owned_service;
+        boost::asio::io_service *service;
+        pthread_t thread;
+        tbb::atomic<uint64_t> sessions;
+        tbb::atomic<uint64_t> sessions_created;
+    };
+
+    static void *ShardThreadRun(void *arg);
+    void RunService(boost::asio::io_service *service);
+    void StartShards();
+    void StopShards();
+
     boost::asio::io_service io_service_;
+    boost::ptr_vector<Shard> shards_;
     bool shutdown_;
+    bool speculative_read_;
     tbb::spin_mutex mutex_;
+    BufferPool buffer_pool_;
 
     DISALLOW_COPY_AND_ASSIGN(EventManager);
 };
@@ -22,6 +22,8 @@ SocketStats::SocketStats() {
     read_block_start_time = 0;
     read_blocked = 0;
     read_blocked_duration_usecs = 0;
+    read_speculative = 0;
+    read_speculative_empty = 0;
 }
 
 void SocketStats::GetRxStats(SocketIOStats *socket_stats) const {
@@ -28,6 +28,8 @@ struct SocketStats {
     tbb::atomic<uint64_t> read_block_start_time;
     tbb::atomic<uint64_t> read_blocked;
     tbb::atomic<uint64_t> read_blocked_duration_usecs;
+    tbb::atomic<uint64_t> read_speculative;
+    tbb::atomic<uint64_t> read_speculative_empty;
 };
 
 }  // namespace io
@@ -15,6 +15,7 @@
 using boost::asio::async_write;
 using boost::asio::buffer;
 using boost::asio::buffer_cast;
+using boost::asio::const_buffer;
 using boost::asio::mutable_buffer;
 using boost::asio::mutable_buffers_1;
 using boost::asio::null_buffers;
@@ -27,6 +28,7 @@ using std::size_t;
 using std::srand;
 using std::string;
 using std::time;
+using std::vector;
 
 class SslSession::SslReader : public Task {
 public:
@@ -131,6 +133,17 @@ size_t SslSession::WriteSome(const uint8_t *data, size_t len,
     }
 }
 
+// The ssl stream only writes out the first buffer of the sequence, the
+// rest is written when the writer is next ready.
+size_t SslSession::GatherWriteSome(const vector<const_buffer> &buffers,
+                                   error_code *error) {
+    if (IsSslHandShakeSuccessLocked()) {
+        return ssl_socket_->write_some(buffers, *error);
+    } else {
+        return (TcpSession::GatherWriteSome(buffers, error));
+    }
+}
+
 void SslSession::AsyncWrite(const u_int8_t *data, size_t size) {
     if (IsSslHandShakeSuccessLocked()) {
         async_write(*ssl_socket_.get(), buffer(data, size),
@@ -68,6 +68,9 @@ private:
                     boost::system::error_code *error);
     std::size_t WriteSome(const uint8_t *data, std::size_t len,
                           boost::system::error_code *error);
+    std::size_t GatherWriteSome(
+        const std::vector<boost::asio::const_buffer> &buffers,
+        boost::system::error_code *error);
     void AsyncWrite(const u_int8_t *data, std::size_t size);
 
     static void TriggerSslHandShakeInternal(SslSessionPtr ptr,
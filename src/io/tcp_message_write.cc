@@ -4,19 +4,28 @@
 
 #include "io/tcp_message_write.h"
 
+#include <algorithm>
+
 #include "base/util.h"
 #include "base/logging.h"
+#include "io/buffer_pool.h"
 #include "io/tcp_session.h"
 #include "io/io_log.h"
 
 using boost::asio::buffer;
 using boost::asio::buffer_cast;
+using boost::asio::const_buffer;
 using boost::asio::mutable_buffer;
 using boost::system::error_code;
+using std::max;
+using std::min;
 using tbb::mutex;
 
+const size_t TcpMessageWriter::kMaxGatherBuffers;
+
 TcpMessageWriter::TcpMessageWriter(TcpSession *session) :
-    offset_(0), session_(session) {
+    offset_(0), queue_bytes_(0), cork_size_(0), write_blocked_(false),
+    flush_pending_(false), session_(session) {
 }
 
 TcpMessageWriter::~TcpMessageWriter() {
@@ -37,60 +46,170 @@ int TcpMessageWriter::Send(const uint8_t *data, size_t len, error_code *ec) {
     session_->server_->stats_.write_calls++;
     session_->server_->stats_.write_bytes += len;
 
-    if (buffer_queue_.empty()) {
-        wrote = session_->WriteSome(data, len, ec);
-        if (TcpSession::IsSocketErrorHard(*ec)) return -1;
-        assert(wrote >= 0);
-
-        if ((size_t)wrote != len) {
-            TCP_SESSION_LOG_UT_DEBUG(session_, TCP_DIR_OUT,
-                "Encountered partial send of " << wrote << " bytes when "
-                "sending " << len << " bytes, Error: " << ec);
-            BufferAppend(data + wrote, len - wrote);
-            session_->DeferWriter();
-        }
-    } else {
+    if (write_blocked_) {
         TCP_SESSION_LOG_UT_DEBUG(session_, TCP_DIR_OUT,
             "Write not ready. Enqueue buffer (len = " << len << ") and return");
         BufferAppend(data, len);
+        return wrote;
+    }
+
+    // Anything queued while the writer is not blocked has been corked.
+    if (!buffer_queue_.empty() || cork_size_ > 0) {
+        return SendCorked(data, len, ec);
+    }
+
+    wrote = session_->WriteSome(data, len, ec);
+    if (TcpSession::IsSocketErrorHard(*ec)) return -1;
+    assert(wrote >= 0);
+
+    if ((size_t)wrote != len) {
+        TCP_SESSION_LOG_UT_DEBUG(session_, TCP_DIR_OUT,
+            "Encountered partial send of " << wrote << " bytes when "
+            "sending " << len << " bytes, Error: " << ec);
+        BufferAppend(data + wrote, len - wrote);
+        write_blocked_ = true;
+        session_->DeferWriter();
     }
     return wrote;
 }
 
+// Buffer the message while less than cork size bytes are queued. Otherwise
+// write the queued data and the message out with one gather write.
+int TcpMessageWriter::SendCorked(const uint8_t *data, size_t len,
+                                 error_code *ec) {
+    if (queue_bytes_ + len < cork_size_) {
+        BufferAppend(data, len);
+        stats_.corked_messages++;
+        if (!flush_pending_) {
+            flush_pending_ = true;
+            session_->DeferWriterFlush();
+        }
+        return len;
+    }
+
+    BufferList buffers;
+    size_t gathered = GatherQueue(&buffers);
+    bool gathered_all = (gathered == queue_bytes_);
+    if (gathered_all) {
+        buffers.push_back(const_buffer(data, len));
+    }
+    if (!buffer_queue_.empty()) {
+        stats_.cork_flushes++;
+        stats_.gather_writes++;
+        stats_.gather_buffers += buffers.size();
+    }
+
+    size_t wrote = session_->GatherWriteSome(buffers, ec);
+    if (TcpSession::IsSocketErrorHard(*ec)) return -1;
+
+    if (!gathered_all || wrote < gathered) {
+        ConsumeQueue(min(wrote, gathered));
+        BufferAppend(data, len);
+        write_blocked_ = true;
+        session_->DeferWriter();
+        return 0;
+    }
+
+    ConsumeQueue(gathered);
+    size_t msg_wrote = wrote - gathered;
+    if (msg_wrote != len) {
+        TCP_SESSION_LOG_UT_DEBUG(session_, TCP_DIR_OUT,
+            "Encountered partial send of " << msg_wrote << " bytes when "
+            "sending " << len << " bytes, Error: " << ec);
+        BufferAppend(data + msg_wrote, len - msg_wrote);
+        write_blocked_ = true;
+        session_->DeferWriter();
+    }
+    return msg_wrote;
+}
+
 // Socket is ready for write. Flush any pending data
 void TcpMessageWriter::HandleWriteReady(error_code *error) {
+    flush_pending_ = false;
     while (!buffer_queue_.empty()) {
-        boost::asio::mutable_buffer head = buffer_queue_.front();
-        const uint8_t *data = buffer_cast<const uint8_t *>(head) + offset_;
-        int remaining = buffer_size(head) - offset_;
-        int wrote = session_->WriteSome(data, remaining, error);
+        BufferList buffers;
+        size_t gathered = GatherQueue(&buffers);
+        size_t wrote = session_->GatherWriteSome(buffers, error);
         if (TcpSession::IsSocketErrorHard(*error)) {
             return;
         }
-        assert(wrote >= 0);
-        if (wrote != remaining) {
-            offset_ += wrote;
+        stats_.gather_writes++;
+        stats_.gather_buffers += buffers.size();
+        ConsumeQueue(wrote);
+        if (wrote != gathered) {
+            write_blocked_ = true;
             session_->DeferWriter();
             return;
-        } else {
-            offset_ = 0;
-            DeleteBuffer(head);
-            buffer_queue_.pop_front();
         }
     }
-    buffer_queue_.clear();
+    write_blocked_ = false;
 }
 
+// Collect the unsent part of the queue, up to kMaxGatherBuffers buffers.
+// Returns the number of bytes collected.
+size_t TcpMessageWriter::GatherQueue(BufferList *buffers) const {
+    size_t bytes = 0;
+    for (BufferQueue::const_iterator iter = buffer_queue_.begin();
+         iter != buffer_queue_.end() && buffers->size() < kMaxGatherBuffers;
+         ++iter) {
+        size_t offset = (iter == buffer_queue_.begin()) ? offset_ : 0;
+        buffers->push_back(const_buffer(iter->data + offset,
+                                        iter->size - offset));
+        bytes += iter->size - offset;
+    }
+    return bytes;
+}
+
+// Drop bytes from the head of the queue, after they have been written.
+void TcpMessageWriter::ConsumeQueue(size_t bytes) {
+    assert(bytes <= queue_bytes_);
+    queue_bytes_ -= bytes;
+    while (bytes > 0) {
+        WriteBuffer &head = buffer_queue_.front();
+        size_t remaining = head.size - offset_;
+        if (bytes < remaining) {
+            offset_ += bytes;
+            return;
+        }
+        bytes -= remaining;
+        offset_ = 0;
+        DeleteBuffer(head);
+        buffer_queue_.pop_front();
+    }
+}
+
+// Pack the data into the room left in the last buffer of the queue, and
+// allocate buffers from the pool for the rest.
 void TcpMessageWriter::BufferAppend(const uint8_t *src, int bytes) {
-    u_int8_t *data = new u_int8_t[bytes];
-    memcpy(data, src, bytes);
-    mutable_buffer buffer = mutable_buffer(data, bytes);
+    size_t remaining = bytes;
+    queue_bytes_ += remaining;
+    if (!buffer_queue_.empty()) {
+        WriteBuffer &tail = buffer_queue_.back();
+        size_t count = min(tail.capacity - tail.size, remaining);
+        memcpy(tail.data + tail.size, src, count);
+        tail.size += count;
+        src += count;
+        remaining -= count;
+    }
+    if (remaining == 0) {
+        return;
+    }
+
+    BufferPool *pool = session_->buffer_pool();
+    size_t capacity = pool ? pool->slab_size() : kDefaultBufferSize;
+    capacity = max(capacity, remaining);
+    uint8_t *data = pool ? pool->Allocate(capacity) : new uint8_t[capacity];
+    WriteBuffer buffer(data, capacity);
+    memcpy(buffer.data, src, remaining);
+    buffer.size = remaining;
     buffer_queue_.push_back(buffer);
 }
 
-void TcpMessageWriter::DeleteBuffer(mutable_buffer buffer) {
-    const uint8_t *data = buffer_cast<const uint8_t *>(buffer);
-    delete[] data;
-    return;
+void TcpMessageWriter::DeleteBuffer(const WriteBuffer &buffer) {
+    BufferPool *pool = session_->buffer_pool();
+    if (pool) {
+        pool->Free(buffer.data, buffer.capacity);
+    } else {
+        delete[] buffer.data;
+    }
 }
-
@@ -8,6 +8,7 @@
 #include <tbb/mutex.h>
 
 #include <list>
+#include <vector>
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
 #include <boost/asio/buffer.hpp>
@@ -17,9 +18,31 @@
 
 class TcpSession;
 
+//
+// Buffers the data that could not be written to the socket and flushes it
+// when the socket becomes writable. Queued data is packed into buffers of
+// the session's buffer pool and written out with a single gather write.
+//
+// Corking is disabled by default. If a cork size is set, messages that are
+// sent while less than that many bytes are queued are buffered and written
+// out together, either when the cork size is reached or when the socket is
+// next polled for write.
+//
 class TcpMessageWriter {
 public:
     static const int kDefaultBufferSize = 4 * 1024;
+    static const size_t kMaxGatherBuffers = 64;
+
+    struct Stats {
+        Stats() : gather_writes(0), gather_buffers(0), corked_messages(0),
+            cork_flushes(0) {
+        }
+        uint64_t gather_writes;     // gather writes of queued data
+        uint64_t gather_buffers;    // buffers written by gather writes
+        uint64_t corked_messages;   // messages buffered by corking
+        uint64_t cork_flushes;      // flushes triggered by reaching cork size
+    };
+
     explicit TcpMessageWriter(TcpSession *session);
     ~TcpMessageWriter();
 
@@ -27,17 +50,42 @@ public:
     int Send(const uint8_t *msg, size_t len,
              boost::system::error_code *ec);
 
+    size_t cork_size() const { return cork_size_; }
+    size_t queue_bytes() const { return queue_bytes_; }
+    const Stats &stats() const { return stats_; }
+
 private:
     friend class TcpSession;
     typedef boost::intrusive_ptr<TcpSession> TcpSessionPtr;
-    typedef std::list<boost::asio::mutable_buffer> BufferQueue;
+    typedef std::vector<boost::asio::const_buffer> BufferList;
+
+    struct WriteBuffer {
+        WriteBuffer(uint8_t *data, size_t capacity)
+            : data(data), capacity(capacity), size(0) {
+        }
+        uint8_t *data;
+        size_t capacity;
+        size_t size;
+    };
+    typedef std::list<WriteBuffer> BufferQueue;
+
     void BufferAppend(const uint8_t *data, int len);
-    void DeleteBuffer(boost::asio::mutable_buffer buffer);
+    void DeleteBuffer(const WriteBuffer &buffer);
     void HandleWriteReady(boost::system::error_code *ec);
+    size_t GatherQueue(BufferList *buffers) const;
+    void ConsumeQueue(size_t bytes);
+    int SendCorked(const uint8_t *data, size_t len,
+                   boost::system::error_code *ec);
+    void set_cork_size(size_t cork_size) { cork_size_ = cork_size; }
 
     BufferQueue buffer_queue_;
     int offset_;
+    size_t queue_bytes_;
+    size_t cork_size_;
+    bool write_blocked_;
+    bool flush_pending_;
     TcpSession *session_;
+    Stats stats_;
 };
 
 #endif  // SRC_IO_TCP_MESSAGE_WRITE_H_
@@ -284,7 +284,7 @@ TcpSession *TcpServer::AllocSession(bool server_session) {
             so_accept_.release();
         }
     } else {
-        Socket *socket = new Socket(*evm_->io_service());
+        Socket *socket = new Socket(*evm_->io_service(evm_->SelectShard()));
         session = AllocSession(socket);
     }
 
@@ -296,7 +296,7 @@ TcpServer::Socket *TcpServer::accept_socket() const {
 }
 
 void TcpServer::set_accept_socket() {
-    so_accept_.reset(new Socket(*evm_->io_service()));
+    so_accept_.reset(new Socket(*evm_->io_service(evm_->SelectShard())));
 }
 
 bool TcpServer::AcceptSession(TcpSession *session) {
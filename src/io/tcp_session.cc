@@ -35,6 +35,7 @@ using boost::system::error_code;
 using std::min;
 using std::ostringstream;
 using std::string;
+using std::vector;
 
 using boost::asio::error::eof;
 using boost::asio::error::try_again;
@@ -84,9 +85,12 @@ TcpSession::TcpSession(
     : server_(server),
       socket_(socket),
       read_on_connect_(async_read_ready),
+      shard_(0),
       established_(false),
       closed_(false),
       direction_(ACTIVE),
+      last_read_len_(0),
+      speculative_read_(false),
       writer_(new TcpMessageWriter(this)),
       name_("-") {
     refcount_ = 0;
@@ -94,14 +98,23 @@ TcpSession::TcpSession(
         TaskScheduler *scheduler = TaskScheduler::GetInstance();
         reader_task_id_ = scheduler->GetTaskId("io::ReaderTask");
     }
+    // The session runs on the shard that its socket belongs to.
     if (server_) {
-        io_strand_.reset(new Strand(*server->event_manager()->io_service()));
+        EventManager *evm = server->event_manager();
+        boost::asio::io_service *io_service =
+            socket ? &socket->get_io_service() : evm->io_service();
+        io_strand_.reset(new Strand(*io_service));
+        shard_ = evm->ShardIndex(io_service);
+        evm->ShardSessionAdd(shard_);
     }
     defer_reader_ = false;
 }
 
 TcpSession::~TcpSession() {
     assert(!established_);
+    if (server_) {
+        server_->event_manager()->ShardSessionDelete(shard_);
+    }
     for (BufferQueue::iterator iter = buffer_queue_.begin();
          iter != buffer_queue_.end(); ++iter) {
         DeleteBuffer(*iter);
@@ -109,8 +122,22 @@ TcpSession::~TcpSession() {
     buffer_queue_.clear();
 }
 
+// Receive buffers come from the buffer pool of the EventManager, if any.
+BufferPool *TcpSession::buffer_pool() const {
+    if (!server_) {
+        return NULL;
+    }
+    return server_->event_manager()->buffer_pool();
+}
+
 mutable_buffer TcpSession::AllocateBuffer(size_t buffer_size) {
-    u_int8_t *data = new u_int8_t[buffer_size];
+    BufferPool *pool = buffer_pool();
+    u_int8_t *data;
+    if (pool) {
+        data = pool->Allocate(buffer_size);
+    } else {
+        data = new u_int8_t[buffer_size];
+    }
     mutable_buffer buffer = mutable_buffer(data, buffer_size);
     buffer_queue_.push_back(buffer);
     return buffer;
@@ -118,7 +145,12 @@ mutable_buffer TcpSession::AllocateBuffer(size_t buffer_size) {
 
 void TcpSession::DeleteBuffer(mutable_buffer buffer) {
     uint8_t *data = buffer_cast<uint8_t *>(buffer);
-    delete[] data;
+    BufferPool *pool = buffer_pool();
+    if (pool) {
+        pool->Free(data, boost::asio::buffer_size(buffer));
+    } else {
+        delete[] data;
+    }
 }
 
 static int BufferCmp(const mutable_buffer &lhs, const const_buffer &rhs) {
@@ -191,8 +223,33 @@ void TcpSession::DeferWriter() {
                                     error, UTCTimestampUsec()));
 }
 
+// Flush the data corked in the writer once the socket is writable. Unlike
+// DeferWriter, this is not accounted as the writer being blocked.
+void TcpSession::DeferWriterFlush() {
+    socket()->async_write_some(null_buffers(),
+                               bind(&TcpSession::WriteReadyInternal,
+                                    TcpSessionPtr(this), error, 0));
+}
+
+void TcpSession::SetWriteCorkSize(size_t cork_size) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    writer_->set_cork_size(cork_size);
+}
+
 void TcpSession::AsyncReadSome() {
     if (established_) {
+        // Read again right away if the last read returned data and the
+        // EventManager does speculative reads. The socket must be non
+        // blocking, since there may be nothing left to read.
+        if (last_read_len_ && server_ &&
+            server_->event_manager()->speculative_read() &&
+            socket()->non_blocking()) {
+            speculative_read_ = true;
+            stats_.read_speculative++;
+            server_->stats_.read_speculative++;
+            TriggerAsyncReadHandler();
+            return;
+        }
         socket()->async_read_some(null_buffers(),
             bind(&TcpSession::AsyncReadHandler, TcpSessionPtr(this)));
     }
@@ -203,6 +260,11 @@ size_t TcpSession::WriteSome(const uint8_t *data, size_t len,
     return socket()->write_some(buffer(data, len), *error);
 }
 
+size_t TcpSession::GatherWriteSome(const vector<const_buffer> &buffers,
+                                   error_code *error) {
+    return socket()->write_some(buffers, *error);
+}
+
 void TcpSession::AsyncWrite(const u_int8_t *data, size_t size) {
     async_write(*socket(), buffer(data, size),
         bind(&TcpSession::AsyncWriteHandler, TcpSessionPtr(this),
@@ -355,10 +417,12 @@ void TcpSession::WriteReadyInternal(TcpSessionPtr session,
     error_code ec = error;
     tbb::mutex::scoped_lock lock(session->mutex_);
 
-    // Update socket write block time.
-    uint64_t blocked_usecs = UTCTimestampUsec() - block_start_time;
-    session->stats_.write_blocked_duration_usecs += blocked_usecs;
-    session->server_->stats_.write_blocked_duration_usecs += blocked_usecs;
+    // Update socket write block time, unless this is a flush of corked data.
+    if (block_start_time) {
+        uint64_t blocked_usecs = UTCTimestampUsec() - block_start_time;
+        session->stats_.write_blocked_duration_usecs += blocked_usecs;
+        session->server_->stats_.write_blocked_duration_usecs += blocked_usecs;
+    }
 
     if (session->IsSocketErrorHard(ec)) {
         goto session_error;
@@ -375,7 +439,10 @@ void TcpSession::WriteReadyInternal(TcpSessionPtr session,
     }
 
     lock.release();
-    session->WriteReady(ec);
+    // The sender was not blocked if corked data was flushed.
+    if (block_start_time) {
+        session->WriteReady(ec);
+    }
     return;
 
 session_error:
@@ -460,11 +527,15 @@ void TcpSession::AsyncReadHandler(TcpSessionPtr session) {
         return;
     }
 
+    bool speculative_read = session->speculative_read_;
+    session->speculative_read_ = false;
+
     mutable_buffer buffer =
         session->AllocateBuffer(session->GetReadBufferSize());
 
     error_code error;
     size_t bytes_transferred = session->ReadSome(buffer, &error);
+    session->last_read_len_ = bytes_transferred;
     if (IsSocketErrorHard(error)) {
         session->ReleaseBufferLocked(buffer);
         // eof is returned when the peer closed the socket, no need to log error
@@ -479,6 +550,15 @@ void TcpSession::AsyncReadHandler(TcpSessionPtr session) {
         return;
     }
 
+    // Nothing was left to read, wait for the socket to become readable.
+    if (speculative_read && bytes_transferred == 0) {
+        session->stats_.read_speculative_empty++;
+        session->server_->stats_.read_speculative_empty++;
+        session->ReleaseBufferLocked(buffer);
+        session->AsyncReadSome();
+        return;
+    }
+
     // Update read statistics.
     session->stats_.read_calls++;
     session->stats_.read_bytes += bytes_transferred;
@@ -530,6 +610,44 @@ int TcpSession::ClearMd5SocketOption(uint32_t peer_ip) {
     return server()->SetMd5SocketOption(socket_->native_handle(), peer_ip, "");
 }
 
+void TcpMessageView::Append(const uint8_t *data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    segments_.push_back(Buffer(data, size));
+    size_ += size;
+}
+
+void TcpMessageView::Clear() {
+    segments_.clear();
+    size_ = 0;
+}
+
+const uint8_t *TcpMessageView::data() const {
+    if (segments_.size() != 1) {
+        return NULL;
+    }
+    return TcpSession::BufferData(segments_.front());
+}
+
+size_t TcpMessageView::CopyOut(size_t offset, uint8_t *dst,
+                               size_t len) const {
+    size_t copied = 0;
+    for (SegmentList::const_iterator iter = segments_.begin();
+         iter != segments_.end() && copied < len; ++iter) {
+        size_t size = TcpSession::BufferSize(*iter);
+        if (offset >= size) {
+            offset -= size;
+            continue;
+        }
+        size_t count = min(size - offset, len - copied);
+        memcpy(dst + copied, TcpSession::BufferData(*iter) + offset, count);
+        copied += count;
+        offset = 0;
+    }
+    return copied;
+}
+
 TcpMessageReader::TcpMessageReader(TcpSession *session,
                                    ReceiveCallback callback)
     : session_(session), callback_(callback), offset_(0), remain_(-1) {
@@ -575,6 +693,31 @@ uint8_t *TcpMessageReader::BufferConcat(uint8_t *data, Buffer buffer,
     return data;
 }
 
+bool TcpMessageReader::ReceiveView(Buffer buffer, int msglength) {
+    TcpMessageView view;
+    for (BufferQueue::const_iterator iter = queue_.begin();
+         iter != queue_.end(); ++iter) {
+        int offset = (iter == queue_.begin()) ? offset_ : 0;
+        view.Append(TcpSession::BufferData(*iter) + offset,
+                    TcpSession::BufferSize(*iter) - offset);
+    }
+    int count = msglength - static_cast<int>(view.size());
+    assert(count > 0 && (size_t) count <= TcpSession::BufferSize(buffer));
+    view.Append(TcpSession::BufferData(buffer), count);
+    stats_.view_messages++;
+    bool success = view_callback_(view);
+
+    // The queued buffers can only be released once the callback is done
+    // with the view.
+    while (!queue_.empty()) {
+        session_->ReleaseBuffer(queue_.front());
+        queue_.pop_front();
+    }
+    offset_ = count;
+    remain_ = -1;
+    return success;
+}
+
 int TcpMessageReader::QueueByteLength() const {
     int total = 0;
     for (BufferQueue::const_iterator iter = queue_.begin();
@@ -639,6 +782,7 @@ void TcpMessageReader::OnRead(Buffer buffer) {
             }
             scoped_array<uint8_t> data(new uint8_t[kHeaderLenSize]);
             Buffer header = PullUp(data.get(), buffer, kHeaderLenSize);
+            stats_.header_pullups++;
             assert(TcpSession::BufferSize(header) == (size_t) kHeaderLenSize);
 
             msglength = MsgLength(header, 0);
@@ -652,12 +796,21 @@ void TcpMessageReader::OnRead(Buffer buffer) {
             return;
         }
 
-        // concat the buffers into a contiguous message.
-        scoped_array<uint8_t> data(new uint8_t[AllocBufferSize(msglength)]);
-        BufferConcat(data.get(), buffer, msglength);
-        assert(remain_ == -1);
-        // Receive the message
-        bool success = callback_(data.get(), msglength);
+        stats_.messages++;
+        bool success;
+        if (!view_callback_.empty()) {
+            success = ReceiveView(buffer, msglength);
+        } else {
+            // concat the buffers into a contiguous message.
+            scoped_array<uint8_t> data(
+                new uint8_t[AllocBufferSize(msglength)]);
+            BufferConcat(data.get(), buffer, msglength);
+            assert(remain_ == -1);
+            stats_.copied_messages++;
+            stats_.copied_bytes += msglength;
+            // Receive the message
+            success = callback_(data.get(), msglength);
+        }
         if (!success)
             return;
     }
@@ -673,6 +826,7 @@ void TcpMessageReader::OnRead(Buffer buffer) {
             break;
         }
         // Receive the message
+        stats_.messages++;
         bool success =
             callback_(TcpSession::BufferData(buffer) + offset_, msglength);
         offset_ += msglength;
@@ -11,6 +11,7 @@
 #include <deque>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/io_service.hpp>
@@ -27,6 +28,7 @@
 #include "base/task.h"
 #include "io/tcp_server.h"
 
+class BufferPool;
 class EventManager;
 class TcpServer;
 class TcpSession;
@@ -152,6 +154,12 @@ public:
         return defer_reader_;
     }
 
+    // Buffer messages sent while less than cork_size bytes are pending and
+    // write them out together. Zero, the default, disables corking.
+    void SetWriteCorkSize(size_t cork_size);
+    const TcpMessageWriter *writer() const { return writer_.get(); }
+    int shard() const { return shard_; }
+
     const io::SocketStats &GetSocketStats() const { return stats_; }
     void GetRxSocketStats(SocketIOStats *socket_stats) const;
     void GetTxSocketStats(SocketIOStats *socket_stats) const;
@@ -189,6 +197,9 @@ protected:
                             boost::system::error_code *error);
     virtual std::size_t WriteSome(const uint8_t *data, std::size_t len,
                                   boost::system::error_code *error);
+    virtual std::size_t GatherWriteSome(
+        const std::vector<boost::asio::const_buffer> &buffers,
+        boost::system::error_code *error);
     virtual void AsyncWrite(const u_int8_t *data, std::size_t size);
 
     virtual int reader_task_id() const {
@@ -224,6 +235,7 @@ private:
                                    uint64_t block_start_time);
 
     void DeferWriter();
+    void DeferWriterFlush();
     void ReleaseBufferLocked(Buffer buffer);
     void SetEstablished(Endpoint remote, Direction dir);
 
@@ -233,6 +245,7 @@ private:
 
     void SetName();
 
+    BufferPool *buffer_pool() const;
     boost::asio::mutable_buffer AllocateBuffer(size_t buffer_size);
     void DeleteBuffer(boost::asio::mutable_buffer buffer);
 
@@ -242,6 +255,7 @@ private:
     boost::scoped_ptr<Socket> socket_;
     boost::scoped_ptr<Strand> io_strand_;
     bool read_on_connect_;
+    int shard_;                    // EventManager shard of the socket
 
     /**************** protected by mutex_ ****************/
     bool established_;             // In TCP ESTABLISHED state.
@@ -251,6 +265,8 @@ private:
     Direction direction_;          // direction (active, passive)
     BufferQueue buffer_queue_;
     boost::system::error_code close_reason_;
+    size_t last_read_len_;         // Bytes returned by the last read
+    bool speculative_read_;        // Read pending without waiting for data
     /**************** end protected by mutex_ ****************/
 
     // Protects observer manipulation and invocation. When this lock is
@@ -279,6 +295,38 @@ inline void intrusive_ptr_release(TcpSession *session) {
     }
 }
 
+// TcpMessageView
+//
+// Scatter-gather view of a message that spans several receive buffers. The
+// segments point into the receive buffers of the session, so the view is
+// only valid for the duration of the receive callback.
+//
+class TcpMessageView {
+public:
+    typedef boost::asio::const_buffer Buffer;
+    typedef std::vector<Buffer> SegmentList;
+
+    TcpMessageView() : size_(0) {
+    }
+
+    void Append(const uint8_t *data, size_t size);
+    void Clear();
+
+    size_t size() const { return size_; }
+    const SegmentList &segments() const { return segments_; }
+
+    // Returns the message if it is in one segment, NULL otherwise.
+    const uint8_t *data() const;
+
+    // Copy len bytes starting at offset into dst. Returns the number of
+    // bytes copied, which is less than len if the view is too short.
+    size_t CopyOut(size_t offset, uint8_t *dst, size_t len) const;
+
+private:
+    SegmentList segments_;
+    size_t size_;
+};
+
 // TcpMessageReader
 //
 // Provides base implementation of OnRead() for TcpSession assuming
@@ -288,11 +336,30 @@ class TcpMessageReader {
 public:
     typedef boost::asio::const_buffer Buffer;
     typedef boost::function<bool(const u_int8_t *, size_t)> ReceiveCallback;
+    typedef boost::function<bool(const TcpMessageView &)> ReceiveViewCallback;
+
+    struct Stats {
+        Stats() : messages(0), view_messages(0), copied_messages(0),
+            copied_bytes(0), header_pullups(0) {
+        }
+        uint64_t messages;          // messages received
+        uint64_t view_messages;     // messages received as a view
+        uint64_t copied_messages;   // messages concatenated by copying
+        uint64_t copied_bytes;      // bytes copied to concatenate messages
+        uint64_t header_pullups;    // headers copied to find the length
+    };
 
     TcpMessageReader(TcpSession *session, ReceiveCallback callback);
     virtual ~TcpMessageReader();
     virtual void OnRead(Buffer buffer);
 
+    // Messages that span receive buffers are handed to the view callback,
+    // if one is set, instead of being copied into a contiguous buffer.
+    void set_view_callback(ReceiveViewCallback callback) {
+        view_callback_ = callback;
+    }
+    const Stats &stats() const { return stats_; }
+
 protected:
     virtual int MsgLength(Buffer buffer, int offset) = 0;
     virtual const int GetHeaderLenSize() = 0;
@@ -304,6 +371,9 @@ private:
     // Copy the queue into one contiguous buffer.
     uint8_t *BufferConcat(uint8_t *data, Buffer buffer, int msglength);
 
+    // Hand the queue to the view callback without copying it.
+    bool ReceiveView(Buffer buffer, int msglength);
+
     int QueueByteLength() const;
 
     Buffer PullUp(uint8_t *data, Buffer buffer, size_t size) const;
@@ -312,9 +382,11 @@ private:
 
     TcpSession *session_;
     ReceiveCallback callback_;
+    ReceiveViewCallback view_callback_;
     BufferQueue queue_;
     int offset_;
     int remain_;
+    Stats stats_;
 
     DISALLOW_COPY_AND_ASSIGN(TcpMessageReader);
 };
@@ -2,7 +2,13 @@
  * Copyright (c) 2013 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <map>
+#include <set>
+#include <boost/bind.hpp>
+#include <tbb/mutex.h>
+
 #include "base/test/task_test_util.h"
+#include "io/io_types.h"
 #include "io/test/event_manager_test.h"
 #include "testing/gunit.h"
 
@@ -39,6 +45,81 @@ TEST_F(EventManagerDeathTest, RunOnce) {
                           ".*RunOnce.*");
 }
 
+class EventManagerShardTest : public ::testing::Test {
+protected:
+    static const int kShards = 3;
+
+    EventManagerShardTest() : evm_(kShards), thread_(&evm_) {
+        handled_ = 0;
+    }
+
+    virtual void SetUp() {
+        thread_.Start();
+    }
+
+    virtual void TearDown() {
+        evm_.Shutdown();
+        thread_.Join();
+    }
+
+    void Handler(int shard) {
+        tbb::mutex::scoped_lock lock(mutex_);
+        threads_[shard].insert(pthread_self());
+        handled_++;
+    }
+
+    EventManager evm_;
+    ServerThread thread_;
+    tbb::mutex mutex_;
+    map<int, set<pthread_t> > threads_;
+    tbb::atomic<int> handled_;
+};
+
+const int EventManagerShardTest::kShards;
+
+// Each shard runs its handlers on a thread of its own.
+TEST_F(EventManagerShardTest, Run) {
+    EXPECT_EQ(kShards, evm_.shard_count());
+    EXPECT_TRUE(evm_.io_service(0) == evm_.io_service());
+    for (int i = 0; i < 10; i++) {
+        for (int shard = 0; shard < kShards; shard++) {
+            evm_.io_service(shard)->post(
+                boost::bind(&EventManagerShardTest::Handler, this, shard));
+        }
+    }
+    TASK_UTIL_EXPECT_EQ(10 * kShards, handled_);
+
+    set<pthread_t> all;
+    for (int shard = 0; shard < kShards; shard++) {
+        EXPECT_EQ(1, threads_[shard].size());
+        EXPECT_EQ(shard, evm_.ShardIndex(evm_.io_service(shard)));
+        all.insert(threads_[shard].begin(), threads_[shard].end());
+    }
+    EXPECT_EQ(kShards, all.size());
+}
+
+TEST_F(EventManagerShardTest, SelectShard) {
+    EXPECT_EQ(0, evm_.SelectShard());
+    evm_.ShardSessionAdd(0);
+    EXPECT_EQ(1, evm_.SelectShard());
+    evm_.ShardSessionAdd(1);
+    evm_.ShardSessionAdd(1);
+    EXPECT_EQ(2, evm_.SelectShard());
+    evm_.ShardSessionAdd(2);
+    EXPECT_EQ(0, evm_.SelectShard());
+    evm_.ShardSessionDelete(1);
+    evm_.ShardSessionDelete(1);
+    EXPECT_EQ(1, evm_.SelectShard());
+
+    vector<EventManagerShardStats> stats;
+    evm_.GetShardStats(&stats);
+    ASSERT_EQ(kShards, stats.size());
+    EXPECT_EQ(1, stats[0].sessions);
+    EXPECT_EQ(0, stats[1].sessions);
+    EXPECT_EQ(2, stats[1].sessions_created);
+    EXPECT_EQ(1, stats[2].sessions);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     ::testing::FLAGS_gtest_death_test_style = "threadsafe";
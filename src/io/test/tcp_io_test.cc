@@ -18,9 +18,11 @@
 #include "base/parse_object.h"
 
 #include "base/task.h"
+#include "base/time_util.h"
 #include "base/test/task_test_util.h"
 
 #include "io/event_manager.h"
+#include "io/tcp_message_write.h"
 #include "io/tcp_server.h"
 #include "io/tcp_session.h"
 #include "io/test/event_manager_test.h"
@@ -154,6 +156,26 @@ protected:
         task_util::WaitForIdle();
     }
 
+    // Streams count copies of msg from the client to the server. Returns the
+    // usecs taken until the server has received all of them.
+    uint64_t StreamMessages(const char *msg, size_t size, int count) {
+        server_->GetSession()->ResetTotal();
+        uint64_t start = UTCTimestampUsec();
+        for (int i = 0; i < count; i++) {
+            // A failed send has still queued the message, so wait for the
+            // queue to drain before sending the next one.
+            if (!client_->Send((const u_int8_t *) msg, size, NULL)) {
+                TASK_UTIL_WAIT_EQ_NO_MSG(true, client_->GetSession()->called,
+                    1000, 10000, "Wait for WriteReady");
+                client_->GetSession()->called = false;
+            }
+        }
+        TASK_UTIL_WAIT_EQ_NO_MSG(count * size,
+            (size_t) server_->GetSession()->GetTotal(), 1000, 100000,
+            "Wait for messages to be received");
+        return UTCTimestampUsec() - start;
+    }
+
     auto_ptr<ServerThread> thread_;
     EchoServer *server_;
     EchoServer *client_;
@@ -362,6 +384,133 @@ TEST_F(EchoServerTest, DeferRead) {
     EXPECT_NE("00:00:00", rx_stats1.blocked_duration);
 }
 
+// Small messages sent while corked are accepted right away and written out
+// together by a gather write.
+TEST_F(EchoServerTest, CorkedSend) {
+    server_->Initialize(0);
+    task_util::WaitForIdle();
+    thread_->Start();
+    int port = server_->GetPort();
+    ASSERT_LT(0, port);
+
+    client_->CreateSession();
+    client_->EchoServer::ConnectTest(port);
+    TASK_UTIL_ASSERT_TRUE((server_->GetSession() != NULL));
+    TASK_UTIL_ASSERT_TRUE(client_->GetSession()->IsEstablished());
+    client_->GetSession()->SetWriteCorkSize(16 * 1024);
+
+    char msg[100];
+    memset(msg, 0xcd, sizeof(msg));
+    const int kMessages = 1000;
+    for (int i = 0; i < kMessages; i++) {
+        size_t sent = 0;
+        EXPECT_TRUE(client_->Send((const u_int8_t *) msg, sizeof(msg), &sent));
+        EXPECT_EQ(sizeof(msg), sent);
+    }
+    TASK_UTIL_EXPECT_EQ(kMessages * sizeof(msg),
+                        server_->GetSession()->GetTotal());
+    TASK_UTIL_EXPECT_EQ(0U, client_->GetSession()->writer()->queue_bytes());
+
+    const TcpMessageWriter::Stats &stats =
+        client_->GetSession()->writer()->stats();
+    EXPECT_LT(0U, stats.corked_messages);
+    EXPECT_LT(0U, stats.gather_writes);
+    EXPECT_LT(stats.gather_writes, (uint64_t) kMessages);
+}
+
+// Throughput of small messages, as sent for a route dump, with and without
+// corking.
+TEST_F(EchoServerTest, DISABLED_CorkedSendPerf) {
+    server_->Initialize(0);
+    task_util::WaitForIdle();
+    thread_->Start();
+    int port = server_->GetPort();
+    ASSERT_LT(0, port);
+
+    client_->CreateSession();
+    client_->EchoServer::ConnectTest(port);
+    TASK_UTIL_ASSERT_TRUE((server_->GetSession() != NULL));
+    TASK_UTIL_ASSERT_TRUE(client_->GetSession()->IsEstablished());
+
+    char msg[256];
+    memset(msg, 0xcd, sizeof(msg));
+    const int kMessages = 1000000;
+    size_t cork_sizes[] = { 0, 16 * 1024, 64 * 1024 };
+    for (size_t idx = 0; idx < sizeof(cork_sizes) / sizeof(cork_sizes[0]);
+         idx++) {
+        client_->GetSession()->SetWriteCorkSize(cork_sizes[idx]);
+        uint64_t elapsed = StreamMessages(msg, sizeof(msg), kMessages);
+        const TcpMessageWriter::Stats &stats =
+            client_->GetSession()->writer()->stats();
+        LOG(DEBUG, "Cork size " << cork_sizes[idx] << ": " << kMessages <<
+            " messages in " << elapsed << " usecs, " <<
+            (kMessages * sizeof(msg)) / (elapsed ? elapsed : 1) <<
+            " MB/s, gather writes " << stats.gather_writes);
+    }
+}
+
+TEST_F(EchoServerTest, SpeculativeRead) {
+    evm_->set_speculative_read(true);
+    server_->Initialize(0);
+    task_util::WaitForIdle();
+    thread_->Start();
+    int port = server_->GetPort();
+    ASSERT_LT(0, port);
+
+    client_->CreateSession();
+    client_->EchoServer::ConnectTest(port);
+    TASK_UTIL_ASSERT_TRUE((server_->GetSession() != NULL));
+    TASK_UTIL_ASSERT_TRUE(client_->GetSession()->IsEstablished());
+
+    char msg[4096];
+    memset(msg, 0xcd, sizeof(msg));
+    const int kMessages = 64;
+    for (int i = 0; i < kMessages; i++) {
+        client_->Send((const u_int8_t *) msg, sizeof(msg), NULL);
+    }
+    TASK_UTIL_EXPECT_EQ(kMessages * sizeof(msg),
+                        server_->GetSession()->GetTotal());
+
+    // Reads that returned data were followed by a speculative read, and the
+    // session went back to waiting once one came up empty.
+    const io::SocketStats &stats = server_->GetSession()->GetSocketStats();
+    TASK_UTIL_EXPECT_TRUE(stats.read_speculative_empty > 0);
+    EXPECT_LT(0U, (uint64_t) stats.read_speculative);
+    EXPECT_GE((uint64_t) stats.read_calls, (uint64_t) stats.read_speculative);
+    EXPECT_EQ(kMessages * sizeof(msg), (uint64_t) stats.read_bytes);
+}
+
+// Compares reads on readiness with speculative reads, for a client that
+// streams messages to the echo server.
+TEST_F(EchoServerTest, DISABLED_SpeculativeReadPerf) {
+    server_->Initialize(0);
+    task_util::WaitForIdle();
+    thread_->Start();
+    int port = server_->GetPort();
+    ASSERT_LT(0, port);
+
+    client_->CreateSession();
+    client_->EchoServer::ConnectTest(port);
+    TASK_UTIL_ASSERT_TRUE((server_->GetSession() != NULL));
+    TASK_UTIL_ASSERT_TRUE(client_->GetSession()->IsEstablished());
+
+    char msg[1024];
+    memset(msg, 0xcd, sizeof(msg));
+    const int kMessages = 1000000;
+    bool modes[] = { false, true };
+    for (size_t idx = 0; idx < sizeof(modes) / sizeof(modes[0]); idx++) {
+        evm_->set_speculative_read(modes[idx]);
+        const io::SocketStats &stats =
+            server_->GetSession()->GetSocketStats();
+        uint64_t read_calls = stats.read_calls;
+        uint64_t elapsed = StreamMessages(msg, sizeof(msg), kMessages);
+        LOG(DEBUG, "Speculative read " << modes[idx] << ": " << kMessages <<
+            " messages in " << elapsed << " usecs, " <<
+            stats.read_calls - read_calls << " reads, " <<
+            stats.read_speculative_empty << " empty speculative reads");
+    }
+}
+
 }  // namespace
 
 int main(int argc, char **argv) {
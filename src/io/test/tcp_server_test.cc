@@ -336,6 +336,14 @@ class ReaderTestSession : public TcpSession {
     }
 
     int release_count() const { return release_count_; }
+    const TcpMessageReader::Stats &reader_stats() const {
+        return reader_->stats();
+    }
+
+    void EnableView() {
+        reader_->set_view_callback(
+            boost::bind(&ReaderTestSession::ReceiveView, this, _1));
+    }
 
   protected:
     virtual void OnRead(Buffer buffer) {
@@ -351,6 +359,20 @@ class ReaderTestSession : public TcpSession {
         return true;
     }
 
+    bool ReceiveView(const TcpMessageView &view) {
+        TCP_UT_LOG_DEBUG("ReceiveView: " << view.size() << " bytes in " <<
+                         view.segments().size() << " segments");
+        // The message spans buffers, so it can't be contiguous.
+        EXPECT_TRUE(view.data() == NULL);
+        vector<uint8_t> data(view.size());
+        EXPECT_EQ(view.size(), view.CopyOut(0, &data[0], view.size()));
+        EXPECT_EQ(view.size(), (size_t) get_value(&data[16], 2));
+        for (size_t i = 18; i < data.size(); i++) {
+            EXPECT_EQ(0, data[i]);
+        }
+        return ReceiveMsg(&data[0], data.size());
+    }
+
     std::auto_ptr<ReaderTest> reader_;
     vector<int> sizes;
     int release_count_;
@@ -418,6 +440,104 @@ TEST_F(ReaderUnitTest, StreamRead) {
     TASK_UTIL_EXPECT_EQ(buf_list.size(), (size_t) session_.release_count());
 }
 
+// Same stream as StreamRead, but the messages that span buffers are handed
+// over as a view instead of being copied.
+TEST_F(ReaderUnitTest, StreamReadView) {
+    uint8_t stream[4096];
+    int sizes[] = { 100, 400, 80, 110, 40, 60 };
+    uint8_t *data = stream;
+    for (size_t i = 0; i < ARRAYLEN(sizes); i++) {
+        CreateFakeMessage(data, sizes[i], sizes[i]);
+        data += sizes[i];
+    }
+    int segments[] = { 100 + 20, 200, 180 + 80 + 10, 7, 10, 83, 40, 60 };
+    vector<mutable_buffer> buf_list;
+    data = stream;
+    for (size_t i = 0; i < ARRAYLEN(segments); i++) {
+        buf_list.push_back(mutable_buffer(data, segments[i]));
+        data += segments[i];
+    }
+    session_.EnableView();
+    for (size_t i = 0; i < buf_list.size(); i++) {
+        session_.Read(buf_list[i]);
+    }
+
+    int i = 0;
+    for (vector<int>::const_iterator iter = session_.begin();
+         iter != session_.end(); ++iter) {
+        TASK_UTIL_EXPECT_EQ(sizes[i], *iter);
+        i++;
+    }
+    TASK_UTIL_EXPECT_EQ(ARRAYLEN(sizes), i);
+    TASK_UTIL_EXPECT_EQ(buf_list.size(), (size_t) session_.release_count());
+
+    const TcpMessageReader::Stats &stats = session_.reader_stats();
+    EXPECT_EQ(ARRAYLEN(sizes), stats.messages);
+    EXPECT_EQ(2U, stats.view_messages);
+    EXPECT_EQ(0U, stats.copied_messages);
+    EXPECT_EQ(0U, stats.copied_bytes);
+    EXPECT_EQ(2U, stats.header_pullups);
+}
+
+TEST(TcpMessageViewTest, CopyOut) {
+    uint8_t data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    TcpMessageView view;
+    view.Append(data, 3);
+    view.Append(data + 3, 0);
+    view.Append(data + 3, 7);
+    EXPECT_EQ(10U, view.size());
+    EXPECT_EQ(2U, view.segments().size());
+    EXPECT_TRUE(view.data() == NULL);
+
+    uint8_t out[10];
+    EXPECT_EQ(4U, view.CopyOut(1, out, 4));
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(i + 1, out[i]);
+    }
+    EXPECT_EQ(2U, view.CopyOut(8, out, 4));
+    EXPECT_EQ(8, out[0]);
+    EXPECT_EQ(9, out[1]);
+    EXPECT_EQ(0U, view.CopyOut(10, out, 4));
+
+    view.Clear();
+    view.Append(data, 10);
+    EXPECT_TRUE(view.data() == data);
+}
+
+TEST(BufferPoolTest, Recycle) {
+    BufferPool pool(1024, 2);
+    BufferPool::Stats stats;
+
+    uint8_t *b1 = pool.Allocate(1024);
+    uint8_t *b2 = pool.Allocate(1024);
+    uint8_t *b3 = pool.Allocate(1024);
+    uint8_t *large = pool.Allocate(4096);
+    pool.GetStats(&stats);
+    EXPECT_EQ(0U, stats.hits);
+    EXPECT_EQ(3U, stats.misses);
+    EXPECT_EQ(1U, stats.oversize);
+
+    // Only max_free slabs are kept, the rest go back to the heap.
+    pool.Free(b1, 1024);
+    pool.Free(b2, 1024);
+    pool.Free(b3, 1024);
+    pool.Free(large, 4096);
+    EXPECT_EQ(2U, pool.free_count());
+    pool.GetStats(&stats);
+    EXPECT_EQ(2U, stats.recycled);
+    EXPECT_EQ(2U, stats.freed);
+
+    uint8_t *b4 = pool.Allocate(1024);
+    EXPECT_TRUE(b4 == b1 || b4 == b2);
+    pool.GetStats(&stats);
+    EXPECT_EQ(1U, stats.hits);
+    EXPECT_EQ(1U, pool.free_count());
+    pool.Free(b4, 1024);
+
+    pool.set_max_free(0);
+    EXPECT_EQ(0U, pool.free_count());
+}
+
 TEST_F(ReaderUnitTest, ZeroMsgLengthRead) {
     uint8_t stream[4096];
     int size = 18;
@@ -355,6 +355,68 @@ TEST_F(UdpRecvTest, Basic) {
     task_util::WaitForIdle();
 }
 
+class UdpRecvBatchServerTest : public UdpRecvServerTest {
+public:
+    static const int kBatchSize = 8;
+
+    explicit UdpRecvBatchServerTest(EventManager *evm) :
+        UdpRecvServerTest(evm),
+        num_batches_(0),
+        max_batch_(0) {
+    }
+
+    void OnReceiveBatch(std::size_t count) {
+        num_batches_++;
+        max_batch_ = std::max(max_batch_, count);
+    }
+
+    int GetNumBatches() const { return num_batches_; }
+    std::size_t GetMaxBatch() const { return max_batch_; }
+
+protected:
+    virtual int receive_batch_size() const { return kBatchSize; }
+
+private:
+    int num_batches_;
+    std::size_t max_batch_;
+};
+
+// Datagrams queued on the socket are read kBatchSize at a time
+TEST_F(UdpRecvTest, Batch) {
+    UdpServerManager::DeleteServer(server_);
+    UdpRecvBatchServerTest *server = new UdpRecvBatchServerTest(evm_.get());
+    server_ = server;
+    server_->Initialize(0);
+    server_->StartReceive();
+    task_util::WaitForIdle();
+    boost::system::error_code ec;
+    boost::asio::ip::udp::endpoint ep = server_->GetLocalEndpoint(&ec);
+    ASSERT_LT(0, ep.port());
+    UdpLocalClient client(ep.port());
+    TASK_UTIL_EXPECT_TRUE(client.Connect());
+    // Queue the datagrams before the server starts reading
+    const char msg[] = "Test Message";
+    const int num_msgs = 20;
+    int len = 0;
+    for (int i = 0; i < num_msgs; i++) {
+        len += client.Send((const u_int8_t *) msg, sizeof(msg));
+    }
+    EXPECT_EQ((int) (num_msgs * sizeof(msg)), len);
+    thread_->Start();
+    TASK_UTIL_EXPECT_EQ(num_msgs, server_->GetNumRecvMsg());
+    EXPECT_EQ((std::size_t) UdpRecvBatchServerTest::kBatchSize,
+              server->GetMaxBatch());
+    EXPECT_GE(server->GetNumBatches(),
+              num_msgs / UdpRecvBatchServerTest::kBatchSize);
+    EXPECT_LT(server->GetNumBatches(), num_msgs);
+    SocketIOStats rx_stats;
+    server_->GetRxSocketStats(&rx_stats);
+    EXPECT_EQ(num_msgs, rx_stats.calls);
+    EXPECT_EQ(len, rx_stats.bytes);
+    client.Close();
+    task_util::WaitForIdle();
+}
+
 }  // namespace
 
 int main(int argc, char **argv) {
@@ -4,6 +4,8 @@
 
 #include "io/udp_server.h"
 
+#include <errno.h>
+#include <sys/socket.h>
 #include <boost/bind.hpp>
 
 #include "base/logging.h"
@@ -93,6 +95,9 @@ void UdpServer::Shutdown() {
             delete[] pbuf_.back();
             pbuf_.pop_back();
         }
+#ifdef __linux__
+        batch_buffers_.clear();
+#endif
     }
     if (socket_.is_open()) {
         boost::system::error_code ec;
@@ -219,6 +224,16 @@ void UdpServer::HandleSendInternal(const const_buffer send_buffer,
 
 void UdpServer::StartReceive() {
     if (state_ == OK) {
+#ifdef __linux__
+        if (receive_batch_size() > 1) {
+            // Wait for the socket to be readable, the datagrams are read
+            // in HandleReceiveBatchInternal
+            socket_.async_receive(boost::asio::null_buffers(),
+                boost::bind(&UdpServer::HandleReceiveBatchInternal,
+                UdpServerPtr(this), boost::asio::placeholders::error));
+            return;
+        }
+#endif
         mutable_buffer b(AllocateBuffer());
         const_buffer buffer(buffer_cast<const uint8_t*>(b),
                             buffer_size(b));
@@ -255,10 +270,78 @@ void UdpServer::HandleReceiveInternal(const_buffer recv_buffer,
     stats_.read_calls++;
     stats_.read_bytes += bytes_transferred;
     // Call the handler
+    OnReceiveBatch(1);
     HandleReceive(recv_buffer, remote_endpoint_, bytes_transferred, error);
     StartReceive();
 }
 
+void UdpServer::HandleReceiveBatchInternal(
+    const boost::system::error_code& error) {
+    if (state_ != OK) {
+        stats_.read_errors++;
+        UDP_SERVER_LOG_ERROR(this, UDP_DIR_IN,
+            "Receive UDP server in WRONG state: " << state_);
+        return;
+    }
+    if (error) {
+        stats_.read_errors++;
+        UDP_SERVER_LOG_ERROR(this, UDP_DIR_IN,
+            "Read FAILED due to error: " << error.value() << " : " <<
+            error.message());
+        StartReceive();
+        return;
+    }
+#ifdef __linux__
+    std::size_t batch_size = receive_batch_size();
+    if (batch_buffers_.size() < batch_size) {
+        batch_buffers_.resize(batch_size);
+        batch_endpoints_.resize(batch_size);
+        batch_iovecs_.resize(batch_size);
+        batch_msgs_.resize(batch_size);
+    }
+    for (std::size_t i = 0; i < batch_size; i++) {
+        if (buffer_cast<void *>(batch_buffers_[i]) == NULL) {
+            batch_buffers_[i] = AllocateBuffer();
+        }
+        batch_iovecs_[i].iov_base = buffer_cast<void *>(batch_buffers_[i]);
+        batch_iovecs_[i].iov_len = buffer_size(batch_buffers_[i]);
+        memset(&batch_msgs_[i], 0, sizeof(struct mmsghdr));
+        batch_msgs_[i].msg_hdr.msg_name = batch_endpoints_[i].data();
+        batch_msgs_[i].msg_hdr.msg_namelen = batch_endpoints_[i].capacity();
+        batch_msgs_[i].msg_hdr.msg_iov = &batch_iovecs_[i];
+        batch_msgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+    int count = recvmmsg(socket_.native_handle(), &batch_msgs_[0], batch_size,
+                         MSG_DONTWAIT, NULL);
+    if (count < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            stats_.read_errors++;
+            UDP_SERVER_LOG_ERROR(this, UDP_DIR_IN,
+                "recvmmsg FAILED due to error: " << errno << " : " <<
+                strerror(errno));
+        }
+        count = 0;
+    }
+    if (count > 0) {
+        OnReceiveBatch(count);
+    }
+    for (int i = 0; i < count; i++) {
+        std::size_t bytes_transferred = batch_msgs_[i].msg_len;
+        batch_endpoints_[i].resize(batch_msgs_[i].msg_hdr.msg_namelen);
+        // The buffer is now owned by the reader, the slot is refilled
+        // before the next read
+        mutable_buffer buffer(batch_buffers_[i]);
+        batch_buffers_[i] = mutable_buffer();
+        // Update read statistics.
+        stats_.read_calls++;
+        stats_.read_bytes += bytes_transferred;
+        // Call the handler
+        HandleReceive(buffer, batch_endpoints_[i], bytes_transferred, error);
+    }
+#endif
+    StartReceive();
+}
+
 void UdpServer::HandleReceive(const const_buffer &recv_buffer,
     udp::endpoint remote_endpoint, std::size_t bytes_transferred,
     const boost::system::error_code& error) {
@@ -7,6 +7,9 @@
 
 #include <string>
 #include <vector>
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
 #include <boost/asio.hpp>
 #include <boost/intrusive_ptr.hpp>
 #include "io/event_manager.h"
@@ -65,6 +68,13 @@ protected:
             const boost::system::error_code& error);
     virtual void OnRead(const boost::asio::const_buffer &recv_buffer,
         const boost::asio::ip::udp::endpoint &remote_endpoint);
+    // Maximum number of datagrams read from the socket in one system call.
+    // Derived class may return more than 1 to have all the datagrams queued
+    // on the socket read with recvmmsg, where it is available.
+    virtual int receive_batch_size() const { return 1; }
+    // Called with the number of datagrams read from the socket, before they
+    // are passed to HandleReceive.
+    virtual void OnReceiveBatch(std::size_t count) { }
     virtual int reader_task_id() const {
         return reader_task_id_;
     }
@@ -93,6 +103,7 @@ private:
             boost::asio::const_buffer recv_buffer,
             std::size_t bytes_transferred,
             const boost::system::error_code& error);
+    void HandleReceiveBatchInternal(const boost::system::error_code& error);
     void HandleSendInternal(boost::asio::const_buffer send_buffer,
             boost::asio::ip::udp::endpoint remote_endpoint,
             std::size_t bytes_transferred,
@@ -107,6 +118,14 @@ private:
     boost::asio::ip::udp::endpoint remote_endpoint_;
     tbb::mutex mutex_;
     std::vector<u_int8_t *> pbuf_;
+#ifdef __linux__
+    // Buffers and message headers for the batched read. Only the slots
+    // handed to HandleReceive are refilled before the next read.
+    std::vector<boost::asio::mutable_buffer> batch_buffers_;
+    std::vector<boost::asio::ip::udp::endpoint> batch_endpoints_;
+    std::vector<struct iovec> batch_iovecs_;
+    std::vector<struct mmsghdr> batch_msgs_;
+#endif
     tbb::atomic<int> refcount_;
     io::SocketStats stats_;
 
@@ -33,6 +33,7 @@ SandeshTraceBufferPtr KSyncErrorTraceBuf(
 
 KSyncObject::FwdRefTree  KSyncObject::fwd_ref_tree_;
 KSyncObject::BackRefTree  KSyncObject::back_ref_tree_;
+tbb::mutex KSyncObject::ref_lock_;
 KSyncObjectManager *KSyncObjectManager::singleton_ = NULL;
 std::auto_ptr<KSyncEntry> KSyncObjectManager::default_defer_entry_;
 
@@ -60,6 +61,8 @@ KSyncObject::KSyncObject(const std::string &name) : need_index_(false), index_ta
                          stale_entry_cleanup_intvl_(0),
                          stale_entries_per_intvl_(0) {
     KSyncTraceBuf = SandeshTraceBufferCreate(name, 1000);
+    entry_count_ = 0;
+    SetPartitionCount(1);
 }
 
 KSyncObject::KSyncObject(const std::string &name, int max_index) :
@@ -69,10 +72,12 @@ KSyncObject::KSyncObject(const std::string &name, int max_index) :
                          stale_entry_cleanup_intvl_(0),
                          stale_entries_per_intvl_(0) {
     KSyncTraceBuf = SandeshTraceBufferCreate(name, 1000);
+    entry_count_ = 0;
+    SetPartitionCount(1);
 }
 
 KSyncObject::~KSyncObject() {
-    assert(tree_.size() == 0);
+    assert(entry_count_ == 0);
     if (stale_entry_cleanup_timer_ != NULL) {
         TimerManager::DeleteTimer(stale_entry_cleanup_timer_);
     }
@@ -98,26 +103,62 @@ void KSyncObject::Shutdown() {
     assert(back_ref_tree_.size() == 0);
 }
 
+void KSyncObject::SetPartitionCount(int count) {
+    assert(count > 0);
+    assert(entry_count_ == 0);
+    partitions_.clear();
+    for (int i = 0; i < count; i++) {
+        partitions_.push_back(new TreePartition());
+    }
+}
+
+KSyncObject::TreePartition *KSyncObject::GetPartition(
+    const KSyncEntry *key) const {
+    int index = PartitionIndex(key);
+    assert(index >= 0 && index < partition_count());
+    return const_cast<TreePartition *>(&partitions_[index]);
+}
+
+tbb::recursive_mutex &KSyncObject::PartitionLock(int index) const {
+    return partitions_[index].lock_;
+}
+
+tbb::recursive_mutex &KSyncObject::EntryLock(const KSyncEntry *entry) const {
+    return GetPartition(entry)->lock_;
+}
+
 KSyncEntry *KSyncObject::Find(const KSyncEntry *key) {
-    Tree::iterator  it = tree_.find(*key);
-    if (it != tree_.end()) {
+    Tree &tree = GetPartition(key)->tree_;
+    Tree::iterator  it = tree.find(*key);
+    if (it != tree.end()) {
         return it.operator->();
     }
 
     return NULL;
 }
 
+// Walks the partitions in order. Entries are ordered by key only within
+// a partition
 KSyncEntry *KSyncObject::Next(const KSyncEntry *entry) const {
-    tbb::recursive_mutex::scoped_lock lock(lock_);
-    Tree::const_iterator it;
-    if (entry == NULL) {
-        it = tree_.begin();
-    } else {
-        it = tree_.iterator_to(*entry);
+    int index = 0;
+    if (entry != NULL) {
+        index = PartitionIndex(entry);
+        const TreePartition &partition = partitions_[index];
+        tbb::recursive_mutex::scoped_lock lock(partition.lock_);
+        Tree::const_iterator it = partition.tree_.iterator_to(*entry);
         it++;
+        if (it != partition.tree_.end()) {
+            return const_cast<KSyncEntry *>(it.operator->());
+        }
+        index++;
     }
-    if (it != tree_.end()) {
-        return const_cast<KSyncEntry *>(it.operator->());
+
+    for (; index < partition_count(); index++) {
+        const TreePartition &partition = partitions_[index];
+        tbb::recursive_mutex::scoped_lock lock(partition.lock_);
+        if (!partition.tree_.empty()) {
+            return const_cast<KSyncEntry *>(&(*partition.tree_.begin()));
+        }
     }
     return NULL;
 }
@@ -127,11 +168,17 @@ KSyncEntry *KSyncObject::CreateImpl(const KSyncEntry *key) {
 
     KSyncEntry *entry;
     if (need_index_) {
-        entry = Alloc(key, index_table_.Alloc());
+        size_t index;
+        {
+            tbb::mutex::scoped_lock lock(index_lock_);
+            index = index_table_.Alloc();
+        }
+        entry = Alloc(key, index);
     } else {
         entry = Alloc(key, KSyncEntry::kInvalidIndex);
     }
-    std::pair<Tree::iterator, bool> ret = tree_.insert(*entry);
+    std::pair<Tree::iterator, bool> ret =
+        GetPartition(entry)->tree_.insert(*entry);
     if (ret.second == false) {
         // entry with same key already exists in the Ksync tree
         // delete the allocated entry and use the entry available
@@ -143,6 +190,7 @@ KSyncEntry *KSyncObject::CreateImpl(const KSyncEntry *key) {
         // entry succeeds, otherwise reference for tree insertion
         // is already accounted for
         intrusive_ptr_add_ref(entry);
+        entry_count_++;
     }
     return entry;
 }
@@ -150,13 +198,14 @@ KSyncEntry *KSyncObject::CreateImpl(const KSyncEntry *key) {
 void KSyncObject::ClearStale(KSyncEntry *entry) {
     // Clear stale marked entry and remove from stale entry tree
     entry->stale_ = false;
+    tbb::mutex::scoped_lock lock(stale_lock_);
     stale_entry_tree_.erase(entry);
 }
 
 // Creates a KSync entry. Calling routine sets no_lookup to TRUE when its
 // guaranteed that KSync entry is not present (ex: flow)
 KSyncEntry *KSyncObject::Create(const KSyncEntry *key, bool no_lookup) {
-    tbb::recursive_mutex::scoped_lock lock(lock_);
+    tbb::recursive_mutex::scoped_lock lock(EntryLock(key));
 
     KSyncEntry *entry = NULL;
     if (no_lookup == false)
@@ -186,7 +235,7 @@ KSyncEntry *KSyncObject::CreateStale(const KSyncEntry *key) {
     // Should not be called without initialising stale entry
     // cleanup InitStaleEntryCleanup
     assert(stale_entry_cleanup_timer_ != NULL);
-    tbb::recursive_mutex::scoped_lock lock(lock_);
+    tbb::recursive_mutex::scoped_lock lock(EntryLock(key));
     KSyncEntry *entry = Find(key);
     if (entry == NULL) {
         entry = CreateImpl(key);
@@ -204,7 +253,10 @@ KSyncEntry *KSyncObject::CreateStale(const KSyncEntry *key) {
 
     // mark the entry stale and add to stale entry tree.
     entry->stale_ = true;
-    stale_entry_tree_.insert(entry);
+    {
+        tbb::mutex::scoped_lock stale_lock(stale_lock_);
+        stale_entry_tree_.insert(entry);
+    }
 
     NotifyEvent(entry, KSyncEntry::ADD_CHANGE_REQ);
     // try starting the timer if not running already
@@ -236,20 +288,24 @@ void KSyncObject::Delete(KSyncEntry *entry) {
 }
 
 void KSyncObject::ChangeKey(KSyncEntry *entry, uint32_t arg) {
-    tbb::recursive_mutex::scoped_lock lock(lock_);
-    assert(tree_.erase(*entry) > 0);
+    TreePartition *partition = GetPartition(entry);
+    tbb::recursive_mutex::scoped_lock lock(partition->lock_);
+    Tree &tree = partition->tree_;
+    assert(tree.erase(*entry) > 0);
     uint32_t old_key = GetKey(entry);
     UpdateKey(entry, arg);
-    std::pair<Tree::iterator, bool> ret = tree_.insert(*entry);
+    // key change is not allowed to move the entry across partitions
+    assert(GetPartition(entry) == partition);
+    std::pair<Tree::iterator, bool> ret = tree.insert(*entry);
     if (ret.second == false) {
         // entry with the same key already exist, to proceed further
         // switch place with the existing entry
         KSyncEntry *current = ret.first.operator->();
-        assert(tree_.erase(*current) > 0);
+        assert(tree.erase(*current) > 0);
         UpdateKey(current, old_key);
         // following tree insertions should always pass
-        assert(tree_.insert(*current).second == true);
-        assert(tree_.insert(*entry).second == true);
+        assert(tree.insert(*current).second == true);
+        assert(tree.insert(*entry).second == true);
     }
 }
 
@@ -259,8 +315,10 @@ uint32_t KSyncObject::GetKey(KSyncEntry *entry) {
 }
 
 void KSyncObject::FreeInd(KSyncEntry *entry, uint32_t index) {
-    assert(tree_.erase(*entry) > 0);
+    assert(GetPartition(entry)->tree_.erase(*entry) > 0);
+    entry_count_--;
     if (need_index_ == true && index != KSyncEntry::kInvalidIndex) {
+        tbb::mutex::scoped_lock lock(index_lock_);
         index_table_.Free(index);
     }
     PreFree(entry);
@@ -273,7 +331,7 @@ void KSyncObject::Free(KSyncEntry *entry) {
 
 void KSyncObject::SafeNotifyEvent(KSyncEntry *entry, 
                                   KSyncEntry::KSyncEvent event) {
-    tbb::recursive_mutex::scoped_lock lock(lock_);
+    tbb::recursive_mutex::scoped_lock lock(EntryLock(entry));
     NotifyEvent(entry, event);
 }
 
@@ -362,8 +420,12 @@ void KSyncDBObject::CleanupOnDel(KSyncEntry *entry) {
 // DBTable notification handler.
 // Generates events for the KSyncEntry state-machine based DBEntry
 // Stores the KSyncEntry allocated as DBEntry-state
+// With more than one partition, DB partition i is handled by KSync
+// partition (i % partition_count()). Notifications from different DB
+// partitions are then processed in parallel.
 void KSyncDBObject::Notify(DBTablePartBase *partition, DBEntryBase *e) {
-    tbb::recursive_mutex::scoped_lock lock(lock_);
+    int index = partition->index() % partition_count();
+    tbb::recursive_mutex::scoped_lock lock(PartitionLock(index));
     DBEntry *entry = static_cast<DBEntry *>(e);
     DBTableBase *table = partition->parent();
     assert(table_ == table);
@@ -452,6 +514,8 @@ void KSyncDBObject::Notify(DBTablePartBase *partition, DBEntryBase *e) {
 
         // TODO : Memory is allocated and freed only for lookup. Fix this.
         key = DBToKSyncEntry(entry);
+        // KSync entry must map to the partition of its DB entry
+        assert(PartitionIndex(key) == index);
         found = Find(key);
         if (found == NULL) {
             ksync = static_cast<KSyncDBEntry *>(CreateImpl(key));
@@ -1411,33 +1475,38 @@ void KSyncObject::NotifyEvent(KSyncEntry *entry, KSyncEntry::KSyncEvent event) {
         FreeInd(entry, entry->GetIndex());
     }
 
-    if (tree_.empty() == true) {
+    if (entry_count_ == 0) {
         EmptyTable();
     }
 }
 
 void KSyncObject::NetlinkAckInternal(KSyncEntry *entry, KSyncEntry::KSyncEvent event) {
-    tbb::recursive_mutex::scoped_lock lock(lock_);
+    tbb::recursive_mutex::scoped_lock lock(EntryLock(entry));
     entry->Response();
     NotifyEvent(entry, event);
 }
 
 bool KSyncObject::StaleEntryCleanupCb() {
-    // donot reschedule timer if no stale entries
-    if (stale_entry_tree_.empty()) {
-        return false;
+    {
+        tbb::mutex::scoped_lock lock(stale_lock_);
+        // donot reschedule timer if no stale entries
+        if (stale_entry_tree_.empty()) {
+            return false;
+        }
     }
 
     uint32_t count = 0;
-    std::set<KSyncEntry::KSyncEntryPtr>::iterator it = stale_entry_tree_.begin();
-    while (it != stale_entry_tree_.end()) {
-        if (count == stale_entries_per_intvl_) {
-            break;
+    while (count < stale_entries_per_intvl_) {
+        KSyncEntry *entry;
+        {
+            tbb::mutex::scoped_lock lock(stale_lock_);
+            if (stale_entry_tree_.empty()) {
+                break;
+            }
+            entry = (*stale_entry_tree_.begin()).get();
         }
-        KSyncEntry *entry = (*it).get();
         // Delete removes entry from stale entry tree
         Delete(entry);
-        it = stale_entry_tree_.begin();
         count++;
     }
 
@@ -1453,12 +1522,14 @@ void KSyncObject::NetlinkAck(KSyncEntry *entry, KSyncEntry::KSyncEvent event) {
 // KSyncEntry dependency management
 ///////////////////////////////////////////////////////////////////////////////
 void KSyncObject::BackRefAdd(KSyncEntry *key, KSyncEntry *reference) {
+    intrusive_ptr_add_ref(key);
+    intrusive_ptr_add_ref(reference);
+
+    tbb::mutex::scoped_lock lock(ref_lock_);
     KSyncFwdReference *fwd_node = new KSyncFwdReference(key, reference);
     FwdRefTree::iterator fwd_it = fwd_ref_tree_.find(*fwd_node);
     assert(fwd_it == fwd_ref_tree_.end());
     fwd_ref_tree_.insert(*fwd_node);
-    intrusive_ptr_add_ref(key);
-    intrusive_ptr_add_ref(reference);
 
     KSyncBackReference *back_node = new KSyncBackReference(reference, key);
     BackRefTree::iterator back_it = back_ref_tree_.find(*back_node);
@@ -1466,7 +1537,8 @@ void KSyncObject::BackRefAdd(KSyncEntry *key, KSyncEntry *reference) {
     back_ref_tree_.insert(*back_node);
 }
 
-void KSyncObject::BackRefDel(KSyncEntry *key) {
+void KSyncObject::BackRefDelInternal(KSyncEntry *key,
+                                     std::vector<KSyncEntry *> *ref_list) {
     KSyncFwdReference fwd_search_node(key, NULL);
     FwdRefTree::iterator fwd_it = fwd_ref_tree_.find(fwd_search_node);
     if (fwd_it == fwd_ref_tree_.end()) {
@@ -1484,35 +1556,90 @@ void KSyncObject::BackRefDel(KSyncEntry *key) {
     back_ref_tree_.erase(back_it);
     delete back_node;
 
-    intrusive_ptr_release(key);
-    intrusive_ptr_release(reference);
+    ref_list->push_back(key);
+    ref_list->push_back(reference);
+}
+
+void KSyncObject::BackRefDel(KSyncEntry *key) {
+    std::vector<KSyncEntry *> ref_list;
+    {
+        tbb::mutex::scoped_lock lock(ref_lock_);
+        BackRefDelInternal(key, &ref_list);
+    }
+
+    // Releasing the reference can trigger the state-machine of the entry,
+    // which must run without ref_lock_
+    for (std::vector<KSyncEntry *>::iterator it = ref_list.begin();
+         it != ref_list.end(); ++it) {
+        intrusive_ptr_release(*it);
+    }
 }
 
 void KSyncObject::BackRefReEval(KSyncEntry *key) {
     std::vector<KSyncEntry *> buf;
+    std::vector<KSyncEntry *> ref_list;
     KSyncBackReference node(key, NULL);
 
-    for (BackRefTree::iterator it = back_ref_tree_.upper_bound(node); 
-         it != back_ref_tree_.end(); ) {
-        BackRefTree::iterator it_work = it++;
+    {
+        tbb::mutex::scoped_lock ref_lock(ref_lock_);
+        for (BackRefTree::iterator it = back_ref_tree_.upper_bound(node);
+             it != back_ref_tree_.end(); ) {
+            BackRefTree::iterator it_work = it++;
 
-        KSyncBackReference *entry = it_work.operator->();
-        if (entry->key_ != key) {
-            break;
+            KSyncBackReference *entry = it_work.operator->();
+            if (entry->key_ != key) {
+                break;
+            }
+            KSyncEntry *back_ref = entry->back_reference_;
+            buf.push_back(back_ref);
+            BackRefDelInternal(entry->back_reference_, &ref_list);
         }
-        KSyncEntry *back_ref = entry->back_reference_;
-        buf.push_back(back_ref);
-        BackRefDel(entry->back_reference_);
     }
 
-    std::vector<KSyncEntry *>::iterator it = buf.begin();
+    std::vector<KSyncEntry *>::iterator it;
+    for (it = ref_list.begin(); it != ref_list.end(); ++it) {
+        intrusive_ptr_release(*it);
+    }
+
+    it = buf.begin();
     while (it != buf.end()) {
-        tbb::recursive_mutex::scoped_lock lock((*it)->GetObject()->lock_);
-        NotifyEvent(*it, KSyncEntry::RE_EVAL);
+        KSyncObject *obj = (*it)->GetObject();
+        // The lock of key is held here. Taking the lock of another partition
+        // can deadlock with a thread re-evaluating in the other direction,
+        // so such entries are re-evaluated from the KSyncObjectManager
+        if ((partition_count() > 1 || obj->partition_count() > 1) &&
+            &obj->EntryLock(*it) != &EntryLock(key)) {
+            KSyncObjectEvent *event =
+                new KSyncObjectEvent(obj, KSyncObjectEvent::RE_EVAL);
+            event->ref_ = *it;
+            KSyncObjectManager::GetInstance()->Enqueue(event);
+        } else {
+            tbb::recursive_mutex::scoped_lock lock(obj->EntryLock(*it));
+            NotifyEvent(*it, KSyncEntry::RE_EVAL);
+        }
         it++;
     }
 }
 
+// Re-evaluate an entry deferred by BackRefReEval. The entry may have been
+// changed, deleted or made to wait on another entry in the meantime
+void KSyncObject::DeferredReEval(KSyncEntry *entry) {
+    tbb::recursive_mutex::scoped_lock lock(EntryLock(entry));
+    if (entry->GetState() != KSyncEntry::ADD_DEFER &&
+        entry->GetState() != KSyncEntry::CHANGE_DEFER) {
+        return;
+    }
+
+    {
+        tbb::mutex::scoped_lock ref_lock(ref_lock_);
+        KSyncFwdReference fwd_search_node(entry, NULL);
+        if (fwd_ref_tree_.find(fwd_search_node) != fwd_ref_tree_.end()) {
+            return;
+        }
+    }
+    NotifyEvent(entry, KSyncEntry::RE_EVAL);
+}
+
 bool KSyncObjectManager::Process(KSyncObjectEvent *event) {
     switch(event->event_) {
     case KSyncObjectEvent::UNREGISTER:
@@ -1566,6 +1693,9 @@ bool KSyncObjectManager::Process(KSyncObjectEvent *event) {
             }
             break;
         }
+    case KSyncObjectEvent::RE_EVAL:
+        event->obj_->DeferredReEval(event->ref_.get());
+        break;
     default:
         assert(0);
     }
@@ -5,6 +5,9 @@
 #ifndef ctrlplane_ksync_object_h 
 #define ctrlplane_ksync_object_h 
 
+#include <vector>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <tbb/atomic.h>
 #include <tbb/mutex.h>
 #include <tbb/recursive_mutex.h>
 #include <base/queue_task.h>
@@ -135,13 +138,14 @@ public:
 
     //Callback when all the entries in table are deleted
     virtual void EmptyTable(void) { };
-    bool IsEmpty(void) { return tree_.empty(); }; 
+    bool IsEmpty(void) { return entry_count_ == 0; };
 
     virtual bool DoEventTrace(void) { return true; }
     virtual void PreFree(KSyncEntry *entry) { }
     static void Shutdown();
 
-    std::size_t Size() { return tree_.size(); }
+    std::size_t Size() { return entry_count_; }
+    int partition_count() const { return partitions_.size(); }
     void set_delete_scheduled() { delete_scheduled_ = true;}
     bool delete_scheduled() { return delete_scheduled_;}
     virtual SandeshTraceBufferPtr GetKSyncTraceBuf() {return KSyncTraceBuf;}
@@ -151,9 +155,16 @@ protected:
     KSyncEntry *CreateImpl(const KSyncEntry *key);
     // Clear Stale Entry flag
     void ClearStale(KSyncEntry *entry);
-    // Big lock on the tree
-    // TODO: Make this more fine granular
-    mutable tbb::recursive_mutex  lock_;
+    // Split the tree and state-machine in to partitions, each with its own
+    // lock. Must be called before any entry is created.
+    void SetPartitionCount(int count);
+    // Partition holding the entry with given key. Objects with more than
+    // one partition must override this, the partition must depend only on
+    // the key
+    virtual int PartitionIndex(const KSyncEntry *key) const { return 0; }
+    tbb::recursive_mutex &PartitionLock(int index) const;
+    // Lock on the partition holding the entry
+    tbb::recursive_mutex &EntryLock(const KSyncEntry *entry) const;
     void ChangeKey(KSyncEntry *entry, uint32_t arg);
     virtual void UpdateKey(KSyncEntry *entry, uint32_t arg) { }
 
@@ -163,8 +174,24 @@ protected:
 
 private:
     friend class KSyncEntry;
+    friend class KSyncObjectManager;
     friend void TestTriggerStaleEntryCleanupCb(KSyncObject *obj);
 
+    struct TreePartition {
+        Tree tree_;
+        mutable tbb::recursive_mutex lock_;
+    };
+    typedef boost::ptr_vector<TreePartition> PartitionList;
+
+    TreePartition *GetPartition(const KSyncEntry *key) const;
+    // Remove the dependency of key on its reference. Ref-counts dropped on
+    // the entries are returned in ref_list, to be released after
+    // ref_lock_ is released
+    static void BackRefDelInternal(KSyncEntry *key,
+                                   std::vector<KSyncEntry *> *ref_list);
+    // Re-evaluate an entry in another partition, deferred by BackRefReEval
+    void DeferredReEval(KSyncEntry *entry);
+
     // Free indication of an KSyncElement. 
     // Removes from tree and free index if allocated earlier
     void FreeInd(KSyncEntry *entry, uint32_t index);
@@ -178,21 +205,26 @@ private:
     //Callback to do cleanup when DEL ACK is received.
     virtual void CleanupOnDel(KSyncEntry *kentry) {}
 
-    // Tree of all KSyncEntries
-    Tree tree_;
+    // Tree of all KSyncEntries, split in partitions
+    PartitionList partitions_;
+    tbb::atomic<size_t> entry_count_;
     // Forward reference tree
     static FwdRefTree  fwd_ref_tree_;
     // Back reference tree
     static BackRefTree  back_ref_tree_;
+    // Lock on the reference trees, shared by all objects
+    static tbb::mutex ref_lock_;
     // Does the KSyncEntry need index?
     bool need_index_;
     // Index table for KSyncObject
     KSyncIndexTable index_table_;
+    tbb::mutex index_lock_;
     // scheduled for deletion
     bool delete_scheduled_;
 
     // stale entry tree
     std::set<KSyncEntry::KSyncEntryPtr> stale_entry_tree_;
+    tbb::mutex stale_lock_;
 
     // Stale Entry Cleanup Timer
     Timer *stale_entry_cleanup_timer_;
@@ -271,6 +303,7 @@ struct KSyncObjectEvent {
         UNKNOWN,
         UNREGISTER,
         DELETE,
+        RE_EVAL,
     };
     KSyncObjectEvent(KSyncObject *obj, Event event) :
         obj_(obj), event_(event) {
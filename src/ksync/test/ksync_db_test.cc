@@ -11,6 +11,8 @@
 #include <tbb/atomic.h>
 
 #include "base/logging.h"
+#include "base/string_util.h"
+#include "base/time_util.h"
 #include "testing/gunit.h"
 
 #include "db/db.h"
@@ -959,11 +961,282 @@ TEST_F(DBKSyncTest, DBFilterDelAddDupToDup) {
     EXPECT_EQ(VlanKSyncEntry::GetDelCount(), 2);
 }
 
+// Vlan table spreading the entries over the DB partitions by tag
+class PartitionedVlanTable : public VlanTable {
+public:
+    PartitionedVlanTable(DB *db, const std::string &name) :
+        VlanTable(db, name) { }
+
+    virtual size_t Hash(const DBEntry *entry) const {
+        return static_cast<const Vlan *>(entry)->GetTag();
+    }
+    virtual size_t Hash(const DBRequestKey *key) const {
+        return static_cast<const Vlan::VlanKey *>(key)->tag_;
+    }
+
+    static DBTableBase *CreateTable(DB *db, const string &name) {
+        PartitionedVlanTable *table = new PartitionedVlanTable(db, name);
+        table->Init();
+        return table;
+    }
+};
+
+// Vlans named "child-*" wait for the vlan with tag + partition count, which
+// is in the same partition. Vlans named "xchild-*" wait for the vlan with
+// tag + 1, which is in the next partition
+class PartitionedVlanKSyncEntry : public VlanKSyncEntry {
+public:
+    PartitionedVlanKSyncEntry(const PartitionedVlanKSyncEntry *entry) :
+        VlanKSyncEntry(entry) { }
+    PartitionedVlanKSyncEntry(const Vlan *vlan) : VlanKSyncEntry(vlan) { }
+    PartitionedVlanKSyncEntry(const uint16_t tag) : VlanKSyncEntry(tag) { }
+    virtual ~PartitionedVlanKSyncEntry() { }
+
+    virtual bool Sync(DBEntry *e) {
+        bool ret = VlanKSyncEntry::Sync(e);
+        if (name().find("child-") == 0 && dep_.get() == NULL) {
+            PartitionedVlanKSyncEntry key(GetTag() +
+                                          GetObject()->partition_count());
+            dep_ = GetObject()->GetReference(&key);
+            ret = true;
+        } else if (name().find("xchild-") == 0 && dep_.get() == NULL) {
+            PartitionedVlanKSyncEntry key(GetTag() + 1);
+            dep_ = GetObject()->GetReference(&key);
+            ret = true;
+        }
+        return ret;
+    }
+    virtual KSyncEntry *UnresolvedReference() {
+        if (dep_.get() != NULL && !dep_->IsResolved()) {
+            return dep_.get();
+        }
+        return NULL;
+    }
+    KSyncDBObject *GetObject() const;
+
+private:
+    KSyncEntryPtr dep_;
+    DISALLOW_COPY_AND_ASSIGN(PartitionedVlanKSyncEntry);
+};
+
+class PartitionedVlanKSyncObject : public KSyncDBObject {
+public:
+    PartitionedVlanKSyncObject(DBTableBase *table, int partition_count) :
+        KSyncDBObject("Partitioned Vlan KSync") {
+        SetPartitionCount(partition_count);
+        RegisterDb(table);
+    }
+    virtual ~PartitionedVlanKSyncObject() { }
+
+    virtual KSyncEntry *Alloc(const KSyncEntry *entry, uint32_t index) {
+        return new PartitionedVlanKSyncEntry(
+            static_cast<const PartitionedVlanKSyncEntry *>(entry));
+    }
+
+    virtual KSyncEntry *DBToKSyncEntry(const DBEntry *e) {
+        return new PartitionedVlanKSyncEntry(static_cast<const Vlan *>(e));
+    }
+
+    virtual int PartitionIndex(const KSyncEntry *key) const {
+        const VlanKSyncEntry *vlan = static_cast<const VlanKSyncEntry *>(key);
+        return vlan->GetTag() % partition_count();
+    }
+
+    static void Init(DBTableBase *table, int partition_count) {
+        assert(singleton_ == NULL);
+        singleton_ = new PartitionedVlanKSyncObject(table, partition_count);
+    }
+
+    static void Shutdown() {
+        delete singleton_;
+        singleton_ = NULL;
+    }
+
+    static PartitionedVlanKSyncObject *GetKSyncObject() { return singleton_; }
+
+private:
+    static PartitionedVlanKSyncObject *singleton_;
+    DISALLOW_COPY_AND_ASSIGN(PartitionedVlanKSyncObject);
+};
+PartitionedVlanKSyncObject *PartitionedVlanKSyncObject::singleton_;
+
+KSyncDBObject *PartitionedVlanKSyncEntry::GetObject() const {
+    return PartitionedVlanKSyncObject::GetKSyncObject();
+}
+
+class DBKSyncPartitionTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        VlanKSyncEntry::Reset();
+        itbl = static_cast<VlanTable *>(db_.CreateTable("db.test.pvlan.0"));
+    }
+
+    virtual void TearDown() {
+        db_.RemoveTable(itbl);
+        delete itbl;
+    }
+
+    void VlanAddDel(const string &name, uint16_t tag, bool del) {
+        DBRequest req;
+        req.oper = del ? DBRequest::DB_ENTRY_DELETE :
+            DBRequest::DB_ENTRY_ADD_CHANGE;
+        req.key.reset(new Vlan::VlanKey(name, tag));
+        req.data.reset(NULL);
+        itbl->Enqueue(&req);
+    }
+
+    // Adds and deletes count vlans, returns the time taken in usec to
+    // program them
+    uint64_t ProgramVlans(int partition_count, int count) {
+        PartitionedVlanKSyncObject::Init(itbl, partition_count);
+        uint64_t start = ClockMonotonicUsec();
+        for (int i = 0; i < count; i++) {
+            VlanAddDel("vlan" + integerToString(i), i, false);
+        }
+        task_util::WaitForIdle(300);
+        uint64_t add_time = ClockMonotonicUsec() - start;
+        EXPECT_EQ(count, (int)
+                  PartitionedVlanKSyncObject::GetKSyncObject()->Size());
+
+        for (int i = 0; i < count; i++) {
+            VlanAddDel("vlan" + integerToString(i), i, true);
+        }
+        task_util::WaitForIdle(300);
+        EXPECT_TRUE(PartitionedVlanKSyncObject::GetKSyncObject()->IsEmpty());
+        PartitionedVlanKSyncObject::Shutdown();
+        return add_time;
+    }
+
+    DB db_;
+    VlanTable *itbl;
+};
+
+TEST_F(DBKSyncPartitionTest, AddDelete) {
+    int partition_count = itbl->PartitionCount();
+    PartitionedVlanKSyncObject::Init(itbl, partition_count);
+    PartitionedVlanKSyncObject *obj =
+        PartitionedVlanKSyncObject::GetKSyncObject();
+    EXPECT_EQ(partition_count, obj->partition_count());
+
+    for (int i = 1; i <= 64; i++) {
+        VlanAddDel("vlan" + integerToString(i), i, false);
+    }
+    task_util::WaitForIdle();
+    EXPECT_EQ(64, VlanKSyncEntry::GetAddCount());
+    EXPECT_EQ(64U, obj->Size());
+
+    // walk visits every partition
+    int count = 0;
+    for (KSyncEntry *entry = obj->Next(NULL); entry != NULL;
+         entry = obj->Next(entry)) {
+        EXPECT_EQ(KSyncEntry::IN_SYNC, entry->GetState());
+        count++;
+    }
+    EXPECT_EQ(64, count);
+
+    for (int i = 1; i <= 64; i++) {
+        PartitionedVlanKSyncEntry key(i);
+        EXPECT_TRUE(obj->Find(&key) != NULL);
+        VlanAddDel("vlan" + integerToString(i), i, true);
+    }
+    task_util::WaitForIdle();
+    EXPECT_EQ(64, VlanKSyncEntry::GetDelCount());
+    EXPECT_TRUE(obj->IsEmpty());
+    PartitionedVlanKSyncObject::Shutdown();
+}
+
+TEST_F(DBKSyncPartitionTest, Dependency) {
+    int partition_count = itbl->PartitionCount();
+    PartitionedVlanKSyncObject::Init(itbl, partition_count);
+    PartitionedVlanKSyncObject *obj =
+        PartitionedVlanKSyncObject::GetKSyncObject();
+
+    // child waits for the parent to be programmed
+    uint16_t parent_tag = 10 + partition_count;
+    VlanAddDel("child-10", 10, false);
+    task_util::WaitForIdle();
+    PartitionedVlanKSyncEntry child_key(10);
+    PartitionedVlanKSyncEntry parent_key(parent_tag);
+    KSyncEntry *child = obj->Find(&child_key);
+    KSyncEntry *parent = obj->Find(&parent_key);
+    ASSERT_TRUE(child != NULL);
+    ASSERT_TRUE(parent != NULL);
+    EXPECT_EQ(KSyncEntry::ADD_DEFER, child->GetState());
+    EXPECT_EQ(KSyncEntry::TEMP, parent->GetState());
+    EXPECT_EQ(0, VlanKSyncEntry::GetAddCount());
+
+    VlanAddDel("parent", parent_tag, false);
+    task_util::WaitForIdle();
+    EXPECT_EQ(KSyncEntry::IN_SYNC, child->GetState());
+    EXPECT_EQ(KSyncEntry::IN_SYNC, parent->GetState());
+    EXPECT_EQ(2, VlanKSyncEntry::GetAddCount());
+
+    // parent is deleted only after child releases the reference
+    VlanAddDel("parent", parent_tag, true);
+    task_util::WaitForIdle();
+    EXPECT_EQ(KSyncEntry::DEL_DEFER_REF, parent->GetState());
+    VlanAddDel("child-10", 10, true);
+    task_util::WaitForIdle();
+    EXPECT_EQ(2, VlanKSyncEntry::GetDelCount());
+    EXPECT_TRUE(obj->IsEmpty());
+    PartitionedVlanKSyncObject::Shutdown();
+}
+
+// Parent in another partition re-evaluates the child through the
+// KSyncObjectManager
+TEST_F(DBKSyncPartitionTest, CrossPartitionDependency) {
+    int partition_count = itbl->PartitionCount();
+    PartitionedVlanKSyncObject::Init(itbl, partition_count);
+    PartitionedVlanKSyncObject *obj =
+        PartitionedVlanKSyncObject::GetKSyncObject();
+
+    VlanAddDel("xchild-10", 10, false);
+    task_util::WaitForIdle();
+    PartitionedVlanKSyncEntry child_key(10);
+    PartitionedVlanKSyncEntry parent_key(11);
+    KSyncEntry *child = obj->Find(&child_key);
+    KSyncEntry *parent = obj->Find(&parent_key);
+    ASSERT_TRUE(child != NULL);
+    ASSERT_TRUE(parent != NULL);
+    EXPECT_EQ(KSyncEntry::ADD_DEFER, child->GetState());
+    EXPECT_EQ(KSyncEntry::TEMP, parent->GetState());
+
+    VlanAddDel("parent", 11, false);
+    task_util::WaitForIdle();
+    EXPECT_EQ(KSyncEntry::IN_SYNC, child->GetState());
+    EXPECT_EQ(KSyncEntry::IN_SYNC, parent->GetState());
+    EXPECT_EQ(2, VlanKSyncEntry::GetAddCount());
+
+    VlanAddDel("xchild-10", 10, true);
+    VlanAddDel("parent", 11, true);
+    task_util::WaitForIdle();
+    EXPECT_EQ(2, VlanKSyncEntry::GetDelCount());
+    EXPECT_TRUE(obj->IsEmpty());
+    PartitionedVlanKSyncObject::Shutdown();
+}
+
+// Compares the time to program entries with a single KSync partition, and
+// with one KSync partition per DB partition
+TEST_F(DBKSyncPartitionTest, DISABLED_ProgrammingThroughputPerf) {
+    static const int kVlanCount = 60000;
+    int partition_count = itbl->PartitionCount();
+    uint64_t single = ProgramVlans(1, kVlanCount);
+    uint64_t partitioned = ProgramVlans(partition_count, kVlanCount);
+    LOG(DEBUG, kVlanCount << " entries, 1 partition : " << single <<
+        " usec, " << partition_count << " partitions : " << partitioned <<
+        " usec");
+    cout << kVlanCount << " entries, 1 partition : " << single <<
+        " usec, " << partition_count << " partitions : " << partitioned <<
+        " usec" << endl;
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     LoggingInit();
 
     object_manager = KSyncObjectManager::Init();
     DB::RegisterFactory("db.test.vlan.0", &VlanTable::CreateTable);
+    DB::RegisterFactory("db.test.pvlan.0",
+                        &PartitionedVlanTable::CreateTable);
     return RUN_ALL_TESTS();
 }
@@ -629,6 +629,28 @@ public:
                                          inp.inp.table,     // table
                                          qs);
 
+                    // Database read latency of all chunks, where
+                    // terms and selects
+                    std::vector<uint32_t> fetch_latency;
+                    uint32_t fetches = 0, fetch_errors = 0;
+                    for (size_t i=0; i < inp.ret_info.size(); i++) {
+                        for (size_t j=0; j < inp.ret_info[i].size(); j++) {
+                            const QPerfInfo &perf(inp.ret_info[i][j]);
+                            if (fetch_latency.size() < perf.fetch_latency.size())
+                                fetch_latency.resize(perf.fetch_latency.size());
+                            for (size_t k=0; k < perf.fetch_latency.size(); k++) {
+                                fetch_latency[k] += perf.fetch_latency[k];
+                                fetches += perf.fetch_latency[k];
+                            }
+                            fetch_errors += perf.fetch_errors;
+                        }
+                    }
+                    if (fetches) {
+                        Q_E_QUERY_FETCH_LATENCY_SEND(ret.inp.qp.qid,
+                            inp.inp.table, fetches, fetch_errors,
+                            fetch_latency);
+                    }
+
                     //g_viz_constants.COLLECTOR_GLOBAL_TABLE 
                     QE_LOG_NOQID(INFO, "Finished: QID " << ret.inp.qp.qid <<
                         " Table " << inp.inp.table <<
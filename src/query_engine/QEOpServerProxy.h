@@ -113,14 +113,17 @@ public:
     struct QPerfInfo {
         QPerfInfo(uint32_t w, uint32_t s, uint32_t p) :
             chunk_where_time(w), chunk_select_time(s), chunk_postproc_time(p),
-            error(0) {}
+            error(0), fetch_errors(0) {}
         QPerfInfo() : 
             chunk_where_time(0), chunk_select_time(0), chunk_postproc_time(0),
-            error(0) {}
+            error(0), fetch_errors(0) {}
         uint32_t chunk_where_time;
         uint32_t chunk_select_time; 
         uint32_t chunk_postproc_time;
         int error; 
+        // Latency histogram of the database reads, see DbFetchStats
+        std::vector<uint32_t> fetch_latency;
+        uint32_t fetch_errors;
     };
 
     void QueryResult(void *, QPerfInfo qperf, std::auto_ptr<BufferT> res,
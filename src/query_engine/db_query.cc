@@ -3,8 +3,38 @@
  */
 
 #include "query.h"
+#include "base/time_util.h"
 #include "base/work_pipeline.h"
 
+const size_t DbFetchStats::kLatencyBuckets;
+
+DbFetchStats::DbFetchStats() {
+    for (size_t i = 0; i < kLatencyBuckets; i++) {
+        latency_[i] = 0;
+    }
+    errors_ = 0;
+}
+
+void DbFetchStats::Record(uint64_t latency_usec, bool error) {
+    size_t bucket = 0;
+    for (uint64_t limit = 1000; latency_usec >= limit &&
+         bucket < kLatencyBuckets - 1; limit <<= 1) {
+        bucket++;
+    }
+    latency_[bucket].fetch_and_increment();
+    if (error) {
+        errors_.fetch_and_increment();
+    }
+}
+
+void DbFetchStats::Get(std::vector<uint32_t> *latency,
+                       uint32_t *errors) const {
+    latency->assign(kLatencyBuckets, 0);
+    for (size_t i = 0; i < kLatencyBuckets; i++) {
+        (*latency)[i] = latency_[i];
+    }
+    *errors = errors_;
+}
 
 /*
  * This function performs GetRowAsync for each row key
@@ -57,11 +87,13 @@ ExternalBase::Efn DbQueryUnit::QueryExec(uint32_t inst,
 bool DbQueryUnit::PipelineCb(std::string &cfname, GenDb::DbDataValueVec &rowkey,
                            GenDb::ColumnNameRange &cr, GetRowInput * ip_ctx, void *privdata) {
     /*
-     *  Call GetRowAsync, with args prepopulated
+     *  Call GetRowAsync, with args prepopulated. The rows are spread over
+     *  the read sessions of the query engine
      */
     AnalyticsQuery *m_query = (AnalyticsQuery *)main_query;
-    return m_query->dbif_->Db_GetRowAsync(cfname, rowkey, cr,
-        GenDb::DbConsistency::LOCAL_ONE,
+    ip_ctx->fetch_start = ClockMonotonicUsec();
+    return m_query->GetReadDbIf(ip_ctx->row_no)->Db_GetRowAsync(cfname,
+        rowkey, cr, GenDb::DbConsistency::LOCAL_ONE,
         boost::bind(&DbQueryUnit::cb, this, _1, _2, ip_ctx, privdata));
 }
 
@@ -186,12 +218,22 @@ query_status_t DbQueryUnit::process_query()
 
     /* Create a pipeline to fetch all rows corresponding to keys */
     int max_tasks = 15;
+    int max_row_fetches = 0;
     if (m_query->qe_) {
         max_tasks = m_query->qe_->max_tasks_;
+        max_row_fetches = m_query->qe_->max_row_fetches_;
     }
 
+    // Each instance of the pipeline has one row fetch outstanding
+    size_t instances = max_row_fetches > 0 ? max_row_fetches : max_tasks;
+    if (instances > keys.size()) {
+        instances = keys.size();
+    }
+    if (instances == 0) {
+        instances = 1;
+    }
     std::vector<std::pair<int,int> > tinfo;
-    for (uint idx=0; idx<(uint)max_tasks; idx++) {
+    for (size_t idx = 0; idx < instances; idx++) {
         tinfo.push_back(make_pair(0, -1));
     }
 
@@ -272,6 +314,8 @@ void DbQueryUnit::cb(GenDb::DbOpResult::type dresult,
     GenDb::NewColVec::iterator i;
 
     AnalyticsQuery *m_query = (AnalyticsQuery *)main_query;
+    m_query->fetch_stats_.Record(ClockMonotonicUsec() - gri->fetch_start,
+        dresult == GenDb::DbOpResult::ERROR);
     for (i = column_list->columns_.begin(); i != column_list->columns_.end();
          i++) {
         {
@@ -122,6 +122,11 @@ void Options::Initialize(EventManager &evm,
              "Max number of rows in chunk slice")
         ("DEFAULT.max_tasks", opt::value<int>()->default_value(0),
              "Max number of tasks used for a query")
+        ("DEFAULT.max_row_fetches", opt::value<int>()->default_value(0),
+             "Max number of database rows fetched in parallel by a query, "
+             "max_tasks if 0")
+        ("DEFAULT.db_read_sessions", opt::value<int>()->default_value(1),
+             "Number of database sessions that queries read from")
         ("DEFAULT.start_time", opt::value<uint64_t>()->default_value(0),
              "Lowest start time for queries")
 
@@ -246,6 +251,8 @@ void Options::Process(int argc, char *argv[],
     GetOptValue<uint64_t>(var_map, start_time_, "DEFAULT.start_time");
     GetOptValue<int>(var_map, max_tasks_, "DEFAULT.max_tasks");
     GetOptValue<int>(var_map, max_slice_, "DEFAULT.max_slice");
+    GetOptValue<int>(var_map, max_row_fetches_, "DEFAULT.max_row_fetches");
+    GetOptValue<int>(var_map, db_read_sessions_, "DEFAULT.db_read_sessions");
     GetOptValue<uint32_t>(var_map, send_ratelimit_,
                               "DEFAULT.sandesh_send_rate_limit");
 
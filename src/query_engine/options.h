@@ -39,6 +39,8 @@ public:
     const uint64_t start_time() const { return start_time_; }
     const int max_tasks() const { return max_tasks_; }
     const int max_slice() const { return max_slice_; }
+    const int max_row_fetches() const { return max_row_fetches_; }
+    const int db_read_sessions() const { return db_read_sessions_; }
     const std::string log_category() const { return log_category_; }
     const std::string log_property_file() const { return log_property_file_; }
     const bool log_disable() const { return log_disable_; }
@@ -95,6 +97,8 @@ private:
     uint64_t start_time_;
     int max_tasks_;
     int max_slice_;
+    int max_row_fetches_;
+    int db_read_sessions_;
     bool test_mode_;
     int analytics_data_ttl_;
     uint32_t send_ratelimit_;
@@ -273,7 +273,8 @@ main(int argc, char *argv[]) {
             max_tasks,
             options.max_slice(),
             options.cassandra_user(),
-            options.cassandra_password()));
+            options.cassandra_password(),
+            options.max_row_fetches()));
     } else {
         qe.reset(new QueryEngine(&evm,
             cassandra_ips,
@@ -284,7 +285,9 @@ main(int argc, char *argv[]) {
             max_tasks,
             options.max_slice(),
             options.cassandra_user(),
-            options.cassandra_password()));
+            options.cassandra_password(),
+            options.max_row_fetches(),
+            options.db_read_sessions()));
     }
 
     signal(SIGTERM, terminate_qe);
@@ -979,6 +979,9 @@ AnalyticsQuery::AnalyticsQuery(std::string qid,
     qe_(qe),
     handle_(handle),
     stats_(NULL) {
+    if (qe_) {
+        read_dbifs_ = qe_->read_dbifs();
+    }
     Init(qid, json_api_data, or_number);
 }
 
@@ -986,7 +989,8 @@ QueryEngine::QueryEngine(EventManager *evm,
             const std::string & redis_ip, unsigned short redis_port,
             const std::string & redis_password, int max_tasks, int max_slice,
             const std::string & cassandra_user,
-            const std::string & cassandra_password) :
+            const std::string & cassandra_password,
+            int max_row_fetches) :
         qosp_(new QEOpServerProxy(evm,
             this, redis_ip, redis_port, redis_password, max_tasks)),
         evm_(evm),
@@ -1002,6 +1006,43 @@ QueryEngine::QueryEngine(EventManager *evm,
 
     ttlmap_ = g_viz_constants.TtlValuesDefault;
     max_tasks_ = max_tasks;
+    max_row_fetches_ = max_row_fetches;
+}
+
+bool QueryEngine::InitDbIf(GenDb::GenDbIf *dbif) {
+    if (!dbif->Db_Init()) {
+        QE_LOG_NOQID(ERROR, "Database initialization failed");
+        return false;
+    }
+
+    if (!dbif->Db_SetTablespace(keyspace_)) {
+        QE_LOG_NOQID(ERROR,  ": Create/Set KEYSPACE: " <<
+                     keyspace_ << " FAILED");
+        return false;
+    }
+
+    for (std::vector<GenDb::NewCf>::const_iterator it = vizd_tables.begin();
+            it != vizd_tables.end(); it++) {
+        if (!dbif->Db_UseColumnfamily(*it)) {
+            return false;
+        }
+    }
+
+    for (std::vector<GenDb::NewCf>::const_iterator it = vizd_flow_tables.begin();
+            it != vizd_flow_tables.end(); it++) {
+        if (!dbif->Db_UseColumnfamily(*it)) {
+            return false;
+        }
+    }
+
+    for (std::vector<GenDb::NewCf>::const_iterator it =
+            vizd_stat_tables.begin();
+            it != vizd_stat_tables.end(); it++) {
+        if (!dbif->Db_UseColumnfamily(*it)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 QueryEngine::QueryEngine(EventManager *evm,
@@ -1010,7 +1051,8 @@ QueryEngine::QueryEngine(EventManager *evm,
             const std::string & redis_ip, unsigned short redis_port,
             const std::string & redis_password, int max_tasks, int max_slice, 
             const std::string & cassandra_user,
-            const std::string & cassandra_password) :
+            const std::string & cassandra_password,
+            int max_row_fetches, int db_read_sessions) :
         qosp_(new QEOpServerProxy(evm,
             this, redis_ip, redis_port, redis_password, max_tasks)),
         evm_(evm),
@@ -1023,6 +1065,7 @@ QueryEngine::QueryEngine(EventManager *evm,
         keyspace_ = g_viz_constants.COLLECTOR_KEYSPACE_CQL;
     max_slice_ = max_slice;
     max_tasks_ = max_tasks;
+    max_row_fetches_ = max_row_fetches;
     init_vizd_tables();
 
     // Initialize database connection
@@ -1032,52 +1075,7 @@ QueryEngine::QueryEngine(EventManager *evm,
     int retries = 0;
     bool retry = true;
     while (retry == true) {
-        retry = false;
-
-        if (!dbif_->Db_Init()) {
-            QE_LOG_NOQID(ERROR, "Database initialization failed");
-            retry = true;
-        }
-
-        if (!retry) {
-            if (!dbif_->Db_SetTablespace(keyspace_)) {
-                QE_LOG_NOQID(ERROR,  ": Create/Set KEYSPACE: " <<
-                             keyspace_ << " FAILED");
-                retry = true;
-            }
-        }
-
-        if (!retry) {
-            for (std::vector<GenDb::NewCf>::const_iterator it = vizd_tables.begin();
-                    it != vizd_tables.end(); it++) {
-                if (!dbif_->Db_UseColumnfamily(*it)) {
-                    retry = true;
-                    break;
-                }
-            }
-        }
-
-        if (!retry) {
-            for (std::vector<GenDb::NewCf>::const_iterator it = vizd_flow_tables.begin();
-                    it != vizd_flow_tables.end(); it++) {
-                if (!dbif_->Db_UseColumnfamily(*it)) {
-                    retry = true;
-                    break;
-                }
-            }
-       }
-
-       if (!retry) {
-            for (std::vector<GenDb::NewCf>::const_iterator it =
-                    vizd_stat_tables.begin();
-                    it != vizd_stat_tables.end(); it++) {
-                if (!dbif_->Db_UseColumnfamily(*it)) {
-                    retry = true;
-                    break;
-                }
-            }
-
-        }
+        retry = !InitDbIf(dbif_.get());
 
         if (retry) {
             std::stringstream ss;
@@ -1166,9 +1164,30 @@ QueryEngine::QueryEngine(EventManager *evm,
     ConnectionState::GetInstance()->Update(ConnectionType::DATABASE,
         std::string(), ConnectionStatus::UP, dbif_->Db_GetEndpoints(),
         std::string());
+
+    // Additional sessions, each with its own connections, that the rows of
+    // queries are read from along with dbif_
+    read_dbifs_.push_back(dbif_);
+    for (int i = 1; i < db_read_sessions; i++) {
+        GenDbIfPtr dbif(new cass::cql::CqlIf(evm, cassandra_ips,
+            cassandra_ports[0], cassandra_user, cassandra_password));
+        if (!InitDbIf(dbif.get())) {
+            QE_LOG_NOQID(ERROR, "Database read session " << i <<
+                         " initialization failed");
+            dbif->Db_Uninit();
+            break;
+        }
+        dbif->Db_SetInitDone(true);
+        read_dbifs_.push_back(dbif);
+    }
+    QE_LOG_NOQID(INFO, "Database read sessions: " << read_dbifs_.size());
 }
 
 QueryEngine::~QueryEngine() {
+    for (size_t i = 1; i < read_dbifs_.size(); i++) {
+        read_dbifs_[i]->Db_Uninit();
+        read_dbifs_[i]->Db_SetInitDone(false);
+    }
     if (dbif_) {
         dbif_->Db_Uninit();
         dbif_->Db_SetInitDone(false);
@@ -1298,6 +1317,8 @@ QueryEngine::QueryExecWhere(void * handle, QueryParams qp, uint32_t chunk,
                 static_cast<uint32_t>((UTCTimestampUsec() - q->where_start_)
                 /1000);
             q->qperf_.error = q->status_details;
+            q->fetch_stats_.Get(&q->qperf_.fetch_latency,
+                &q->qperf_.fetch_errors);
             qosp_->QueryResult(q->handle_, q->qperf_, q->wherequery_->where_result_);
         case QUERY_IN_PROGRESS:
             query_status_ = true;
@@ -1342,6 +1363,7 @@ QueryEngine::QueryExec(void * handle, QueryParams qp, uint32_t chunk,
 
     QE_TRACE_NOQID(DEBUG, " Finished query processing for QID " << qid << " chunk:" << chunk);
     q->qperf_.error = q->status_details;
+    q->fetch_stats_.Get(&q->qperf_.fetch_latency, &q->qperf_.fetch_errors);
     qosp_->QueryResult(handle, q->qperf_, q->final_result, q->final_mresult);
     delete q;
     return true;
@@ -376,6 +376,22 @@ struct GetRowInput {
     int sub_qid;
     int row_no;
     int inst;
+    uint64_t fetch_start;
+};
+
+// Latencies of the database reads of a query: the row fetches of the where
+// stage and the multi-row reads of select. Bucket i counts the reads that
+// took less than 2^i msec, and the last bucket the slower ones. Row fetches
+// complete in the database threads, so the counters are atomic.
+struct DbFetchStats {
+    static const size_t kLatencyBuckets = 12;
+
+    DbFetchStats();
+    void Record(uint64_t latency_usec, bool error);
+    void Get(std::vector<uint32_t> *latency, uint32_t *errors) const;
+
+    tbb::atomic<uint32_t> latency_[kLatencyBuckets];
+    tbb::atomic<uint32_t> errors_;
 };
 
 // max number of entries to extract from db
@@ -576,6 +592,9 @@ public:
     friend class SelectTest;
 private:
     bool is_valid_select_field(const std::string& select_field) const;
+    // Reads the rows of keys, recording the latency in the fetch stats
+    bool GetMultiRow(GenDb::ColListVec *out, const std::string &cfname,
+        const std::vector<GenDb::DbDataValueVec> &keys);
     // 
     // Object table query
     //
@@ -796,6 +815,15 @@ public:
 
     // Interface to Cassandra
     GenDbIfPtr dbif_;
+    // Sessions that the rows are read from, dbif_ if empty
+    std::vector<GenDbIfPtr> read_dbifs_;
+    GenDb::GenDbIf *GetReadDbIf(size_t n) const {
+        if (read_dbifs_.empty()) {
+            return dbif_.get();
+        }
+        return read_dbifs_[n % read_dbifs_.size()].get();
+    }
+    DbFetchStats fetch_stats_;
     void db_err_handler() {};
     
     //Query related fields
@@ -945,6 +973,8 @@ public:
 
     uint64_t stime;
     int max_tasks_;
+    // Max number of rows fetched in parallel by a query, max_tasks_ if 0
+    int max_row_fetches_;
 
     QueryEngine(EventManager *evm,
             std::vector<std::string> cassandra_ips,
@@ -953,14 +983,16 @@ public:
             const std::string & redis_password,
             int max_tasks, int max_slice,
             const std::string & cassandra_name,
-            const std::string & cassandra_password);
+            const std::string & cassandra_password,
+            int max_row_fetches = 0, int db_read_sessions = 1);
 
     QueryEngine(EventManager *evm,
             const std::string & redis_ip, unsigned short redis_port,
             const std::string & redis_password, int max_tasks,
             int max_slice,
             const std::string  & cassandra_user,
-            const std::string  & cassandra_password);
+            const std::string  & cassandra_password,
+            int max_row_fetches = 0);
 
     virtual ~QueryEngine();
     
@@ -1006,8 +1038,13 @@ public:
 
     void db_err_handler() {};
     TtlMap& GetTTlMap() { return ttlmap_; }
+    const std::vector<GenDbIfPtr> &read_dbifs() const { return read_dbifs_; }
 private:
+    bool InitDbIf(GenDb::GenDbIf *dbif);
+
     GenDbIfPtr dbif_;
+    // dbif_ followed by the additional sessions for reading rows
+    std::vector<GenDbIfPtr> read_dbifs_;
     boost::scoped_ptr<QEOpServerProxy> qosp_;
     EventManager *evm_;
     std::vector<int> cassandra_ports_;
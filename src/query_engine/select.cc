@@ -6,6 +6,7 @@
 
 #include "boost/uuid/uuid_io.hpp"
 #include "base/util.h"
+#include "base/time_util.h"
 #include "rapidjson/document.h"
 
 #include "analytics/vizd_table_desc.h"
@@ -172,6 +173,17 @@ bool SelectQuery::is_valid_select_field(const std::string& select_field) const {
     return true;
 }
 
+bool SelectQuery::GetMultiRow(GenDb::ColListVec *out,
+        const std::string &cfname,
+        const std::vector<GenDb::DbDataValueVec> &keys) {
+    AnalyticsQuery *mquery = (AnalyticsQuery*)main_query;
+    uint64_t start = ClockMonotonicUsec();
+    bool success = mquery->GetReadDbIf(mquery->parallel_batch_num)->
+        Db_GetMultiRow(out, cfname, keys);
+    mquery->fetch_stats_.Record(ClockMonotonicUsec() - start, !success);
+    return success;
+}
+
 bool SelectQuery::is_flow_tuple_specified() {
     for (std::vector<std::string>::const_iterator it = 
          select_column_fields.begin(); it != select_column_fields.end(); ++it) {
@@ -305,7 +317,7 @@ query_status_t SelectQuery::process_query() {
         }
 
         GenDb::ColListVec mget_res;
-        if (!m_query->dbif_->Db_GetMultiRow(&mget_res, g_viz_constants.FLOW_TABLE, keys)) {
+        if (!GetMultiRow(&mget_res, g_viz_constants.FLOW_TABLE, keys)) {
             QE_IO_ERROR_RETURN(0, QUERY_FAILURE);
         }
 
@@ -490,7 +502,7 @@ query_status_t SelectQuery::process_query() {
         }
 
         GenDb::ColListVec mget_res;
-        if (!m_query->dbif_->Db_GetMultiRow(&mget_res, g_viz_constants.OBJECT_VALUE_TABLE, keys)) {
+        if (!GetMultiRow(&mget_res, g_viz_constants.OBJECT_VALUE_TABLE, keys)) {
             QE_IO_ERROR_RETURN(0, QUERY_FAILURE);
         }
 
@@ -573,7 +585,7 @@ query_status_t SelectQuery::process_query() {
         }
 
         GenDb::ColListVec mget_res;
-        if (!m_query->dbif_->Db_GetMultiRow(&mget_res,
+        if (!GetMultiRow(&mget_res,
                     g_viz_constants.COLLECTOR_GLOBAL_TABLE, keys)) {
             QE_IO_ERROR_RETURN(0, QUERY_FAILURE);
         }
@@ -16,6 +16,7 @@
 using ::testing::_;
 using ::testing::Return;
 using ::testing::AnyNumber;
+using ::testing::AtLeast;
 
 TtlMap ttl_map = g_viz_constants.TtlValuesDefault;
 
@@ -106,6 +107,61 @@ TEST_F(DbQueryUnitTest, ProcessQuery) {
     EXPECT_EQ(QUERY_IN_PROGRESS, status);
 }
 
+// Rows are read from all the read sessions
+TEST_F(DbQueryUnitTest, ProcessQueryReadSessions) {
+    AnalyticsQueryMock analytics_query_mock;
+    analytics_query_mock.parallel_batch_num = 1;
+    analytics_query_mock.query_id = "abcd";
+    analytics_query_mock.read_dbifs_.push_back(analytics_query_mock.dbif_);
+    analytics_query_mock.read_dbifs_.push_back(GenDbIfPtr(new CqlIfMock()));
+
+    DbQueryUnit *dbq = new DbQueryUnit(&analytics_query_mock, &analytics_query_mock);
+    for (size_t i = 0; i < analytics_query_mock.read_dbifs_.size(); i++) {
+        EXPECT_CALL(*(CqlIfMock *)(analytics_query_mock.read_dbifs_[i].get()),
+            Db_GetRowAsync(_,_,_,_,_))
+                .Times(AtLeast(1))
+                .WillRepeatedly(Invoke(this,
+                    &DbQueryUnitTest::GetRowAsyncSuccess));
+    }
+    EXPECT_CALL(analytics_query_mock, table()).Times(AnyNumber()).WillRepeatedly(Return("table1"));
+    EXPECT_CALL(analytics_query_mock, end_time()).Times(AnyNumber()).WillRepeatedly(Return(1473385977637609));
+    EXPECT_CALL(analytics_query_mock, from_time()).Times(AnyNumber()).WillRepeatedly(Return(1473384977637609));
+    EXPECT_CALL(analytics_query_mock, subquery_processed(_)).Times(1).WillOnce(Invoke(this, &DbQueryUnitTest::subquery_processed));
+    bool status = dbq->process_query();
+    sleep(5);
+    EXPECT_EQ(QUERY_IN_PROGRESS, status);
+
+    std::vector<uint32_t> latency;
+    uint32_t errors;
+    analytics_query_mock.fetch_stats_.Get(&latency, &errors);
+    EXPECT_EQ(DbFetchStats::kLatencyBuckets, latency.size());
+    uint32_t fetches = 0;
+    for (size_t i = 0; i < latency.size(); i++) {
+        fetches += latency[i];
+    }
+    // One fetch per row key
+    EXPECT_EQ(120U, fetches);
+    EXPECT_EQ(0U, errors);
+}
+
+TEST_F(DbQueryUnitTest, FetchStats) {
+    DbFetchStats stats;
+    stats.Record(500, false);
+    stats.Record(999, false);
+    stats.Record(1000, true);
+    stats.Record(5000, false);
+    stats.Record(3600ULL * 1000 * 1000, false);
+    std::vector<uint32_t> latency;
+    uint32_t errors;
+    stats.Get(&latency, &errors);
+    ASSERT_EQ(DbFetchStats::kLatencyBuckets, latency.size());
+    EXPECT_EQ(2U, latency[0]);
+    EXPECT_EQ(1U, latency[1]);
+    EXPECT_EQ(1U, latency[3]);
+    EXPECT_EQ(1U, latency[DbFetchStats::kLatencyBuckets - 1]);
+    EXPECT_EQ(1U, errors);
+}
+
 TEST_F(DbQueryUnitTest, ProcessQueryFailure) {
     AnalyticsQueryMock analytics_query_mock;
     AnalyticsQueryMock parent;
@@ -85,6 +85,8 @@ TEST_F(OptionsTest, NoArguments) {
     EXPECT_EQ(options_.start_time(), 0);
     EXPECT_EQ(options_.max_tasks(), 0);
     EXPECT_EQ(options_.max_slice(), 100);
+    EXPECT_EQ(options_.max_row_fetches(), 0);
+    EXPECT_EQ(options_.db_read_sessions(), 1);
     EXPECT_EQ(options_.test_mode(), false);
     EXPECT_EQ(options_.sandesh_send_rate_limit(), 0);
 }
@@ -126,6 +128,8 @@ TEST_F(OptionsTest, DefaultConfFile) {
     EXPECT_EQ(options_.start_time(), 0);
     EXPECT_EQ(options_.max_tasks(), 0);
     EXPECT_EQ(options_.max_slice(), 100);
+    EXPECT_EQ(options_.max_row_fetches(), 0);
+    EXPECT_EQ(options_.db_read_sessions(), 1);
     EXPECT_EQ(options_.test_mode(), false);
     EXPECT_EQ(options_.sandesh_send_rate_limit(), 100);
 }
@@ -170,6 +174,8 @@ TEST_F(OptionsTest, OverrideStringFromCommandLine) {
     EXPECT_EQ(options_.start_time(), 0);
     EXPECT_EQ(options_.max_tasks(), 0);
     EXPECT_EQ(options_.max_slice(), 100);
+    EXPECT_EQ(options_.max_row_fetches(), 0);
+    EXPECT_EQ(options_.db_read_sessions(), 1);
     EXPECT_EQ(options_.test_mode(), false);
     EXPECT_EQ(options_.sandesh_send_rate_limit(), 5);
 }
@@ -212,6 +218,8 @@ TEST_F(OptionsTest, OverrideBooleanFromCommandLine) {
     EXPECT_EQ(options_.start_time(), 0);
     EXPECT_EQ(options_.max_tasks(), 0);
     EXPECT_EQ(options_.max_slice(), 100);
+    EXPECT_EQ(options_.max_row_fetches(), 0);
+    EXPECT_EQ(options_.db_read_sessions(), 1);
     EXPECT_EQ(options_.test_mode(), true); // Overridden from command line.
 }
 
@@ -238,6 +246,8 @@ TEST_F(OptionsTest, CustomConfigFile) {
         "start_time=123456\n"
         "max_tasks=200\n"
         "max_slice=500\n"
+        "max_row_fetches=64\n"
+        "db_read_sessions=4\n"
         "sandesh_send_rate_limit=5\n"
         "\n"
         "[DISCOVERY]\n"
@@ -312,6 +322,8 @@ TEST_F(OptionsTest, CustomConfigFile) {
     EXPECT_EQ(options_.start_time(), 123456);
     EXPECT_EQ(options_.max_tasks(), 200);
     EXPECT_EQ(options_.max_slice(), 500);
+    EXPECT_EQ(options_.max_row_fetches(), 64);
+    EXPECT_EQ(options_.db_read_sessions(), 4);
     EXPECT_EQ(options_.test_mode(), true);
     EXPECT_EQ(options_.cassandra_user(), "cassandra1");
     EXPECT_EQ(options_.cassandra_password(), "cassandra1");
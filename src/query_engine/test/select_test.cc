@@ -8,6 +8,7 @@
 #include "analytics_query_mock.h"
 #include <boost/uuid/uuid.hpp>
 
+using ::testing::_;
 using ::testing::Return;
 using ::testing::AnyNumber;
 
@@ -53,6 +54,12 @@ public:
          return sq->process_object_query_specific_select_params(sel_field,
              col_res_map, cmap, uuid, uuid_to_objid_map);
     }
+
+    bool test_get_multi_row(SelectQuery *sq, GenDb::ColListVec *out,
+                        const std::string& cfname,
+                        const std::vector<GenDb::DbDataValueVec>& keys) {
+         return sq->GetMultiRow(out, cfname, keys);
+    }
 };
 
 // Invalid Selection of timeseries and sum(bytes)
@@ -156,6 +163,41 @@ TEST_F(SelectTest, TestProcessObjectQuerySelectParams) {
 
 }
 
+// Multi-row reads of select are recorded in the fetch stats of the query
+TEST_F(SelectTest, GetMultiRowFetchStats) {
+    AnalyticsQueryMock analytics_query_mock;
+    select_fs_query_default_expect_init(analytics_query_mock);
+
+    std::map<std::string, std::string> json_select;
+    json_select.insert(std::pair<std::string, std::string>(
+        "select_fields", "[\"sum(bytes)\", \"packets\"]"));
+    SelectQuery* select_query = new SelectQuery(&analytics_query_mock,
+                                                json_select);
+    EXPECT_CALL(*(CqlIfMock *)(analytics_query_mock.dbif_.get()),
+        Db_GetMultiRow(_, g_viz_constants.FLOW_TABLE, _))
+        .Times(2)
+        .WillOnce(Return(true))
+        .WillOnce(Return(false));
+    boost::uuids::random_generator rgen_;
+    std::vector<GenDb::DbDataValueVec> keys;
+    keys.push_back(GenDb::DbDataValueVec(1, rgen_()));
+    GenDb::ColListVec mget_res;
+    EXPECT_TRUE(test_get_multi_row(select_query, &mget_res,
+        g_viz_constants.FLOW_TABLE, keys));
+    EXPECT_FALSE(test_get_multi_row(select_query, &mget_res,
+        g_viz_constants.FLOW_TABLE, keys));
+
+    std::vector<uint32_t> latency;
+    uint32_t errors;
+    analytics_query_mock.fetch_stats_.Get(&latency, &errors);
+    uint32_t fetches = 0;
+    for (size_t i = 0; i < latency.size(); i++) {
+        fetches += latency[i];
+    }
+    EXPECT_EQ(2U, fetches);
+    EXPECT_EQ(1U, errors);
+}
+
 int main(int argc, char **argv) {
     LoggingInit();
     ::testing::InitGoogleTest(&argc, argv);
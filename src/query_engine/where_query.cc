@@ -1081,6 +1081,8 @@ void WhereQuery::subquery_processed(QueryUnit *subquery) {
         m_query->qperf_.chunk_where_time =
             static_cast<uint32_t>((UTCTimestampUsec() - m_query->where_start_)
             /1000);
+        m_query->fetch_stats_.Get(&m_query->qperf_.fetch_latency,
+            &m_query->qperf_.fetch_errors);
         where_query_cb_(m_query->handle_, m_query->qperf_, where_result_);
         return;
     }
@@ -1128,6 +1130,8 @@ void WhereQuery::subquery_processed(QueryUnit *subquery) {
         m_query->qperf_.chunk_where_time =
             static_cast<uint32_t>((UTCTimestampUsec() - m_query->where_start_)
             /1000);
+        m_query->fetch_stats_.Get(&m_query->qperf_.fetch_latency,
+            &m_query->qperf_.fetch_errors);
         where_query_cb_(m_query->handle_, m_query->qperf_, where_result_);
     }
 }
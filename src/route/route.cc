@@ -45,3 +45,32 @@ void Route::Sort(Compare compare, const Path *prev_front) {
         set_last_change_at_to_now();
     }
 }
+
+void Route::InsertSorted(const Path *ipath, Compare compare) {
+    Path *path = const_cast<Path *> (ipath);
+    const Path *prev_front = front();
+
+    // Insert before the first path that is worse. The path list is sorted
+    // as long as the comparison is a strict weak ordering. Otherwise, e.g.
+    // when BGP compares MED only for paths from the same neighbor AS, the
+    // resulting order depends on the order in which paths are inserted.
+    PathList::iterator it = path_.begin();
+    while (it != path_.end() && !compare(*path, *it)) {
+        ++it;
+    }
+    path->set_time_stamp_usecs(UTCTimestampUsec());
+    path_.insert(it, *path);
+
+    if (prev_front != front()) {
+        set_last_change_at_to_now();
+    }
+}
+
+void Route::RemoveSorted(const Path *path) {
+    const Path *prev_front = front();
+    remove(path);
+
+    if (prev_front != front()) {
+        set_last_change_at_to_now();
+    }
+}
@@ -43,6 +43,14 @@ public:
     // Sort paths based on compare function.
     void Sort(Compare compare, const Path *prev_front);
 
+    // Insert a path at its position in a path list that is already sorted
+    // based on compare function. Equivalent to insert followed by Sort.
+    void InsertSorted(const Path *path, Compare compare);
+
+    // Remove a path from a sorted path list. Equivalent to remove followed by
+    // Sort.
+    void RemoveSorted(const Path *path);
+
     const PathList &GetPathList() const {
         return path_;
     }
@@ -225,6 +225,9 @@ void Agent::SetAgentTaskPolicy() {
     const char *walk_cancel_exclude_list[] = {
         "Agent::ControllerXmpp",
         "db::DBTable",
+        // Route walks are started and their walk done is handled in
+        // db::Walker, both modify the walk references of AgentRouteWalker
+        "db::Walker",
         // For ToR Agent Agent::KSync and Agent::RouteWalker both task tries
         // to modify route path list inline (out of DB table context) to
         // manage route exports from dynamic peer before release the peer
@@ -239,6 +242,16 @@ void Agent::SetAgentTaskPolicy() {
     SetTaskPolicyOne("Agent::RouteWalker", walk_cancel_exclude_list,
                      sizeof(walk_cancel_exclude_list) / sizeof(char *));
 
+    // DBTableWalkMgr runs in db::Walker. Tasks starting table walks and tasks
+    // updating the table partitions should be exclusive with it
+    const char *db_walker_exclude_list[] = {
+        "db::DBTable",
+        AGENT_SHUTDOWN_TASKNAME,
+        AGENT_INIT_TASKNAME
+    };
+    SetTaskPolicyOne("db::Walker", db_walker_exclude_list,
+                     sizeof(db_walker_exclude_list) / sizeof(char *));
+
     const char *ksync_exclude_list[] = {
         "db::DBTable",
         AGENT_SHUTDOWN_TASKNAME,
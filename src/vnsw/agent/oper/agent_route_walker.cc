@@ -15,20 +15,23 @@
 
 using namespace std;
 
+const uint32_t AgentRouteWalker::kMaxRouteWalks;
+
 AgentRouteWalker::AgentRouteWalker(Agent *agent, WalkType type) :
-    agent_(agent), walk_type_(type),
-    vrf_walkid_(DBTableWalker::kInvalidWalkerId), walk_done_cb_(),
+    agent_(agent), walk_type_(type), vrf_walk_ref_(), route_walk_count_(0),
+    max_route_walks_(kMaxRouteWalks), walk_done_cb_(),
     route_walk_done_for_vrf_cb_(),
     work_queue_(TaskScheduler::GetInstance()->
                 GetTaskId("Agent::RouteWalker"), 0,
-                boost::bind(&AgentRouteWalker::RouteWalker, this, _1)) {
+                boost::bind(&AgentRouteWalker::RouteWalker, this, _1)),
+    walkable_route_tables_(0) {
     walk_count_ = AgentRouteWalker::kInvalidWalkCount;
     queued_walk_count_ = AgentRouteWalker::kInvalidWalkCount;
     queued_walk_done_count_ = AgentRouteWalker::kInvalidWalkCount;
     for (uint8_t table_type = (Agent::INVALID + 1);
          table_type < Agent::ROUTE_TABLE_MAX;
          table_type++) {
-        route_walkid_[table_type].clear();
+        route_walk_ref_[table_type].clear();
         walkable_route_tables_ |= (1 << table_type);
     }
 
@@ -39,6 +42,19 @@ AgentRouteWalker::AgentRouteWalker(Agent *agent, WalkType type) :
 
 AgentRouteWalker::~AgentRouteWalker() {
     work_queue_.Shutdown();
+    if (vrf_walk_ref_.get() != NULL) {
+        vrf_walk_ref_->table()->ReleaseWalker(vrf_walk_ref_);
+    }
+    for (uint8_t table_type = (Agent::INVALID + 1);
+         table_type < Agent::ROUTE_TABLE_MAX;
+         table_type++) {
+        for (VrfRouteWalkRefMapIterator iter =
+             route_walk_ref_[table_type].begin();
+             iter != route_walk_ref_[table_type].end(); ++iter) {
+            iter->second->table()->ReleaseWalker(iter->second);
+        }
+        route_walk_ref_[table_type].clear();
+    }
 }
 
 bool AgentRouteWalker::RouteWalker(boost::shared_ptr<AgentRouteWalkerQueueEntry> data) {
@@ -52,6 +68,8 @@ bool AgentRouteWalker::RouteWalker(boost::shared_ptr<AgentRouteWalkerQueueEntry>
           CancelVrfWalkInternal();
           break;
       case AgentRouteWalkerQueueEntry::START_ROUTE_WALK:
+          if (DeferRouteWalk(data))
+              break;
           DecrementQueuedWalkCount();
           StartRouteWalkInternal(vrf);
           break;
@@ -79,14 +97,12 @@ void AgentRouteWalker::CancelVrfWalk() {
 }
 
 void AgentRouteWalker::CancelVrfWalkInternal() {
-    DBTableWalker *walker = agent_->db()->GetWalker();
-    if (vrf_walkid_ != DBTableWalker::kInvalidWalkerId) {
+    if (vrf_walk_ref_.get() != NULL) {
         AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
                            "VRF table walk cancelled ",
-                           walk_type_, "", vrf_walkid_, 0, "",
+                           walk_type_, "", stats_.vrf_walks, 0, "",
                            DBTableWalker::kInvalidWalkerId);
-        walker->WalkCancel(vrf_walkid_);
-        vrf_walkid_ = DBTableWalker::kInvalidWalkerId;
+        agent_->vrf_table()->ReleaseWalker(vrf_walk_ref_);
         DecrementWalkCount();
     }
 }
@@ -102,30 +118,42 @@ void AgentRouteWalker::CancelRouteWalk(VrfEntry *vrf) {
 }
 
 void AgentRouteWalker::CancelRouteWalkInternal(const VrfEntry *vrf) {
-    DBTableWalker *walker = agent_->db()->GetWalker();
     uint32_t vrf_id = vrf->vrf_id();
 
+    CancelDeferredRouteWalk(vrf_id);
     //Cancel Route table walks
     for (uint8_t table_type = (Agent::INVALID + 1);
          table_type < Agent::ROUTE_TABLE_MAX;
          table_type++) {
-        VrfRouteWalkerIdMapIterator iter = 
-            route_walkid_[table_type].find(vrf_id);
-        if (iter != route_walkid_[table_type].end()) {
+        VrfRouteWalkRefMapIterator iter =
+            route_walk_ref_[table_type].find(vrf_id);
+        if (iter != route_walk_ref_[table_type].end()) {
             AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
                                "route table walk cancelled", walk_type_,
                                (vrf != NULL) ? vrf->GetName() : "Unknown",
-                               vrf_walkid_, table_type, "", iter->second);
-            walker->WalkCancel(iter->second);
-            route_walkid_[table_type].erase(iter);
-            DecrementWalkCount();
+                               stats_.vrf_walks, table_type, "",
+                               stats_.route_walks);
+            ReleaseRouteWalk(iter, table_type);
+            stats_.route_walks_cancelled++;
         }
     }
 }
 
+/*
+ * Releases the walker of a route table walk. The walk done callback is not
+ * invoked for a released walker.
+ */
+void AgentRouteWalker::ReleaseRouteWalk(VrfRouteWalkRefMapIterator iter,
+                                        uint8_t table_type) {
+    iter->second->table()->ReleaseWalker(iter->second);
+    route_walk_ref_[table_type].erase(iter);
+    route_walk_count_--;
+    DecrementWalkCount();
+}
+
 /*
  * Startes a new walk for all VRF.
- * Cancels any old walk of VRF.
+ * Restarts any old walk of VRF.
  */
 void AgentRouteWalker::StartVrfWalk() {
     boost::shared_ptr<AgentRouteWalkerQueueEntry> data(new AgentRouteWalkerQueueEntry(NULL,
@@ -137,29 +165,37 @@ void AgentRouteWalker::StartVrfWalk() {
 
 void AgentRouteWalker::StartVrfWalkInternal()
 {
-    DBTableWalker *walker = agent_->db()->GetWalker();
+    VrfTable *table = agent_->vrf_table();
 
-    //Cancel the VRF walk if started previously
-    CancelVrfWalkInternal();
-
-    //New walk start for VRF
-    vrf_walkid_ = walker->WalkTable(agent_->vrf_table(), NULL,
-                                    boost::bind(&AgentRouteWalker::VrfWalkNotify, 
-                                                this, _1, _2),
-                                    boost::bind(&AgentRouteWalker::VrfWalkDone, 
-                                                this, _1));
-    if (vrf_walkid_ != DBTableWalker::kInvalidWalkerId) {
-        IncrementWalkCount();
+    stats_.vrf_walks++;
+    //Restart the VRF walk if started previously
+    if (vrf_walk_ref_.get() != NULL) {
+        table->WalkAgain(vrf_walk_ref_);
+        stats_.vrf_walks_restarted++;
         AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
-                           "VRF table walk started",
-                           walk_type_, "", vrf_walkid_,
+                           "VRF table walk restarted",
+                           walk_type_, "", stats_.vrf_walks,
                            0, "", DBTableWalker::kInvalidWalkerId);
+        return;
     }
+
+    //New walk start for VRF
+    vrf_walk_ref_ = table->AllocWalker(
+                        boost::bind(&AgentRouteWalker::VrfWalkNotify,
+                                    this, _1, _2),
+                        boost::bind(&AgentRouteWalker::VrfWalkDoneInternal,
+                                    this, _1, _2));
+    table->WalkTable(vrf_walk_ref_);
+    IncrementWalkCount();
+    AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
+                       "VRF table walk started",
+                       walk_type_, "", stats_.vrf_walks,
+                       0, "", DBTableWalker::kInvalidWalkerId);
 }
 
 /*
  * Starts route walk for given VRF.
- * Cancels any old route walks started for given VRF
+ * Restarts any old route walks started for given VRF
  */
 void AgentRouteWalker::StartRouteWalk(VrfEntry *vrf) {
     boost::shared_ptr<AgentRouteWalkerQueueEntry> data(new AgentRouteWalkerQueueEntry(vrf,
@@ -170,15 +206,12 @@ void AgentRouteWalker::StartRouteWalk(VrfEntry *vrf) {
 }
 
 void AgentRouteWalker::StartRouteWalkInternal(const VrfEntry *vrf) {
-    DBTableWalker *walker = agent_->db()->GetWalker();
-    DBTableWalker::WalkId walkid = DBTableWalker::kInvalidWalkerId;
     uint32_t vrf_id = vrf->vrf_id();
     AgentRouteTable *table = NULL;
 
-    //Cancel any walk started previously for this VRF
-    CancelRouteWalkInternal(vrf);
-
-    //Start the walk for every route table
+    //Start the walk for every route table. Walk started previously for this
+    //VRF is restarted, so that requests coming in while the walk is pending
+    //are served by the same walk.
     for (uint8_t table_type = (Agent::INVALID + 1);
          table_type < Agent::ROUTE_TABLE_MAX;
          table_type++) {
@@ -186,27 +219,145 @@ void AgentRouteWalker::StartRouteWalkInternal(const VrfEntry *vrf) {
             continue;
         table = static_cast<AgentRouteTable *>
             (vrf->GetRouteTable(table_type));
+        VrfRouteWalkRefMapIterator iter =
+            route_walk_ref_[table_type].find(vrf_id);
+        if ((iter != route_walk_ref_[table_type].end()) &&
+            (iter->second->table() != table)) {
+            //Walk on route table of an old VRF with same id
+            ReleaseRouteWalk(iter, table_type);
+            iter = route_walk_ref_[table_type].end();
+        }
         if (table == NULL) {
             AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
                                "Route table walk SKIPPED for vrf", walk_type_,
                                (vrf != NULL) ? vrf->GetName() : "Unknown",
-                               vrf_walkid_, table_type, "", walkid);
+                               stats_.vrf_walks, table_type, "",
+                               stats_.route_walks);
             continue;
         }
-        walkid = walker->WalkTable(table, NULL, 
-                             boost::bind(&AgentRouteWalker::RouteWalkNotify, 
-                                         this, _1, _2),
-                             boost::bind(&AgentRouteWalker::RouteWalkDone, 
-                                         this, _1));
-        if (walkid != DBTableWalker::kInvalidWalkerId) {
-            route_walkid_[table_type][vrf_id] = walkid;
-            IncrementWalkCount();
+        stats_.route_walks++;
+        if (iter != route_walk_ref_[table_type].end()) {
+            table->WalkAgain(iter->second);
+            stats_.route_walks_restarted++;
             AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
-                               "Route table walk started for vrf", walk_type_,
+                               "Route table walk restarted for vrf",
+                               walk_type_,
                                (vrf != NULL) ? vrf->GetName() : "Unknown",
-                               vrf_walkid_, table_type, "", walkid);
+                               stats_.vrf_walks, table_type, "",
+                               stats_.route_walks);
+            continue;
+        }
+        DBTable::DBTableWalkRef walk_ref = table->AllocWalker(
+            boost::bind(&AgentRouteWalker::RouteWalkNotifyInternal,
+                        this, _1, _2),
+            boost::bind(&AgentRouteWalker::RouteWalkDoneInternal,
+                        this, _1, _2));
+        route_walk_ref_[table_type][vrf_id] = walk_ref;
+        route_walk_count_++;
+        IncrementWalkCount();
+        table->WalkTable(walk_ref);
+        AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
+                           "Route table walk started for vrf", walk_type_,
+                           (vrf != NULL) ? vrf->GetName() : "Unknown",
+                           stats_.vrf_walks, table_type, "",
+                           stats_.route_walks);
+    }
+}
+
+// Number of route tables of the VRF that StartRouteWalkInternal walks
+uint32_t AgentRouteWalker::RouteTableWalkCount(const VrfEntry *vrf) const {
+    uint32_t count = 0;
+    for (uint8_t table_type = (Agent::INVALID + 1);
+         table_type < Agent::ROUTE_TABLE_MAX;
+         table_type++) {
+        if (!(walkable_route_tables_ & (1 << table_type)))
+            continue;
+        if (vrf->GetRouteTable(table_type) != NULL)
+            count++;
+    }
+    return count;
+}
+
+bool AgentRouteWalker::IsRouteWalkPending(uint32_t vrf_id) const {
+    for (uint8_t table_type = (Agent::INVALID + 1);
+         table_type < Agent::ROUTE_TABLE_MAX;
+         table_type++) {
+        if (route_walk_ref_[table_type].find(vrf_id) !=
+            route_walk_ref_[table_type].end()) {
+            return true;
         }
     }
+    return false;
+}
+
+/*
+ * Defers the route walk of a VRF if max_route_walks_ route table walks are
+ * already pending. Request for a VRF which already has a route walk pending
+ * is never deferred, as it restarts the pending walk.
+ * Deferred walk remains accounted in queued_walk_count_ till it is started.
+ */
+bool AgentRouteWalker::DeferRouteWalk(DeferredWalk data) {
+    VrfEntry *vrf = data->vrf_ref_.get();
+    uint32_t vrf_id = vrf->vrf_id();
+
+    if (deferred_vrf_ids_.find(vrf_id) != deferred_vrf_ids_.end()) {
+        //Walk is yet to start, it serves this request as well. Keep the
+        //latest VRF in case an old VRF with same id was deferred.
+        for (DeferredWalkList::iterator it = deferred_walks_.begin();
+             it != deferred_walks_.end(); ++it) {
+            if ((*it)->vrf_ref_->vrf_id() == vrf_id) {
+                *it = data;
+                break;
+            }
+        }
+        DecrementQueuedWalkCount();
+        //Accounted per route table, like a restart of a started walk
+        stats_.route_walks_restarted += RouteTableWalkCount(vrf);
+        return true;
+    }
+
+    if ((route_walk_count_ < max_route_walks_) || IsRouteWalkPending(vrf_id))
+        return false;
+
+    deferred_walks_.push_back(data);
+    deferred_vrf_ids_.insert(vrf_id);
+    stats_.route_walks_deferred++;
+    AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
+                       "Route walk deferred for vrf", walk_type_,
+                       vrf->GetName(), stats_.vrf_walks, 0, "",
+                       stats_.route_walks);
+    return true;
+}
+
+void AgentRouteWalker::CancelDeferredRouteWalk(uint32_t vrf_id) {
+    if (deferred_vrf_ids_.erase(vrf_id) == 0)
+        return;
+
+    for (DeferredWalkList::iterator it = deferred_walks_.begin();
+         it != deferred_walks_.end(); ++it) {
+        if ((*it)->vrf_ref_->vrf_id() == vrf_id) {
+            deferred_walks_.erase(it);
+            break;
+        }
+    }
+    DecrementQueuedWalkCount();
+    stats_.route_walks_cancelled++;
+}
+
+/*
+ * Starts deferred route walks, in the order they were requested, as long as
+ * route table walks pending are below max_route_walks_.
+ */
+void AgentRouteWalker::StartDeferredRouteWalks() {
+    while (!deferred_walks_.empty() &&
+           (route_walk_count_ < max_route_walks_)) {
+        DeferredWalk data = deferred_walks_.front();
+        deferred_walks_.pop_front();
+        VrfEntry *vrf = data->vrf_ref_.get();
+        deferred_vrf_ids_.erase(vrf->vrf_id());
+        DecrementQueuedWalkCount();
+        StartRouteWalkInternal(vrf);
+    }
 }
 
 /*
@@ -229,24 +380,39 @@ bool AgentRouteWalker::VrfWalkNotify(DBTablePartBase *partition,
         AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
                            "Ignore VRF as it is deleted", walk_type_,
                            (vrf != NULL) ? vrf->GetName() : "Unknown",
-                           vrf_walkid_, 0, "", DBTableWalker::kInvalidWalkerId);
+                           stats_.vrf_walks, 0, "",
+                           DBTableWalker::kInvalidWalkerId);
         return true;
     }
 
     AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
                        "Starting route walk for vrf", walk_type_,
                        (vrf != NULL) ? vrf->GetName() : "Unknown",
-                       vrf_walkid_, 0, "", DBTableWalker::kInvalidWalkerId);
+                       stats_.vrf_walks, 0, "",
+                       DBTableWalker::kInvalidWalkerId);
     StartRouteWalk(vrf);
     return true;
 }
 
+/*
+ * Walk done is invoked in db::Walker task context. Ignore walk done of a
+ * walker which has been replaced.
+ */
+void AgentRouteWalker::VrfWalkDoneInternal(DBTable::DBTableWalkRef ref,
+                                           DBTableBase *part) {
+    if (ref != vrf_walk_ref_)
+        return;
+    VrfWalkDone(part);
+}
+
 void AgentRouteWalker::VrfWalkDone(DBTableBase *part) {
     AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
                        "VRF table walk done",
-                       walk_type_, "", vrf_walkid_,
+                       walk_type_, "", stats_.vrf_walks,
                        0, "", DBTableWalker::kInvalidWalkerId);
-    vrf_walkid_ = DBTableWalker::kInvalidWalkerId;
+    if (vrf_walk_ref_.get() != NULL) {
+        agent_->vrf_table()->ReleaseWalker(vrf_walk_ref_);
+    }
     DecrementWalkCount();
     Callback(NULL);
 }
@@ -259,26 +425,44 @@ bool AgentRouteWalker::RouteWalkNotify(DBTablePartBase *partition,
     const AgentRoute *route = static_cast<const AgentRoute *>(e);
     AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
                        "Ignore Route notifications from this walk",
-                       walk_type_, "", vrf_walkid_,
+                       walk_type_, "", stats_.vrf_walks,
                        (route != NULL) ? route->GetTableType() : 0,
                        "", DBTableWalker::kInvalidWalkerId);
     return true;
 }
 
+bool AgentRouteWalker::RouteWalkNotifyInternal(DBTablePartBase *partition,
+                                               DBEntryBase *e) {
+    stats_.route_entries++;
+    return RouteWalkNotify(partition, e);
+}
+
+void AgentRouteWalker::RouteWalkDoneInternal(DBTable::DBTableWalkRef ref,
+                                             DBTableBase *part) {
+    AgentRouteTable *table = static_cast<AgentRouteTable *>(part);
+    uint8_t table_type = table->GetTableType();
+
+    VrfRouteWalkRefMapIterator iter =
+        route_walk_ref_[table_type].find(table->vrf_id());
+    if ((iter == route_walk_ref_[table_type].end()) || (iter->second != ref))
+        return;
+    stats_.route_walks_done++;
+    RouteWalkDone(part);
+}
+
 void AgentRouteWalker::RouteWalkDone(DBTableBase *part) {
     AgentRouteTable *table = static_cast<AgentRouteTable *>(part);
     uint32_t vrf_id = table->vrf_id();
     uint8_t table_type = table->GetTableType();
 
-    VrfRouteWalkerIdMapIterator iter = route_walkid_[table_type].find(vrf_id);
-    if (iter != route_walkid_[table_type].end()) {
+    VrfRouteWalkRefMapIterator iter = route_walk_ref_[table_type].find(vrf_id);
+    if (iter != route_walk_ref_[table_type].end()) {
         AGENT_DBWALK_TRACE(AgentRouteWalkerTrace,
                            "Route table walk done for route",
-                           walk_type_, "", vrf_walkid_, table_type,
+                           walk_type_, "", stats_.vrf_walks, table_type,
                            (table != NULL) ? table->GetTableName() : "Unknown",
-                           iter->second);
-        route_walkid_[table_type].erase(vrf_id);
-        DecrementWalkCount();
+                           stats_.route_walks_done);
+        ReleaseRouteWalk(iter, table_type);
 
         // vrf entry can be null as table wud have released the reference
         // via lifetime actor
@@ -288,9 +472,9 @@ void AgentRouteWalker::RouteWalkDone(DBTableBase *part) {
         // routes have gone and table is empty. Since routes have gone
         // state from vncontroller on routes have been removed and so would
         // have happened on vrf entry as well.
-        if (vrf != NULL) {
-            Callback(vrf);
-        }
+        // Callback is still needed to start deferred walks and to notify
+        // completion of all walks.
+        Callback(vrf);
     }
 }
 
@@ -326,6 +510,11 @@ void AgentRouteWalker::CallbackInternal(VrfEntry *vrf, bool all_walks_done) {
         //Deletes the state on VRF
         OnRouteTableWalkCompleteForVrf(vrf);
     }
+    if (!deferred_walks_.empty()) {
+        StartDeferredRouteWalks();
+        //Deferred VRF may not have any route table left to walk
+        all_walks_done = AreAllWalksDone();
+    }
     if (all_walks_done) {
         //To be executed in callback where surity is there
         //that all walks are done.
@@ -340,31 +529,15 @@ void AgentRouteWalker::OnRouteTableWalkCompleteForVrf(VrfEntry *vrf) {
     if (route_walk_done_for_vrf_cb_.empty())
         return;
 
-    for (uint8_t table_type = (Agent::INVALID + 1);
-         table_type < Agent::ROUTE_TABLE_MAX;
-         table_type++) {
-        VrfRouteWalkerIdMapIterator iter = 
-            route_walkid_[table_type].find(vrf->vrf_id());
-        if (iter != route_walkid_[table_type].end()) {
-            return;
-        }
-    }
+    if (IsRouteWalkPending(vrf->vrf_id()))
+        return;
     route_walk_done_for_vrf_cb_(vrf);
 }
 
 bool AgentRouteWalker::AreAllWalksDone() const {
     bool walk_done = false;
-    if (vrf_walkid_ == DBTableWalker::kInvalidWalkerId) {
+    if ((vrf_walk_ref_.get() == NULL) && (route_walk_count_ == 0)) {
         walk_done = true;
-        for (uint8_t table_type = (Agent::INVALID + 1);
-             table_type < Agent::ROUTE_TABLE_MAX;
-             table_type++) {
-            if (route_walkid_[table_type].size() != 0) {
-                //Route walk pending
-                walk_done = false;
-                break;
-            }
-        }
     }
     if (walk_done && (walk_count_ != AgentRouteWalker::kInvalidWalkCount)
         && (queued_walk_count_ != AgentRouteWalker::kInvalidWalkCount)) {
@@ -5,6 +5,10 @@
 #ifndef vnsw_agent_route_walker_hpp
 #define vnsw_agent_route_walker_hpp
 
+#include <list>
+#include <set>
+#include <tbb/atomic.h>
+
 #include <cmn/agent_cmn.h>
 #include <cmn/agent.h>
 
@@ -26,15 +30,26 @@
  *    start route table walk. In this way only VRF entries can be traversed 
  *    without route walks issued.
  *    
- * Cancellation of walks happen when a new walk is started and there was an old
- * walk started using same object. Multiple objects of this class can have
- * separate parallel walks. 
+ * Walks are issued through DBTableWalkMgr, which walks one table at a time
+ * and serves all walkers requesting a walk of a table in a single pass. So
+ * walks started on the same tables by different objects of this class (path
+ * preference, controller cleanup, resync...) are coalesced instead of running
+ * in parallel.
+ * Starting a walk again on a table with an old walk still pending restarts
+ * the old walk (DBTable::WalkAgain) instead of cancelling it and issuing a
+ * new one. Multiple objects of this class can have separate parallel walks.
  * Cancellation of VRF walk only cancels VRF walk and not the corresponding
  * route walk started by VRF.
  * Cancellation of route walk can be done by usig CancelRouteWalk with vrf as
  * argument.
  * TODO - Do route cancellation for route walks when vrf walk is cancelled.
  *
+ * Rate limiting - An object does not keep more than max_route_walks() route
+ * table walks pending. Route walks of further VRF are deferred and started,
+ * in the order they were requested, as pending walks complete.
+ *
+ * Progress of the walks is available with stats() and route_walk_count().
+ *
  */
 
 struct AgentRouteWalkerQueueEntry {
@@ -59,6 +74,7 @@ struct AgentRouteWalkerQueueEntry {
 class AgentRouteWalker {
 public:
     static const int kInvalidWalkCount = 0;
+    static const uint32_t kMaxRouteWalks = 1024;
     typedef boost::function<void()> WalkDone;
     typedef boost::function<void(VrfEntry *)> RouteWalkDoneCb;
     enum WalkType {
@@ -67,8 +83,29 @@ public:
         ALL,
     };
 
-    typedef std::map<uint32_t, DBTableWalker::WalkId> VrfRouteWalkerIdMap;
-    typedef std::map<uint32_t, DBTableWalker::WalkId>::iterator VrfRouteWalkerIdMapIterator;
+    struct WalkStats {
+        WalkStats() :
+            vrf_walks(0), vrf_walks_restarted(0), route_walks(0),
+            route_walks_restarted(0), route_walks_deferred(0),
+            route_walks_cancelled(0), route_walks_done(0) {
+            route_entries = 0;
+        }
+        uint64_t vrf_walks;
+        uint64_t vrf_walks_restarted;
+        uint64_t route_walks;
+        // Route walk requests merged into a walk already pending
+        uint64_t route_walks_restarted;
+        uint64_t route_walks_deferred;
+        uint64_t route_walks_cancelled;
+        uint64_t route_walks_done;
+        // Updated by the walks of all partitions of a table, in parallel
+        tbb::atomic<uint64_t> route_entries;
+    };
+
+    typedef std::map<uint32_t, DBTable::DBTableWalkRef> VrfRouteWalkRefMap;
+    typedef VrfRouteWalkRefMap::iterator VrfRouteWalkRefMapIterator;
+    typedef boost::shared_ptr<AgentRouteWalkerQueueEntry> DeferredWalk;
+    typedef std::list<DeferredWalk> DeferredWalkList;
 
     AgentRouteWalker(Agent *agent, WalkType type);
     virtual ~AgentRouteWalker();
@@ -105,12 +142,30 @@ public:
         walkable_route_tables_ = walkable_route_tables;
     }
     uint32_t walkable_route_tables() const {return walkable_route_tables_;}
+    void set_max_route_walks(uint32_t max_route_walks) {
+        max_route_walks_ = max_route_walks;
+    }
+    uint32_t max_route_walks() const {return max_route_walks_;}
+    // Number of route table walks pending
+    uint32_t route_walk_count() const {return route_walk_count_;}
+    uint32_t deferred_walk_count() const {return deferred_walks_.size();}
+    const WalkStats &stats() const {return stats_;}
 
 private:
     void StartVrfWalkInternal();
     void CancelVrfWalkInternal();
     void StartRouteWalkInternal(const VrfEntry * vrf);
     void CancelRouteWalkInternal(const VrfEntry *vrf);
+    uint32_t RouteTableWalkCount(const VrfEntry *vrf) const;
+    bool IsRouteWalkPending(uint32_t vrf_id) const;
+    bool DeferRouteWalk(DeferredWalk data);
+    void CancelDeferredRouteWalk(uint32_t vrf_id);
+    void StartDeferredRouteWalks();
+    void ReleaseRouteWalk(VrfRouteWalkRefMapIterator iter, uint8_t table_type);
+    bool RouteWalkNotifyInternal(DBTablePartBase *partition, DBEntryBase *e);
+    void VrfWalkDoneInternal(DBTable::DBTableWalkRef ref, DBTableBase *part);
+    void RouteWalkDoneInternal(DBTable::DBTableWalkRef ref,
+                               DBTableBase *part);
 
     void Callback(VrfEntry *vrf);
     void CallbackInternal(VrfEntry *vrf, bool all_walks_done);
@@ -128,14 +183,21 @@ private:
     tbb::atomic<int> queued_walk_count_;
     tbb::atomic<int> queued_walk_done_count_;
     tbb::atomic<int> walk_count_;
-    DBTableWalker::WalkId vrf_walkid_;
-    VrfRouteWalkerIdMap route_walkid_[Agent::ROUTE_TABLE_MAX];
+    DBTable::DBTableWalkRef vrf_walk_ref_;
+    VrfRouteWalkRefMap route_walk_ref_[Agent::ROUTE_TABLE_MAX];
+    uint32_t route_walk_count_;
+    uint32_t max_route_walks_;
+    // Route walks waiting for pending route walks to go below
+    // max_route_walks_, deferred_vrf_ids_ has the vrf of each of them
+    DeferredWalkList deferred_walks_;
+    std::set<uint32_t> deferred_vrf_ids_;
+    WalkStats stats_;
     WalkDone walk_done_cb_;
     RouteWalkDoneCb route_walk_done_for_vrf_cb_;
     //work queue(Agent::RouteWalker) is used for starting/cancelling
-    //walks. This task is in exclusion with dbtable and Controller
+    //walks. This task is in exclusion with dbtable, db::Walker and Controller
     //which makes sure that walk-done and cancel walk do not get executed in
-    //parallel. Both these calls modify walkid.
+    //parallel. Both these calls modify the walk references.
     WorkQueue<boost::shared_ptr<AgentRouteWalkerQueueEntry> > work_queue_;
     uint32_t walkable_route_tables_;
     DISALLOW_COPY_AND_ASSIGN(AgentRouteWalker);
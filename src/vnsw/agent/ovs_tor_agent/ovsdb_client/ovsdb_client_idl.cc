@@ -148,7 +148,9 @@ OvsdbClientIdl::OvsdbClientIdl(OvsdbClientSession *session, Agent *agent,
                 *(agent->event_manager())->io_service(),
                 "OVSDB Client Keep Alive Timer",
                 agent->task_scheduler()->GetTaskId("Agent::KSync"), 0)),
-    monitor_request_id_(NULL), bulk_txn_(NULL), stats_() {
+    monitor_request_id_(NULL), bulk_txn_(NULL),
+    max_in_flight_txn_(OVSDBMaxInFlightPendingTxn),
+    max_entries_in_bulk_txn_(OVSDBMaxEntriesInBulkTxn), stats_() {
     refcount_ = 0;
     vtep_global_= ovsdb_wrapper_vteprec_global_first(idl_);
     ovsdb_wrapper_idl_set_callback(idl_, (void *)this,
@@ -201,7 +203,7 @@ OvsdbClientIdl::OvsdbMsg::~OvsdbMsg() {
 }
 
 OvsdbClientIdl::TxnStats::TxnStats() : txn_initiated(0), txn_succeeded(0),
-    txn_failed(0) {
+    txn_failed(0), bulk_txn(0), bulk_txn_entries(0) {
 }
 
 void OvsdbClientIdl::OnEstablish() {
@@ -236,8 +238,10 @@ void OvsdbClientIdl::TxnScheduleJsonRpc(struct jsonrpc_msg *msg) {
     // increment stats.
     stats_.txn_initiated++;
 
+    // messages already throttled are sent first, to keep the txns in order
     if (!session_->ThrottleInFlightTxnMessages() ||
-        OVSDBMaxInFlightPendingTxn >= pending_txn_.size()) {
+        (pending_send_msgs_.empty() &&
+         max_in_flight_txn_ >= pending_txn_.size())) {
         session_->SendJsonRpc(msg);
     } else {
         // throttle txn messages, push the message to pending send
@@ -298,11 +302,7 @@ struct ovsdb_idl_txn *OvsdbClientIdl::CreateTxn(OvsdbEntryBase *entry,
     if (bulk_txn_ != NULL) {
         // reset bulk_txn_ and bulk_entries_ before triggering EncodeSendTxn
         // to let the transaction send go through
-        pending_txn_[bulk_txn_] = bulk_entries_;
-        bulk_entries_.clear();
-        struct ovsdb_idl_txn *bulk_txn = bulk_txn_;
-        bulk_txn_ = NULL;
-        EncodeSendTxn(bulk_txn, NULL);
+        EncodeSendTxn(CloseBulkTxn(), NULL);
     }
 
     struct ovsdb_idl_txn *txn = ovsdb_wrapper_idl_txn_create(idl_);
@@ -337,16 +337,37 @@ struct ovsdb_idl_txn *OvsdbClientIdl::CreateBulkTxn(OvsdbEntryBase *entry,
     entry->ack_event_ = ack_event;
 
     // try creating bulk transaction only if pending txn are there
-    if (pending_txn_.empty() || bulk_entries_.size() == OVSDBEntriesInBulkTxn) {
+    if (pending_txn_.empty() || bulk_entries_.size() >= BulkTxnEntryLimit()) {
         // once done bunch entries add the txn to pending txn list and
         // reset bulk_txn_ to let EncodeSendTxn proceed with bulk txn
-        pending_txn_[bulk_txn_] = bulk_entries_;
-        bulk_txn_ = NULL;
-        bulk_entries_.clear();
+        CloseBulkTxn();
     }
     return bulk_txn;
 }
 
+// Bulk txn is kept small while there is room in the in flight window, to
+// keep the latency of each update low. Once the window is full the txns can
+// only go out as acks come in, so the bulk txn grows to carry all the entries
+// accumulated till the next ack in a single txn. Pending bulk txn is sent on
+// every txn ack (DeleteTxn).
+std::size_t OvsdbClientIdl::BulkTxnEntryLimit() const {
+    if (pending_txn_.size() < max_in_flight_txn_ ||
+        max_entries_in_bulk_txn_ < OVSDBEntriesInBulkTxn) {
+        return OVSDBEntriesInBulkTxn;
+    }
+    return max_entries_in_bulk_txn_;
+}
+
+struct ovsdb_idl_txn *OvsdbClientIdl::CloseBulkTxn() {
+    struct ovsdb_idl_txn *bulk_txn = bulk_txn_;
+    stats_.bulk_txn++;
+    stats_.bulk_txn_entries += bulk_entries_.size();
+    pending_txn_[bulk_txn_] = bulk_entries_;
+    bulk_entries_.clear();
+    bulk_txn_ = NULL;
+    return bulk_txn;
+}
+
 bool OvsdbClientIdl::EncodeSendTxn(struct ovsdb_idl_txn *txn,
                                    OvsdbEntryBase *skip_entry) {
     assert(ConcurrencyCheck());
@@ -383,11 +404,7 @@ void OvsdbClientIdl::DeleteTxn(struct ovsdb_idl_txn *txn) {
     // if there is a pending bulk entry encode and send before
     // destroying the current txn
     if (bulk_txn_ != NULL) {
-        pending_txn_[bulk_txn_] = bulk_entries_;
-        bulk_entries_.clear();
-        struct ovsdb_idl_txn *bulk_txn = bulk_txn_;
-        bulk_txn_ = NULL;
-        EncodeSendTxn(bulk_txn, NULL);
+        EncodeSendTxn(CloseBulkTxn(), NULL);
     }
     ovsdb_wrapper_idl_txn_destroy(txn);
 }
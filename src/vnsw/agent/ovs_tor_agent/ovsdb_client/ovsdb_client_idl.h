@@ -73,6 +73,8 @@ public:
 
     static const std::size_t OVSDBMaxInFlightPendingTxn = 25;
     static const std::size_t OVSDBEntriesInBulkTxn = 4;
+    // limit of entries in bulk txn, used once in flight window is full
+    static const std::size_t OVSDBMaxEntriesInBulkTxn = 1024;
 
     enum Op {
         OVSDB_DEL = 0,
@@ -104,6 +106,8 @@ public:
         uint64_t txn_initiated;
         uint64_t txn_succeeded;
         uint64_t txn_failed;
+        uint64_t bulk_txn;
+        uint64_t bulk_txn_entries;
     };
 
     typedef boost::function<void(OvsdbClientIdl::Op, struct ovsdb_idl_row *)> NotifyCB;
@@ -181,6 +185,19 @@ public:
     uint64_t pending_txn_count() const;
     uint64_t pending_send_msg_count() const;
 
+    // window of txns sent and waiting for ack, used to throttle txn messages
+    // and to grow bulk txn when the window is full
+    void set_max_in_flight_txn(std::size_t count) {
+        max_in_flight_txn_ = count;
+    }
+    std::size_t max_in_flight_txn() const { return max_in_flight_txn_; }
+    void set_max_entries_in_bulk_txn(std::size_t count) {
+        max_entries_in_bulk_txn_ = count;
+    }
+    std::size_t max_entries_in_bulk_txn() const {
+        return max_entries_in_bulk_txn_;
+    }
+
     // Concurrency Check to validate all idl transactions happen only in
     // db::DBTable or Agent::KSync task context
     bool ConcurrencyCheck() const;
@@ -192,6 +209,10 @@ private:
     friend void intrusive_ptr_release(OvsdbClientIdl *p);
 
     void ConnectOperDB();
+    // number of entries after which current bulk txn is closed
+    std::size_t BulkTxnEntryLimit() const;
+    // move current bulk txn to pending txn list, to allow it to be sent
+    struct ovsdb_idl_txn *CloseBulkTxn();
 
     struct ovsdb_idl *idl_;
     const struct vteprec_global *vtep_global_;
@@ -218,6 +239,8 @@ private:
     struct ovsdb_idl_txn *bulk_txn_;
     // list of entries added to bulk txn
     OvsdbEntryList bulk_entries_;
+    std::size_t max_in_flight_txn_;
+    std::size_t max_entries_in_bulk_txn_;
 
     // transaction stats per IDL
     TxnStats stats_;
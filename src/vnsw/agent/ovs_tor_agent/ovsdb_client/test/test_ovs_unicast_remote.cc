@@ -6,6 +6,7 @@
 #include "testing/gunit.h"
 
 #include <base/logging.h>
+#include <base/time_util.h>
 #include <io/event_manager.h>
 #include <io/test/event_manager_test.h>
 #include <tbb/task.h>
@@ -110,6 +111,80 @@ protected:
         }
     }
 
+    // Add test-vrf1 and export it to test-router, returns the vrf entry
+    // in ovsdb
+    VrfOvsdbEntry *AddVrfToRouter() {
+        VnAddReq(2, "test-vn1");
+        agent_->vrf_table()->CreateVrfReq("test-vrf1", MakeUuid(2));
+        AddPhysicalDevice("test-router", 1);
+        client->WaitForIdle();
+        AddPhysicalDeviceVn(agent_, 1, 2, true);
+        client->WaitForIdle();
+
+        VrfOvsdbObject *table = tcp_session_->client_idl()->vrf_ovsdb();
+        VrfOvsdbEntry vrf_key(table, UuidToString(MakeUuid(2)));
+        VrfOvsdbEntry *vrf_entry;
+        WAIT_FOR(100, 10000,
+                 (vrf_entry =
+                  static_cast<VrfOvsdbEntry *>(table->Find(&vrf_key))) != NULL);
+        return vrf_entry;
+    }
+
+    void DelVrfFromRouter() {
+        DelPhysicalDeviceVn(agent_, 1, 2, false);
+        client->WaitForIdle();
+        DeletePhysicalDevice("test-router");
+        client->WaitForIdle();
+        agent_->vrf_table()->DeleteVrfReq("test-vrf1");
+        VnDelReq(2);
+        client->WaitForIdle();
+
+        LogicalSwitchTable *l_table =
+            tcp_session_->client_idl()->logical_switch_table();
+        LogicalSwitchEntry l_key(l_table, UuidToString(MakeUuid(2)));
+        WAIT_FOR(100, 10000, (l_table->Find(&l_key) == NULL));
+    }
+
+    static MacAddress RouteMac(int index) {
+        return MacAddress(0, 0, 0, 2, (index >> 8) & 0xff, index & 0xff);
+    }
+
+    // Add routes in single db task run
+    void AddRoutes(int start, int count) {
+        TestTaskHold *hold = new TestTaskHold(
+            TaskScheduler::GetInstance()->GetTaskId("db::DBTable"), 0);
+        for (int i = start; i < start + count; i++) {
+            BridgeTunnelRouteAdd(agent_->local_peer(), std::string("test-vrf1"),
+                                 (1 << TunnelType::VXLAN), "10.0.2.1",
+                                 101, RouteMac(i), "0.0.0.0", 32);
+        }
+        delete hold;
+    }
+
+    void DelRoutes(int start, int count) {
+        Ip4Address zero_ip;
+        for (int i = start; i < start + count; i++) {
+            EvpnAgentRouteTable::DeleteReq(agent_->local_peer(),
+                                           std::string("test-vrf1"),
+                                           RouteMac(i), zero_ip, 0, NULL);
+        }
+        client->WaitForIdle();
+    }
+
+    bool RoutesInSync(VrfOvsdbEntry *vrf_entry, int start, int count) {
+        UnicastMacRemoteTable *u_table = vrf_entry->route_table();
+        for (int i = start; i < start + count; i++) {
+            UnicastMacRemoteEntry key(u_table, RouteMac(i).ToString());
+            UnicastMacRemoteEntry *entry =
+                static_cast<UnicastMacRemoteEntry *>(u_table->Find(&key));
+            if (entry == NULL || entry->GetState() != KSyncEntry::IN_SYNC ||
+                entry->ovs_entry() == NULL) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     Agent *agent_;
     TestOvsAgentInit *init_;
     OvsPeerManager *peer_manager_;
@@ -412,6 +487,64 @@ TEST_F(UnicastRemoteTest, PhysicalLocatorCreateWait) {
     WAIT_FOR(100, 10000, (l_table->Find(&l_key) == NULL));
 }
 
+// Bulk txn grows beyond OVSDBEntriesInBulkTxn while in flight window is full
+TEST_F(UnicastRemoteTest, BulkTxnWithFullInFlightWindow) {
+    const int kRouteCount = 64;
+    OvsdbClientIdl *idl = tcp_session_->client_idl();
+    VrfOvsdbEntry *vrf_entry = AddVrfToRouter();
+    ASSERT_TRUE(vrf_entry != NULL);
+
+    // first route creates the physical locator
+    AddRoutes(0, 1);
+    client->WaitForIdle();
+    WAIT_FOR(100, 10000, RoutesInSync(vrf_entry, 0, 1));
+
+    idl->set_max_in_flight_txn(1);
+    OvsdbClientIdl::TxnStats stats = idl->stats();
+    AddRoutes(1, kRouteCount);
+    client->WaitForIdle();
+    WAIT_FOR(100, 10000, RoutesInSync(vrf_entry, 1, kRouteCount));
+
+    uint64_t bulk_txn = idl->stats().bulk_txn - stats.bulk_txn;
+    uint64_t bulk_txn_entries =
+        idl->stats().bulk_txn_entries - stats.bulk_txn_entries;
+    EXPECT_LE(kRouteCount, bulk_txn_entries);
+    EXPECT_LT(bulk_txn, kRouteCount / OvsdbClientIdl::OVSDBEntriesInBulkTxn);
+    EXPECT_EQ(stats.txn_failed, idl->stats().txn_failed);
+    EXPECT_EQ(0, idl->pending_send_msg_count());
+
+    idl->set_max_in_flight_txn(OvsdbClientIdl::OVSDBMaxInFlightPendingTxn);
+    DelRoutes(0, kRouteCount + 1);
+    DelVrfFromRouter();
+}
+
+// Time taken to program routes in ovsdb server
+TEST_F(UnicastRemoteTest, DISABLED_BulkTxnConvergencePerf) {
+    const int kRouteCount = 10000;
+    OvsdbClientIdl *idl = tcp_session_->client_idl();
+    VrfOvsdbEntry *vrf_entry = AddVrfToRouter();
+    ASSERT_TRUE(vrf_entry != NULL);
+
+    AddRoutes(0, 1);
+    client->WaitForIdle();
+    WAIT_FOR(100, 10000, RoutesInSync(vrf_entry, 0, 1));
+
+    OvsdbClientIdl::TxnStats stats = idl->stats();
+    uint64_t start = ClockMonotonicUsec();
+    AddRoutes(1, kRouteCount);
+    WAIT_FOR(1000, 100000, RoutesInSync(vrf_entry, 1, kRouteCount));
+    uint64_t elapsed = ClockMonotonicUsec() - start;
+    cout << kRouteCount << " routes programmed in " << elapsed / 1000
+         << " msec, txns " << (idl->stats().txn_initiated - stats.txn_initiated)
+         << ", bulk txns " << (idl->stats().bulk_txn - stats.bulk_txn)
+         << ", bulk txn entries "
+         << (idl->stats().bulk_txn_entries - stats.bulk_txn_entries) << endl;
+    EXPECT_EQ(stats.txn_failed, idl->stats().txn_failed);
+
+    DelRoutes(0, kRouteCount + 1);
+    DelVrfFromRouter();
+}
+
 int main(int argc, char *argv[]) {
     GETUSERARGS();
     // override with true to initialize ovsdb server and client
@@ -389,6 +389,8 @@ bool DnsHandler::HandleVirtualDnsRequest(const VmInterface *vmitf) {
                 break;
             }
             UpdateQueryNames();
+            if (ResolveFromCache())
+                break;
 
             uint8_t count = 0;
             bool query_success = false;
@@ -622,6 +624,7 @@ bool DnsHandler::HandleBindResponse() {
                                        DnsItemsToString(linklocal_items_));
                     } else {
                         valid_response = true;
+                        handler->CacheResponse(flags, ans, auth, add);
                         handler->Resolve(flags, ques, ans, auth, add);
                         DNS_BIND_TRACE(DnsBindTrace,
                                        "Query successful : xid = " <<
@@ -651,6 +654,7 @@ bool DnsHandler::HandleBindResponse() {
         } else if (!dns_proto->IsDnsHandlerInUse(handler)) {
             if (flags.ret) {
                 /* Send last invalid response to requesting VM */
+                handler->CacheResponse(flags, ans, auth, add);
                 handler->Resolve(flags, ques, ans, auth, add);
                 DNS_BIND_TRACE(DnsBindTrace,
                                "Send invalid BIND response: xid = " << xid);
@@ -713,6 +717,7 @@ bool DnsHandler::HandleModifyVdns() {
     DnsProto::DnsUpdateIpc *ipc =
         static_cast<DnsProto::DnsUpdateIpc *>(pkt_info_->ipc);
     DnsProto *dns_proto = agent()->GetDnsProto();
+    dns_proto->FlushDnsCache(ipc->old_vdns);
     std::vector<DnsProto::DnsUpdateIpc *> change_list;
     const DnsProto::DnsUpdateSet &update_set = dns_proto->update_set();
     for (DnsProto::DnsUpdateSet::const_iterator it = update_set.begin();
@@ -938,6 +943,39 @@ void DnsHandler::SendDnsResponse() {
     }
 }
 
+// Queries with a single question are answered from the answer cache when
+// the virtual DNS server has answered the same question recently.
+bool DnsHandler::IsCacheable() const {
+    return items_.size() == 1 && linklocal_items_.empty();
+}
+
+bool DnsHandler::ResolveFromCache() {
+    if (!IsCacheable())
+        return false;
+
+    dns_flags flags;
+    DnsItems ans, auth, add;
+    if (!agent()->GetDnsProto()->LookupDnsCache(
+            ipam_type_.ipam_dns_server.virtual_dns_server_name,
+            items_.front(), &flags, &ans, &auth, &add))
+        return false;
+
+    DNS_BIND_TRACE(DnsBindTrace, "Query answered from cache : xid = " <<
+                   dns_->xid << " " << DnsItemsToString(items_));
+    Resolve(flags, items_, ans, auth, add);
+    return true;
+}
+
+void DnsHandler::CacheResponse(const dns_flags &flags, const DnsItems &ans,
+                               const DnsItems &auth, const DnsItems &add) {
+    if (!IsCacheable())
+        return;
+
+    agent()->GetDnsProto()->AddDnsCache(
+        ipam_type_.ipam_dns_server.virtual_dns_server_name,
+        items_.front(), flags, ans, auth, add);
+}
+
 void DnsHandler::UpdateQueryNames() {
     for (DnsItems::iterator it = items_.begin(); it != items_.end(); ++it) {
         if (it->name.find('.', 0) == std::string::npos) {
@@ -988,6 +1026,7 @@ void DnsHandler::Update(InterTaskMsg *msg) {
     DnsProto::DnsUpdateIpc *update = static_cast<DnsProto::DnsUpdateIpc *>(msg);
     bool free_update = true;
     DnsProto *dns_proto = agent()->GetDnsProto();
+    dns_proto->FlushDnsCache(update->xmpp_data->virtual_dns);
     DnsProto::DnsUpdateIpc *update_req = dns_proto->FindUpdateRequest(update);
     if (update_req) {
         DnsUpdateData *data = update_req->xmpp_data;
@@ -1031,6 +1070,7 @@ void DnsHandler::DelUpdate(InterTaskMsg *msg) {
     DnsProto *dns_proto = agent()->GetDnsProto();
     DnsProto::DnsUpdateIpc *update_req = dns_proto->FindUpdateRequest(update);
     while (update_req) {
+        dns_proto->FlushDnsCache(update_req->xmpp_data->virtual_dns);
         for (DnsItems::iterator item = update_req->xmpp_data->items.begin(); 
              item != update_req->xmpp_data->items.end(); ++item) {
             // in case of delete, set the class to NONE and ttl to 0
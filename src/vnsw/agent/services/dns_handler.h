@@ -74,6 +74,10 @@ private:
     void ParseQuery();
     void Resolve(dns_flags flags, const DnsItems &ques, DnsItems &ans,
                  DnsItems &auth, DnsItems &add);
+    bool IsCacheable() const;
+    bool ResolveFromCache();
+    void CacheResponse(const dns_flags &flags, const DnsItems &ans,
+                       const DnsItems &auth, const DnsItems &add);
     bool SendDnsQuery(int8_t idx, uint16_t xid);
     void SendDnsResponse();
     void UpdateQueryNames();
@@ -3,6 +3,8 @@
  */
 
 #include <sys/types.h>
+#include <algorithm>
+#include "base/time_util.h"
 #include "net/address_util.h"
 #include "init/agent_init.h"
 #include "oper/interface_common.h"
@@ -17,6 +19,8 @@
 #include "oper/vn.h"
 #include "oper/route_common.h"
 
+const uint32_t DnsProto::kDnsCacheMaxNegativeTtl;
+
 void DnsProto::IoShutdown() {
     BindResolver::Shutdown();
 
@@ -28,6 +32,7 @@ void DnsProto::IoShutdown() {
     }
 
     curr_vm_requests_.clear();
+    FlushDnsCache();
     // Following tables should be deleted when all VMs are gone
     assert(update_set_.empty());
     assert(all_vms_.empty());
@@ -239,6 +244,7 @@ void DnsProto::IpamNotify(IFMapNode *node) {
 
 void DnsProto::VdnsNotify(IFMapNode *node) {
     DNS_BIND_TRACE(DnsBindTrace, "Vdns Notify : " << node->name());
+    FlushDnsCache(node->name());
     // Update any existing records prior to checking for new ones
     if (!node->IsDeleted()) {
         autogen::VirtualDns *virtual_dns =
@@ -671,6 +677,128 @@ bool DnsProto::IsVmRequestDuplicate(DnsHandler::QueryKey *key) {
     return curr_vm_requests_.find(*key) != curr_vm_requests_.end();
 }
 
+// Time for which an answer can be served from the cache; zero if the answer
+// should not be cached. Negative answers are cached only when they carry
+// an SOA record (RFC 2308).
+uint32_t DnsProto::GetDnsCacheTtl(const dns_flags &flags, const DnsItems &ans,
+                                  const DnsItems &auth,
+                                  const DnsItems &add) const {
+    bool negative = (flags.ret == DNS_ERR_NO_SUCH_NAME) ||
+                    (flags.ret == DNS_ERR_NO_ERROR && ans.empty());
+    if (flags.ret != DNS_ERR_NO_ERROR && !negative)
+        return 0;
+
+    uint32_t ttl = kDnsDefaultTtl;
+    bool soa_found = false;
+    const DnsItems *sections[] = { &ans, &auth, &add };
+    for (unsigned int i = 0; i < sizeof(sections) / sizeof(sections[0]); ++i) {
+        for (DnsItems::const_iterator it = sections[i]->begin();
+             it != sections[i]->end(); ++it) {
+            ttl = std::min(ttl, it->ttl);
+            if (it->type == DNS_TYPE_SOA) {
+                ttl = std::min(ttl, it->soa.ttl);
+                soa_found = true;
+            }
+        }
+    }
+
+    if (negative) {
+        if (!soa_found)
+            return 0;
+        ttl = std::min(ttl, kDnsCacheMaxNegativeTtl);
+    }
+    return ttl;
+}
+
+bool DnsProto::LookupDnsCache(const std::string &vdns, const DnsItem &ques,
+                              dns_flags *flags, DnsItems *ans, DnsItems *auth,
+                              DnsItems *add) {
+    tbb::mutex::scoped_lock lock(cache_mutex_);
+    DnsCacheMap::iterator it = dns_cache_.find(DnsCacheKey(vdns, ques));
+    if (it == dns_cache_.end()) {
+        stats_.cache_misses++;
+        return false;
+    }
+
+    uint64_t now = UTCTimestampUsec() / 1000000;
+    if (now >= it->second.expiry_time) {
+        dns_cache_.erase(it);
+        stats_.cache_misses++;
+        return false;
+    }
+
+    // age the records by the time spent in the cache
+    uint32_t elapsed = now - it->second.insert_time;
+    *flags = it->second.flags;
+    *ans = it->second.ans;
+    *auth = it->second.auth;
+    *add = it->second.add;
+    DnsItems *sections[] = { ans, auth, add };
+    for (unsigned int i = 0; i < sizeof(sections) / sizeof(sections[0]); ++i) {
+        for (DnsItems::iterator item = sections[i]->begin();
+             item != sections[i]->end(); ++item) {
+            item->ttl -= elapsed;
+        }
+    }
+    stats_.cache_hits++;
+    return true;
+}
+
+void DnsProto::AddDnsCache(const std::string &vdns, const DnsItem &ques,
+                           const dns_flags &flags, const DnsItems &ans,
+                           const DnsItems &auth, const DnsItems &add) {
+    uint32_t ttl = GetDnsCacheTtl(flags, ans, auth, add);
+    if (!ttl)
+        return;
+
+    uint64_t now = UTCTimestampUsec() / 1000000;
+    DnsCacheKey key(vdns, ques);
+    tbb::mutex::scoped_lock lock(cache_mutex_);
+    if (dns_cache_.size() >= kDnsCacheMaxEntries &&
+        dns_cache_.find(key) == dns_cache_.end()) {
+        for (DnsCacheMap::iterator it = dns_cache_.begin();
+             it != dns_cache_.end(); ) {
+            if (now >= it->second.expiry_time)
+                dns_cache_.erase(it++);
+            else
+                ++it;
+        }
+        if (dns_cache_.size() >= kDnsCacheMaxEntries)
+            return;
+    }
+
+    DnsCacheEntry &entry = dns_cache_[key];
+    entry.flags = flags;
+    entry.ans = ans;
+    entry.auth = auth;
+    entry.add = add;
+    entry.insert_time = now;
+    entry.expiry_time = now + ttl;
+}
+
+void DnsProto::FlushDnsCache(const std::string &vdns) {
+    // handlers key the cache with the name as used in the DNS messages
+    std::string name(vdns);
+    BindUtil::RemoveSpecialChars(name);
+    tbb::mutex::scoped_lock lock(cache_mutex_);
+    if (name.empty()) {
+        dns_cache_.clear();
+        return;
+    }
+    for (DnsCacheMap::iterator it = dns_cache_.begin();
+         it != dns_cache_.end(); ) {
+        if (it->first.vdns == name)
+            dns_cache_.erase(it++);
+        else
+            ++it;
+    }
+}
+
+uint32_t DnsProto::DnsCacheSize() const {
+    tbb::mutex::scoped_lock lock(cache_mutex_);
+    return dns_cache_.size();
+}
+
 DnsProto::DnsFipEntry::DnsFipEntry(const VnEntry *vn, const Ip4Address &fip,
                                    const VmInterface *itf)
     : vn_(vn), floating_ip_(fip), interface_(itf) {
@@ -17,6 +17,8 @@ public:
     static const uint32_t kDnsTimeout = 3000;   // milli seconds
     static const uint32_t kDnsMaxRetries = 2;
     static const uint32_t kDnsDefaultTtl = 84600;
+    static const uint32_t kDnsCacheMaxEntries = 4096;
+    static const uint32_t kDnsCacheMaxNegativeTtl = 300; // seconds
 
     enum InterTaskMessage {
         DNS_NONE,
@@ -103,6 +105,7 @@ public:
         DnsStats() { Reset(); }
         void Reset() {
             requests = resolved = retransmit_reqs = unsupported = fail = drop = 0;
+            cache_hits = cache_misses = 0;
         }
 
         uint32_t requests;
@@ -111,6 +114,39 @@ public:
         uint32_t unsupported;
         uint32_t fail;
         uint32_t drop;
+        uint32_t cache_hits;
+        uint32_t cache_misses;
+    };
+
+    // Key of the answer cache : virtual DNS server, query name, type & class
+    struct DnsCacheKey {
+        DnsCacheKey(const std::string &v, const DnsItem &item)
+            : vdns(v), name(item.name), type(item.type), eclass(item.eclass) {}
+        bool operator<(const DnsCacheKey &rhs) const {
+            if (vdns != rhs.vdns)
+                return vdns < rhs.vdns;
+            if (name != rhs.name)
+                return name < rhs.name;
+            if (type != rhs.type)
+                return type < rhs.type;
+            return eclass < rhs.eclass;
+        }
+
+        std::string vdns;
+        std::string name;
+        uint16_t type;
+        uint16_t eclass;
+    };
+
+    // Answer from the DNS server, kept until the smallest TTL of its records
+    // expires. NXDOMAIN and NODATA answers are kept as per the SOA minimum.
+    struct DnsCacheEntry {
+        dns_flags flags;
+        DnsItems ans;
+        DnsItems auth;
+        DnsItems add;
+        uint64_t insert_time;   // seconds
+        uint64_t expiry_time;   // seconds
     };
 
     struct DnsFipEntry {
@@ -143,6 +179,7 @@ public:
     // Map of transaction id and BindServer Index
     typedef std::map<uint32_t, int16_t> DnsBindQueryIndexMap;
     typedef std::pair<uint32_t, int16_t> DnsBindQueryIndexPair;
+    typedef std::map<DnsCacheKey, DnsCacheEntry> DnsCacheMap;
 
     void ConfigInit();
     void Shutdown();
@@ -199,6 +236,17 @@ public:
     void DelVmRequest(DnsHandler::QueryKey *key);
     bool IsVmRequestDuplicate(DnsHandler::QueryKey *key);
 
+    bool LookupDnsCache(const std::string &vdns, const DnsItem &ques,
+                        dns_flags *flags, DnsItems *ans, DnsItems *auth,
+                        DnsItems *add);
+    void AddDnsCache(const std::string &vdns, const DnsItem &ques,
+                     const dns_flags &flags, const DnsItems &ans,
+                     const DnsItems &auth, const DnsItems &add);
+    // Remove the cached answers of a virtual DNS server, all if empty
+    void FlushDnsCache(const std::string &vdns);
+    void FlushDnsCache() { FlushDnsCache(std::string()); }
+    uint32_t DnsCacheSize() const;
+
     uint32_t timeout() const { return timeout_; }
     void set_timeout(uint32_t timeout) { timeout_ = timeout; }
     uint32_t max_retries() const { return max_retries_; }
@@ -243,6 +291,8 @@ private:
     bool GetFipName(const VmInterface *vmitf,
                     const  autogen::VirtualDnsType &vdns_type,
                     const Ip4Address &ip, std::string &fip_name) const;
+    uint32_t GetDnsCacheTtl(const dns_flags &flags, const DnsItems &ans,
+                            const DnsItems &auth, const DnsItems &add) const;
 
     uint16_t xid_;
     DnsUpdateSet update_set_;
@@ -250,6 +300,9 @@ private:
     DnsVmRequestSet curr_vm_requests_;
     DnsBindQueryIndexMap dns_query_index_map_;
     DnsStats stats_;
+    // the cache is flushed from config notifications in the db task
+    mutable tbb::mutex cache_mutex_;
+    DnsCacheMap dns_cache_;
     uint32_t timeout_;   // milli seconds
     uint32_t max_retries_;
 
@@ -250,6 +250,10 @@ void ServicesSandesh::DnsStatsSandesh(std::string ctxt, bool more) {
     dns->set_dns_unsupported(nstats.unsupported);
     dns->set_dns_failures(nstats.fail);
     dns->set_dns_drops(nstats.drop);
+    dns->set_dns_cache_hits(nstats.cache_hits);
+    dns->set_dns_cache_misses(nstats.cache_misses);
+    dns->set_dns_cache_entries(
+        Agent::GetInstance()->GetDnsProto()->DnsCacheSize());
     dns->set_context(ctxt);
     dns->set_more(more);
     dns->Response();
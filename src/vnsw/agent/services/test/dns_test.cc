@@ -548,6 +548,8 @@ TEST_F(DnsTest, VirtualDnsReqTest) {
 
     Agent::GetInstance()->GetDnsProto()->set_timeout(30);
     Agent::GetInstance()->GetDnsProto()->set_max_retries(1);
+    // answer to the first query is cached, make sure this one goes out
+    Agent::GetInstance()->GetDnsProto()->FlushDnsCache();
     SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, a_items);
     g_xid++;
     usleep(100000); // wait for retry timer to expire
@@ -590,6 +592,111 @@ TEST_F(DnsTest, VirtualDnsReqTest) {
     client->WaitForIdle();
 }
 
+TEST_F(DnsTest, VirtualDnsCacheTest) {
+    struct PortInfo input[] = {
+        {"vnet1", 1, "1.1.1.1", "00:00:00:01:01:01", 1, 1},
+    };
+    IpamInfo ipam_info[] = {
+        {"1.2.3.128", 27, "1.2.3.129", true},
+        {"7.8.9.0", 24, "7.8.9.12", true},
+        {"1.1.1.0", 24, "1.1.1.200", true},
+    };
+
+    char vdns_attr[] =
+        "<virtual-DNS-data>\
+            <domain-name>test.contrail.juniper.net</domain-name>\
+            <dynamic-records-from-client>true</dynamic-records-from-client>\
+            <record-order>fixed</record-order>\
+            <default-ttl-seconds>120</default-ttl-seconds>\
+        </virtual-DNS-data>\n";
+    char ipam_attr[] = "<network-ipam-mgmt>\n <ipam-dns-method>virtual-dns-server</ipam-dns-method>\n <ipam-dns-server><virtual-dns-server-name>vdns1</virtual-dns-server-name></ipam-dns-server>\n </network-ipam-mgmt>\n";
+
+    CreateVmportEnv(input, 1, 0);
+    client->WaitForIdle();
+    client->Reset();
+    IntfCfgAdd(input, 0);
+    WaitForItfUpdate(1);
+
+    AddIPAM("vn1", ipam_info, 3, ipam_attr, "vdns1");
+    client->WaitForIdle();
+    AddVDNS("vdns1", vdns_attr);
+    client->WaitForIdle();
+
+    DnsProto *dns_proto = Agent::GetInstance()->GetDnsProto();
+    dns_proto->ClearStats();
+    DnsProto::DnsStats stats;
+    int count = 0;
+
+    // first query is sent to the DNS server and the answer is cached
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, a_items);
+    g_xid++;
+    usleep(1000);
+    client->WaitForIdle();
+    SendDnsResp(1, a_items, 1, auth_items, 1, add_items);
+    CHECK_CONDITION(stats.resolved < 1);
+    CHECK_STATS(stats, 1, 1, 0, 0, 0, 0);
+    EXPECT_EQ(0U, stats.cache_hits);
+    EXPECT_EQ(1U, stats.cache_misses);
+    EXPECT_EQ(1U, dns_proto->DnsCacheSize());
+
+    // same query is answered without waiting for the DNS server
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, a_items);
+    client->WaitForIdle();
+    CHECK_CONDITION(stats.resolved < 2);
+    CHECK_STATS(stats, 2, 2, 0, 0, 0, 0);
+    EXPECT_EQ(1U, stats.cache_hits);
+    EXPECT_EQ(1U, stats.cache_misses);
+
+    // NXDOMAIN with an SOA record is cached as well
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, &a_items[1]);
+    g_xid++;
+    usleep(1000);
+    client->WaitForIdle();
+    SendDnsResp(1, &a_items[1], 1, add_items, 0, NULL, true);
+    CHECK_CONDITION(stats.fail < 1);
+    CHECK_STATS(stats, 3, 2, 0, 0, 1, 0);
+    EXPECT_EQ(2U, stats.cache_misses);
+    EXPECT_EQ(2U, dns_proto->DnsCacheSize());
+
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, &a_items[1]);
+    client->WaitForIdle();
+    CHECK_CONDITION(stats.fail < 2);
+    CHECK_STATS(stats, 4, 2, 0, 0, 2, 0);
+    EXPECT_EQ(2U, stats.cache_hits);
+
+    // multiple questions are not cached
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 2, a_items);
+    g_xid++;
+    usleep(1000);
+    client->WaitForIdle();
+    SendDnsResp(2, a_items, 2, auth_items, 2, add_items);
+    CHECK_CONDITION(stats.resolved < 3);
+    CHECK_STATS(stats, 5, 3, 0, 0, 2, 0);
+    EXPECT_EQ(2U, dns_proto->DnsCacheSize());
+
+    // update from the client invalidates the answers of the virtual DNS
+    SendDnsReq(DNS_OPCODE_UPDATE, GetItfId(0), 1, a_items);
+    client->WaitForIdle();
+    CHECK_CONDITION(stats.resolved < 4);
+    CHECK_STATS(stats, 6, 4, 0, 0, 2, 0);
+    EXPECT_EQ(0U, dns_proto->DnsCacheSize());
+
+    client->Reset();
+    DeleteVmportEnv(input, 1, 1, 0);
+    client->WaitForIdle();
+
+    IntfCfgDel(input, 0);
+    WaitForItfUpdate(0);
+    dns_proto->ClearStats();
+
+    client->Reset();
+    DelIPAM("vn1", "vdns1");
+    client->WaitForIdle();
+    DelVDNS("vdns1");
+    client->WaitForIdle();
+    EXPECT_EQ(0U, dns_proto->DnsCacheSize());
+}
+
 // Order the config such that Ipam gets updated last
 TEST_F(DnsTest, VirtualDnsIpamUpdateReqTest) {
     struct PortInfo input[] = {
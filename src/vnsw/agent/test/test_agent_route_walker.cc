@@ -17,6 +17,7 @@
 #include "services/services_init.h"
 #include "vrouter/ksync/ksync_init.h"
 #include "oper/agent_route_walker.h"
+#include "db/db_table_walk_mgr.h"
 #include "test_cmn_util.h"
 #include "kstate/test/test_kstate_util.h"
 #include "vr_types.h"
@@ -378,6 +379,121 @@ TEST_F(AgentRouteWalkerTest, walk_on_deleted_vrf_with_deleted_route_table) {
     DeleteEnvironment(1);
 }
 
+// Requests to walk a VRF while its walk is pending are served by one walk
+TEST_F(AgentRouteWalkerTest, restart_pending_route_walk) {
+    client->Reset();
+    SetupEnvironment(1);
+    VrfEntry *vrf = VrfGet("vrf1");
+    EXPECT_TRUE(vrf != NULL);
+    DBTableWalkMgr *walk_mgr = Agent::GetInstance()->db()->GetWalkMgr();
+    walk_mgr->DisableWalkProcessing();
+    StartRouteWalk(vrf);
+    StartRouteWalk(vrf);
+    StartRouteWalk(vrf);
+    client->WaitForIdle();
+    EXPECT_EQ(Agent::ROUTE_TABLE_MAX - 1, route_walk_count());
+    EXPECT_EQ(3 * (Agent::ROUTE_TABLE_MAX - 1), stats().route_walks);
+    EXPECT_EQ(2 * (Agent::ROUTE_TABLE_MAX - 1), stats().route_walks_restarted);
+    walk_mgr->EnableWalkProcessing();
+    WAIT_FOR(1000, 1000, IsWalkCompleted() == true);
+    VerifyNotifications(13, 0, 0, Agent::ROUTE_TABLE_MAX - 1);
+    EXPECT_EQ(Agent::ROUTE_TABLE_MAX - 1, stats().route_walks_done);
+    EXPECT_EQ(13, stats().route_entries);
+    EXPECT_EQ(0, route_walk_count());
+    DeleteEnvironment(1);
+}
+
+// Walks of a table requested by different walkers are done in one pass
+TEST_F(AgentRouteWalkerTest, coalesce_walks_of_walkers) {
+    client->Reset();
+    SetupEnvironment(1);
+    VrfEntry *vrf = VrfGet("vrf1");
+    EXPECT_TRUE(vrf != NULL);
+    InetUnicastAgentRouteTable *table = vrf->GetInet4UnicastRouteTable();
+    AgentRouteWalker walker(Agent::GetInstance(), AgentRouteWalker::ALL);
+    DBTableWalkMgr *walk_mgr = Agent::GetInstance()->db()->GetWalkMgr();
+    walk_mgr->DisableWalkProcessing();
+    StartRouteWalk(vrf);
+    walker.StartRouteWalk(vrf);
+    client->WaitForIdle();
+    uint64_t walk_count = table->walk_count();
+    walk_mgr->EnableWalkProcessing();
+    WAIT_FOR(1000, 1000, IsWalkCompleted() == true);
+    WAIT_FOR(1000, 1000, walker.IsWalkCompleted() == true);
+    VerifyNotifications(13, 0, 0, Agent::ROUTE_TABLE_MAX - 1);
+    EXPECT_EQ(walk_count + 1, table->walk_count());
+    EXPECT_EQ(Agent::ROUTE_TABLE_MAX - 1, walker.stats().route_walks_done);
+    EXPECT_EQ(13, walker.stats().route_entries);
+    DeleteEnvironment(1);
+}
+
+// Route walks of VRF beyond max_route_walks are deferred and done later
+TEST_F(AgentRouteWalkerTest, defer_route_walks) {
+    client->Reset();
+    SetupEnvironment(2);
+    set_max_route_walks(1);
+    StartVrfWalk();
+    VerifyNotifications(35, 3, 1, ((Agent::ROUTE_TABLE_MAX - 1) * 3));
+    WAIT_FOR(1000, 1000, IsWalkCompleted() == true);
+    EXPECT_EQ(2, stats().route_walks_deferred);
+    EXPECT_EQ(0, deferred_walk_count());
+    EXPECT_TRUE(AllWalksDequeued());
+    DeleteEnvironment(2);
+}
+
+// Request to walk a VRF whose walk is deferred is merged into it, and is
+// accounted per route table like the restart of a started walk
+TEST_F(AgentRouteWalkerTest, restart_deferred_route_walk) {
+    client->Reset();
+    SetupEnvironment(2);
+    set_max_route_walks(1);
+    VrfEntry *vrf1 = VrfGet("vrf1");
+    VrfEntry *vrf2 = VrfGet("vrf2");
+    EXPECT_TRUE(vrf1 != NULL);
+    EXPECT_TRUE(vrf2 != NULL);
+    DBTableWalkMgr *walk_mgr = Agent::GetInstance()->db()->GetWalkMgr();
+    walk_mgr->DisableWalkProcessing();
+    StartRouteWalk(vrf1);
+    StartRouteWalk(vrf2);
+    StartRouteWalk(vrf2);
+    client->WaitForIdle();
+    EXPECT_EQ(1, stats().route_walks_deferred);
+    EXPECT_EQ(1, deferred_walk_count());
+    EXPECT_EQ(Agent::ROUTE_TABLE_MAX - 1, stats().route_walks_restarted);
+    walk_mgr->EnableWalkProcessing();
+    WAIT_FOR(1000, 1000, IsWalkCompleted() == true);
+    EXPECT_EQ(2 * (Agent::ROUTE_TABLE_MAX - 1), stats().route_walks_done);
+    EXPECT_EQ(0, deferred_walk_count());
+    EXPECT_TRUE(AllWalksDequeued());
+    DeleteEnvironment(2);
+}
+
+// Merged request of a walker restricted to some route tables is accounted
+// only for the route tables it walks
+TEST_F(AgentRouteWalkerTest, restart_deferred_route_walk_table_mask) {
+    client->Reset();
+    SetupEnvironment(2);
+    set_max_route_walks(1);
+    set_walkable_route_tables(1 << Agent::INET4_UNICAST);
+    VrfEntry *vrf1 = VrfGet("vrf1");
+    VrfEntry *vrf2 = VrfGet("vrf2");
+    EXPECT_TRUE(vrf1 != NULL);
+    EXPECT_TRUE(vrf2 != NULL);
+    DBTableWalkMgr *walk_mgr = Agent::GetInstance()->db()->GetWalkMgr();
+    walk_mgr->DisableWalkProcessing();
+    StartRouteWalk(vrf1);
+    StartRouteWalk(vrf2);
+    StartRouteWalk(vrf2);
+    client->WaitForIdle();
+    EXPECT_EQ(1, stats().route_walks_deferred);
+    EXPECT_EQ(1, stats().route_walks_restarted);
+    walk_mgr->EnableWalkProcessing();
+    WAIT_FOR(1000, 1000, IsWalkCompleted() == true);
+    EXPECT_EQ(2, stats().route_walks_done);
+    EXPECT_TRUE(AllWalksDequeued());
+    DeleteEnvironment(2);
+}
+
 //TODO REMAINING TESTS
 // - based on walktype - unicast/multicast/all
 //
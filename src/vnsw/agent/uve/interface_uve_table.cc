@@ -2,6 +2,7 @@
  * Copyright (c) 2015 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <algorithm>
 #include <oper/interface_common.h>
 #include <oper/health_check.h>
 #include <uve/interface_uve_table.h>
@@ -181,12 +182,68 @@ bool InterfaceUveTable::UveInterfaceEntry::FrameInterfaceMsg(const string &name,
     return true;
 }
 
+//Copies the fields of the UVE built by FrameInterfaceMsg which have changed
+//since they were last sent. Name, VN and VM are always set, as they identify
+//the interface and are not optional.
+#define UVE_INTERFACE_FIELD_DELTA(field)                                    \
+    if (!sent_uve_info_.__isset.field ||                                    \
+        uve.get_##field() != sent_uve_info_.get_##field()) {                \
+        s_intf->set_##field(uve.get_##field());                             \
+        sent_uve_info_.set_##field(uve.get_##field());                      \
+        changed = true;                                                     \
+    }
+
+bool InterfaceUveTable::UveInterfaceEntry::FrameInterfaceDeltaMsg
+    (const string &name, UveVMInterfaceAgent *s_intf) {
+    UveVMInterfaceAgent uve;
+    if (!FrameInterfaceMsg(name, &uve)) {
+        return false;
+    }
+
+    bool changed = false;
+    s_intf->set_name(name);
+    SetVnVmInfo(s_intf);
+    if (s_intf->get_virtual_network() !=
+        sent_uve_info_.get_virtual_network() ||
+        s_intf->get_vm_name() != sent_uve_info_.get_vm_name() ||
+        s_intf->get_vm_uuid() != sent_uve_info_.get_vm_uuid()) {
+        sent_uve_info_.set_virtual_network(s_intf->get_virtual_network());
+        sent_uve_info_.set_vm_name(s_intf->get_vm_name());
+        sent_uve_info_.set_vm_uuid(s_intf->get_vm_uuid());
+        changed = true;
+    }
+
+    UVE_INTERFACE_FIELD_DELTA(ip_address);
+    UVE_INTERFACE_FIELD_DELTA(mac_address);
+    UVE_INTERFACE_FIELD_DELTA(ip6_address);
+    UVE_INTERFACE_FIELD_DELTA(ip6_active);
+    UVE_INTERFACE_FIELD_DELTA(is_health_check_active);
+    UVE_INTERFACE_FIELD_DELTA(floating_ips);
+    UVE_INTERFACE_FIELD_DELTA(health_check_instance_list);
+    UVE_INTERFACE_FIELD_DELTA(label);
+    UVE_INTERFACE_FIELD_DELTA(ip4_active);
+    UVE_INTERFACE_FIELD_DELTA(l2_active);
+    UVE_INTERFACE_FIELD_DELTA(active);
+    UVE_INTERFACE_FIELD_DELTA(admin_state);
+    UVE_INTERFACE_FIELD_DELTA(uuid);
+    UVE_INTERFACE_FIELD_DELTA(gateway);
+    UVE_INTERFACE_FIELD_DELTA(fixed_ip4_list);
+    UVE_INTERFACE_FIELD_DELTA(fixed_ip6_list);
+    return changed;
+}
+
+#undef UVE_INTERFACE_FIELD_DELTA
+
 void InterfaceUveTable::UveInterfaceEntry::Reset() {
+    UveVMInterfaceAgent uve;
+
     intf_ = NULL;
     port_bitmap_.Reset();
     prev_fip_tree_.clear();
     fip_tree_.clear();
     ace_set_.clear();
+    /* Send all the fields when the entry is renewed */
+    sent_uve_info_ = uve;
 
     ace_stats_changed_ = false;
     deleted_ = true;
@@ -252,7 +309,7 @@ void InterfaceUveTable::DispatchInterfaceMsg(const UveVMInterfaceAgent &uve) {
 void InterfaceUveTable::SendInterfaceMsg(const string &name,
                                          UveInterfaceEntry *entry) {
     UveVMInterfaceAgent uve;
-    if (entry->FrameInterfaceMsg(name, &uve)) {
+    if (entry->FrameInterfaceDeltaMsg(name, &uve)) {
         DispatchInterfaceMsg(uve);
     }
 }
@@ -418,7 +475,7 @@ void InterfaceUveTable::UveInterfaceEntry::UpdateFloatingIpStats
     if (deleted_ && !renewed_) {
         return;
     }
-    FloatingIp *entry = FipEntry(fip_info.fip_, fip_info.vn_);
+    FloatingIp *entry = FindFipEntry(fip_info.fip_, fip_info.vn_);
     /* Ignore stats update request if it comes after entry is removed */
     if (entry == NULL) {
         return;
@@ -427,10 +484,17 @@ void InterfaceUveTable::UveInterfaceEntry::UpdateFloatingIpStats
 }
 
 InterfaceUveTable::FloatingIp *InterfaceUveTable::UveInterfaceEntry::FipEntry
+    (uint32_t ip, const string &vn) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    return FindFipEntry(ip, vn);
+}
+
+/* Callers hold mutex_, since fip_tree_ is modified from db::DBTable task */
+InterfaceUveTable::FloatingIp *InterfaceUveTable::UveInterfaceEntry::FindFipEntry
     (uint32_t ip, const string &vn) {
     Ip4Address addr(ip);
-    FloatingIpPtr key(new FloatingIp(addr, vn));
-    FloatingIpSet::iterator fip_it =  fip_tree_.find(key);
+    FloatingIpSet::iterator fip_it =
+        FindFloatingIp(&fip_tree_, FloatingIp(addr, vn));
     if (fip_it == fip_tree_.end()) {
         return NULL;
     } else {
@@ -502,9 +566,8 @@ bool InterfaceUveTable::UveInterfaceEntry::FillFloatingIpStats
             diff_uve.set_ip_address(ip.floating_ip_.to_string());
             diff_uve.set_virtual_network(ip.vn_.get()->GetName());
 
-            FloatingIpPtr key(new FloatingIp(ip.floating_ip_,
-                                             ip.vn_.get()->GetName()));
-            FloatingIpSet::iterator fip_it =  fip_tree_.find(key);
+            FloatingIp key(ip.floating_ip_, ip.vn_.get()->GetName());
+            FloatingIpSet::iterator fip_it = FindFloatingIp(&fip_tree_, key);
             if (fip_it == fip_tree_.end()) {
                 SetStats(uve_fip, 0, 0, 0, 0);
                 SetDiffStats(diff_uve, 0, 0, 0, 0, diff_list_send);
@@ -512,18 +575,19 @@ bool InterfaceUveTable::UveInterfaceEntry::FillFloatingIpStats
                 FloatingIp *fip = (*fip_it).get();
                 SetStats(uve_fip, fip->in_bytes_, fip->in_packets_,
                          fip->out_bytes_, fip->out_packets_);
-                FloatingIpSet::iterator prev_it = prev_fip_tree_.find(key);
+                FloatingIpSet::iterator prev_it =
+                    FindFloatingIp(&prev_fip_tree_, key);
                 if (prev_it == prev_fip_tree_.end()) {
                     SetDiffStats(diff_uve, fip->in_bytes_, fip->in_packets_,
                                  fip->out_bytes_, fip->out_packets_,
                                  diff_list_send);
-                    FloatingIpPtr prev_fip_ptr(new FloatingIp(ip.floating_ip_,
-                                                      ip.vn_.get()->GetName(),
-                                                      fip->in_bytes_,
-                                                      fip->in_packets_,
-                                                      fip->out_bytes_,
-                                                      fip->out_packets_));
-                    prev_fip_tree_.insert(prev_fip_ptr);
+                    InsertFloatingIp(&prev_fip_tree_,
+                                     FloatingIp(ip.floating_ip_,
+                                                ip.vn_.get()->GetName(),
+                                                fip->in_bytes_,
+                                                fip->in_packets_,
+                                                fip->out_bytes_,
+                                                fip->out_packets_));
                 } else {
                     FloatingIp *pfip = (*prev_it).get();
                     SetDiffStats(diff_uve, (fip->in_bytes_ - pfip->in_bytes_),
@@ -569,25 +633,47 @@ void InterfaceUveTable::UveInterfaceEntry::SetStats
     fip.set_out_pkts(out_pkts);
 }
 
+InterfaceUveTable::FloatingIpSet::iterator
+InterfaceUveTable::UveInterfaceEntry::FindFloatingIp(FloatingIpSet *set,
+                                                     const FloatingIp &key) {
+    FloatingIpSet::iterator it = std::lower_bound(set->begin(), set->end(),
+                                                  key, FloatingIpCmp());
+    if (it != set->end() && (*it)->fip_ == key.fip_ && (*it)->vn_ == key.vn_) {
+        return it;
+    }
+    return set->end();
+}
+
+/* Adds a copy of key to the set, if it is not already present. Returns the
+ * entry in the set */
+InterfaceUveTable::FloatingIp *
+InterfaceUveTable::UveInterfaceEntry::InsertFloatingIp(FloatingIpSet *set,
+                                                       const FloatingIp &key) {
+    FloatingIpSet::iterator it = std::lower_bound(set->begin(), set->end(),
+                                                  key, FloatingIpCmp());
+    if (it != set->end() && (*it)->fip_ == key.fip_ && (*it)->vn_ == key.vn_) {
+        return (*it).get();
+    }
+    it = set->insert(it, FloatingIpPtr(new FloatingIp(key)));
+    return (*it).get();
+}
+
 void InterfaceUveTable::UveInterfaceEntry::AddFloatingIp
     (const VmInterface::FloatingIp &fip) {
-    FloatingIpPtr key(new FloatingIp(fip.floating_ip_,
-                                     fip.vn_.get()->GetName()));
-    FloatingIpSet::iterator it = fip_tree_.find(key);
-    if (it != fip_tree_.end()) {
-        return;
-    }
-    fip_tree_.insert(key);
+    tbb::mutex::scoped_lock lock(mutex_);
+    InsertFloatingIp(&fip_tree_,
+                     FloatingIp(fip.floating_ip_, fip.vn_.get()->GetName()));
 }
 
 void InterfaceUveTable::UveInterfaceEntry::RemoveFloatingIp
     (const VmInterface::FloatingIp &fip) {
-    FloatingIpPtr key(new FloatingIp(fip.floating_ip_, fip.vn_.get()->GetName()));
-    FloatingIpSet::iterator it = fip_tree_.find(key);
+    FloatingIp key(fip.floating_ip_, fip.vn_.get()->GetName());
+    tbb::mutex::scoped_lock lock(mutex_);
+    FloatingIpSet::iterator it = FindFloatingIp(&fip_tree_, key);
     if (it != fip_tree_.end()) {
         fip_tree_.erase(it);
     }
-    FloatingIpSet::iterator prev_it = prev_fip_tree_.find(key);
+    FloatingIpSet::iterator prev_it = FindFloatingIp(&prev_fip_tree_, key);
     if (prev_it != prev_fip_tree_.end()) {
         prev_fip_tree_.erase(prev_it);
     }
@@ -596,18 +682,21 @@ void InterfaceUveTable::UveInterfaceEntry::RemoveFloatingIp
 void InterfaceUveTable::UveInterfaceEntry::UpdateInterfaceAceStats
     (const std::string &ace_uuid) {
     AceStats key(ace_uuid);
+    tbb::mutex::scoped_lock lock(mutex_);
     ace_stats_changed_ = true;
-    AceStatsSet::const_iterator it = ace_set_.find(key);
-    if (it != ace_set_.end()) {
+    AceStatsSet::iterator it = std::lower_bound(ace_set_.begin(),
+                                                ace_set_.end(), key);
+    if (it != ace_set_.end() && it->ace_uuid == ace_uuid) {
         it->count++;
         return;
     }
     key.count = 1;
-    ace_set_.insert(key);
+    ace_set_.insert(it, key);
 }
 
 bool InterfaceUveTable::UveInterfaceEntry::FrameInterfaceAceStatsMsg
     (const std::string &name, UveVMInterfaceAgent *s_intf) {
+    tbb::mutex::scoped_lock lock(mutex_);
     if (!ace_stats_changed_) {
         return false;
     }
@@ -82,19 +82,21 @@ public:
     class FloatingIpCmp {
         public:
             bool operator()(const FloatingIpPtr &lhs,
-                            const FloatingIpPtr &rhs) const {
-                if (lhs.get()->fip_ != rhs.get()->fip_) {
-                    return lhs.get()->fip_ < rhs.get()->fip_;
+                            const FloatingIp &rhs) const {
+                if (lhs.get()->fip_ != rhs.fip_) {
+                    return lhs.get()->fip_ < rhs.fip_;
                 }
-                return (lhs.get()->vn_ < rhs.get()->vn_);
+                return (lhs.get()->vn_ < rhs.vn_);
             }
     };
-    typedef std::set<FloatingIpPtr, FloatingIpCmp> FloatingIpSet;
+    //Flat set, kept sorted using FloatingIpCmp. Interfaces have a few
+    //floating-ips, and the set is looked up for every flow stats update.
+    typedef std::vector<FloatingIpPtr> FloatingIpSet;
 
     struct AceStats {
-        const std::string ace_uuid;
-        mutable uint64_t count;
-        mutable uint64_t prev_count;
+        std::string ace_uuid;
+        uint64_t count;
+        uint64_t prev_count;
         AceStats(const std::string &ace) : ace_uuid(ace), count(0),
             prev_count(0) {
         }
@@ -102,7 +104,8 @@ public:
             return ace_uuid < rhs.ace_uuid;
         }
     };
-    typedef std::set<AceStats> AceStatsSet;
+    //Flat set, kept sorted on ace_uuid
+    typedef std::vector<AceStats> AceStatsSet;
     struct UveInterfaceEntry {
         const VmInterface *intf_;
         boost::uuids::uuid uuid_;
@@ -114,14 +117,19 @@ public:
         bool renewed_;
         bool ace_stats_changed_;
         UveVMInterfaceAgent uve_info_;
+        //Values of the config fields last sent by Agent::Uve. Only the
+        //fields that differ from these are sent. Kept apart from uve_info_,
+        //which holds the stats fields updated by the stats collector.
+        UveVMInterfaceAgent sent_uve_info_;
         AceStatsSet ace_set_;
-        /* For exclusion between kTaskFlowStatsCollector and Agent::Uve */
+        /* For exclusion between kTaskFlowStatsCollector, Agent::Uve and
+         * db::DBTable, which updates fip_tree_ */
         tbb::mutex mutex_;
 
         UveInterfaceEntry(const VmInterface *i) : intf_(i),
             uuid_(i->GetUuid()), port_bitmap_(),
             fip_tree_(), prev_fip_tree_(), changed_(true), deleted_(false),
-            renewed_(false), uve_info_() { }
+            renewed_(false), uve_info_(), sent_uve_info_() { }
         virtual ~UveInterfaceEntry() {}
         void UpdateFloatingIpStats(const FipInfo &fip_info);
         bool FillFloatingIpStats(vector<VmFloatingIPStats> &result,
@@ -136,8 +144,16 @@ public:
         void AddFloatingIp(const VmInterface::FloatingIp &fip);
         InterfaceUveTable::FloatingIp *FipEntry(uint32_t ip,
                                                 const std::string &vn);
+        InterfaceUveTable::FloatingIp *FindFipEntry(uint32_t ip,
+                                                    const std::string &vn);
+        static FloatingIpSet::iterator FindFloatingIp(FloatingIpSet *set,
+                                                      const FloatingIp &key);
+        static FloatingIp *InsertFloatingIp(FloatingIpSet *set,
+                                            const FloatingIp &key);
         bool FrameInterfaceMsg(const std::string &name,
                                UveVMInterfaceAgent *s_intf) const;
+        bool FrameInterfaceDeltaMsg(const std::string &name,
+                                    UveVMInterfaceAgent *s_intf);
         bool FrameInterfaceAceStatsMsg(const std::string &name,
                                        UveVMInterfaceAgent *s_intf);
         bool GetVmInterfaceGateway(const VmInterface *vm_intf,
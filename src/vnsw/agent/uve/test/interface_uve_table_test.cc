@@ -7,6 +7,7 @@
 #include <oper/interface_common.h>
 #include <oper/interface.h>
 #include <oper/vm_interface.h>
+#include <uve/agent_uve_base.h>
 #include <uve/test/interface_uve_table_test.h>
 
 
@@ -63,8 +64,9 @@ const InterfaceUveTable::FloatingIp *InterfaceUveTableTest::GetVmIntfFip
         UveInterfaceEntry *entry = it->second.get();
         boost::system::error_code ec;
         Ip4Address ip = Ip4Address::from_string(fip, ec);
-        FloatingIpPtr key(new FloatingIp(ip, vn));
-        FloatingIpSet::iterator fip_it = entry->fip_tree_.find(key);
+        FloatingIpSet::iterator fip_it =
+            UveInterfaceEntry::FindFloatingIp(&entry->fip_tree_,
+                                              FloatingIp(ip, vn));
         if (fip_it != entry->fip_tree_.end()) {
             return (*fip_it).get();
         }
@@ -81,3 +83,34 @@ InterfaceUveTableTest::GetUveInterfaceEntry(const string &name) {
     InterfaceUveTable::UveInterfaceEntry* entry = it->second.get();
     return entry;
 }
+
+void InterfaceUveTableTest::AddUveInterfaceEntry(const std::string &name,
+                                                 const VmInterface *intf) {
+    tbb::mutex::scoped_lock lock(interface_tree_mutex_);
+    UveInterfaceEntryPtr entry(new UveInterfaceEntry(intf));
+    interface_tree_.insert(InterfacePair(name, entry));
+}
+
+void InterfaceUveTableTest::DeleteUveInterfaceEntry(const std::string &name) {
+    tbb::mutex::scoped_lock lock(interface_tree_mutex_);
+    interface_tree_.erase(name);
+}
+
+/* Marks all entries changed, as done on a notification for the interface */
+void InterfaceUveTableTest::MarkAllChanged() {
+    InterfaceMap::iterator it = interface_tree_.begin();
+    while (it != interface_tree_.end()) {
+        it->second->changed_ = true;
+        ++it;
+    }
+}
+
+/* Runs the timer until all the entries are visited once */
+void InterfaceUveTableTest::RunTimerPass() {
+    uint32_t count = (interface_tree_.size() +
+                      AgentUveBase::kUveCountPerTimer - 1) /
+        AgentUveBase::kUveCountPerTimer;
+    for (uint32_t i = 0; i < count; i++) {
+        TimerExpiry();
+    }
+}
@@ -23,6 +23,11 @@ public:
     const UveVMInterfaceAgent &last_sent_uve() const { return uve_; }
     InterfaceUveTable::UveInterfaceEntry* GetUveInterfaceEntry
         (const std::string &name);
+    void AddUveInterfaceEntry(const std::string &name,
+                              const VmInterface *intf);
+    void DeleteUveInterfaceEntry(const std::string &name);
+    void MarkAllChanged();
+    void RunTimerPass();
 private:
     uint32_t send_count_;
     uint32_t delete_count_;
@@ -3,6 +3,7 @@
  */
 
 #include "base/os.h"
+#include <base/time_util.h>
 #include <cfg/cfg_init.h>
 #include <oper/operdb_init.h>
 #include <controller/controller_init.h>
@@ -722,6 +723,94 @@ TEST_F(InterfaceUveTest, VmIntfAddDel_3) {
     vmut->ClearCount();
 }
 
+//Verifies that the interface UVE carries only the fields which changed
+//since it was last sent, and that all the fields are sent once the entry is
+//renewed
+TEST_F(InterfaceUveTest, VmIntfDelta) {
+    struct PortInfo input[] = {
+        {"vnet1", 1, "1.1.1.1", "00:00:00:01:01:01", 1, 1},
+    };
+
+    InterfaceUveTableTest *vmut = static_cast<InterfaceUveTableTest *>
+        (Agent::GetInstance()->uve()->interface_uve_table());
+    vmut->ClearCount();
+    EXPECT_EQ(0U, vmut->InterfaceUveCount());
+
+    util_.VnAdd(input[0].vn_id);
+    util_.NovaPortAdd(input);
+    util_.ConfigPortAdd(input);
+    util_.VmAdd(input[0].vm_id);
+    AddLink("virtual-machine", "vm1", "virtual-machine-interface", "vnet1");
+    client->WaitForIdle();
+
+    util_.EnqueueSendVmiUveTask();
+    client->WaitForIdle();
+
+    //All the fields are sent in the first UVE
+    EXPECT_EQ(1U, vmut->send_count());
+    UveVMInterfaceAgent uve1 = vmut->last_sent_uve();
+    EXPECT_TRUE(uve1.__isset.mac_address);
+    EXPECT_TRUE(uve1.__isset.uuid);
+    EXPECT_TRUE(uve1.__isset.gateway);
+    EXPECT_TRUE(uve1.__isset.fixed_ip4_list);
+    EXPECT_FALSE(uve1.get_vm_uuid().empty());
+
+    //No UVE is sent when none of the fields changed
+    vmut->MarkAllChanged();
+    util_.EnqueueSendVmiUveTask();
+    client->WaitForIdle();
+    EXPECT_EQ(1U, vmut->send_count());
+
+    //Only the VM fields change when the VM is disassociated
+    DelLink("virtual-machine", "vm1", "virtual-machine-interface", "vnet1");
+    util_.VmDelete(input[0].vm_id);
+    client->WaitForIdle();
+    util_.EnqueueSendVmiUveTask();
+    client->WaitForIdle();
+    EXPECT_EQ(2U, vmut->send_count());
+    UveVMInterfaceAgent uve2 = vmut->last_sent_uve();
+    EXPECT_TRUE(uve2.get_vm_uuid().empty());
+    EXPECT_FALSE(uve2.__isset.mac_address);
+    EXPECT_FALSE(uve2.__isset.uuid);
+    EXPECT_FALSE(uve2.__isset.gateway);
+    EXPECT_FALSE(uve2.__isset.fixed_ip4_list);
+
+    //Delete and add back the interface config before the UVE is sent, so
+    //that the entry is renewed. All the fields are sent again.
+    DelNode("virtual-machine-interface", "vnet1");
+    client->WaitForIdle();
+    InterfaceUveTable::UveInterfaceEntry* entry = vmut->GetUveInterfaceEntry
+        ("vnet1");
+    EXPECT_TRUE(entry->deleted_);
+    util_.ConfigPortAdd(input);
+    EXPECT_TRUE(entry->renewed_);
+    util_.EnqueueSendVmiUveTask();
+    client->WaitForIdle();
+    EXPECT_EQ(1U, vmut->delete_count());
+    EXPECT_EQ(4U, vmut->send_count());
+    UveVMInterfaceAgent uve3 = vmut->last_sent_uve();
+    EXPECT_FALSE(uve3.get_deleted());
+    EXPECT_TRUE(uve3.__isset.mac_address);
+    EXPECT_TRUE(uve3.__isset.uuid);
+    EXPECT_TRUE(uve3.__isset.gateway);
+    EXPECT_TRUE(uve3.__isset.fixed_ip4_list);
+
+    //cleanup
+    util_.VnDelete(input[0].vn_id);
+    DelNode("virtual-machine-interface", "vnet1");
+    client->WaitForIdle();
+    IntfCfgDel(input, 0);
+    client->WaitForIdle();
+
+    util_.EnqueueSendVmiUveTask();
+    client->WaitForIdle();
+    WAIT_FOR(1000, 500, ((vmut->InterfaceUveCount() == 0U)));
+
+    //clear counters at the end of test case
+    client->Reset();
+    vmut->ClearCount();
+}
+
 TEST_F(InterfaceUveTest, FipStats_1) {
     InterfaceUveTableTest *vmut = static_cast<InterfaceUveTableTest *>
         (Agent::GetInstance()->uve()->interface_uve_table());
@@ -1243,6 +1332,49 @@ TEST_F(InterfaceUveTest, IntfStatsTest) {
     InterfaceCleanup();
 }
 
+//Measures the time taken in each interval to send UVEs for interfaces which
+//are marked changed. Only the first interval sends the UVEs, since the
+//fields of the interfaces don't change after that.
+TEST_F(InterfaceUveTest, DISABLED_InterfaceUveDeltaPerf) {
+    const uint32_t kInterfaceCount = 5000;
+    const int kIntervalCount = 10;
+    InterfaceUveTableTest *vmut = static_cast<InterfaceUveTableTest *>
+        (Agent::GetInstance()->uve()->interface_uve_table());
+
+    std::vector<VmInterface *> intf_list;
+    for (uint32_t i = 0; i < kInterfaceCount; i++) {
+        VmInterface *intf = new VmInterface(MakeUuid(10000 + i));
+        std::stringstream name;
+        name << "perf-vmi-" << i;
+        vmut->AddUveInterfaceEntry(name.str(), intf);
+        intf_list.push_back(intf);
+    }
+
+    vmut->ClearCount();
+    uint32_t first_count = 0;
+    for (int i = 0; i < kIntervalCount; i++) {
+        vmut->MarkAllChanged();
+        uint64_t start = ClockMonotonicUsec();
+        vmut->RunTimerPass();
+        uint64_t elapsed = ClockMonotonicUsec() - start;
+        LOG(DEBUG, "Interval " << i << ": " << vmut->send_count()
+            << " UVEs sent, " << elapsed << " usec");
+        if (i == 0) {
+            first_count = vmut->send_count();
+        }
+    }
+    EXPECT_TRUE(first_count >= kInterfaceCount);
+    EXPECT_EQ(first_count, vmut->send_count());
+
+    for (uint32_t i = 0; i < kInterfaceCount; i++) {
+        std::stringstream name;
+        name << "perf-vmi-" << i;
+        vmut->DeleteUveInterfaceEntry(name.str());
+        delete intf_list[i];
+    }
+    vmut->ClearCount();
+}
+
 TEST_F(InterfaceUveTest, PhysicalIntfAddDel_1) {
 }
 
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <boost/scoped_ptr.hpp>
+#include <base/string_util.h>
+#include <uve/vm_stat_kvm_reader.h>
+
+#include "testing/gunit.h"
+
+using namespace std;
+
+class Agent;
+void RouterIdDepInit(Agent *agent) {
+}
+
+static const string kUuid1("90cb7351-d2dc-4d8d-a216-2f460be183b6");
+static const string kUuid2("1b2c3d4e-0000-4000-8000-000000000002");
+static const string kUuid3("1b2c3d4e-0000-4000-8000-000000000003");
+
+//Builds a fake /proc and cgroup hierarchy under a temporary directory
+class VmStatKvmReaderTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        char dir[] = "/tmp/vm_stat_kvm_reader.XXXXXX";
+        ASSERT_TRUE(mkdtemp(dir) != NULL);
+        root_ = dir;
+        proc_ = root_ + "/proc";
+        cgroup_ = root_ + "/cgroup";
+        MakeDir(proc_);
+        MakeDir(cgroup_);
+        reader_.reset(new VmStatKvmReader(proc_, cgroup_));
+    }
+
+    virtual void TearDown() {
+        reader_.reset();
+        RemoveDir(root_);
+    }
+
+    void MakeDir(const string &path) {
+        for (size_t pos = root_.size() + 1; pos != string::npos;
+             pos = path.find('/', pos + 1)) {
+            mkdir(path.substr(0, pos).c_str(), 0755);
+        }
+        mkdir(path.c_str(), 0755);
+    }
+
+    void RemoveDir(const string &path) {
+        DIR *dir = opendir(path.c_str());
+        if (dir == NULL) {
+            unlink(path.c_str());
+            return;
+        }
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            string name = entry->d_name;
+            if (name == "." || name == "..")
+                continue;
+            RemoveDir(path + "/" + name);
+        }
+        closedir(dir);
+        rmdir(path.c_str());
+    }
+
+    void WriteFile(const string &path, const string &data) {
+        MakeDir(path.substr(0, path.rfind('/')));
+        ofstream file(path.c_str(), ios::binary);
+        file << data;
+    }
+
+    string ProcDir(int pid) {
+        stringstream path;
+        path << proc_ << "/" << pid;
+        return path.str();
+    }
+
+    //Adds a qemu process with the given arguments after the binary name
+    void AddProcess(int pid, const string &binary, const string &args) {
+        string cmdline = binary;
+        cmdline.push_back('\0');
+        for (size_t i = 0; i < args.size(); i++) {
+            cmdline.push_back(args[i] == ' ' ? '\0' : args[i]);
+        }
+        cmdline.push_back('\0');
+        WriteFile(ProcDir(pid) + "/cmdline", cmdline);
+        WriteFile(ProcDir(pid) + "/status",
+                  "Name:\tqemu-system-x86\n"
+                  "VmPeak:\t 2500000 kB\n"
+                  "VmSize:\t 2400000 kB\n"
+                  "VmRSS:\t  1048576 kB\n");
+        WriteFile(ProcDir(pid) + "/stat",
+                  "1234 (qemu-kvm) S 1 1 1 0 -1 0 0 0 0 0 "
+                  "500 300 0 0 20 0 3 0 100 0 0\n");
+    }
+
+    //Writes a qcow2 header with the given virtual size
+    void WriteQcow2(const string &path, uint64_t virtual_size) {
+        string header(32, '\0');
+        header[0] = 'Q'; header[1] = 'F'; header[2] = 'I'; header[3] = 0xfb;
+        for (int i = 0; i < 8; i++) {
+            header[31 - i] = (virtual_size >> (i * 8)) & 0xff;
+        }
+        WriteFile(path, header);
+    }
+
+    string root_;
+    string proc_;
+    string cgroup_;
+    boost::scoped_ptr<VmStatKvmReader> reader_;
+};
+
+TEST_F(VmStatKvmReaderTest, CgroupV1) {
+    string disk = root_ + "/instances/" + kUuid1 + "/disk";
+    AddProcess(1234, "/usr/bin/qemu-system-x86_64",
+               "-name instance-00000001 -m 2048 -smp 2 -uuid " +
+               kUuid1 + " -drive file=" + disk +
+               ",if=none,id=drive-virtio-disk0,format=qcow2");
+    WriteQcow2(disk, 20ULL * 1024 * 1024 * 1024);
+
+    string domain = "/machine.slice/machine-qemu\\x2d1\\x2dinstance.scope";
+    WriteFile(ProcDir(1234) + "/cgroup",
+              "4:memory:" + domain + "/emulator\n"
+              "3:cpu,cpuacct:" + domain + "/emulator\n");
+    WriteFile(cgroup_ + "/cpuacct" + domain + "/cpuacct.usage",
+              "13400000000\n");
+    WriteFile(cgroup_ + "/cpuacct" + domain + "/vcpu0/cpuacct.usage",
+              "6000000000\n");
+    WriteFile(cgroup_ + "/cpuacct" + domain + "/vcpu1/cpuacct.usage",
+              "5000000000\n");
+
+    //Not a domain
+    WriteFile(ProcDir(1) + "/cmdline", string("/sbin/init\0", 11));
+    WriteFile(proc_ + "/self/cmdline", "bash");
+
+    reader_->Scan(100);
+    EXPECT_EQ(1U, reader_->domains().size());
+
+    VmStatKvmReader::DomainStats stats;
+    EXPECT_TRUE(reader_->GetDomainStats(StringToUuid(kUuid1), &stats));
+    EXPECT_EQ(1234U, stats.pid);
+    EXPECT_EQ(2048U * 1024, stats.memory_quota);
+    EXPECT_EQ(2400000U, stats.virt_memory);
+    EXPECT_EQ(2500000U, stats.virt_memory_peak);
+    EXPECT_EQ(1048576U, stats.rss);
+    EXPECT_DOUBLE_EQ(13.4, stats.cpu_time);
+    ASSERT_EQ(2U, stats.vcpu_time.size());
+    EXPECT_DOUBLE_EQ(6.0, stats.vcpu_time[0]);
+    EXPECT_DOUBLE_EQ(5.0, stats.vcpu_time[1]);
+    EXPECT_EQ(disk, stats.disk_path);
+    EXPECT_EQ(20ULL * 1024 * 1024 * 1024, stats.disk_virtual_size);
+
+    EXPECT_FALSE(reader_->GetDomainStats(StringToUuid(kUuid2), &stats));
+}
+
+TEST_F(VmStatKvmReaderTest, CgroupV2) {
+    string disk = root_ + "/instances/" + kUuid2 + "/disk";
+    AddProcess(2000, "/usr/libexec/qemu-kvm",
+               "-name guest=instance-00000002 -m size=4G,slots=16 -uuid " +
+               kUuid2 + " -blockdev {\"driver\":\"file\",\"filename\":\"" +
+               disk + "\",\"node-name\":\"storage1\"}");
+    WriteFile(disk, string(4096, 'x'));
+
+    string domain = "/machine.slice/machine-qemu\\x2d2\\x2dinstance.scope";
+    WriteFile(ProcDir(2000) + "/cgroup", "0::" + domain + "/emulator\n");
+    WriteFile(cgroup_ + domain + "/cpu.stat",
+              "usage_usec 2500000\nuser_usec 2000000\nsystem_usec 500000\n");
+    WriteFile(cgroup_ + domain + "/vcpu0/cpu.stat",
+              "usage_usec 1500000\n");
+
+    VmStatKvmReader::DomainStats stats;
+    EXPECT_TRUE(reader_->GetDomainStats(StringToUuid(kUuid2), &stats));
+    EXPECT_EQ(4U * 1024 * 1024, stats.memory_quota);
+    EXPECT_DOUBLE_EQ(2.5, stats.cpu_time);
+    ASSERT_EQ(1U, stats.vcpu_time.size());
+    EXPECT_DOUBLE_EQ(1.5, stats.vcpu_time[0]);
+    EXPECT_EQ(disk, stats.disk_path);
+    //Not a qcow2 image, capacity is the size of the file
+    EXPECT_EQ(4096U, stats.disk_virtual_size);
+}
+
+//Cpu time is read from /proc/<pid>/stat when there is no cgroup
+TEST_F(VmStatKvmReaderTest, NoCgroup) {
+    AddProcess(3000, "qemu-system-x86_64", "-uuid " + kUuid3);
+
+    VmStatKvmReader::DomainStats stats;
+    EXPECT_TRUE(reader_->GetDomainStats(StringToUuid(kUuid3), &stats));
+    EXPECT_DOUBLE_EQ(800.0 / sysconf(_SC_CLK_TCK), stats.cpu_time);
+    EXPECT_TRUE(stats.vcpu_time.empty());
+    EXPECT_TRUE(stats.disk_path.empty());
+    EXPECT_EQ(0U, stats.memory_quota);
+}
+
+//All domains are read in one scan, which is reused until it is older than
+//kMaxSnapshotAge
+TEST_F(VmStatKvmReaderTest, SharedSnapshot) {
+    AddProcess(1234, "qemu-system-x86_64", "-uuid " + kUuid1);
+    AddProcess(2000, "qemu-system-x86_64", "-uuid " + kUuid2);
+
+    VmStatKvmReader::DomainStats stats;
+    EXPECT_TRUE(reader_->GetDomainStats(StringToUuid(kUuid1), &stats));
+    EXPECT_TRUE(reader_->GetDomainStats(StringToUuid(kUuid2), &stats));
+    EXPECT_EQ(1U, reader_->scan_count());
+    EXPECT_EQ(2U, reader_->domains().size());
+
+    //New domain is not seen until the snapshot is taken again
+    AddProcess(3000, "qemu-system-x86_64", "-uuid " + kUuid3);
+    EXPECT_FALSE(reader_->GetDomainStats(StringToUuid(kUuid3), &stats));
+    EXPECT_EQ(1U, reader_->scan_count());
+
+    //Stale snapshot is taken again
+    reader_->Scan(time(NULL) - VmStatKvmReader::kMaxSnapshotAge);
+    EXPECT_TRUE(reader_->GetDomainStats(StringToUuid(kUuid3), &stats));
+    EXPECT_EQ(3U, reader_->scan_count());
+    EXPECT_EQ(3U, reader_->domains().size());
+
+    //Domain that is gone is removed
+    RemoveDir(ProcDir(1234));
+    reader_->Scan(time(NULL));
+    EXPECT_FALSE(reader_->GetDomainStats(StringToUuid(kUuid1), &stats));
+    EXPECT_EQ(2U, reader_->domains().size());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
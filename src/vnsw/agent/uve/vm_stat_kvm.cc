@@ -6,7 +6,10 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <algorithm>
+#include <limits>
 #include <uve/vm_stat_kvm.h>
+#include <uve/vm_stat_kvm_reader.h>
 #include <uve/vm_stat_data.h>
 #include <db/db.h>
 #include <db/db_entry.h>
@@ -24,7 +27,12 @@ using namespace boost::uuids;
 using namespace boost::asio;
 
 VmStatKvm::VmStatKvm(Agent *agent, const uuid &vm_uuid)
-    : VmStat(agent, vm_uuid) {
+    : VmStat(agent, vm_uuid), reader_() {
+}
+
+VmStatKvm::VmStatKvm(Agent *agent, const uuid &vm_uuid,
+                     boost::shared_ptr<VmStatKvmReader> reader)
+    : VmStat(agent, vm_uuid), reader_(reader) {
 }
 
 VmStatKvm::~VmStatKvm() {
@@ -250,7 +258,70 @@ void VmStatKvm::GetMemoryQuota() {
     ExecCmd(cmd.str(), boost::bind(&VmStatKvm::ReadMemoryQuota, this));
 }
 
+//Updates all the stats from the snapshot taken by the reader, without
+//running any virsh command. Returns false if the domain is not found, in
+//which case the stats are collected using virsh.
+bool VmStatKvm::ReadDomainStats() {
+    if (reader_.get() == NULL) {
+        return false;
+    }
+
+    VmStatKvmReader::DomainStats stats;
+    if (!reader_->GetDomainStats(vm_uuid_, &stats)) {
+        return false;
+    }
+
+    pid_ = stats.pid;
+    mem_usage_ = stats.rss;
+    virt_memory_ = stats.virt_memory;
+    virt_memory_peak_ = stats.virt_memory_peak;
+    if (stats.memory_quota) {
+        vm_memory_quota_ = stats.memory_quota;
+    }
+
+    //The same snapshot may be read again, if the collection is restarted
+    //within kMaxSnapshotAge
+    if (prev_cpu_snapshot_time_ &&
+        difftime(stats.snapshot_time, prev_cpu_snapshot_time_) > 0) {
+        cpu_usage_ = (stats.cpu_time - prev_cpu_stat_)/
+                     difftime(stats.snapshot_time, prev_cpu_snapshot_time_);
+        cpu_usage_ *= 100;
+    }
+    prev_cpu_stat_ = stats.cpu_time;
+    prev_cpu_snapshot_time_ = stats.snapshot_time;
+
+    if (prev_vcpu_usage_.size() != stats.vcpu_time.size()) {
+        //In case a new VCPU get added
+        prev_vcpu_usage_ = stats.vcpu_time;
+    }
+    if (prev_vcpu_snapshot_time_ &&
+        difftime(stats.snapshot_time, prev_vcpu_snapshot_time_) > 0) {
+        vcpu_usage_percent_.clear();
+        for (uint32_t i = 0; i < stats.vcpu_time.size(); i++) {
+            double cpu_usage = (stats.vcpu_time[i] - prev_vcpu_usage_[i])/
+                difftime(stats.snapshot_time, prev_vcpu_snapshot_time_);
+            cpu_usage *= 100;
+            vcpu_usage_percent_.push_back(cpu_usage);
+        }
+    }
+    prev_vcpu_usage_ = stats.vcpu_time;
+    prev_vcpu_snapshot_time_ = stats.snapshot_time;
+
+    //virsh domblkinfo reports the sizes in bytes
+    const uint64_t max_size = std::numeric_limits<uint32_t>::max();
+    virtual_size_ = std::min(stats.disk_virtual_size, max_size);
+    disk_size_ = std::min(stats.disk_allocated_size, max_size);
+
+    SendVmCpuStats();
+    return true;
+}
+
 bool VmStatKvm::TimerExpiry() {
+    if (ReadDomainStats()) {
+        //Reschedule the timer
+        return true;
+    }
+
     if (pid_ == 0) {
         GetPid();
     } else {
@@ -299,5 +370,9 @@ void VmStatKvm::GetPid() {
 }
 
 void VmStatKvm::Start() {
+    if (ReadDomainStats()) {
+        StartTimer();
+        return;
+    }
     GetPid();
 }
@@ -5,11 +5,16 @@
 #ifndef vnsw_agent_vm_stat_kvm_h
 #define vnsw_agent_vm_stat_kvm_h
 
+#include <boost/shared_ptr.hpp>
 #include "vm_stat.h"
 
+class VmStatKvmReader;
+
 class VmStatKvm : public VmStat {
 public:
     VmStatKvm(Agent *agent, const boost::uuids::uuid &vm_uuid);
+    VmStatKvm(Agent *agent, const boost::uuids::uuid &vm_uuid,
+              boost::shared_ptr<VmStatKvmReader> reader);
     ~VmStatKvm();
 
     void Start();
@@ -29,6 +34,11 @@ private:
     void ReadPid();
     void ReadMemoryQuota();
     void GetMemoryQuota();
+    bool ReadDomainStats();
+
+    //Reads the stats of all domains from /proc and cgroups. virsh commands
+    //are run only when the domain is not found by the reader.
+    boost::shared_ptr<VmStatKvmReader> reader_;
 
     DISALLOW_COPY_AND_ASSIGN(VmStatKvm);
 };
@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <base/string_util.h>
+#include <uve/vm_stat_kvm_reader.h>
+
+using namespace boost::uuids;
+
+namespace {
+
+bool ReadFile(const std::string &path, std::string *data) {
+    std::ifstream file(path.c_str());
+    if (!file) {
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    *data = contents.str();
+    return true;
+}
+
+//Reads the first number in the file, e.g. cpuacct.usage
+bool ReadNumber(const std::string &path, uint64_t *value) {
+    std::ifstream file(path.c_str());
+    file >> *value;
+    return !file.fail();
+}
+
+//Reads the value of the key from a file with "key value" lines,
+//e.g. cpu.stat
+bool ReadKeyValue(const std::string &path, const std::string &key,
+                  uint64_t *value) {
+    std::ifstream file(path.c_str());
+    std::string tmp;
+    while (file >> tmp) {
+        if (tmp == key) {
+            file >> *value;
+            return !file.fail();
+        }
+    }
+    return false;
+}
+
+//Converts the argument of qemu -m to KiB, the unit used by virsh dommemstat.
+//The argument is either a size or has a size=<size> option, with MiB as the
+//default unit.
+uint32_t ParseMemorySize(const std::string &arg) {
+    std::string size = arg;
+    size_t pos = arg.find("size=");
+    if (pos != std::string::npos) {
+        size = arg.substr(pos + 5);
+    }
+    char *end = NULL;
+    uint64_t value = strtoull(size.c_str(), &end, 10);
+    switch (*end) {
+    case 'k':
+    case 'K':
+        break;
+    case 'g':
+    case 'G':
+        value *= 1024 * 1024;
+        break;
+    default:
+        value *= 1024;
+        break;
+    }
+    if (value > std::numeric_limits<uint32_t>::max()) {
+        return std::numeric_limits<uint32_t>::max();
+    }
+    return value;
+}
+
+//Returns the image path from a -drive file=<path>,... or a -blockdev
+//{"filename":"<path>",...} argument
+std::string ParseDiskPath(const std::string &arg) {
+    size_t pos = arg.find("\"filename\":\"");
+    if (pos != std::string::npos) {
+        pos += 12;
+        return arg.substr(pos, arg.find('"', pos) - pos);
+    }
+    pos = arg.find("file=");
+    if (pos != std::string::npos && (pos == 0 || arg[pos - 1] == ',')) {
+        pos += 5;
+        return arg.substr(pos, arg.find(',', pos) - pos);
+    }
+    return "";
+}
+
+uint64_t ReadBigEndian(const unsigned char *data, size_t len) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < len; i++) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+}  // namespace
+
+VmStatKvmReader::DomainStats::DomainStats()
+    : pid(0), snapshot_time(0), cpu_time(0), vcpu_time(), virt_memory(0),
+      virt_memory_peak(0), rss(0), memory_quota(0), disk_path(),
+      disk_virtual_size(0), disk_allocated_size(0) {
+}
+
+VmStatKvmReader::VmStatKvmReader()
+    : proc_root_("/proc"), cgroup_root_("/sys/fs/cgroup"), domains_(),
+      snapshot_time_(0), scan_count_(0) {
+}
+
+VmStatKvmReader::VmStatKvmReader(const std::string &proc_root,
+                                 const std::string &cgroup_root)
+    : proc_root_(proc_root), cgroup_root_(cgroup_root), domains_(),
+      snapshot_time_(0), scan_count_(0) {
+}
+
+VmStatKvmReader::~VmStatKvmReader() {
+}
+
+std::string VmStatKvmReader::ProcPath(uint32_t pid, const char *file) const {
+    std::ostringstream path;
+    path << proc_root_ << "/" << pid << "/" << file;
+    return path.str();
+}
+
+bool VmStatKvmReader::GetDomainStats(const uuid &vm_uuid,
+                                     DomainStats *stats) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    time_t now;
+    time(&now);
+    if (scan_count_ == 0 || difftime(now, snapshot_time_) >= kMaxSnapshotAge) {
+        ScanDomains(now);
+    }
+
+    DomainStatsMap::const_iterator it = domains_.find(vm_uuid);
+    if (it == domains_.end()) {
+        return false;
+    }
+    *stats = it->second;
+    return true;
+}
+
+void VmStatKvmReader::Scan(time_t now) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    ScanDomains(now);
+}
+
+void VmStatKvmReader::ScanDomains(time_t now) {
+    domains_.clear();
+    snapshot_time_ = now;
+    scan_count_++;
+
+    DIR *dir = opendir(proc_root_.c_str());
+    if (dir == NULL) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        char *end = NULL;
+        unsigned long pid = strtoul(entry->d_name, &end, 10);
+        if (end == entry->d_name || *end != '\0') {
+            continue;
+        }
+
+        uuid vm_uuid = nil_uuid();
+        DomainStats stats;
+        if (!ReadCmdline(pid, &vm_uuid, &stats)) {
+            continue;
+        }
+        stats.pid = pid;
+        stats.snapshot_time = now;
+        ReadMemStat(pid, &stats);
+        if (!ReadCgroupCpuStat(pid, &stats)) {
+            ReadProcCpuStat(pid, &stats);
+        }
+        ReadDiskStat(&stats);
+        domains_[vm_uuid] = stats;
+    }
+    closedir(dir);
+}
+
+bool VmStatKvmReader::ReadCmdline(uint32_t pid, uuid *vm_uuid,
+                                  DomainStats *stats) const {
+    std::string cmdline;
+    if (!ReadFile(ProcPath(pid, "cmdline"), &cmdline)) {
+        return false;
+    }
+
+    //Arguments are separated by '\0'
+    std::vector<std::string> args;
+    size_t start = 0;
+    while (start < cmdline.size()) {
+        size_t end = cmdline.find('\0', start);
+        if (end == std::string::npos) {
+            end = cmdline.size();
+        }
+        args.push_back(cmdline.substr(start, end - start));
+        start = end + 1;
+    }
+    if (args.empty() || (args[0].find("qemu") == std::string::npos &&
+                         args[0].find("kvm") == std::string::npos)) {
+        return false;
+    }
+
+    for (size_t i = 1; i + 1 < args.size(); i++) {
+        if (args[i] == "-uuid") {
+            *vm_uuid = StringToUuid(args[i + 1]);
+        } else if (args[i] == "-m") {
+            stats->memory_quota = ParseMemorySize(args[i + 1]);
+        }
+    }
+    if (*vm_uuid == nil_uuid()) {
+        return false;
+    }
+
+    const std::string uuid_str = UuidToString(*vm_uuid);
+    for (size_t i = 1; i < args.size(); i++) {
+        std::string path = ParseDiskPath(args[i]);
+        if (path.find(uuid_str) != std::string::npos) {
+            stats->disk_path = path;
+            break;
+        }
+    }
+    return true;
+}
+
+void VmStatKvmReader::ReadMemStat(uint32_t pid, DomainStats *stats) const {
+    std::ifstream file(ProcPath(pid, "status").c_str());
+    bool vmsize = false;
+    bool peak = false;
+    bool rss = false;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream vm(line);
+        std::string tmp;
+        vm >> tmp;
+        if (tmp == "VmSize:") {
+            vm >> stats->virt_memory;
+            vmsize = true;
+        } else if (tmp == "VmRSS:") {
+            vm >> stats->rss;
+            rss = true;
+        } else if (tmp == "VmPeak:") {
+            vm >> stats->virt_memory_peak;
+            peak = true;
+        }
+        if (rss && vmsize && peak)
+            break;
+    }
+}
+
+//Reads the cpu time of the domain from its cgroup, as listed in
+///proc/<pid>/cgroup. libvirt moves the qemu process to the emulator child
+//of the domain cgroup, and the vcpu threads to vcpuN children.
+bool VmStatKvmReader::ReadCgroupCpuStat(uint32_t pid,
+                                        DomainStats *stats) const {
+    std::ifstream file(ProcPath(pid, "cgroup").c_str());
+    std::string line;
+    std::string cpuacct_dir;
+    std::string unified_dir;
+    while (std::getline(file, line)) {
+        //<hierarchy-id>:<controllers>:<path>
+        size_t first = line.find(':');
+        size_t second = line.find(':', first + 1);
+        if (first == std::string::npos || second == std::string::npos) {
+            continue;
+        }
+        std::string controllers =
+            "," + line.substr(first + 1, second - first - 1) + ",";
+        std::string path = line.substr(second + 1);
+        const std::string emulator = "/emulator";
+        if (path.size() > emulator.size() &&
+            path.compare(path.size() - emulator.size(), emulator.size(),
+                         emulator) == 0) {
+            path.erase(path.size() - emulator.size());
+        }
+        if (controllers.find(",cpuacct,") != std::string::npos) {
+            cpuacct_dir = cgroup_root_ + "/cpuacct" + path;
+        } else if (controllers == ",," && line.compare(0, 2, "0:") == 0) {
+            unified_dir = cgroup_root_ + path;
+        }
+    }
+
+    uint64_t usage = 0;
+    if (!cpuacct_dir.empty() &&
+        ReadNumber(cpuacct_dir + "/cpuacct.usage", &usage)) {
+        //In nanoseconds
+        stats->cpu_time = usage / 1000000000.0;
+        for (int vcpu = 0; ; vcpu++) {
+            std::ostringstream path;
+            path << cpuacct_dir << "/vcpu" << vcpu << "/cpuacct.usage";
+            if (!ReadNumber(path.str(), &usage))
+                break;
+            stats->vcpu_time.push_back(usage / 1000000000.0);
+        }
+        return true;
+    }
+
+    if (!unified_dir.empty() &&
+        ReadKeyValue(unified_dir + "/cpu.stat", "usage_usec", &usage)) {
+        stats->cpu_time = usage / 1000000.0;
+        for (int vcpu = 0; ; vcpu++) {
+            std::ostringstream path;
+            path << unified_dir << "/vcpu" << vcpu << "/cpu.stat";
+            if (!ReadKeyValue(path.str(), "usage_usec", &usage))
+                break;
+            stats->vcpu_time.push_back(usage / 1000000.0);
+        }
+        return true;
+    }
+    return false;
+}
+
+//Reads utime and stime of the qemu process from /proc/<pid>/stat
+void VmStatKvmReader::ReadProcCpuStat(uint32_t pid,
+                                      DomainStats *stats) const {
+    std::string data;
+    if (!ReadFile(ProcPath(pid, "stat"), &data)) {
+        return;
+    }
+    //Fields after the command name, which is in parentheses, start with
+    //the state. utime and stime are the 12th and 13th of them.
+    size_t pos = data.rfind(')');
+    if (pos == std::string::npos) {
+        return;
+    }
+    std::stringstream fields(data.substr(pos + 1));
+    std::string tmp;
+    for (int i = 0; i < 11; i++) {
+        fields >> tmp;
+    }
+    uint64_t utime = 0, stime = 0;
+    if (fields >> utime >> stime) {
+        stats->cpu_time = (double)(utime + stime) / sysconf(_SC_CLK_TCK);
+    }
+}
+
+//Disk allocation is the space used by the image file, and capacity is the
+//virtual size in the header of qcow2 images or the file size otherwise, as
+//reported by virsh domblkinfo.
+void VmStatKvmReader::ReadDiskStat(DomainStats *stats) const {
+    if (stats->disk_path.empty()) {
+        return;
+    }
+    struct stat st;
+    if (stat(stats->disk_path.c_str(), &st) != 0) {
+        return;
+    }
+    stats->disk_allocated_size = (uint64_t)st.st_blocks * 512;
+    stats->disk_virtual_size = st.st_size;
+
+    std::ifstream file(stats->disk_path.c_str(), std::ios::binary);
+    unsigned char header[32];
+    if (file.read(reinterpret_cast<char *>(header), sizeof(header)) &&
+        ReadBigEndian(header, 4) == kQcow2Magic) {
+        stats->disk_virtual_size = ReadBigEndian(header + 24, 8);
+    }
+}
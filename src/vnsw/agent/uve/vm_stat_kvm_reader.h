@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef vnsw_agent_vm_stat_kvm_reader_h
+#define vnsw_agent_vm_stat_kvm_reader_h
+
+#include <stdint.h>
+#include <time.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/uuid/uuid.hpp>
+#include <tbb/mutex.h>
+#include <base/util.h>
+
+//Reads the statistics of all KVM domains on the compute node in one pass
+//over /proc and the cgroup hierarchy, instead of running virsh commands for
+//each domain.
+//
+//Domains are qemu processes, identified by the -uuid argument on their
+//command line. For each domain,
+// - cpu time is taken from the cpuacct cgroup of the domain (per vcpu from
+//   the vcpuN child cgroups created by libvirt), or from /proc/<pid>/stat
+//   when the cgroup is not available
+// - memory usage is taken from /proc/<pid>/status and memory quota from the
+//   -m argument
+// - disk sizes are taken from the disk image on the command line whose path
+//   has the domain uuid in it, the same disk that is picked from virsh
+//   domblklist
+//
+//The snapshot of all domains is shared by the VmStatKvm objects, and is
+//taken again only when it is older than kMaxSnapshotAge.
+class VmStatKvmReader {
+public:
+    static const time_t kMaxSnapshotAge = 10;
+    static const uint32_t kQcow2Magic = 0x514649fb;
+
+    struct DomainStats {
+        DomainStats();
+
+        uint32_t pid;
+        time_t snapshot_time;
+        //Seconds of cpu time used by the domain and by each of its vcpus
+        double cpu_time;
+        std::vector<double> vcpu_time;
+        //In KiB
+        uint32_t virt_memory;
+        uint32_t virt_memory_peak;
+        uint32_t rss;
+        uint32_t memory_quota;
+        std::string disk_path;
+        uint64_t disk_virtual_size;
+        uint64_t disk_allocated_size;
+    };
+    typedef std::map<boost::uuids::uuid, DomainStats> DomainStatsMap;
+
+    VmStatKvmReader();
+    VmStatKvmReader(const std::string &proc_root,
+                    const std::string &cgroup_root);
+    ~VmStatKvmReader();
+
+    //Copies the stats of the domain from the snapshot, after taking a new
+    //snapshot if it is too old. Returns false if the domain is not found.
+    bool GetDomainStats(const boost::uuids::uuid &vm_uuid,
+                        DomainStats *stats);
+    //Takes a new snapshot of all the domains
+    void Scan(time_t now);
+
+    const DomainStatsMap &domains() const { return domains_; }
+    uint64_t scan_count() const { return scan_count_; }
+
+private:
+    void ScanDomains(time_t now);
+    bool ReadCmdline(uint32_t pid, boost::uuids::uuid *vm_uuid,
+                     DomainStats *stats) const;
+    void ReadMemStat(uint32_t pid, DomainStats *stats) const;
+    bool ReadCgroupCpuStat(uint32_t pid, DomainStats *stats) const;
+    void ReadProcCpuStat(uint32_t pid, DomainStats *stats) const;
+    void ReadDiskStat(DomainStats *stats) const;
+    std::string ProcPath(uint32_t pid, const char *file) const;
+
+    const std::string proc_root_;
+    const std::string cgroup_root_;
+    tbb::mutex mutex_;
+    DomainStatsMap domains_;
+    time_t snapshot_time_;
+    uint64_t scan_count_;
+    DISALLOW_COPY_AND_ASSIGN(VmStatKvmReader);
+};
+#endif // vnsw_agent_vm_stat_kvm_reader_h
@@ -7,10 +7,11 @@
 #include <uve/vm_uve_entry.h>
 #include <uve/agent_uve.h>
 #include <uve/vm_stat_kvm.h>
+#include <uve/vm_stat_kvm_reader.h>
 #include <uve/vm_stat_docker.h>
 
 VmUveTable::VmUveTable(Agent *agent, uint32_t default_intvl)
-    : VmUveTableBase(agent, default_intvl) {
+    : VmUveTableBase(agent, default_intvl), kvm_stat_reader_() {
     event_queue_.reset(new WorkQueue<VmStatData *>
             (TaskScheduler::GetInstance()->GetTaskId("Agent::Uve"), 0,
              boost::bind(&VmUveTable::Process, this, _1)));
@@ -76,7 +77,10 @@ void VmUveTable::VmStatCollectionStart(VmUveVmState *state, const VmEntry *vm) {
     //Create object to poll for VM stats
     VmStat *stat = NULL;
     if (agent_->isKvmMode()) {
-        stat = new VmStatKvm(agent_, vm->GetUuid());
+        if (kvm_stat_reader_.get() == NULL) {
+            kvm_stat_reader_.reset(new VmStatKvmReader());
+        }
+        stat = new VmStatKvm(agent_, vm->GetUuid(), kvm_stat_reader_);
     } else if (agent_->isDockerMode()) {
         stat = new VmStatDocker(agent_, vm->GetUuid());
     }
@@ -11,6 +11,8 @@
 #include <pkt/flow_proto.h>
 #include <pkt/flow_table.h>
 
+class VmStatKvmReader;
+
 class VmUveTable : public VmUveTableBase {
 public:
     VmUveTable(Agent *agent, uint32_t default_intvl);
@@ -31,6 +33,8 @@ private:
     virtual void SendVmDeleteMsg(const std::string &vm_config_name);
 
     boost::scoped_ptr<WorkQueue<VmStatData *> > event_queue_;
+    //Shared by the VmStatKvm objects of all the VMs
+    boost::shared_ptr<VmStatKvmReader> kvm_stat_reader_;
     DISALLOW_COPY_AND_ASSIGN(VmUveTable);
 };
 